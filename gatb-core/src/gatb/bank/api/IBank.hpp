@@ -95,6 +95,16 @@ public:
     /** \copydoc tools::collections::Iterable::iterator */
     virtual tools::dp::Iterator<Sequence>* iterator () = 0;
 
+    /** Split the bank into several iterators over disjoint parts of the bank; together, they
+     * iterate all the sequences of the bank. They can be used concurrently by different threads
+     * without sharing a lock (see IDispatcher::iterate with a vector of iterators).
+     *
+     * An implementation may return fewer iterators than requested, for instance a single one if
+     * the bank can't be split.
+     * \param[in] nbIterators : requested number of iterators
+     * \return the iterators (heap allocated, to be released by the caller) */
+    virtual std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbIterators) = 0;
+
     /** \copydoc tools::collections::Bag::insert */
     virtual void insert (const Sequence& item) = 0;
 
@@ -60,6 +60,13 @@ public:
 
 	
 	
+    /** \copydoc IBank::iterators
+     * By default, the bank is not split. */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbIterators)
+    {
+        return std::vector<tools::dp::Iterator<Sequence>*> (1, this->iterator());
+    }
+
     /** \copydoc IBank::estimateNbItems */
     int64_t estimateNbItems ()
     {
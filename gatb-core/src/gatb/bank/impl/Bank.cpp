@@ -47,9 +47,9 @@ Bank::Bank ()
 {
     /** We register most known factories. */
     _registerFactory_ ("album",  new BankAlbumFactory(),  false);
+    _registerFactory_ ("binary", new BankBinaryFactory(), false);
     _registerFactory_ ("fasta",  new BankFastaFactory(),  false);
 	_registerFactory_ ("leon", new BankLeonFactory(), false);
-    _registerFactory_ ("binary", new BankBinaryFactory(), false);
 
     DEBUG (("Bank::Bank,  found %ld factories\n", _factories.size()));
 }
@@ -132,6 +132,28 @@ IBankFactory* Bank::_getFactory_ (const std::string& name)
     return 0;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Bank::setNbDecompressThreads (IBank* bank, int64_t nb)
+{
+    if (nb < 0)  { throw system::Exception ("Bad number of decompression threads %lld", (long long)nb); }
+
+    if (BankFasta* fasta = dynamic_cast<BankFasta*> (bank))
+    {
+        fasta->setNbDecompressThreads (nb);
+    }
+    else if (BankComposite* composite = dynamic_cast<BankComposite*> (bank))
+    {
+        for (size_t i=0; i<composite->getBanks().size(); i++)  {  setNbDecompressThreads (composite->getBanks()[i], nb);  }
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -54,8 +54,9 @@ namespace impl      {
  *
  * Today, the following factories are registered:
  *  1) BankAlbumFactory
- *  2) BankFastaFactory
- *  3) BankBinaryFactory
+ *  2) BankBinaryFactory (BankBinary and BankBinaryIndexed; tried first since its check on the magic number is strict)
+ *  3) BankFastaFactory
+ *  4) BankLeonFactory
  *
  * During a call to 'open', each factory is tried (in the order of registration)
  * until a correct IBank object is returned; if no valid IBank is found, an exception
@@ -112,6 +113,12 @@ public:
     /** Get a factory for a given name. */
     static IBankFactory* getFactory (const std::string& name)  { return singleton()._getFactory_(name); }
 
+    /** Set the number of threads inflating the gzipped files of a bank (see BankFasta::setNbDecompressThreads).
+     * In case of a composite bank, it is set for each sub bank; other kinds of banks are left unchanged.
+     * \param[in] bank : the bank
+     * \param[in] nb : number of threads, an exception is thrown if it is negative */
+    static void setNbDecompressThreads (IBank* bank, int64_t nb);
+
 private:
 
     /** Private due to singleton method. */
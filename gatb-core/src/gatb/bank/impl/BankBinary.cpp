@@ -307,6 +307,59 @@ void BankBinary::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& m
     it.estimate (number, totalSize, maxSize);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the block headers are read to split the file on block boundaries
+*********************************************************************/
+std::vector<tools::dp::Iterator<Sequence>*> BankBinary::iterators (size_t nbIterators)
+{
+    std::vector<tools::dp::Iterator<Sequence>*> result;
+
+    /** We get the offsets of the blocks. */
+    std::vector<u_int64_t> offsets;
+
+    FILE* file = fopen (_filename.c_str(), "rb");
+    if (file == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    if (checkMagic (file))
+    {
+        u_int64_t    offset     = MAGIC_NUMBER != 0 ? sizeof(MAGIC_NUMBER) : 0;
+        unsigned int block_size = 0;
+
+        while (fread (&block_size, sizeof(unsigned int), 1, file) == 1)
+        {
+            offsets.push_back (offset);
+            offset += sizeof(unsigned int) + block_size;
+            if (fseeko (file, offset, SEEK_SET) != 0)  { break; }
+        }
+        offsets.push_back (offset);
+    }
+    fclose (file);
+
+    if (nbIterators <= 1 || offsets.size() <= 2)  {  result.push_back (iterator());  return result; }
+
+    /** We split the blocks into ranges of about the same size. */
+    u_int64_t begin = offsets.front();
+    u_int64_t total = offsets.back() - begin;
+
+    for (size_t i=1, b=0; i<=nbIterators && b+1<offsets.size(); i++)
+    {
+        u_int64_t limit = begin + (total * i) / nbIterators;
+        size_t    e     = b+1;
+        while (e+1 < offsets.size() && offsets[e] < limit)  { e++; }
+        if (i == nbIterators)  { e = offsets.size()-1; }
+
+        result.push_back (new Iterator (*this, offsets[b], offsets[e]));
+        b = e;
+    }
+
+    return result;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -363,10 +416,10 @@ bool BankBinary::check (const std::string& uri)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-BankBinary::Iterator::Iterator (BankBinary& ref)
+BankBinary::Iterator::Iterator (BankBinary& ref, u_int64_t offsetBegin, u_int64_t offsetEnd)
     : _ref(ref), _isDone(true), _bufferData (0), cpt_buffer(0), blocksize_toread(0), nseq_lues(0),
       binary_read_file(0),
-      _index(0)
+      _index(0), _offsetBegin(offsetBegin), _offsetEnd(offsetEnd), _offset(0)
 {
 }
 
@@ -410,10 +463,19 @@ void BankBinary::Iterator::first()
 
         /** We read the magic number. */
         if (checkMagic(binary_read_file)==false)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
+
+        /** We go to the first block of the range. */
+        _offset = MAGIC_NUMBER != 0 ? sizeof(MAGIC_NUMBER) : 0;
+        if (_offsetBegin > _offset)
+        {
+            fseeko (binary_read_file, _offsetBegin, SEEK_SET);
+            _offset = _offsetBegin;
+        }
     }
 
     /** We reinitialize some attributes. */
     _isDone          = false;
+    _index           = 0;
     cpt_buffer       = 0;
     blocksize_toread = 0;
     nseq_lues        = 0;
@@ -441,12 +503,14 @@ void BankBinary::Iterator::next ()
     if (cpt_buffer == blocksize_toread)
     {
         /** We read the size of the following cache buffer. */
-        if (! fread(&block_size,sizeof(unsigned int),1, binary_read_file)) //read block header
+        if (_offset >= _offsetEnd || ! fread(&block_size,sizeof(unsigned int),1, binary_read_file)) //read block header
         {
             _isDone = true;
             return;
         }
 
+        _offset += sizeof(unsigned int) + block_size;
+
         /** We are about to read another chunk of data from the disk. We need */
         setBufferData (new Data (block_size));
 
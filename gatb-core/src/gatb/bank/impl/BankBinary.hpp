@@ -29,6 +29,7 @@
 /********************************************************************************/
 
 #include <gatb/bank/impl/AbstractBank.hpp>
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
 
 #include <vector>
 #include <string>
@@ -88,6 +89,11 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
 
+    /** \copydoc IBank::iterators
+     * The iterators read disjoint ranges of blocks of the file; the indexes of their sequences
+     * are relative to the beginning of their range. */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbIterators);
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems () { return -1; }
 
@@ -123,8 +129,10 @@ public:
     public:
         /** Constructor.
          * \param[in] ref : the associated iterable instance.
+         * \param[in] offsetBegin : offset in the file of the first block to be read (0 for the first block of the file)
+         * \param[in] offsetEnd : offset in the file after the last block to be read (end of the file by default)
          */
-        Iterator (BankBinary& ref);
+        Iterator (BankBinary& ref, u_int64_t offsetBegin=0, u_int64_t offsetEnd=~(u_int64_t)0);
 
         /** Destructor */
         virtual ~Iterator ();
@@ -167,6 +175,11 @@ public:
         FILE* binary_read_file;
 
         size_t _index;
+
+        /** Range of the file to be read, and offset of the next block. */
+        u_int64_t _offsetBegin;
+        u_int64_t _offsetEnd;
+        u_int64_t _offset;
     };
 
 protected:
@@ -187,7 +200,7 @@ protected:
 
 /********************************************************************************/
 
-/* \brief Factory for the BankBinary class. */
+/* \brief Factory for the BankBinary and BankBinaryIndexed classes. */
 class BankBinaryFactory : public IBankFactory
 {
 public:
@@ -195,6 +208,7 @@ public:
     /** \copydoc IBankFactory::createBank */
     IBank* createBank (const std::string& uri)
     {
+        if (BankBinaryIndexed::check(uri))  { return new BankBinaryIndexed (uri); }
         return BankBinary::check(uri) ? new BankBinary (uri) : 0;
     }
 };
@@ -0,0 +1,672 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/BankBinaryIndexed.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <zlib.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::misc;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+static const u_int64_t MAGIC_NUMBER = 0x3258444e49424741ULL;   // "AGBINDX2"
+static const u_int32_t VERSION      = 2;
+
+/** Max number of sequences in a block. */
+static const size_t MAX_BLOCK_SEQUENCES = 1<<20;
+
+struct FileHeader
+{
+    u_int64_t magic;
+    u_int32_t version;
+    u_int32_t flags;
+};
+
+struct FileTrailer
+{
+    u_int64_t indexOffset;
+    u_int64_t nbBlocks;
+    u_int64_t nbSequences;
+    u_int64_t totalSize;
+    u_int64_t maxSize;
+    u_int32_t version;
+    u_int32_t flags;
+    u_int64_t magic;
+};
+
+/** Sizes of the parts of a block. */
+struct BlockHeader
+{
+    u_int32_t nbSequences;
+    u_int32_t nbRuns;
+    u_int32_t nucleotidesSize;
+    u_int32_t textSize;
+    u_int32_t textCompressedSize;
+};
+
+/********************************************************************************/
+
+/** Code of a nucleotide (A=0, C=1, T=2, G=3), or -1 for other letters (stored as N). */
+static const signed char* codeTable ()
+{
+    static signed char table[256];
+    static bool        init = false;
+
+    if (init == false)
+    {
+        for (size_t i=0; i<256; i++)  { table[i] = -1; }
+        const char* nt = "ACTGactg";
+        for (size_t i=0; i<8; i++)  { table[(unsigned char)nt[i]] = (nt[i]>>1) & 3; }
+        init = true;
+    }
+    return table;
+}
+
+/** The 4 letters encoded in a byte. */
+static const char* decodeTable ()
+{
+    static char table[256*4];
+    static bool init = false;
+
+    if (init == false)
+    {
+        const char* nt = "ACTG";
+        for (size_t i=0; i<256; i++)
+        {
+            for (size_t j=0; j<4; j++)  { table[4*i+j] = nt[(i >> (6-2*j)) & 3]; }
+        }
+        init = true;
+    }
+    return table;
+}
+
+/********************************************************************************/
+static void writeData (FILE* file, const void* data, size_t size)
+{
+    if (size > 0 && fwrite (data, 1, size, file) != size)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_write_file);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::BankBinaryIndexed (const std::string& filename, int flags, size_t blockSize)
+    : _filename(filename), _flags(flags), _writeFlags(flags), _blockSize(blockSize),
+      _nbSequences(0), _totalSize(0), _maxSize(0),
+      _writeFile(0), _writeOffset(0), _blockNbNucleotides(0)
+{
+    /** We make sure the tables are built before any concurrent use. */
+    codeTable ();
+    decodeTable ();
+
+    if (check (_filename))  {  load ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::~BankBinaryIndexed ()
+{
+    if (_writeFile != 0)  {  fclose (_writeFile);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankBinaryIndexed::check (const std::string& uri)
+{
+    bool result = false;
+
+    FILE* file = fopen (uri.c_str(), "rb");
+    if (file != NULL)
+    {
+        FileHeader header;
+        result = fread (&header, sizeof(header), 1, file) == 1 && header.magic == MAGIC_NUMBER && header.version == VERSION;
+        fclose (file);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : load the index of the blocks
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::load ()
+{
+    FILE* file = fopen (_filename.c_str(), "rb");
+    if (file == 0)  { throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str()); }
+
+    FileTrailer trailer;
+    bool ok = fseeko (file, -(off_t)sizeof(trailer), SEEK_END) == 0
+           && fread (&trailer, sizeof(trailer), 1, file) == 1
+           && trailer.magic == MAGIC_NUMBER;
+
+    if (ok)
+    {
+        _index.resize (trailer.nbBlocks);
+        ok = fseeko (file, trailer.indexOffset, SEEK_SET) == 0
+          && fread (_index.data(), sizeof(BlockInfo), _index.size(), file) == _index.size();
+    }
+
+    fclose (file);
+
+    if (!ok)  {  _index.clear();  throw gatb::core::system::Exception ("bad indexed binary bank '%s'", _filename.c_str());  }
+
+    _flags       = trailer.flags;
+    _nbSequences = trailer.nbSequences;
+    _totalSize   = trailer.totalSize;
+    _maxSize     = trailer.maxSize;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::insert (const Sequence& seq)
+{
+    /** We may have to create the file at first call. */
+    if (_writeFile == 0)  {  create ();  }
+
+    /** Shortcuts. */
+    const char* data     = seq.getDataBuffer();
+    size_t      len      = seq.getDataSize();
+
+    /** The lengths of the sequences are written on 4 bytes. */
+    if (len > (u_int32_t)~0)  {  throw gatb::core::system::Exception ("sequence too long (%lld) for indexed binary bank '%s'", (long long)len, _filename.c_str());  }
+    u_int32_t   seqIdx   = _blockLengths.size();
+    bool        isAscii  = seq.getDataEncoding() == Data::ASCII;
+    const signed char* code = codeTable();
+
+    _blockLengths.push_back (len);
+
+    /** We encode the nucleotides, 4 in one byte, and keep the runs of N. */
+    size_t        runStart = ~(size_t)0;
+    unsigned char current  = 0;
+
+    for (size_t i=0; i<len; i++)
+    {
+        int c;
+             if (isAscii)                                       {  c = code[(unsigned char)data[i]];  }
+        else if (seq.getDataEncoding() == Data::BINARY)         {  c = Data::ConvertBinary::get  (data, i).first;  }
+        else                                                    {  c = Data::ConvertInteger::get (data, i).first;  }
+
+        if (c < 0)
+        {
+            if (runStart == ~(size_t)0)  { runStart = i; }
+            c = 0;
+        }
+        else if (runStart != ~(size_t)0)
+        {
+            _blockRuns.push_back (seqIdx);  _blockRuns.push_back (runStart);  _blockRuns.push_back (i - runStart);
+            runStart = ~(size_t)0;
+        }
+
+        current = (current << 2) | c;
+        if ((i & 3) == 3)  { _blockNucleotides.push_back (current);  current = 0; }
+    }
+
+    if (runStart != ~(size_t)0)  {  _blockRuns.push_back (seqIdx);  _blockRuns.push_back (runStart);  _blockRuns.push_back (len - runStart);  }
+
+    if (len & 3)  { _blockNucleotides.push_back (current << (2 * (4 - (len & 3)))); }
+
+    /** We keep the comment and the quality. */
+    if (_flags & WITH_COMMENTS)   {  _blockText += seq.getComment();  _blockText += '\0';  }
+    if (_flags & WITH_QUALITIES)  {  _blockText += seq.getQuality();  _blockText += '\0';  }
+
+    _nbSequences ++;
+    _totalSize   += len;
+    if (len > _maxSize)  { _maxSize = len; }
+
+    _blockNbNucleotides += len;
+
+    if (_blockNbNucleotides >= _blockSize || _blockLengths.size() >= MAX_BLOCK_SEQUENCES)  {  writeBlock ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : create the file and write its header
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::create ()
+{
+    _writeFile = fopen (_filename.c_str(), "wb");
+    if (_writeFile == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    FileHeader header = { MAGIC_NUMBER, VERSION, (u_int32_t)_writeFlags };
+    writeData (_writeFile, &header, sizeof(header));
+
+    _flags       = _writeFlags;
+    _writeOffset = sizeof(header);
+    _index.clear();
+    _nbSequences = _totalSize = _maxSize = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : write the current block and add it to the index
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::writeBlock ()
+{
+    if (_blockLengths.empty())  { return; }
+
+    /** We compress the comments and qualities. */
+    vector<Bytef> text;
+    if (_blockText.empty() == false)
+    {
+        uLongf compressedSize = compressBound (_blockText.size());
+        text.resize (compressedSize);
+        if (compress2 (text.data(), &compressedSize, (const Bytef*)_blockText.data(), _blockText.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            throw gatb::core::system::Exception ("unable to compress block of bank '%s'", _filename.c_str());
+        }
+        text.resize (compressedSize);
+    }
+
+    /** The sizes of a block are written on 4 bytes. */
+    u_int64_t blockSize = sizeof(BlockHeader) + (_blockLengths.size() + _blockRuns.size())*sizeof(u_int32_t) + _blockNucleotides.size() + text.size();
+    if (blockSize > (u_int32_t)~0 || _blockText.size() > (u_int32_t)~0)
+    {
+        throw gatb::core::system::Exception ("block too big (%lld bytes) for indexed binary bank '%s'", (long long)blockSize, _filename.c_str());
+    }
+
+    BlockHeader header = {
+        (u_int32_t)_blockLengths.size(), (u_int32_t)(_blockRuns.size()/3), (u_int32_t)_blockNucleotides.size(),
+        (u_int32_t)_blockText.size(),    (u_int32_t)text.size()
+    };
+
+    writeData (_writeFile, &header,                   sizeof(header));
+    writeData (_writeFile, _blockLengths.data(),      _blockLengths.size()*sizeof(u_int32_t));
+    writeData (_writeFile, _blockRuns.data(),         _blockRuns.size()   *sizeof(u_int32_t));
+    writeData (_writeFile, _blockNucleotides.data(),  _blockNucleotides.size());
+    writeData (_writeFile, text.data(),               text.size());
+
+    BlockInfo info;
+    info.offset        = _writeOffset;
+    info.size          = blockSize;
+    info.nbSequences   = _blockLengths.size();
+    info.firstSequence = _nbSequences - _blockLengths.size();
+    info.nbNucleotides = _blockNbNucleotides;
+    _index.push_back (info);
+
+    _writeOffset += info.size;
+
+    _blockLengths.clear();
+    _blockRuns.clear();
+    _blockNucleotides.clear();
+    _blockText.clear();
+    _blockNbNucleotides = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::flush ()
+{
+    /** A bank without any inserted sequence is still written (header and empty index), unless
+     * it is an existing bank. */
+    if (_writeFile == 0)
+    {
+        if (check (_filename))  { return; }
+        create ();
+    }
+
+    writeBlock ();
+
+    /** We write the index and the trailer. */
+    FileTrailer trailer = {
+        _writeOffset, _index.size(), _nbSequences, _totalSize, _maxSize, VERSION, (u_int32_t)_flags, MAGIC_NUMBER
+    };
+
+    writeData (_writeFile, _index.data(), _index.size()*sizeof(BlockInfo));
+    writeData (_writeFile, &trailer,      sizeof(trailer));
+
+    if (fclose (_writeFile) != 0)  {  _writeFile = 0;  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_write_file);  }
+    _writeFile = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t BankBinaryIndexed::getSize ()
+{
+    return System::file().getSize (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the information is exact, since it is in the trailer of the file
+*********************************************************************/
+void BankBinaryIndexed::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    number    = _nbSequences;
+    totalSize = _totalSize;
+    maxSize   = _maxSize;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::remove ()
+{
+    System::file().remove (_filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the ranges have about the same number of nucleotides
+*********************************************************************/
+std::vector<tools::dp::Iterator<Sequence>*> BankBinaryIndexed::iterators (size_t nbRanges)
+{
+    std::vector<tools::dp::Iterator<Sequence>*> result;
+
+    size_t nbBlocks = _index.size();
+    nbRanges = std::max ((size_t)1, std::min (nbRanges, nbBlocks));
+
+    size_t begin = 0;
+    u_int64_t cumul = 0;
+
+    for (size_t r=1; r<=nbRanges; r++)
+    {
+        size_t end = begin;
+        u_int64_t target = (_totalSize * r) / nbRanges;
+
+        /** Each range keeps at least one block, and leaves at least one block to each following range. */
+        while (end < nbBlocks && (end == begin || cumul < target) && nbBlocks - end > nbRanges - r)
+        {
+            cumul += _index[end].nbNucleotides;
+            end ++;
+        }
+        if (r == nbRanges)  { end = nbBlocks; }
+
+        result.push_back (new Iterator (*this, begin, end));
+        begin = end;
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::Iterator::Iterator (BankBinaryIndexed& ref, size_t blockBegin, size_t blockEnd)
+    : _ref(ref), _blockBegin(blockBegin), _blockEnd(std::min (blockEnd, ref._index.size())), _iterEnd(_blockEnd),
+      _isDone(true), _file(0), _block(0), _seqInBlock(0), _loadedBlock(~(size_t)0), _lengths(0), _bufferData(0)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinaryIndexed::Iterator::~Iterator ()
+{
+    if (_file != 0)  {  fclose (_file);  }
+
+    setBufferData (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::first ()
+{
+    _block      = _blockBegin;
+    _seqInBlock = 0;
+    _iterEnd    = _blockEnd;
+    _isDone     = _block >= _iterEnd;
+
+    if (!_isDone)  {  loadBlock (_block);  update ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::next ()
+{
+    if (++_seqInBlock >= _ref._index[_block].nbSequences)
+    {
+        _seqInBlock = 0;
+        if (++_block >= _iterEnd)  {  _isDone = true;  return;  }
+        loadBlock (_block);
+    }
+
+    update ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BankBinaryIndexed::Iterator::jump (u_int64_t index)
+{
+    if (index >= _ref._nbSequences)  { return false; }
+
+    /** We look for the last block whose first sequence is before the wanted one. */
+    size_t lo = 0, hi = _ref._index.size();
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (_ref._index[mid].firstSequence <= index)  { lo = mid; }  else  { hi = mid; }
+    }
+
+    _block      = lo;
+    _seqInBlock = index - _ref._index[lo].firstSequence;
+    _isDone     = false;
+
+    /** The iteration goes on up to the end of the block if it is beyond the range. */
+    _iterEnd = std::max (_blockEnd, _block + 1);
+
+    loadBlock (_block);
+    update ();
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : read a block and decode its nucleotides
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::loadBlock (size_t block)
+{
+    if (block == _loadedBlock)  { return; }
+
+    /** We open the binary file at first call. */
+    if (_file == 0)
+    {
+        _file = fopen (_ref._filename.c_str(), "rb");
+        if (_file == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
+    }
+
+    const BlockInfo& info = _ref._index[block];
+
+    _raw.resize (info.size);
+    if (fseeko (_file, info.offset, SEEK_SET) != 0 || fread (_raw.data(), 1, info.size, _file) != info.size)
+    {
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());
+    }
+
+    /** Shortcuts on the parts of the block. */
+    BlockHeader header;
+    memcpy (&header, _raw.data(), sizeof(header));
+
+    _lengths                       = (const u_int32_t*) (_raw.data() + sizeof(header));
+    const u_int32_t*     runs      = _lengths + header.nbSequences;
+    const unsigned char* nucl      = (const unsigned char*) (runs + 3*header.nbRuns);
+    const unsigned char* text      = nucl + header.nucleotidesSize;
+
+    /** We decode the nucleotides; a new buffer is used since previous sequences may still refer to the former one. */
+    setBufferData (new Data (info.nbNucleotides, Data::ASCII));
+    char*       out    = _bufferData->getBuffer();
+    const char* decode = decodeTable();
+
+    _offsets.resize (header.nbSequences);
+
+    u_int64_t offset = 0;
+    for (size_t i=0; i<header.nbSequences; i++)
+    {
+        u_int32_t len = _lengths[i];
+        _offsets[i] = offset;
+
+        for (u_int32_t j=0; j+4 <= len; j+=4)  {  memcpy (out + offset + j, decode + 4*(*nucl++), 4);  }
+        if (len & 3)                           {  memcpy (out + offset + (len & ~3), decode + 4*(*nucl++), len & 3);  }
+
+        offset += len;
+    }
+
+    for (size_t r=0; r<header.nbRuns; r++, runs+=3)  {  memset (out + _offsets[runs[0]] + runs[1], 'N', runs[2]);  }
+
+    /** We inflate the comments and qualities. */
+    _text.resize (header.textSize);
+    if (header.textSize > 0)
+    {
+        uLongf size = header.textSize;
+        if (uncompress ((Bytef*)_text.data(), &size, text, header.textCompressedSize) != Z_OK || size != header.textSize)
+        {
+            throw gatb::core::system::Exception ("bad block in indexed binary bank '%s'", _ref._filename.c_str());
+        }
+    }
+
+    _textOffsets.resize (header.nbSequences);
+    size_t nbStrings = ((_ref._flags & WITH_COMMENTS) ? 1 : 0) + ((_ref._flags & WITH_QUALITIES) ? 1 : 0);
+    for (size_t i=0, pos=0; i<header.nbSequences && nbStrings>0; i++)
+    {
+        _textOffsets[i] = pos;
+        for (size_t k=0; k<nbStrings; k++)  { pos += strlen (_text.data() + pos) + 1; }
+    }
+
+    _loadedBlock = block;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinaryIndexed::Iterator::update ()
+{
+    size_t i = _seqInBlock;
+
+    _item->setDataRef (_bufferData, _offsets[i], _lengths[i]);
+    _item->setIndex   (_ref._index[_block].firstSequence + i);
+
+    const char* text = _text.data() + (_text.empty() ? 0 : _textOffsets[i]);
+
+    if (_ref._flags & WITH_COMMENTS)   {  _item->_comment.assign (text);  text += _item->_comment.size() + 1;  }
+    if (_ref._flags & WITH_QUALITIES)  {  _item->_quality.assign (text);  }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,259 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BankBinaryIndexed.hpp
+ *  \brief Indexed binary bank format, with random access to blocks of sequences
+ */
+
+#ifndef _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_
+#define _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/AbstractBank.hpp>
+
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Implementation of IBank for an indexed binary format (version 2 of the binary bank)
+ *
+ * In contrast to BankBinary, the sequences are kept as they are (no split on N), with their
+ * comments and qualities (optional), and the file has an index of its blocks, so:
+ *   - several threads can iterate disjoint ranges of blocks (see 'iterators')
+ *   - a sequence can be reached by its index with one seek (see Iterator::jump).
+ *
+ * A binary file is made of:
+ *    - a header: magic number (8 bytes), version and flags (4 bytes each)
+ *    - a list of blocks; a block is:
+ *          - number of sequences, of N runs, size of the nucleotides, raw and compressed sizes of the text (4 bytes each)
+ *          - the length of each sequence (4 bytes each)
+ *          - the N runs: index of the sequence in the block, position and length (4 bytes each)
+ *          - the nucleotides of each sequence (4 nucleotides encoded in 1 byte, each sequence
+ *            starting on a new byte); N are encoded as A
+ *          - the comments and qualities of the sequences, compressed with zlib; each one ends with a null character.
+ *    - the index: offset in the file, size, number of sequences, index of the first sequence
+ *      and number of nucleotides of each block
+ *    - a trailer: offset of the index, number of blocks, number of sequences, total and max
+ *      size of the sequences, version, flags and magic number.
+ *
+ * Nucleotides are stored upper case; any letter other than A, C, G or T is stored as N.
+ *
+ * The iterated sequences are in ASCII, like the sequences of a FASTA bank.
+ *
+ * BankConverterAlgorithm creates such banks, and BankBinaryFactory recognizes them, so a bank
+ * converted once can be given as input instead of the original FASTA/FASTQ files.
+ */
+class BankBinaryIndexed : public AbstractBank
+{
+public:
+
+    /** Returns the name of the bank format. */
+    static const char* name()  { return "binary_indexed"; }
+
+    /** Kind of information kept besides the nucleotides. */
+    enum Flags_e
+    {
+        WITH_COMMENTS  = 1,
+        WITH_QUALITIES = 2
+    };
+
+    /** Constructor. If the file exists, its index is loaded; it is replaced by the first call to 'insert'.
+     * \param[in] filename : uri of the bank.
+     * \param[in] flags : information to be written besides the nucleotides (see Flags_e)
+     * \param[in] blockSize : number of nucleotides of a block (the last sequence of a block may go beyond) */
+    BankBinaryIndexed (const std::string& filename, int flags=WITH_COMMENTS|WITH_QUALITIES, size_t blockSize=1<<20);
+
+    /** Destructor. */
+    ~BankBinaryIndexed ();
+
+    /** \copydoc IBank::getId. */
+    std::string getId ()  { return _filename; }
+
+    /** \copydoc IBank::iterator */
+    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+
+    /** Split the bank into iterators over disjoint ranges of blocks. The iterators may be used
+     * concurrently by different threads.
+     * \param[in] nbRanges : requested number of iterators.
+     * \return a vector of at most nbRanges iterators (heap allocated, to be released by the caller). */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbRanges);
+
+    /** \copydoc IBank::getNbItems */
+    int64_t getNbItems () { return _nbSequences; }
+
+    /** \copydoc IBank::insert */
+    void insert (const Sequence& item);
+
+    /** \copydoc IBank::flush */
+    void flush ();
+
+    /** \copydoc IBank::getSize */
+    u_int64_t getSize ();
+
+    /** \copydoc IBank::estimate */
+    void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    /** \copydoc IBank::remove. */
+    void remove ();
+
+    /** Get the number of blocks of the bank.
+     * \return the number of blocks. */
+    size_t getNbBlocks () const  { return _index.size(); }
+
+    /** Get the flags of the bank.
+     * \return the flags (see Flags_e) */
+    int getFlags () const  { return _flags; }
+
+    /** Check that the given uri is a correct indexed binary bank. */
+    static bool check (const std::string& uri);
+
+    /************************************************************/
+
+    /** \brief Specific Iterator impl for BankBinaryIndexed class
+     *
+     * The iterator reads a whole block at once and decodes it into an ASCII buffer; the
+     * sequences refer to this buffer.
+     */
+    class Iterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+        /** Constructor.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] blockBegin : index of the first block to be iterated
+         * \param[in] blockEnd : index after the last block to be iterated (all the blocks by default)
+         */
+        Iterator (BankBinaryIndexed& ref, size_t blockBegin=0, size_t blockEnd=~(size_t)0);
+
+        /** Destructor */
+        virtual ~Iterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _isDone; }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()  { return *_item; }
+
+        /** Go to a sequence given by its index in the bank. The iteration then goes on from this
+         * sequence up to the end of the block range of the iterator (or of the block of the sequence
+         * if it is beyond this range). The block range itself is not changed: 'first' still starts
+         * the iteration of the range.
+         * \param[in] index : index of the sequence in the bank
+         * \return false if there is no such sequence. */
+        bool jump (u_int64_t index);
+
+    private:
+
+        /** Reference to the underlying Iterable instance. */
+        BankBinaryIndexed& _ref;
+
+        /** Range of the blocks of the iterator. */
+        const size_t _blockBegin;
+        const size_t _blockEnd;
+
+        /** Index after the last block of the current iteration (see jump). */
+        size_t _iterEnd;
+
+        /** Tells whether the iteration is finished or not. */
+        bool _isDone;
+
+        FILE* _file;
+
+        /** Current block and sequence in this block. */
+        size_t    _block;
+        u_int32_t _seqInBlock;
+        size_t    _loadedBlock;
+
+        /** Data of the current block: lengths of the sequences, offsets of their nucleotides
+         * in the decoded buffer and of their comments/qualities in the text. */
+        std::vector<unsigned char> _raw;
+        std::vector<char>          _text;
+        std::vector<u_int64_t>     _offsets;
+        std::vector<u_int32_t>     _textOffsets;
+        const u_int32_t*           _lengths;
+
+        /** Decoded nucleotides of the current block. */
+        tools::misc::Data* _bufferData;
+        void setBufferData (tools::misc::Data* bufferData)  { SP_SETATTR(bufferData); }
+
+        /** Read and decode a block. */
+        void loadBlock (size_t block);
+
+        /** Set the item to the current sequence. */
+        void update ();
+    };
+
+protected:
+
+    /** Index of a block. */
+    struct BlockInfo
+    {
+        u_int64_t offset;
+        u_int32_t size;
+        u_int32_t nbSequences;
+        u_int64_t firstSequence;
+        u_int64_t nbNucleotides;
+    };
+
+    /** URI of the bank. */
+    std::string _filename;
+
+    /** Flags of the iterated bank, and of the bank to be written. */
+    int    _flags;
+    int    _writeFlags;
+    size_t _blockSize;
+
+    /** Index of the blocks and global information. */
+    std::vector<BlockInfo> _index;
+    u_int64_t _nbSequences;
+    u_int64_t _totalSize;
+    u_int64_t _maxSize;
+
+    /** Writing: output file and content of the current block. */
+    FILE*                      _writeFile;
+    u_int64_t                  _writeOffset;
+    std::vector<u_int32_t>     _blockLengths;
+    std::vector<u_int32_t>     _blockRuns;
+    std::vector<unsigned char> _blockNucleotides;
+    std::string                _blockText;
+    u_int64_t                  _blockNbNucleotides;
+
+    void load ();
+    void create ();
+    void writeBlock ();
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK__IMPL_BANK_BINARY_INDEXED_HPP_ */
@@ -116,6 +116,49 @@ public:
         return new tools::dp::impl::CompositeIterator<Sequence> (iterators);
     }
 
+    /** \copydoc IBank::iterators
+     * With fewer iterators than banks, each iterator goes through consecutive banks; otherwise,
+     * the banks are split. In both cases, the iterators get about the same amount of data. */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbIterators)
+    {
+        std::vector<tools::dp::Iterator<Sequence>*> result;
+
+        std::vector<u_int64_t> cumul (_banks.size()+1, 0);
+        for (size_t i=0; i<_banks.size(); i++)  {  cumul[i+1] = cumul[i] + std::max ((u_int64_t)1, _banks[i]->getSize());  }
+
+        if (nbIterators <= 1 || _banks.empty())  {  result.push_back (iterator());  }
+
+        else if (nbIterators < _banks.size())
+        {
+            for (size_t i=0, begin=0; i<nbIterators; i++)
+            {
+                /** Each iterator keeps at least one bank, and leaves at least one bank to each following iterator. */
+                size_t end = begin+1;
+                while (end < _banks.size() - (nbIterators-1-i) && cumul[end] < (cumul.back() * (i+1)) / nbIterators)  { end++; }
+                if (i == nbIterators-1)  { end = _banks.size(); }
+
+                std::vector<tools::dp::Iterator<Sequence>*> its;
+                for (size_t b=begin; b<end; b++)  {  its.push_back (_banks[b]->iterator());  }
+                result.push_back (its.size()==1 ? its[0] : new tools::dp::impl::CompositeIterator<Sequence> (its));
+
+                begin = end;
+            }
+        }
+
+        else
+        {
+            for (size_t i=0; i<_banks.size(); i++)
+            {
+                size_t nb = (nbIterators*cumul[i+1] + cumul.back()/2) / cumul.back() - (nbIterators*cumul[i] + cumul.back()/2) / cumul.back();
+
+                std::vector<tools::dp::Iterator<Sequence>*> its = _banks[i]->iterators (std::max ((size_t)1, nb));
+                result.insert (result.end(), its.begin(), its.end());
+            }
+        }
+
+        return result;
+    }
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems ()
     {
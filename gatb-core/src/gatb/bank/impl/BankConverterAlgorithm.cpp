@@ -198,8 +198,9 @@ IBank* BankConverterAlgorithm::createBank (
         nbInputSequences, outputName.c_str(), nbSeq
     ));
 
-    /** We create a new binary bank. */
-    IBank* result = new BankBinary (outputName, _kmerSize);
+    /** We create a new binary bank. The sequences are kept whole (with their N, comments and
+     * qualities) in an indexed bank, so the result can be iterated by several threads. */
+    IBank* result = new BankBinaryIndexed (outputName);
 
     /** We need an iterator on the input bank. */
     Iterator<Sequence>* itBank = createIterator<Sequence> (
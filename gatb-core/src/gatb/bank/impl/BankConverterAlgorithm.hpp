@@ -42,7 +42,9 @@ namespace impl      {
 
 /** \brief Algorithm implementation that converts a bank into a binary one
  *
- * This algorithm converts an input IBank instance into a binary output bank.
+ * This algorithm converts an input IBank instance into a binary output bank (see
+ * BankBinaryIndexed). The binary bank can later be opened through Bank::open like the
+ * original bank, which avoids parsing text files again.
  *
  * It subclasses gatb::core::tools::misc::impl::Algorithm in order to get all the features
  * of its parent class.
@@ -56,7 +58,7 @@ public:
 
     /** Constructor.
      * \param[in] bank : bank to be converted (likely in FASTA format)
-     * \param[in] kmerSize : kmer size
+     * \param[in] kmerSize : kmer size (not used: the sequences are kept whole)
      * \param[in] outputUri : uri of the output binary bank. */
     BankConverterAlgorithm (IBank* bank, size_t kmerSize, const std::string& outputUri);
 
@@ -19,6 +19,7 @@
 
 #include <gatb/bank/impl/BankFasta.hpp>
 #include <gatb/bank/impl/BankComposite.hpp>
+#include <gatb/bank/impl/GzipReader.hpp>
 
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
@@ -29,6 +30,10 @@
 #include <string.h>
 #include <errno.h>
 #include <zlib.h> // Added by Pierre Peterlongo on 02/08/2012.
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace gatb::core::tools::dp;
@@ -54,21 +59,107 @@ size_t BankFasta::_dataLineSize = 70;
 
 /********************************************************************************/
 // heavily inspired by kseq.h from Heng Li (https://github.com/attractivechaos/klib)
+// A plain (not gzipped) file is memory mapped: the buffer is then the mapped window of the file
+// (the byte range of the iterator), which is never refilled, and sequences may refer directly
+// to the mapped bytes. Beyond the window, the file is read through 'stream' into an allocated buffer.
+// A gzipped file may be inflated in background threads by 'reader' instead of 'stream'.
 typedef struct
 {
     gzFile stream;
+    GzipReader* reader;
     unsigned char *buffer;
-    int buffer_start, buffer_end;
+    int64_t buffer_start, buffer_end;
     bool eof;
     char last_char;
+    u_int64_t buffer_offset;  // offset in the file of buffer[0]
+    unsigned char *mapping;   // mapped window of the file, 0 if the file is read through 'stream' only
+    u_int64_t mapping_offset; // offset in the file of the window (page aligned)
+    u_int64_t mapping_size;   // size of the window
+    u_int64_t file_size;      // size of the mapped file
+    int mapping_fd;           // descriptor of the mapped file, kept for mapping it again
+
+    /** Tell whether the buffer is the mapped window. */
+    bool mapped () const  { return mapping != 0 && buffer == mapping; }
+
+    /** Map (again) the window of the file. */
+    bool map (void* addr, int flags)
+    {
+        void* res = mmap (addr, mapping_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_NORESERVE|flags, mapping_fd, mapping_offset);
+        if (res == MAP_FAILED)  { return false; }
+        madvise (res, mapping_size, MADV_SEQUENTIAL);
+        mapping = (unsigned char*) res;
+        return true;
+    }
+
+    /** Read the file through 'stream' from the given offset, in an allocated buffer. The window
+     * stays mapped, since sequences may still refer to it. */
+    void read_stream (u_int64_t offset)
+    {
+        if (mapped())  {  buffer = (unsigned char*) MALLOC (BUFFER_SIZE);  }
+        gzseek (stream, offset, SEEK_SET);
+        eof           = 0;
+        buffer_start  = 0;
+        buffer_end    = 0;
+        buffer_offset = offset;
+    }
+
+    void rewind (u_int64_t offset=0)
+    {
+        last_char     = 0;
+
+        if (mapping != 0 && offset >= mapping_offset)
+        {
+            /** The clients may have modified the (private) mapped bytes through the data of the
+             * sequences: we map the window again at the same address, which drops these changes.
+             * If it can't be done, the file is read through 'stream' from now on. */
+            if (map (mapping, MAP_FIXED) == false)
+            {
+                if (mapped())  {  buffer = (unsigned char*) MALLOC (BUFFER_SIZE);  }
+                munmap (mapping, mapping_size);
+                mapping = 0;
+            }
+        }
+
+        if (mapping != 0 && offset >= mapping_offset)
+        {
+            if (!mapped())  {  FREE (buffer);  buffer = mapping;  }
+
+            eof           = mapping_offset + mapping_size >= file_size;
+            buffer_start  = std::min (offset - mapping_offset, mapping_size);
+            buffer_end    = mapping_size;
+            buffer_offset = mapping_offset;
+            return;
+        }
+
+        if (mapped())  {  buffer = (unsigned char*) MALLOC (BUFFER_SIZE);  }
+
+        if (reader != 0)
+        {
+            /** The reader can only go back to the beginning, so we skip the data up to the offset. */
+            reader->rewind ();
+            for (u_int64_t nb=offset; nb > 0; )
+            {
+                int len = reader->read (buffer, std::min (nb, (u_int64_t)BUFFER_SIZE));
+                if (len <= 0)  { break; }
+                nb -= len;
+            }
+        }
+        else if (offset==0)  { gzrewind (stream); }
+        else                 { gzseek   (stream, offset, SEEK_SET); }
+        eof           = 0;
+        buffer_start  = 0;
+        buffer_end    = 0;
+        buffer_offset = offset;
+    }
+
+    /** Offset in the file of the last character got through buffered_getc. */
+    u_int64_t last_offset () const  { return buffer_offset + buffer_start - 1; }
 
-    void rewind ()
+    /** Offset in the (uncompressed) file of the next character to be read from the file. */
+    u_int64_t position ()
     {
-        gzrewind (stream);
-        last_char    = 0;
-        eof          = 0;
-        buffer_start = 0;
-        buffer_end   = 0;
+        if (mapped())  { return buffer_offset + std::min ((u_int64_t)buffer_start, mapping_size); }
+        return reader != 0 ? reader->tell() : gztell (stream);
     }
 
 } buffered_file_t;
@@ -107,10 +198,12 @@ struct buffered_strings_t
 ** REMARKS :
 *********************************************************************/
 BankFasta::BankFasta (const std::string& filename, bool output_fastq, bool output_gz)
-    : filesizes(0), nb_files(0), _insertHandle(0), _gz_insertHandle(0)
+    : filesizes(0), nb_files(0), _insertHandle(0), _gzWriter(0), _insertSynchro(0), _nbDecompressThreads(0),
+      _nbCompressThreads(0), _outputBGZF(false)
 {
     _output_fastq = output_fastq;
     _output_gz= output_gz;
+    setInsertSynchro (System::thread().newSynchronizer());
     _filenames.push_back (filename);
     init ();
 }
@@ -125,8 +218,10 @@ BankFasta::BankFasta (const std::string& filename, bool output_fastq, bool outpu
 *********************************************************************/
 BankFasta::~BankFasta ()
 {
-    if (_insertHandle    != 0)  { fclose  (_insertHandle);    }
-    if (_gz_insertHandle != 0)  { gzclose (_gz_insertHandle); }
+    if (_insertHandle != 0)  { fclose (_insertHandle); }
+    delete _gzWriter;
+
+    setInsertSynchro (0);
 }
 
 /*********************************************************************
@@ -139,8 +234,10 @@ BankFasta::~BankFasta ()
 *********************************************************************/
 void BankFasta::finalize ()
 {
-    if (_insertHandle    != 0)  { fclose  (_insertHandle);    _insertHandle    = 0; }
-    if (_gz_insertHandle != 0)  { gzclose (_gz_insertHandle); _gz_insertHandle = 0; }
+    LocalSynchronizer synchro (_insertSynchro);
+
+    if (_insertHandle != 0)  { fclose (_insertHandle);  _insertHandle = 0; }
+    if (_gzWriter     != 0)  { delete _gzWriter;        _gzWriter     = 0; }
 }
 
 /*********************************************************************
@@ -213,10 +310,72 @@ void BankFasta::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& ma
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void BankFasta::flush ()
+bool BankFasta::isSplittable ()
 {
-    if (_insertHandle    != 0)  { fflush  (_insertHandle);              }
-    if (_gz_insertHandle != 0)  { gzflush (_gz_insertHandle, Z_FINISH); }
+    bool result = false;
+
+    /** gzdirect tells us whether zlib reads the file as is (ie. no compression). */
+    if (gzFile stream = gzopen (_filenames[0].c_str(), "r"))  {  result = gzdirect (stream) == 1;  gzclose (stream);  }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  : fasta_record_start
+** PURPOSE : find the offset of the first record header starting at or after a given offset
+** INPUT   : file, offset, file size, fastq flag
+** OUTPUT  :
+** RETURN  : offset of the record header (or file size if none)
+** REMARKS : a FASTA record begins with a '>' at the beginning of a line. A FASTQ record begins with
+**           a '@' at the beginning of a line whose second following line begins with a '+'; this
+**           discards quality lines that begin with a '@'.
+*********************************************************************/
+static u_int64_t fasta_record_start (FILE* file, u_int64_t offset, u_int64_t fileSize, bool fastq)
+{
+    if (offset == 0)  { return 0; }
+
+    /** We start one character before the offset in order to know whether a line starts at the offset. */
+    if (fseeko (file, offset-1, SEEK_SET) != 0)  { return fileSize; }
+
+    /** We keep the offset and the first character of the last three lines. */
+    u_int64_t linePos[3];
+    int       lineChar[3];
+    size_t    nbLines = 0;
+
+    u_int64_t pos  = offset-1;
+    int       prev = fgetc (file);
+    int       c;
+
+    for ( ; (c = fgetc (file)) != EOF; prev = c)
+    {
+        pos++;
+
+        if (prev != '\n')  { continue; }
+
+        /** A line starts at 'pos'. */
+        if (!fastq)
+        {
+            if (c == '>')  { return pos; }
+            continue;
+        }
+
+        if (nbLines == 3)
+        {
+            linePos [0] = linePos [1];  linePos [1] = linePos [2];
+            lineChar[0] = lineChar[1];  lineChar[1] = lineChar[2];
+            nbLines--;
+        }
+        linePos [nbLines] = pos;
+        lineChar[nbLines] = c;
+        nbLines++;
+
+        if (nbLines == 3 && lineChar[0] == '@' && lineChar[2] == '+')  { return linePos[0]; }
+    }
+
+    /** Last chance for a FASTQ record whose '+' line is the last line of the file. */
+    if (fastq && nbLines == 3 && lineChar[0] == '@' && lineChar[2] == '+')  { return linePos[0]; }
+
+    return fileSize;
 }
 
 /*********************************************************************
@@ -227,70 +386,104 @@ void BankFasta::flush ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void BankFasta::insert (const Sequence& item)
+std::vector<tools::dp::Iterator<Sequence>*> BankFasta::iterators (size_t nbRanges)
 {
-    /** We open the last file if needed. */
-    if (_insertHandle == 0  &&  _filenames.empty()==false)
-    {
-        _insertHandle = fopen (_filenames[_filenames.size()-1].c_str(), "w");
-    }
+    /** Under this size per range, splitting the file is not worth it. */
+    static const u_int64_t MIN_RANGE_SIZE = 1024*1024;
 
-    if (_output_gz && _gz_insertHandle == 0  &&  _filenames.empty()==false)
-    {
-        _gz_insertHandle =  gzopen (_filenames[_filenames.size()-1].c_str(), "w");
-    }
-    
-    if (_insertHandle != 0)
+    std::vector<tools::dp::Iterator<Sequence>*> result;
+
+    u_int64_t fileSize = System::file().getSize (_filenames[0]);
+
+    if (nbRanges > 1  &&  fileSize >= nbRanges*MIN_RANGE_SIZE  &&  isSplittable())
     {
-        if(_output_fastq)
+        if (FILE* file = fopen (_filenames[0].c_str(), "r"))
         {
-            if(_output_gz)
+            /** We look for the format of the records from the first non blank character. */
+            int c;
+            while ((c = fgetc (file)) != EOF && isspace(c))  {}
+            bool fastq = (c == '@');
+
+            /** We compute the ranges boundaries, each one being moved to the next record start. */
+            std::vector<u_int64_t> bounds;
+            bounds.push_back (0);
+            for (size_t i=1; i<nbRanges; i++)
             {
-                gzprintf (_gz_insertHandle, "@%s\n", item.getComment().c_str());
-                gzprintf (_gz_insertHandle, "%.*s\n",(int)item.getDataSize(),  item.getDataBuffer());
-                gzprintf (_gz_insertHandle, "+\n");
-                gzprintf (_gz_insertHandle, "%s\n", item.getQuality().c_str());
+                bounds.push_back (std::max (bounds.back(), fasta_record_start (file, (fileSize*i)/nbRanges, fileSize, fastq)));
             }
-            else
+            bounds.push_back (fileSize);
+
+            fclose (file);
+
+            for (size_t i=0; i<nbRanges; i++)
             {
-                fprintf (_insertHandle, "@%s\n", item.getComment().c_str());
-                fprintf (_insertHandle, "%.*s\n",(int)item.getDataSize(),  item.getDataBuffer());
-                fprintf (_insertHandle, "+\n");
-                fprintf (_insertHandle, "%s\n", item.getQuality().c_str());
+                if (bounds[i] < bounds[i+1])  {  result.push_back (new Iterator (*this, bounds[i], bounds[i+1]));  }
             }
-
         }
-        else
-        {
-        /** We add the sequence into the bag. */
-        fprintf (_insertHandle, ">%s\n", item.getComment().c_str());
+    }
 
-#if 1
-        fprintf (_insertHandle, "%.*s\n",(int)item.getDataSize(),  item.getDataBuffer());
-#else
-        // We dump the data with fixed sized columns
-        char line[4*1024];
-        char* loop = line;
-        size_t actualDataLineSize = _dataLineSize > 0 ? _dataLineSize : (size_t)(~0);
+    /** By default, we have a single iterator on the whole bank. */
+    if (result.empty())  {  result.push_back (iterator());  }
 
-        size_t len = item.getDataSize();
+    return result;
+}
 
-        for (size_t i=0; i<len; )
-        {
-            size_t j=0;
-            for (j=0; j<actualDataLineSize && i<len; j++, i++)
-            {
-                *(loop++) = item.getDataBuffer() [i];
-                if (j >= sizeof(line)-2)
-                {
-                    *(loop++) = 0;   fprintf (_insertHandle, "%s", line);     loop = line;
-                }
-            }
-            *(loop++) = 0;    fprintf (_insertHandle, "%s\n", line);    loop = line;
-        }
-#endif
-        }
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFasta::flush ()
+{
+    LocalSynchronizer synchro (_insertSynchro);
+
+    if (_insertHandle != 0)  { fflush (_insertHandle);  }
+    if (_gzWriter     != 0)  { _gzWriter->flush();      }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFasta::insert (const Sequence& item)
+{
+    LocalSynchronizer synchro (_insertSynchro);
+
+    /** We open the last file if needed. */
+    if (_insertHandle == 0  &&  _gzWriter == 0  &&  _filenames.empty()==false)
+    {
+        const string& filename = _filenames[_filenames.size()-1];
+
+        if (_output_gz)  {  _gzWriter = new GzipWriter (filename, _outputBGZF ? GzipWriter::BGZF : GzipWriter::GZIP, _nbCompressThreads);  }
+        else             {  _insertHandle = fopen (filename.c_str(), "w");  }
+    }
+
+    /** We format the whole record, so it is written with a single call. */
+    string& record = _insertBuffer;
+    record.clear();
+
+    record += _output_fastq ? '@' : '>';
+    record += item.getComment();
+    record += '\n';
+    record.append (item.getDataBuffer(), item.getDataSize());
+    record += '\n';
+
+    if (_output_fastq)
+    {
+        record += "+\n";
+        record += item.getQuality();
+        record += '\n';
     }
+
+    if (_gzWriter != 0)           {  _gzWriter->write (record.data(), record.size());  }
+    else if (_insertHandle != 0)  {  fwrite (record.data(), 1, record.size(), _insertHandle);  }
 }
 
 /*********************************************************************
@@ -303,6 +496,7 @@ void BankFasta::insert (const Sequence& item)
 *********************************************************************/
 BankFasta::Iterator::Iterator (BankFasta& ref, CommentMode_e commentMode)
     : _ref(ref), _commentsMode(commentMode), _isDone(true), _isInitialized(false), _nIters(0),
+      _offsetBegin(0), _offsetEnd(~((u_int64_t)0)),
       index_file(0), buffered_file(0), buffered_strings(0), _index(0)
 {
     DEBUG (("Bank::Iterator::Iterator\n"));
@@ -313,6 +507,27 @@ BankFasta::Iterator::Iterator (BankFasta& ref, CommentMode_e commentMode)
         throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filenames[0].c_str());  }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFasta::Iterator::Iterator (BankFasta& ref, u_int64_t offsetBegin, u_int64_t offsetEnd, CommentMode_e commentMode)
+    : _ref(ref), _commentsMode(commentMode), _isDone(true), _isInitialized(false), _nIters(0),
+      _offsetBegin(offsetBegin), _offsetEnd(offsetEnd),
+      index_file(0), buffered_file(0), buffered_strings(0), _index(0)
+{
+    DEBUG (("Bank::Iterator::Iterator  range [%lld,%lld]\n", offsetBegin, offsetEnd));
+
+    /** We check that the file can be opened. */
+    if (gzFile stream = gzopen (_ref._filenames[0].c_str(), "r"))  {  gzclose (stream);  }
+    else  {
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filenames[0].c_str());  }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -343,7 +558,7 @@ void BankFasta::Iterator::first()
     for (u_int64_t i = 0; i < _ref.nb_files; i++)
     {
         buffered_file_t* bf = (buffered_file_t *) buffered_file[i];
-        if (bf != 0)  { bf->rewind(); }
+        if (bf != 0)  { bf->rewind(_offsetBegin); }
     }
 
     index_file = 0;
@@ -391,8 +606,11 @@ void BankFasta::Iterator::next()
 inline bool rebuffer (buffered_file_t *bf)
 {
     if (bf->eof) return false;
+    /** The end of the mapped window is not the end of the file: we go on with 'stream'. */
+    if (bf->mapped())  {  bf->read_stream (bf->buffer_offset + bf->buffer_end);  }
+    bf->buffer_offset += bf->buffer_end;
     bf->buffer_start = 0;
-    bf->buffer_end = gzread (bf->stream, bf->buffer, BUFFER_SIZE);
+    bf->buffer_end = bf->reader != 0 ? bf->reader->read (bf->buffer, BUFFER_SIZE) : gzread (bf->stream, bf->buffer, BUFFER_SIZE);
     if (bf->buffer_end < BUFFER_SIZE) bf->eof = 1;
     if (bf->buffer_end == 0) return false;
     return true;
@@ -433,12 +651,13 @@ inline signed int buffered_gets (
     if (bf->buffer_start >= bf->buffer_end && bf->eof) return -1;
     while (1)
     {
-        int i;
+        int64_t i;
         if (bf->buffer_start >= bf->buffer_end) if (!rebuffer (bf)) break;
         if (allow_spaces)
         {
-            for (i = bf->buffer_start; i < bf->buffer_end; i++)
-                if (bf->buffer[i] == '\n') break;
+            /** memchr is vectorized by the libc (SSE2/AVX2 according to the CPU). */
+            unsigned char* eol = (unsigned char*) memchr (bf->buffer + bf->buffer_start, '\n', bf->buffer_end - bf->buffer_start);
+            i = eol ? eol - bf->buffer : bf->buffer_end;
         }
         else
         {
@@ -496,8 +715,14 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
         if (c == -1) return false; // eof
         bf->last_char = c;
     }
+
+    /** In case of a byte range, the iteration ends with the first record starting beyond the range. */
+    if (bf->last_offset() >= _offsetEnd)  { return false; }
     bs->quality->length = bs->read->length = bs->dummy->length = 0;
 
+    /** Sequence referenced in the mapped file, if any. */
+    char* ref = 0;
+
     if (buffered_gets (bf, bs->header, (char *) &c, false, false) < 0) //ici
         return false; // eof
 
@@ -524,12 +749,33 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
         bs->read->max = 256;
         bs->read->string = (char*)  MALLOC (bs->read->max);
     }
-    while ((c = buffered_getc (bf)) != -1 && c != '>' && c != '+' && c != '@')
+
+    /** In a mapped file, a sequence written on a single line is not copied: the sequence data
+     * refers to the mapped bytes. The line (and the next character) must be in the mapped window. */
+    if (bf->mapped() && bf->buffer_start < bf->buffer_end)
+    {
+        char*   begin = (char*) bf->buffer + bf->buffer_start;
+        int64_t avail = bf->buffer_end - bf->buffer_start;
+        char*   eol   = (char*) memchr (begin, '\n', avail);
+        int64_t len   = eol ? eol - begin : avail;
+        bool    known = (eol && eol+1 < begin+avail) || bf->eof;
+        char    next  = (eol && eol+1 < begin+avail) ? eol[1] : -1;
+
+        if (known && len > 0 && *begin != '>' && *begin != '+' && *begin != '@' && (next == -1 || next == '>' || next == '+' || next == '@'))
+        {
+            ref = begin;
+            bs->read->length = (len > 1 && begin[len-1] == '\r') ? len-1 : len;
+            bf->buffer_start += eol ? len+1 : len;
+        }
+    }
+
+    while (ref == 0 && (c = buffered_getc (bf)) != -1 && c != '>' && c != '+' && c != '@')
     {
         if (c == '\n') continue; // empty line
         bs->read->string[bs->read->length++] = c;
         buffered_gets (bf, bs->read, NULL, true, true);
     }
+    if (ref != 0)  { c = buffered_getc (bf); }
     if (c == '>' || c == '@') bf->last_char = c;
     if (bs->read->length + 1 >= bs->read->max)
     {
@@ -556,11 +802,8 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
     }
 
     /** We update the data of the sequence. */
-#if 1
-    data.set (bs->read->string, bs->read->length);
-#else
-    data.setRef (bs->read->string, bs->read->length);
-#endif
+    if (ref != 0)  {  data.setRef (ref,              bs->read->length);  }
+    else           {  data.set    (bs->read->string, bs->read->length);  }
 
     //if (comment.empty() == false)
     {
@@ -648,8 +891,50 @@ void BankFasta::Iterator::init ()
 
         buffered_file_t** bf = (buffered_file_t **) buffered_file + i;
         *bf = (buffered_file_t *)  CALLOC (1, sizeof(buffered_file_t));
-        (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
         (*bf)->stream = gzopen (fname, "r");
+
+        /** A plain file is memory mapped instead of being read through zlib; only the byte range
+         * of the iterator is mapped (rounded to pages), the record ending beyond it is read through
+         * zlib. The mapping is private and writable, so clients may still modify the data of the
+         * sequences; it is mapped again on each rewind, so each iteration gets the file content.
+         * Since the pages are not written in general, no swap space is reserved for them. */
+        if ((*bf)->stream != NULL && gzdirect ((*bf)->stream) == 1)
+        {
+            u_int64_t size  = System::file().getSize (fname);
+            u_int64_t page  = sysconf (_SC_PAGESIZE);
+            u_int64_t begin = std::min (_offsetBegin, size) / page * page;
+            u_int64_t end   = _offsetEnd < size ? std::min (size, (_offsetEnd / page + 1) * page) : size;
+
+            (*bf)->file_size      = size;
+            (*bf)->mapping_offset = begin;
+            (*bf)->mapping_size   = end - begin;
+            (*bf)->mapping_fd     = end > begin ? open (fname, O_RDONLY) : -1;
+
+            if ((*bf)->mapping_fd >= 0 && (*bf)->map (0, 0))
+            {
+                (*bf)->buffer = (*bf)->mapping;
+                (*bf)->rewind (begin);
+                continue;
+            }
+
+            if ((*bf)->mapping_fd >= 0)  { close ((*bf)->mapping_fd); }
+            (*bf)->mapping_size = 0;
+        }
+
+        (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
+
+        /** A compressed file is inflated in background threads, ahead of the parsing. */
+        if ((*bf)->stream != NULL && _ref._nbDecompressThreads > 0 && gzdirect ((*bf)->stream) == 0)
+        {
+            gzclose ((*bf)->stream);
+            (*bf)->stream = 0;
+            (*bf)->reader = new GzipReader (fname, _ref._nbDecompressThreads);
+            continue;
+        }
+
+        /** For a byte range, we make zlib detect now that the file is not compressed, so gzseek
+         * will be a plain lseek instead of reading the file up to the offset. */
+        if ((*bf)->stream != NULL && _offsetBegin > 0)  {  gzdirect ((*bf)->stream);  }
 		
         /** We check that we can open the file. */
         if ((*bf)->stream == NULL)
@@ -699,9 +984,12 @@ void BankFasta::Iterator::finalize ()
         {
             /** We close the handle of the file. */
             if (bf->stream != NULL)  {  gzclose (bf->stream);  bf->stream = 0; }
+            if (bf->reader != 0)     {  delete bf->reader;     bf->reader = 0; }
 
-            /** We delete the buffer. */
-            FREE (bf->buffer);
+            /** We delete the buffer and unmap the file. */
+            if (!bf->mapped())     {  FREE (bf->buffer);  }
+            if (bf->mapping != 0)  {  munmap (bf->mapping, bf->mapping_size);  }
+            if (bf->mapping_size > 0)  {  close (bf->mapping_fd);  }
 
             /** We delete the buffered file itself. */
             FREE (bf);
@@ -758,7 +1046,7 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     {
         buffered_file_t* current = (buffered_file_t *) buffered_file[i];
 
-        actualPosition += gztell (current->stream);
+        actualPosition += current->position();
     }
 
     if (actualPosition > 0)
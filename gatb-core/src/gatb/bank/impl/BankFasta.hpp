@@ -30,6 +30,7 @@
 #include <zlib.h>
 
 #include <gatb/bank/impl/AbstractBank.hpp>
+#include <gatb/bank/impl/GzipWriter.hpp>
 
 #include <vector>
 #include <string>
@@ -72,7 +73,7 @@ public:
     /** Constructor.
      * \param[in] filename : uri of the bank.
      * \param[in] output_fastq : tells whether the file is in fastq or not.
-     * \param[in] output_gz: tells whether the file is gzipped or not
+     * \param[in] output_gz: tells whether the file is gzipped or not (see setNbCompressThreads and setOutputBGZF)
      */
     BankFasta (const std::string& filename, bool output_fastq = false, bool output_gz = false);
 
@@ -85,10 +86,24 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
 
+    /** Split the bank into several iterators over disjoint byte ranges of the file. Each range
+     * begins on a record boundary, so the iterators can be used concurrently by different threads
+     * without sharing a lock. Only uncompressed files can be split; otherwise (or if the file is too
+     * small to be worth it), a single iterator over the whole bank is returned.
+     * \param[in] nbRanges : requested number of iterators.
+     * \return a vector of at most nbRanges iterators (heap allocated, to be released by the caller). */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbRanges);
+
+    /** Tells whether the bank file can be read from arbitrary byte offsets (ie. it is not gzipped).
+     * \return true if the bank can be split into byte ranges. */
+    bool isSplittable ();
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems () { return -1; }
 
-    /** \copydoc IBank::insert */
+    /** Insert a sequence at the end of the bank. Several threads may insert sequences into the
+     * same bank (for instance the functors of a Dispatcher); each record is written at once.
+     * \param[in] item : the sequence to be inserted */
     void insert (const Sequence& item);
 
     /** \copydoc IBank::flush */
@@ -103,6 +118,25 @@ public:
     static void setDataLineSize (size_t len) { _dataLineSize = len; }
     static size_t getDataLineSize ()  { return _dataLineSize; }
 
+    /** Set the number of threads inflating a gzipped file of the bank while it is parsed by the
+     * iterators created afterwards. With 0, the file is inflated by the iterating thread itself.
+     * Only BGZF files use more than one thread (see also Bank::setNbDecompressThreads).
+     * \param[in] nb : number of threads (0 by default) */
+    void setNbDecompressThreads (size_t nb) { _nbDecompressThreads = nb; }
+    size_t getNbDecompressThreads () const  { return _nbDecompressThreads; }
+
+    /** Set the number of threads deflating the sequences inserted afterwards into a gzipped bank.
+     * With 0, the data is deflated by the inserting thread itself. The file content doesn't depend on it.
+     * \param[in] nb : number of threads (0 by default) */
+    void setNbCompressThreads (size_t nb) { _nbCompressThreads = nb; }
+    size_t getNbCompressThreads () const  { return _nbCompressThreads; }
+
+    /** Tell whether a gzipped bank is written as BGZF (which can be inflated in parallel)
+     * instead of plain gzip members. To be set before the first insertion.
+     * \param[in] bgzf : true for BGZF (false by default) */
+    void setOutputBGZF (bool bgzf) { _outputBGZF = bgzf; }
+    bool getOutputBGZF () const  { return _outputBGZF; }
+
     /** \copydoc IBank::finalize */
     void finalize ();
 
@@ -151,6 +185,15 @@ public:
          */
         Iterator (BankFasta& ref, CommentMode_e commentMode = FULL);
 
+        /** Constructor for iterating only the records whose header starts in [offsetBegin,offsetEnd[
+         * Note that offsetBegin must be the offset of a record header (see BankFasta::iterators).
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] offsetBegin : offset of the first record to be iterated in the file
+         * \param[in] offsetEnd : offset where the iteration stops
+         * \param[in] commentMode : kind of comments we want to retrieve
+         */
+        Iterator (BankFasta& ref, u_int64_t offsetBegin, u_int64_t offsetEnd, CommentMode_e commentMode = FULL);
+
         /** Destructor */
         ~Iterator ();
 
@@ -169,6 +212,10 @@ public:
         /** Estimation of the sequences information */
         void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
 
+        /** Get the bank iterated by this iterator.
+         * \return the bank */
+        BankFasta& getBank ()  { return _ref; }
+
     private:
 
         /** Reference to the underlying Iterable instance. */
@@ -185,6 +232,10 @@ public:
 
         /* Number of time next has been called   */
         u_int64_t   _nIters;
+
+        /** Byte range of the file to be iterated. */
+        u_int64_t   _offsetBegin;
+        u_int64_t   _offsetEnd;
         
         /** Initialization method. */
         void init ();
@@ -225,9 +276,19 @@ protected:
     /** File handle for inserting sequences into the bank. */
     FILE* _insertHandle;
 
-    gzFile _gz_insertHandle;
-    
+    /** Writer for inserting sequences into a gzipped bank. */
+    GzipWriter* _gzWriter;
+
+    /** Formatted record to be written. */
+    std::string _insertBuffer;
+
+    system::ISynchronizer* _insertSynchro;
+    void setInsertSynchro (system::ISynchronizer* insertSynchro)  { SP_SETATTR(insertSynchro); }
+
     static size_t _dataLineSize;
+    size_t        _nbDecompressThreads;
+    size_t        _nbCompressThreads;
+    bool          _outputBGZF;
 
     /** Initialization method (compute the file sizes). */
     void init ();
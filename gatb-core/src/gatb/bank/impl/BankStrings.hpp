@@ -85,6 +85,20 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()  { return new tools::dp::impl::VectorIterator2<Sequence> (_sequences); }
 
+    /** \copydoc IBank::iterators */
+    std::vector<tools::dp::Iterator<Sequence>*> iterators (size_t nbIterators)
+    {
+        std::vector<tools::dp::Iterator<Sequence>*> result;
+        nbIterators = std::max ((size_t)1, std::min (nbIterators, _sequences.size()));
+        for (size_t i=0; i<nbIterators; i++)
+        {
+            result.push_back (new tools::dp::impl::VectorIterator2<Sequence> (
+                _sequences, (i*_sequences.size())/nbIterators, ((i+1)*_sequences.size())/nbIterators
+            ));
+        }
+        return result;
+    }
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems () { return _sequences.size(); }
 
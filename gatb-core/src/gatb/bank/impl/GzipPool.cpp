@@ -0,0 +1,165 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/GzipPool.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+#include <assert.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipPool::GzipPool (size_t nbThreads)
+    : _nbStarted(0), _nbDone(0), _finished(false)
+{
+    for (size_t i=0; i<std::max (nbThreads, (size_t)1); i++)  {  _threads.push_back (System::thread().newThread (mainloop, this));  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipPool::~GzipPool ()
+{
+    try  {  wait ();  }
+    catch (Exception& e)  {}
+
+    {
+        std::lock_guard<std::mutex> lock (_mutex);
+        _finished = true;
+    }
+    _workCondition.notify_all();
+
+    for (size_t i=0; i<_threads.size(); i++)
+    {
+        _threads[i]->join();
+        delete _threads[i];
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipPool::submit (const std::vector<Command*>& commands)
+{
+    for (size_t i=0; i<commands.size(); i++)  {  commands[i]->use();  }
+
+    {
+        std::lock_guard<std::mutex> lock (_mutex);
+
+        assert (_nbDone == _commands.size());
+
+        _commands  = commands;
+        _nbStarted = 0;
+        _nbDone    = 0;
+    }
+    _workCondition.notify_all();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the commands of the batch are released
+*********************************************************************/
+void GzipPool::wait ()
+{
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _doneCondition.wait (lock, [this] { return _nbDone == _commands.size(); });
+    }
+
+    string error;
+    for (size_t i=0; i<_commands.size(); i++)
+    {
+        if (error.empty())  { error = _commands[i]->getError(); }
+        _commands[i]->forget();
+    }
+
+    std::lock_guard<std::mutex> lock (_mutex);
+    _commands.clear();
+    _nbStarted = 0;
+    _nbDone    = 0;
+
+    if (!error.empty())  { throw Exception ("%s", error.c_str()); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* GzipPool::mainloop (void* data)
+{
+    GzipPool* pool = (GzipPool*) data;
+
+    for (;;)
+    {
+        Command* cmd = 0;
+        {
+            std::unique_lock<std::mutex> lock (pool->_mutex);
+            pool->_workCondition.wait (lock, [pool] { return pool->_finished || pool->_nbStarted < pool->_commands.size(); });
+            if (pool->_finished)  { break; }
+            cmd = pool->_commands[pool->_nbStarted++];
+        }
+
+        cmd->execute();
+
+        bool batchDone = false;
+        {
+            std::lock_guard<std::mutex> lock (pool->_mutex);
+            batchDone = ++pool->_nbDone == pool->_commands.size();
+        }
+        if (batchDone)  { pool->_doneCondition.notify_one(); }
+    }
+
+    return 0;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,113 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file GzipPool.hpp
+ *  \brief Threads inflating or deflating gzip data
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_GZIP_POOL_HPP_
+#define _GATB_CORE_BANK_IMPL_GZIP_POOL_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/IThread.hpp>
+#include <gatb/system/api/ISmartPointer.hpp>
+#include <gatb/tools/designpattern/api/ICommand.hpp>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Threads executing batches of commands for GzipReader and GzipWriter.
+ *
+ * The threads are created with the pool and live as long as it. A batch of commands is given
+ * by 'submit' and executed by the threads while the client goes on; 'wait' returns once the
+ * whole batch is done. There is at most one batch at a time, given by a single client thread.
+ *
+ * The state of the pool is protected by a mutex; the idle threads (and the client waiting for
+ * the end of a batch) block on a condition variable notified by 'submit' (and by the end of
+ * each command), so that they do not wake up while there is nothing to do.
+ */
+class GzipPool
+{
+public:
+
+    /** Command of a batch; an error is kept instead of being thrown by 'execute'. */
+    class Command : public tools::dp::ICommand, public system::SmartPointer
+    {
+    public:
+
+        /** Get the error of the command.
+         * \return the error message, empty if no error occurred. */
+        const std::string& getError () const  { return _error; }
+
+    protected:
+
+        std::string _error;
+    };
+
+    /** Constructor. The threads are started at once.
+     * \param[in] nbThreads : number of threads (at least 1) */
+    GzipPool (size_t nbThreads);
+
+    /** Destructor. Waits for the current batch, then stops the threads. */
+    ~GzipPool ();
+
+    /** Get the number of threads of the pool.
+     * \return the number of threads. */
+    size_t getNbThreads () const  { return _threads.size(); }
+
+    /** Give a batch of commands to the threads; the previous batch must be done.
+     * \param[in] commands : the commands, used by the pool until the end of the batch */
+    void submit (const std::vector<Command*>& commands);
+
+    /** Wait for the end of the current batch (if any). An exception is thrown with the error
+     * of the first failed command of the batch. */
+    void wait ();
+
+private:
+
+    std::vector<system::IThread*> _threads;
+
+    std::mutex              _mutex;
+    std::condition_variable _workCondition;
+    std::condition_variable _doneCondition;
+
+    std::vector<Command*> _commands;
+    size_t                _nbStarted;
+    size_t                _nbDone;
+    bool                  _finished;
+
+    /** Main loop of the threads. */
+    static void* mainloop (void* data);
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_GZIP_POOL_HPP_ */
@@ -0,0 +1,389 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/GzipReader.hpp>
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <string.h>
+#include <stdio.h>
+#include <zlib.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/********************************************************************************/
+static u_int16_t get16 (const unsigned char* p)  { return p[0] | (p[1] << 8); }
+static u_int32_t get32 (const unsigned char* p)  { return p[0] | (p[1] << 8) | (p[2] << 16) | ((u_int32_t)p[3] << 24); }
+
+/*********************************************************************
+** METHOD  : readBgzfBlock
+** PURPOSE : read the next BGZF block of a file
+** INPUT   : file
+** OUTPUT  : block
+** RETURN  : false at the end of the file
+** REMARKS : throws an exception if the block is not a BGZF block
+*********************************************************************/
+static bool readBgzfBlock (FILE* file, GzipReader::Block& block)
+{
+    unsigned char header[12];
+
+    size_t nb = fread (header, 1, sizeof(header), file);
+    if (nb == 0)  { return false; }
+
+    if (nb != sizeof(header) || header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 || (header[3] & 4) == 0)
+    {
+        throw Exception ("GzipReader: bad BGZF block header");
+    }
+
+    /** We look for the 'BC' subfield giving the size of the block. */
+    u_int16_t xlen = get16 (header+10);
+    vector<unsigned char> extra (xlen);
+    if (fread (extra.data(), 1, xlen, file) != xlen)  { throw Exception ("GzipReader: truncated BGZF block"); }
+
+    int bsize = -1;
+    for (size_t i=0; i+4 <= xlen; i += 4 + get16 (&extra[i+2]))
+    {
+        if (extra[i]==66 && extra[i+1]==67 && get16 (&extra[i+2])==2 && i+6 <= xlen)  {  bsize = get16 (&extra[i+4]);  }
+    }
+
+    int remaining = bsize + 1 - (int)sizeof(header) - xlen;
+    if (bsize < 0 || remaining < 8)  { throw Exception ("GzipReader: bad BGZF block size"); }
+
+    block.data.resize (remaining);
+    if (fread (block.data.data(), 1, remaining, file) != (size_t)remaining)  { throw Exception ("GzipReader: truncated BGZF block"); }
+
+    block.crc   = get32 (&block.data[remaining-8]);
+    block.isize = get32 (&block.data[remaining-4]);
+    block.data.resize (remaining-8);
+
+    return true;
+}
+
+/********************************************************************************/
+/** Inflates some blocks of a batch into their place in the decompressed chunk. */
+class InflateCommand : public GzipPool::Command
+{
+public:
+
+    InflateCommand (vector<GzipReader::Block>& blocks, size_t nbBlocks, vector<u_int64_t>& offsets, unsigned char* output, size_t first, size_t step)
+        : _blocks(blocks), _nbBlocks(nbBlocks), _offsets(offsets), _output(output), _first(first), _step(step) {}
+
+    void execute ()
+    {
+        for (size_t i=_first; i<_nbBlocks && _error.empty(); i+=_step)
+        {
+            GzipReader::Block& block = _blocks[i];
+            unsigned char*     out   = _output + _offsets[i];
+
+            z_stream zs;
+            memset (&zs, 0, sizeof(zs));
+            if (inflateInit2 (&zs, -15) != Z_OK)  { _error = "GzipReader: inflateInit failed";  break; }
+
+            zs.next_in   = block.data.data();
+            zs.avail_in  = block.data.size();
+            zs.next_out  = out;
+            zs.avail_out = block.isize;
+
+            int res = inflate (&zs, Z_FINISH);
+            bool ok = (res == Z_STREAM_END) && (zs.total_out == block.isize);
+            inflateEnd (&zs);
+
+            if (!ok || crc32 (0, out, block.isize) != block.crc)  { _error = "GzipReader: corrupted BGZF block"; }
+        }
+    }
+
+private:
+
+    vector<GzipReader::Block>& _blocks;
+    size_t                     _nbBlocks;
+    vector<u_int64_t>&         _offsets;
+    unsigned char*             _output;
+    size_t                     _first;
+    size_t                     _step;
+};
+
+/********************************************************************************/
+/** Inflates the next chunk of a plain gzip file. */
+class GzreadCommand : public GzipPool::Command
+{
+public:
+
+    GzreadCommand (gzFile stream, vector<unsigned char>& chunk, bool& eof)
+        : _stream(stream), _chunk(chunk), _eof(eof) {}
+
+    void execute ()
+    {
+        int nb = gzread (_stream, _chunk.data(), _chunk.size());
+        if (nb < 0)  { _error = "GzipReader: error while inflating";  return; }
+
+        _eof = (size_t)nb < _chunk.size();
+        _chunk.resize (nb);
+    }
+
+private:
+
+    gzFile                 _stream;
+    vector<unsigned char>& _chunk;
+    bool&                  _eof;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipReader::GzipReader (const std::string& filename, size_t nbThreads)
+    : _filename(filename), _bgzf(isBGZF(filename)), _pool(nbThreads),
+      _stream(0), _file(0), _eof(false), _currentPos(0), _pending(false), _position(0)
+{
+    DEBUG (("GzipReader::GzipReader  file=%s  bgzf=%d  nbThreads=%ld\n", filename.c_str(), _bgzf, nbThreads));
+
+    if (_bgzf)
+    {
+        _blocks.resize  (_pool.getNbThreads() * BLOCKS_PER_THREAD);
+        _offsets.resize (_blocks.size());
+    }
+
+    open ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipReader::~GzipReader ()
+{
+    close ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool GzipReader::isBGZF (const std::string& filename)
+{
+    bool result = false;
+
+    if (FILE* file = fopen (filename.c_str(), "rb"))
+    {
+        unsigned char header[18];
+        if (fread (header, 1, sizeof(header), file) == sizeof(header))
+        {
+            result = header[0]==0x1f && header[1]==0x8b && header[2]==8 && (header[3] & 4)
+                  && get16 (header+10) >= 6 && header[12]==66 && header[13]==67 && get16 (header+14)==2;
+        }
+        fclose (file);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int GzipReader::read (void* buffer, unsigned int size)
+{
+    unsigned int nb = 0;
+
+    while (nb < size)
+    {
+        if (_currentPos >= _current.size() && next() == false)  { break; }
+
+        size_t len = std::min ((size_t)(size - nb), _current.size() - _currentPos);
+        memcpy ((unsigned char*)buffer + nb, _current.data() + _currentPos, len);
+        _currentPos += len;
+        nb          += len;
+    }
+
+    _position += nb;
+    return nb;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipReader::rewind ()
+{
+    /** Nothing to do if nothing has been read yet. */
+    if (_position == 0 && _current.empty())  { return; }
+
+    close ();
+    open  ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the first chunk is given to the pool at once
+*********************************************************************/
+void GzipReader::open ()
+{
+    _eof        = false;
+    _position   = 0;
+    _currentPos = 0;
+    _current.clear();
+
+    if (_bgzf)  { _file   = fopen  (_filename.c_str(), "rb"); }
+    else        { _stream = gzopen (_filename.c_str(), "r");  }
+
+    if (_file == 0 && _stream == 0)  { throw Exception (STR_BANK_unable_open_file, _filename.c_str()); }
+
+    if (_stream != 0)  { gzbuffer ((gzFile)_stream, 1024*1024); }
+
+    submit ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipReader::close ()
+{
+    /** The pending chunk is not needed anymore, nor its error. */
+    if (_pending)
+    {
+        _pending = false;
+        try  {  _pool.wait ();  }
+        catch (Exception& e)  {}
+    }
+
+    if (_file   != 0)  { fclose  (_file);            _file   = 0; }
+    if (_stream != 0)  { gzclose ((gzFile)_stream);  _stream = 0; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the BGZF blocks are read by the client thread, then inflated by the pool
+*********************************************************************/
+void GzipReader::submit ()
+{
+    if (_eof)  { return; }
+
+    vector<GzipPool::Command*> commands;
+
+    if (_bgzf)
+    {
+        /** We read a batch of blocks and compute where each one goes in the chunk. */
+        size_t    nbBlocks = 0;
+        u_int64_t total    = 0;
+
+        while (nbBlocks < _blocks.size() && readBgzfBlock (_file, _blocks[nbBlocks]))
+        {
+            _offsets[nbBlocks] = total;
+            total += _blocks[nbBlocks].isize;
+            nbBlocks++;
+        }
+
+        _eof = nbBlocks < _blocks.size();
+
+        if (nbBlocks == 0)  { return; }
+
+        _next.resize (total);
+
+        size_t nbCommands = std::min (_pool.getNbThreads(), nbBlocks);
+        for (size_t i=0; i<nbCommands; i++)
+        {
+            commands.push_back (new InflateCommand (_blocks, nbBlocks, _offsets, _next.data(), i, nbCommands));
+        }
+    }
+    else
+    {
+        _next.resize (CHUNK_SIZE);
+        commands.push_back (new GzreadCommand ((gzFile)_stream, _next, _eof));
+    }
+
+    _pool.submit (commands);
+    _pending = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : an empty chunk (like the BGZF end of file block) is skipped
+*********************************************************************/
+bool GzipReader::next ()
+{
+    _current.clear();
+    _currentPos = 0;
+
+    while (_pending && _current.empty())
+    {
+        _pending = false;
+
+        try
+        {
+            _pool.wait ();
+            _current.swap (_next);
+
+            /** The next chunk is inflated while the client reads the current one. */
+            submit ();
+        }
+        catch (Exception& e)  {  throw Exception ("%s (%s)", e.getMessage(), _filename.c_str());  }
+    }
+
+    return _current.empty() == false;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
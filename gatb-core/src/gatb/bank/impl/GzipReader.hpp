@@ -0,0 +1,140 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file GzipReader.hpp
+ *  \brief Decompression of gzip files by a pool of threads
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_
+#define _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/GzipPool.hpp>
+#include <gatb/system/api/types.hpp>
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Read a gzip file whose decompression is done by a pool of threads.
+ *
+ * The decompressed data is produced by chunks: while the client reads a chunk, the next one
+ * is inflated by the threads of a GzipPool, created once for the life time of the reader:
+ *   - a plain gzip file is inflated by a single thread (the format can't be split)
+ *   - a BGZF file (gzip made of independent blocks of at most 64 KB, as produced by bgzip)
+ *     is read by batches of blocks, the blocks of a batch being shared by 'nbThreads' threads.
+ *
+ * The reader is meant to be used by a single client thread, through read/rewind/tell,
+ * like a gzFile.
+ */
+class GzipReader
+{
+public:
+
+    /** Constructor. The decompression begins at once.
+     * \param[in] filename : path of the gzip file
+     * \param[in] nbThreads : number of threads inflating BGZF blocks (at least 1) */
+    GzipReader (const std::string& filename, size_t nbThreads);
+
+    /** Destructor. Stops the decompression. */
+    ~GzipReader ();
+
+    /** Read decompressed data.
+     * \param[out] buffer : where the data is copied
+     * \param[in] size : max number of bytes to be read
+     * \return the number of bytes read, 0 at the end of the file. */
+    int read (void* buffer, unsigned int size);
+
+    /** Go back to the beginning of the file. */
+    void rewind ();
+
+    /** Get the offset in the decompressed data.
+     * \return the number of bytes read since the beginning of the file. */
+    u_int64_t tell () const  { return _position; }
+
+    /** Tell whether the file is BGZF.
+     * \return true if the first block of the file is a BGZF block. */
+    bool isBGZF () const  { return _bgzf; }
+
+    /** Tell whether a file is in the BGZF format, ie. its first gzip member has a 'BC' extra subfield.
+     * \param[in] filename : path of the file
+     * \return true if the file is BGZF. */
+    static bool isBGZF (const std::string& filename);
+
+    /** A BGZF block, as read from the file: the deflated data followed by the gzip trailer. */
+    struct Block
+    {
+        std::vector<unsigned char> data;
+        u_int32_t                  crc;
+        u_int32_t                  isize;
+    };
+
+private:
+
+    /** Size of the chunks of a plain gzip file. */
+    static const size_t CHUNK_SIZE = 4*1024*1024;
+
+    /** Number of BGZF blocks in a batch per inflating thread. */
+    static const size_t BLOCKS_PER_THREAD = 64;
+
+    typedef std::vector<unsigned char> Chunk;
+
+    std::string _filename;
+    bool        _bgzf;
+    GzipPool    _pool;
+
+    /** The file, as a gzFile for a plain gzip file. */
+    void* _stream;
+    FILE* _file;
+    bool  _eof;
+
+    /** BGZF blocks of the batch being inflated, and their offsets in the inflated chunk. */
+    std::vector<Block>     _blocks;
+    std::vector<u_int64_t> _offsets;
+
+    Chunk     _current;
+    size_t    _currentPos;
+    Chunk     _next;
+    bool      _pending;
+    u_int64_t _position;
+
+    void open  ();
+    void close ();
+
+    /** Give the inflation of the next chunk to the pool, unless the end of the file is reached. */
+    void submit ();
+
+    /** Wait for the next chunk and make it the current one.
+     * \return false at the end of the file. */
+    bool next ();
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_ */
@@ -0,0 +1,385 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/GzipWriter.hpp>
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+
+#include <string.h>
+#include <zlib.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/** Max size of a BGZF block, header and trailer included. */
+static const size_t BGZF_MAX_BLOCK = 65536;
+
+/** Max size of the uncompressed data of a BGZF block (as bgzip does). */
+static const size_t BGZF_BLOCK_DATA = 0xff00;
+
+/** Sizes of the header and of the trailer of a BGZF block. */
+static const size_t BGZF_HEADER  = 18;
+static const size_t BGZF_TRAILER = 8;
+
+/** The empty block ending a BGZF file. */
+static const unsigned char BGZF_EOF[] =
+{
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43,
+    0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/********************************************************************************/
+static void put16 (unsigned char* p, u_int16_t v)  { p[0] = v & 0xff;  p[1] = v >> 8; }
+static void put32 (unsigned char* p, u_int32_t v)  { put16 (p, v & 0xffff);  put16 (p+2, v >> 16); }
+
+/********************************************************************************/
+/** Deflates some chunks of a batch, each one into its own output. */
+class DeflateCommand : public GzipPool::Command
+{
+public:
+
+    DeflateCommand (vector<vector<unsigned char>*>& inputs, vector<vector<unsigned char> >& outputs,
+        GzipWriter::Format format, int level, size_t first, size_t step
+    )
+        : _inputs(inputs), _outputs(outputs), _format(format), _level(level), _first(first), _step(step) {}
+
+    void execute ()
+    {
+        for (size_t i=_first; i<_inputs.size() && _error.empty(); i+=_step)
+        {
+            if (_format == GzipWriter::BGZF)  { deflateBgzf (*_inputs[i], _outputs[i]); }
+            else                              { deflateGzip (*_inputs[i], _outputs[i]); }
+        }
+    }
+
+private:
+
+    vector<vector<unsigned char>*>& _inputs;
+    vector<vector<unsigned char> >& _outputs;
+    GzipWriter::Format              _format;
+    int                             _level;
+    size_t                          _first;
+    size_t                          _step;
+
+    /** The chunk becomes a whole gzip member. */
+    void deflateGzip (const vector<unsigned char>& input, vector<unsigned char>& output)
+    {
+        z_stream zs;
+        memset (&zs, 0, sizeof(zs));
+        if (deflateInit2 (&zs, _level, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK)  { _error = "GzipWriter: deflateInit failed";  return; }
+
+        output.resize (deflateBound (&zs, input.size()));
+
+        zs.next_in   = (Bytef*) input.data();
+        zs.avail_in  = input.size();
+        zs.next_out  = output.data();
+        zs.avail_out = output.size();
+
+        if (deflate (&zs, Z_FINISH) != Z_STREAM_END)  { _error = "GzipWriter: error while deflating"; }
+
+        output.resize (zs.total_out);
+        deflateEnd (&zs);
+    }
+
+    /** The chunk is cut into BGZF blocks. */
+    void deflateBgzf (const vector<unsigned char>& input, vector<unsigned char>& output)
+    {
+        output.reserve (input.size() / 2);
+
+        for (size_t offset=0; offset < input.size() && _error.empty(); )
+        {
+            size_t length = std::min (input.size() - offset, BGZF_BLOCK_DATA);
+
+            size_t start = output.size();
+            output.resize (start + BGZF_MAX_BLOCK);
+
+            unsigned char* block = output.data() + start;
+            const unsigned char* in = input.data() + offset;
+
+            /** A block that doesn't shrink enough is stored without compression; it always fits. */
+            size_t size = deflateBlock (in, length, block + BGZF_HEADER, _level);
+            if (size == 0)  { size = deflateBlock (in, length, block + BGZF_HEADER, 0); }
+            if (size == 0)  { _error = "GzipWriter: error while deflating";  break; }
+
+            size_t bsize = BGZF_HEADER + size + BGZF_TRAILER;
+
+            static const unsigned char header[] = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0 };
+            memcpy (block, header, sizeof(header));
+            put16 (block + 16, bsize - 1);
+
+            put32 (block + BGZF_HEADER + size,     crc32 (0, in, length));
+            put32 (block + BGZF_HEADER + size + 4, length);
+
+            output.resize (start + bsize);
+            offset += length;
+        }
+    }
+
+    /** Deflate (raw) the data of a BGZF block; returns 0 if the result is too big for a block. */
+    size_t deflateBlock (const unsigned char* in, size_t length, unsigned char* out, int level)
+    {
+        z_stream zs;
+        memset (&zs, 0, sizeof(zs));
+        if (deflateInit2 (&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)  { return 0; }
+
+        zs.next_in   = (Bytef*) in;
+        zs.avail_in  = length;
+        zs.next_out  = out;
+        zs.avail_out = BGZF_MAX_BLOCK - BGZF_HEADER - BGZF_TRAILER;
+
+        size_t result = deflate (&zs, Z_FINISH) == Z_STREAM_END ? zs.total_out : 0;
+        deflateEnd (&zs);
+
+        return result;
+    }
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipWriter::GzipWriter (const std::string& filename, Format format, size_t nbThreads, int level)
+    : _filename(filename), _format(format), _level(level), _file(0), _pool(0), _pending(false), _current(0), _position(0)
+{
+    DEBUG (("GzipWriter::GzipWriter  file=%s  format=%d  nbThreads=%ld\n", filename.c_str(), format, nbThreads));
+
+    _file = fopen (_filename.c_str(), "wb");
+    if (_file == 0)  { throw Exception (STR_BANK_unable_open_file, _filename.c_str()); }
+
+    if (nbThreads > 0)  {  _pool = new GzipPool (nbThreads);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipWriter::~GzipWriter ()
+{
+    try  {  close ();  }
+    catch (Exception& e)  {  fprintf (stderr, "%s\n", e.getMessage());  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::write (const void* buffer, size_t size)
+{
+    if (_file == 0)  { throw Exception ("GzipWriter: %s is closed", _filename.c_str()); }
+
+    const unsigned char* data = (const unsigned char*) buffer;
+
+    while (size > 0)
+    {
+        if (_current == 0)  { _current = new Chunk;  _current->reserve (CHUNK_SIZE); }
+
+        size_t nb = std::min (size, CHUNK_SIZE - _current->size());
+        _current->insert (_current->end(), data, data + nb);
+
+        data      += nb;
+        size      -= nb;
+        _position += nb;
+
+        if (_current->size() >= CHUNK_SIZE)  { push(); }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::flush ()
+{
+    if (_file == 0)  { return; }
+
+    if (_current != 0)  {  _batch.push_back (_current);  _current = 0;  }
+
+    submit   ();
+    complete ();
+
+    fflush (_file);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::close ()
+{
+    if (_file == 0)  { return; }
+
+    string error;
+    try  {  flush ();  }
+    catch (Exception& e)  {  error = e.getMessage();  }
+
+    delete _pool;
+    _pool = 0;
+
+    for (size_t i=0; i<_batch.size(); i++)  { delete _batch[i]; }
+    _batch.clear();
+
+    delete _current;
+    _current = 0;
+
+    if (_format == BGZF && error.empty())
+    {
+        if (fwrite (BGZF_EOF, 1, sizeof(BGZF_EOF), _file) != sizeof(BGZF_EOF))  { error = "GzipWriter: unable to write " + _filename; }
+    }
+
+    if (fclose (_file) != 0 && error.empty())  { error = "GzipWriter: unable to write " + _filename; }
+    _file = 0;
+
+    if (!error.empty())  { throw Exception ("%s", error.c_str()); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::push ()
+{
+    _batch.push_back (_current);
+    _current = 0;
+
+    if (_batch.size() >= (_pool != 0 ? _pool->getNbThreads() : 1))  {  submit ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::submit ()
+{
+    /** At most two batches are in memory: the one being deflated and the one being filled. */
+    complete ();
+
+    if (_batch.empty())  { return; }
+
+    _inputs.swap (_batch);
+    _outputs.resize (_inputs.size());
+
+    if (_pool != 0)
+    {
+        size_t nbCommands = std::min (_pool->getNbThreads(), _inputs.size());
+
+        vector<GzipPool::Command*> commands;
+        for (size_t i=0; i<nbCommands; i++)
+        {
+            commands.push_back (new DeflateCommand (_inputs, _outputs, _format, _level, i, nbCommands));
+        }
+
+        _pool->submit (commands);
+    }
+
+    _pending = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : wait for the batch being deflated and write its chunks in order
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the chunks of the batch are deleted
+*********************************************************************/
+void GzipWriter::complete ()
+{
+    if (_pending == false)  { return; }
+    _pending = false;
+
+    string error;
+
+    if (_pool != 0)
+    {
+        try                   {  _pool->wait ();  }
+        catch (Exception& e)  {  error = e.getMessage();  }
+    }
+    else
+    {
+        /** Without pool, the client deflates the batch itself. */
+        DeflateCommand cmd (_inputs, _outputs, _format, _level, 0, 1);
+        cmd.execute ();
+        error = cmd.getError();
+    }
+
+    for (size_t i=0; i<_inputs.size(); i++)  { delete _inputs[i]; }
+    _inputs.clear();
+
+    if (!error.empty())  { _outputs.clear();  throw Exception ("%s", error.c_str()); }
+
+    /** The chunks are written in the order they were given. */
+    for (size_t i=0; i<_outputs.size(); i++)  { writeChunk (_outputs[i]); }
+    _outputs.clear();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipWriter::writeChunk (const Chunk& chunk)
+{
+    if (fwrite (chunk.data(), 1, chunk.size(), _file) != chunk.size())
+    {
+        throw Exception ("GzipWriter: unable to write %s", _filename.c_str());
+    }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file GzipWriter.hpp
+ *  \brief Compression of gzip files by a pool of threads
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_GZIP_WRITER_HPP_
+#define _GATB_CORE_BANK_IMPL_GZIP_WRITER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/GzipPool.hpp>
+#include <gatb/system/api/types.hpp>
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Write a gzip file whose compression is done by a pool of threads.
+ *
+ * The written data is gathered into chunks of CHUNK_SIZE bytes, and the chunks into batches of
+ * 'nbThreads' chunks. A batch is deflated by the threads of a GzipPool (created once for the life
+ * time of the writer) while the client fills the next one; the chunks of a batch are then written
+ * in order by the client, so the file content is the same whatever the number of threads.
+ * Each chunk becomes:
+ *   - an independent gzip member (GZIP format); a file made of several members is a valid gzip file
+ *   - a list of BGZF blocks of at most 64 KB (BGZF format, as produced by bgzip); the file
+ *     ends with the BGZF end of file block. Such a file can be inflated in parallel by GzipReader.
+ *
+ * The writer is meant to be used by a single client thread, through write/flush/close,
+ * like a gzFile.
+ */
+class GzipWriter
+{
+public:
+
+    /** Format of the written file. */
+    enum Format
+    {
+        GZIP,
+        BGZF
+    };
+
+    /** Constructor. The file is created at once.
+     * \param[in] filename : path of the gzip file
+     * \param[in] format : gzip members or BGZF blocks
+     * \param[in] nbThreads : number of threads deflating the chunks; with 0, the chunks are
+     *                        deflated and written by the client thread itself.
+     * \param[in] level : compression level (-1 for the zlib default) */
+    GzipWriter (const std::string& filename, Format format=GZIP, size_t nbThreads=0, int level=-1);
+
+    /** Destructor. Closes the file. */
+    ~GzipWriter ();
+
+    /** Write data. The data is copied, so the buffer may be reused at once.
+     * \param[in] buffer : data to be written
+     * \param[in] size : number of bytes to be written */
+    void write (const void* buffer, size_t size);
+
+    /** Deflate and write all the pending data, then flush the file. */
+    void flush ();
+
+    /** Flush the data, end the file and close it. Nothing can be written afterwards. */
+    void close ();
+
+    /** Get the number of bytes given to the writer.
+     * \return the size of the uncompressed data. */
+    u_int64_t tell () const  { return _position; }
+
+private:
+
+    /** Size of the chunks given to the deflating threads. */
+    static const size_t CHUNK_SIZE = 4*1024*1024;
+
+    typedef std::vector<unsigned char> Chunk;
+
+    std::string _filename;
+    Format      _format;
+    int         _level;
+    FILE*       _file;
+    GzipPool*   _pool;
+
+    /** Chunks of the batch being filled. */
+    std::vector<Chunk*> _batch;
+
+    /** Chunks of the batch being deflated, and their deflated content. */
+    std::vector<Chunk*> _inputs;
+    std::vector<Chunk>  _outputs;
+    bool                _pending;
+
+    Chunk*    _current;
+    u_int64_t _position;
+
+    /** Add the current chunk to the batch being filled; a full batch is given to the pool. */
+    void push ();
+
+    /** Give the batch being filled to the pool, once the previous batch is written. */
+    void submit ();
+
+    /** Wait for the batch being deflated and write it (without pool, the batch is deflated here). */
+    void complete ();
+
+    /** Write a deflated chunk into the file. */
+    void writeChunk (const Chunk& chunk);
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_GZIP_WRITER_HPP_ */
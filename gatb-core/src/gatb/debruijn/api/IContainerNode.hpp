@@ -55,6 +55,18 @@ public:
     /** Tells whether an item exists or not in the container
      * \return true if the item exists, false otherwise */
     virtual bool contains (const Item& item) = 0;
+
+    /** Tells whether the container supports the removal of items.
+     * \return true if remove may succeed, false otherwise */
+    virtual bool canRemove () const  { return false; }
+
+    /** Remove an item from the container.
+     * Note: most implementations (Bloom filter based) can't remove items; they return false.
+     * Only items actually inserted should be removed: removing a false positive of a
+     * probabilistic container may remove an inserted item sharing its fingerprint.
+     * \param[in] item : the item to be removed
+     * \return true if the item has been removed, false otherwise */
+    virtual bool remove (const Item& item)  { return false; }
 };
 
 /********************************************************************************/
@@ -29,6 +29,7 @@
 /********************************************************************************/
 
 #include <gatb/debruijn/api/IContainerNode.hpp>
+#include <gatb/tools/collections/impl/CuckooFilter.hpp>
 #include <cstdarg>
 
 /********************************************************************************/
@@ -38,6 +39,36 @@ namespace debruijn  {
 namespace impl      {
 /********************************************************************************/
 
+/** Filter a batch of flagged items through a container: the items whose flag is set are
+ * looked for with a single containsBatch call, and each flag is kept only if the answer
+ * of the container for the item is 'keepFound'.
+ * \param[in] container : the container to be queried
+ * \param[in] items : the items
+ * \param[in] n : number of items
+ * \param[in,out] flags : flags of the items, updated with the answers of the container
+ * \param[in] keepFound : true for keeping the items found in the container, false for keeping the other ones */
+template <typename Item> void filterBatch (
+    tools::collections::Container<Item>* container, const Item* items, size_t n, u_int8_t* flags, bool keepFound
+)
+{
+    static const size_t BATCH = 8;
+    Item      sub   [BATCH];
+    size_t    idx   [BATCH];
+    u_int8_t  found [BATCH];
+
+    for (size_t b=0; b<n; b+=BATCH)
+    {
+        size_t m = 0;
+        for (size_t i=b; i<std::min(n,b+BATCH); i++)  {  if (flags[i])  {  sub[m] = items[i];  idx[m++] = i;  }  }
+        if (m==0)  { continue; }
+
+        container->containsBatch (sub, m, found);
+        for (size_t j=0; j<m; j++)  {  flags[idx[j]] = ((found[j]!=0) == keepFound);  }
+    }
+}
+
+/********************************************************************************/
+
 /** \brief IContainerNode implementation with a Bloom filter and a cFP set
  *
  *  In the GATB terminology, this object contains the information relative to the nodes of the dBG.
@@ -73,6 +104,14 @@ public:
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (_bloom->contains(item) && !_falsePositives->contains(item));  }
 
+    /** \copydoc Container::containsBatch
+     * Only the items found in the Bloom filter are looked for in the cFP set. */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        _bloom->containsBatch (items, n, out);
+        filterBatch (_falsePositives, items, n, out, false);
+    }
+
 protected:
 
     tools::collections::Container<Item>* _bloom;
@@ -99,6 +138,9 @@ public:
 
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (this->_bloom)->contains(item);  }
+
+    /** \copydoc Container::containsBatch */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)  {  (this->_bloom)->containsBatch (items, n, out);  }
 };
 
 /********************************************************************************/
@@ -150,6 +192,38 @@ public:
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (_bloom->contains(item) && ! containsCFP(item));  }
 
+    /** \copydoc Container::containsBatch
+     * Each level of the cascade is queried only with the items still alive at this level. */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        static const size_t BATCH = 8;
+        u_int8_t b2[BATCH], b3[BATCH], b4[BATCH];
+
+        _bloom->containsBatch (items, n, out);
+
+        for (size_t b=0; b<n; b+=BATCH)
+        {
+            size_t m = std::min (BATCH, n-b);
+
+            for (size_t i=0; i<m; i++)  {  b2[i] = out[b+i];  }
+            filterBatch (_bloom2, items+b, m, b2, true);
+
+            for (size_t i=0; i<m; i++)  {  b3[i] = b2[i];  }
+            filterBatch (_bloom3, items+b, m, b3, true);
+
+            for (size_t i=0; i<m; i++)  {  b4[i] = b3[i];  }
+            filterBatch (_bloom4,          items+b, m, b4, true);
+            filterBatch (_falsePositives,  items+b, m, b4, false);
+
+            /** Same logic as containsCFP. */
+            for (size_t i=0; i<m; i++)
+            {
+                bool cfp = (b2[i] && !b3[i]) || b4[i];
+                if (cfp)  { out[b+i] = 0; }
+            }
+        }
+    }
+
 private:
 
     tools::collections::Container<Item>* _bloom;
@@ -185,6 +259,43 @@ private:
 
 };
 
+/********************************************************************************/
+
+/** \brief IContainerNode implementation with a cuckoo filter
+ *
+ * The nodes are the items of a cuckoo filter built from the solid kmers: a single structure
+ * is probed per query, with the false positive rate of the filter (no cFP set, so there is no
+ * debloom step). Nodes can be removed from the container.
+ */
+template <typename Item> class ContainerNodeCuckoo : public IContainerNode<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor
+     * \param[in] filter : the cuckoo filter. */
+    ContainerNodeCuckoo (tools::collections::impl::CuckooFilter<Item>* filter) : _filter(0)  {  setFilter (filter);  }
+
+    /** Destructor. */
+    ~ContainerNodeCuckoo ()  {  setFilter (0);  }
+
+    /** \copydoc IContainerNode::contains */
+    bool contains (const Item& item)  {  return _filter->contains (item);  }
+
+    /** \copydoc Container::containsBatch */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)  {  _filter->containsBatch (items, n, out);  }
+
+    /** \copydoc IContainerNode::canRemove */
+    bool canRemove () const  {  return true;  }
+
+    /** \copydoc IContainerNode::remove */
+    bool remove (const Item& item)  {  return _filter->remove (item);  }
+
+private:
+
+    tools::collections::impl::CuckooFilter<Item>* _filter;
+    void setFilter (tools::collections::impl::CuckooFilter<Item>* filter)  { SP_SETATTR(filter); }
+};
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -183,7 +183,8 @@ void configure_visitor<Node,Edge,GraphDataVariant>::operator() (GraphData<span>&
         graph.getInfo().add (1, props);
     }
 
-    if (graph.getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE)
+    /** A graph whose nodes are in a cuckoo filter has no Bloom filter (see build_visitor_postsolid). */
+    if ((graph.getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE) && !storage.getGroup("bloom").getProperty("kind").empty())
     {
         /** We set the container. */
         BloomAlgorithm<span> algo (storage);
@@ -192,8 +193,8 @@ void configure_visitor<Node,Edge,GraphDataVariant>::operator() (GraphData<span>&
 
     if (graph.getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_DEBLOOM_DONE)
     {
-        /** We set the container. */
-        DebloomAlgorithm<span> algo (storage);
+        /** We set the container; with MPHF, nodes are deleted in the node states, never in the container. */
+        DebloomAlgorithm<span> algo (storage, (graph.getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE) == 0);
         graph.getInfo().add (1, algo.getInfo());
         data.setContainer (algo.getContainerNode());
     }
@@ -230,6 +231,14 @@ void configure_visitor<Node,Edge,GraphDataVariant>::operator() (GraphData<span>&
         data.setAbundance (mphf_algo.getAbundanceMap());
         data.setNodeState (mphf_algo.getNodeStateMap());
         data.setAdjacency (mphf_algo.getAdjacencyMap());
+
+        /** A cuckoo filter (the only container supporting removal) has false positives sharing
+         * the MPHF indexes of solid kmers: we need the node checks. */
+        if (data._container != 0 && data._container->canRemove())
+        {
+            mphf_algo.buildNodeChecks ();
+            data.setNodeCheck (mphf_algo.getNodeCheckMap());
+        }
     }
 }
 
@@ -364,6 +373,12 @@ void build_visitor_solid<Node,Edge,GraphDataVariant>::operator() (GraphData<span
 
     ConfigurationAlgorithm<span> configAlgo (bank, props);
     configAlgo.getInput()->add (0, STR_STORAGE_TYPE, std::to_string(graph._storageMode) );
+
+    /** The Bloom filter of the solid kmers may be filled during the counting (a cuckoo filter needs none). */
+    if (graph._bloomKind != BLOOM_NONE && graph._debloomKind != DEBLOOM_CUCKOO)
+    {
+        configAlgo.setBloomBitsPerKmer (DebloomAlgorithm<span>::getNbBitsPerKmer (graph._kmerSize, graph._debloomKind));
+    }
     graph.executeAlgorithm (configAlgo, & graph.getStorage(), props, graph._info);
     Configuration config = configAlgo.getConfiguration();
     graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_CONFIGURATION_DONE);
@@ -395,18 +410,34 @@ void build_visitor_solid<Node,Edge,GraphDataVariant>::operator() (GraphData<span
     /************************************************************/
     DEBUG ((cout << "build_visitor : SortingCountAlgorithm BEGIN\n"));
 
+    /** The Bloom filter of the solid kmers is filled during the counting, so the Bloom stage won't have
+     * to read the solid kmers again (see BloomAlgorithm::setBloom). The configuration tells whether it
+     * fits in the memory of the counting. */
+    CountProcessorBloom<span>* bloomProcessor = 0;
+    if (config._bloom_in_counting)
+    {
+        bloomProcessor = new CountProcessorBloom<span> (
+            graph._kmerSize,
+            DebloomAlgorithm<span>::getNbBitsPerKmer (graph._kmerSize, graph._debloomKind),
+            graph._bloomKind
+        );
+    }
+    LOCAL (bloomProcessor);
+
     /** We create a DSK instance and execute it. */
     SortingCountAlgorithm<span> sortingCount (
             bank,
             config,
             new Repartitor(minimizersGroup),
-            SortingCountAlgorithm<span>::getDefaultProcessorVector (config, props, solidStorage, mainStorage),
+            SortingCountAlgorithm<span>::getDefaultProcessorVector (config, props, solidStorage, mainStorage, bloomProcessor),
             props
             );
 
     graph.executeAlgorithm (sortingCount, solidStorage, props, graph._info);
     graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_SORTING_COUNT_DONE);
 
+    if (bloomProcessor != 0)  {  data.setBloom (bloomProcessor->getBloom());  }
+
     Partition<Count>* solidCounts = & dskGroup.getPartition<Count> ("solid");
 
     /** We configure the variant. */
@@ -472,6 +503,14 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     Group& dskGroup = (*solidStorage)("dsk"); 
     Partition<Count>* solidCounts = & dskGroup.getPartition<Count> ("solid");
 
+    /** We may save the Bloom, cFP and MPHF structures built below into the native mapped file of the
+     * storage too, so that loading the graph uses them in place instead of reading them. A graph whose
+     * structures are already built keeps its mapped file, if any. */
+    bool useMappedFile = props->get("-mmap") != 0
+        && !graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE)
+        && !graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE);
+    if (useMappedFile)  {  graph.getStorage().createMappedFile();  }
+
     /** We create an instance of the MPHF Algorithm class (I was wondering: why is that a class, and not a function?) and execute it. */
     bool  noMphf = props->get("-no-mphf") != 0;
     if ((!noMphf) && (!graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE)))
@@ -495,6 +534,13 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
         data.setAbundance(mphf_algo.getAbundanceMap());
         data.setNodeState(mphf_algo.getNodeStateMap());
         data.setAdjacency(mphf_algo.getAdjacencyMap());
+
+        /** The false positives of a cuckoo filter share the MPHF indexes of solid kmers: we need the node checks. */
+        if (graph._debloomKind == DEBLOOM_CUCKOO)
+        {
+            mphf_algo.buildNodeChecks ();
+            data.setNodeCheck (mphf_algo.getNodeCheckMap());
+        }
         graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE);
 
         DEBUG ((cout << "build_visitor : MPHFAlgorithm END\n"));
@@ -507,7 +553,12 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     {
         DEBUG ((cout << "build_visitor : BloomAlgorithm BEGIN\n"));
 
-        if (graph._bloomKind != BLOOM_NONE)
+        /** A cuckoo filter holds the nodes by itself (see DebloomAlgorithm): no Bloom filter is needed. */
+        if (graph._debloomKind == DEBLOOM_CUCKOO)
+        {
+            graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE);
+        }
+        else if (graph._bloomKind != BLOOM_NONE)
         {
             BloomAlgorithm<span> bloomAlgo (
                     graph.getStorage(),
@@ -517,8 +568,12 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
                     props->get(STR_NB_CORES)   ? props->getInt(STR_NB_CORES)   : 0,
                     graph._bloomKind
                     );
+            bloomAlgo.setBloom (data._bloom);
             graph.executeAlgorithm (bloomAlgo, & graph.getStorage(), props, graph._info);
             graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE);
+
+            /** The debloom stage will use the Bloom filter in memory. */
+            data.setBloom (bloomAlgo.getBloom());
         }
 
         DEBUG ((cout << "build_visitor : BloomAlgorithm END\n"));
@@ -549,12 +604,17 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
                 );
         LOCAL (debloom);
 
+        if (props->get(STR_CUCKOO_BITS))  {  debloom->getInput()->add (0, STR_CUCKOO_BITS, props->getStr(STR_CUCKOO_BITS));  }
+
+        debloom->setBloom (data._bloom);
+
         graph.executeAlgorithm (*debloom, & graph.getStorage(), props, graph._info);
 
         graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_DEBLOOM_DONE);
 
         /** We configure the variant. */
         data.setContainer (debloom->getContainerNode());
+        data.setBloom     (0);
 
         DEBUG ((cout << "build_visitor : DebloomAlgorithm END\n"));
     }
@@ -610,6 +670,9 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     /************************************************************/
     /*                        Clean up                          */
     /************************************************************/
+
+    /** The mapped file gets its final name. */
+    if (useMappedFile)  {  graph.getStorage().closeMappedFile();  }
 }
 
 
@@ -644,12 +707,14 @@ IOptionsParser* GraphTemplate<Node, Edge, GraphDataVariant>::getOptionsParser (b
     parser->push_back (DebloomAlgorithm<>::getOptionsParser());
     parser->push_back (BranchingAlgorithm<>::getOptionsParser());
     parser->push_front (new OptionNoParam  ("-no-mphf",       "don't construct the MPHF"));
+    parser->push_front (new OptionNoParam  ("-mmap",          "also save the Bloom, cFP and MPHF in a native file used in place at load"));
 
     /** We create a "general options" parser. */
     IOptionsParser* parserGeneral  = new OptionsParser ("general");
     parserGeneral->push_front (new OptionOneParam (STR_INTEGER_PRECISION, "integers precision (0 for optimized value)", false, "0", false));
     parserGeneral->push_front (new OptionOneParam (STR_VERBOSE,           "verbosity level",      false, "1"  ));
     parserGeneral->push_front (new OptionOneParam (STR_NB_CORES,          "number of cores",      false, "0"  ));
+    parserGeneral->push_front (new OptionOneParam (STR_DECOMPRESS_THREADS,"number of threads inflating gzipped reads (0 for none)", false, "0", false));
     parserGeneral->push_front (new OptionNoParam  (STR_CONFIG_ONLY,       "dump config only"));
     
     parser->push_back  (parserGeneral);
@@ -814,6 +879,9 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (bank::IBank* bank, t
     parse (params->getStr(STR_DEBLOOM_IMPL),      _debloomImpl);
     parse (params->getStr(STR_BRANCHING_TYPE),    _branchingKind);
 
+    /** We set the number of threads inflating gzipped reads files during the build. */
+    if (params->get(STR_DECOMPRESS_THREADS))  {  Bank::setNbDecompressThreads (bank, params->getInt(STR_DECOMPRESS_THREADS));  }
+
     /** We configure the data variant according to the provided kmer size. */
     setVariant (_variant, _kmerSize, integerPrecision);
 
@@ -896,6 +964,9 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
         /** We build a Bank instance for the provided reads uri. */
         bank::IBank* bank = Bank::open (params->getStr(STR_URI_INPUT));
 
+        /** We set the number of threads inflating gzipped reads files during the build. */
+        if (params->get(STR_DECOMPRESS_THREADS))  {  Bank::setNbDecompressThreads (bank, params->getInt(STR_DECOMPRESS_THREADS));  }
+
         /** We build the graph according to the wanted precision. */
         boost::apply_visitor (build_visitor_solid<Node, Edge, GraphDataVariant>(*this, bank,params),  *(GraphDataVariant*)_variant);
         boost::apply_visitor (build_visitor_postsolid<Node, Edge, GraphDataVariant>(*this, params),  *(GraphDataVariant*)_variant);
@@ -1136,6 +1207,67 @@ size_t GraphTemplate<Node, Edge, GraphDataVariant>::degree (Node& node, Directio
 template<typename Node, typename Edge, typename GraphDataVariant>
 void GraphTemplate<Node, Edge, GraphDataVariant>::degree (Node& node, size_t &in, size_t &out) const  {  countNeighbors(node, in, out);  } 
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : candidate neighbors of a node, queried in a single batch
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the (at most 8) canonical neighbors candidates are built (outcoming ones first,
+**           then incoming ones, each by increasing nucleotide) and all looked for at once
+**           with GraphData::containsBatch, so the memory accesses of the 8 queries overlap.
+*********************************************************************/
+template<size_t span>
+struct NeighborCandidates
+{
+    typedef typename Kmer<span>::Type Type;
+
+    Type        kmer   [8];
+    Strand      strand [8];
+    Nucleotide  nt     [8];
+    Direction   dir    [8];
+    u_int8_t    found  [8];
+    size_t      size;
+
+    NeighborCandidates (const GraphData<span>& data, const Type& graine, Direction direction) : size(0)
+    {
+        /** Shortcuts. */
+        size_t      kmerSize = data._model->getKmerSize();
+        const Type& mask     = data._model->getKmerMax();
+
+        if (direction & DIR_OUTCOMING)
+        {
+            for (u_int64_t n=0; n<4; n++)
+            {
+                Type forward = ( (graine << 2 )  + n) & mask;
+                add (forward, revcomp (forward, kmerSize), (Nucleotide)n, DIR_OUTCOMING);
+            }
+        }
+
+        if (direction & DIR_INCOMING)
+        {
+            /** IMPORTANT !!! Since we have hugely shift the nt value, we make sure to use a long enough integer. */
+            for (u_int64_t n=0; n<4; n++)
+            {
+                Type single_nt;
+                single_nt.setVal(n);
+                single_nt <<=  ((kmerSize-1)*2);
+                Type forward = ((graine >> 2 )  + single_nt ) & mask; /* previous kmer */
+                add (forward, revcomp (forward, kmerSize), (Nucleotide)n, DIR_INCOMING);
+            }
+        }
+
+        data.containsBatch (kmer, size, found);
+    }
+
+    void add (const Type& forward, const Type& reverse, Nucleotide n, Direction d)
+    {
+        if (forward < reverse)  {  kmer[size] = forward;  strand[size] = STRAND_FORWARD;  }
+        else                    {  kmer[size] = reverse;  strand[size] = STRAND_REVCOMP;  }
+        nt[size] = n;  dir[size] = d;  size++;
+    }
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -1280,68 +1412,17 @@ struct getItems_visitor : public boost::static_visitor<GraphVector<Item> >    {
             return itemsAdj;
         }
 
-        /* else, run classical neighbor queries using the data.contains() operation (bloom filters behind the scenes) */
+        /* else, run classical neighbor queries using the data.containsBatch() operation (bloom filters behind the scenes) */
+        NeighborCandidates<span> candidates (data, graine, direction);
 
-        if (direction & DIR_OUTCOMING)
+        for (size_t i=0; i<candidates.size; i++)
         {
-            for (u_int64_t nt=0; nt<4; nt++)
+            if (candidates.found[i])
             {
                 typename Node::Value dest_value;
-                Type forward = ( (graine << 2 )  + nt) & mask;
-                Type reverse = revcomp (forward, kmerSize);
-
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        dest_value = forward;
-                        if (debug) std::cout << "kmer  "<< sourceVal << " found OUT FWD nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_FORWARD, (Nucleotide)nt, DIR_OUTCOMING);
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        dest_value = reverse;
-                        if (debug) std::cout << "found OUT REV nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_REVCOMP, (Nucleotide)nt, DIR_OUTCOMING);
-                    }
-                }
-            }
-        }
-
-        if (direction & DIR_INCOMING)
-        {
-            /** IMPORTANT !!! Since we have hugely shift the nt value, we make sure to use a long enough integer. */
-            for (u_int64_t nt=0; nt<4; nt++)
-            {
-                Type single_nt;
-                single_nt.setVal(nt);
-                single_nt <<=  ((kmerSize-1)*2);
-                typename Node::Value dest_value;
-                Type forward = ((graine >> 2 )  + single_nt ) & mask; /* previous kmer */
-                Type reverse = revcomp (forward, kmerSize);
-
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        dest_value = forward;
-                        if (debug) std::cout << "found INC FWD nt=" << nt << std::endl;
-                        // It used to be that "nt" was source[0] (in forward strand) and reverse(source[k-1]) in reverse, but i think it was wrong, so i changed it. TODO: delete this line if neighbors(..,DIR_INCOMING) causes no trouble for anyone, as it is now.
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_FORWARD, (Nucleotide)nt, DIR_INCOMING);
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        dest_value = reverse;
-                        if (debug) std::cout << "found INC REV nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_REVCOMP, (Nucleotide)nt, DIR_INCOMING);
-                    }
-                }
+                dest_value = candidates.kmer[i];
+                if (debug) std::cout << "kmer  "<< sourceVal << " found " << (candidates.dir[i]==DIR_OUTCOMING ? "OUT" : "INC") << " " << (candidates.strand[i]==STRAND_REVCOMP ? "REV" : "FWD") << " nt=" << candidates.nt[i] << std::endl;
+                fct (items, idx++, source.kmer, source.strand, dest_value, candidates.strand[i], candidates.nt[i], candidates.dir[i]);
             }
         }
 
@@ -1408,7 +1489,7 @@ GraphVector<Node> GraphTemplate<Node, Edge, GraphDataVariant>::getNodes (Node &s
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS : simple version of getITems above, just for counting number of neighbors. sorry for code duplication, I didn't want to use more functors (yet)
+** REMARKS : simple version of getITems above, just for counting number of neighbors.
 *********************************************************************/
 template<typename Node, typename Edge, typename GraphDataVariant>
 struct countNeighbors_visitor : public boost::static_visitor<void>    {
@@ -1452,7 +1533,7 @@ struct countNeighbors_visitor : public boost::static_visitor<void>    {
             return;
         }
 
-        /* else, run classical neighbor queries using the data.contains() operation (bloom filters behind the scenes) */
+        /* else, run classical neighbor queries using the data.containsBatch() operation (bloom filters behind the scenes) */
 
         /** Shortcut. */
         typedef typename Kmer<span>::Type Type;
@@ -1462,63 +1543,19 @@ struct countNeighbors_visitor : public boost::static_visitor<void>    {
 
         /** Shortcuts. */
         size_t      kmerSize = data._model->getKmerSize();
-        const Type& mask     = data._model->getKmerMax();
-
 
         /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node */
         Type graine = ((source.strand == STRAND_FORWARD) ?  sourceVal :  revcomp (sourceVal, kmerSize) );
         /* TODO opt: in some cases we may skip computing graine, e.g. whenever there are no neighbors */
 
+        NeighborCandidates<span> candidates (data, graine, direction);
 
-        if (direction & DIR_OUTCOMING)
+        for (size_t i=0; i<candidates.size; i++)
         {
-            for (u_int64_t nt=0; nt<4; nt++)
+            if (candidates.found[i])
             {
-                Type forward = ( (graine << 2 )  + nt) & mask;
-                Type reverse = revcomp (forward, kmerSize);
-
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        outdegree++;
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        outdegree++;
-                    }
-                }
-            }
-        }
-
-        if (direction & DIR_INCOMING)
-        {
-            /** IMPORTANT !!! Since we have hugely shift the nt value, we make sure to use a long enough integer. */
-            for (u_int64_t nt=0; nt<4; nt++)
-            {
-                Type single_nt;
-                single_nt.setVal(nt);
-                single_nt <<=  ((kmerSize-1)*2);
-                Type forward = ((graine >> 2 )  + single_nt ) & mask; /* previous kmer */
-                Type reverse = revcomp (forward, kmerSize);
-
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        indegree++;
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        indegree++;
-                    }
-                }
+                if (candidates.dir[i] == DIR_OUTCOMING)  {  outdegree++;  }
+                else                                     {  indegree++;   }
             }
         }
     }
@@ -2213,6 +2250,34 @@ bool GraphTemplate<Node, Edge, GraphDataVariant>::contains (const Node& item) co
     return boost::apply_visitor (contains_visitor<Node, Edge, GraphDataVariant>(item),  *(GraphDataVariant*)_variant);
 }
 
+/********************************************************************************/
+/* removes a node from the nodes container, when the container supports it (cuckoo filter);
+ * the neighbors queries then don't see the node, with or without MPHF node states. */
+template<typename Node, typename Edge, typename GraphDataVariant>
+struct removeNode_visitor : public boost::static_visitor<bool>    {
+
+    const Node& node;
+    removeNode_visitor (const Node& aNode) : node(aNode) {}
+
+    template<size_t span>  bool operator() (const GraphData<span>& data) const
+    {
+        /** Shortcut. */
+        typedef typename Kmer<span>::Type Type;
+
+        return data._container != 0 && data._container->remove (node.template getKmer<Type>());
+    }
+};
+
+/* tells whether the nodes container supports the removal of nodes (cuckoo filter). */
+template<typename Node, typename Edge, typename GraphDataVariant>
+struct canRemoveNode_visitor : public boost::static_visitor<bool>    {
+
+    template<size_t span>  bool operator() (const GraphData<span>& data) const
+    {
+        return data._container != 0 && data._container->canRemove ();
+    }
+};
+
 template<typename Node, typename Edge, typename GraphDataVariant>
 template<size_t span>
 bool GraphTemplate<Node, Edge, GraphDataVariant>::contains (const typename Kmer<span>::Type& item) const
@@ -3224,6 +3289,10 @@ unsigned long getNodeIndex (const GraphData<span>& data, Node_in& node)
     // we use _abundance as the mphf. we could also use _nodestate but it might be null if disabled by disableNodeState()
     unsigned long hashIndex = (*(data._abundance)).getCode(value);
 
+    // a false positive of the nodes container is not in the mphf, even if it gets the index of some solid kmer
+    if (hashIndex != ULLONG_MAX && !data.checkNode (value, hashIndex))
+        hashIndex = ULLONG_MAX;
+
     node.mphfIndex = hashIndex;
     
     //std::cout<<"getNodeIndex : " << value <<  " : " << hashIndex << std::endl;
@@ -3382,10 +3451,18 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::disableNodeState() const
     boost::apply_visitor (disableNodeState_visitor<Node, Edge, GraphDataVariant>(),  *(GraphDataVariant*)_variant);
 }
 
+/* without MPHF, a node is deleted if its container doesn't have it any more (see removeNode_visitor);
+ * containers that can't remove nodes (Bloom filters) have no deletion information, all nodes are then said deleted. */
 template<typename Node, typename Edge, typename GraphDataVariant> 
 bool GraphTemplate<Node, Edge, GraphDataVariant>::isNodeDeleted(Node& node) const
 {
-    return (!checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE)) || (((queryNodeState(node) >> 1) & 1) == 1);
+    if (!checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE))
+    {
+        if (boost::apply_visitor (canRemoveNode_visitor<Node, Edge, GraphDataVariant>(),  *(GraphDataVariant*)_variant))
+            return !contains(node);
+        return true;
+    }
+    return (((queryNodeState(node) >> 1) & 1) == 1);
 }
 
 
@@ -3556,6 +3633,11 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned i
 template<typename Node, typename Edge, typename GraphDataVariant>
 void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNode (Node& node) const
 {
+    // a node that is not in the graph (already deleted, or a false positive of a cuckoo filter rejected by
+    // GraphData::checkNode) has nothing to delete; its MPHF index, if any, belongs to another node.
+    if (checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE) && !contains(node))
+        return;
+
     bool hasAdjacency = getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_ADJACENCY_DONE;
     if (hasAdjacency)
     {
@@ -3633,8 +3715,15 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNode (Node& node) const
     Vector<Edge> neighbs = this->neighborsEdge(node);
 #endif
 
+    // with MPHF, the node is only marked as deleted in the node states. The container can't tell apart a false positive
+    // from a solid node: removing a false positive neighbor (e.g. during tip removal) would remove the fingerprint of a
+    // solid node (see IContainerNode::remove). The node checks make sure that such a neighbor never reaches this point.
     if (checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE))
         setNodeState(node, 2);
+    // without MPHF, the node is removed from its container (when supported), only once since the container
+    // can't tell apart two nodes sharing a fingerprint.
+    else if (!isNodeDeleted(node))
+        boost::apply_visitor (removeNode_visitor<Node, Edge, GraphDataVariant>(node),  *(GraphDataVariant*)_variant);
 
     // another test
 #if 0
@@ -37,6 +37,8 @@
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/tools/math/Integer.hpp>
 
+#include <boost/mpl/contains.hpp>
+
 #include <gatb/kmer/impl/BloomBuilder.hpp>
 #include <gatb/kmer/impl/DebloomAlgorithm.hpp>
 
@@ -591,12 +593,30 @@ public:
     /* Copy Constructor.*/
     GraphTemplate (const GraphTemplate& graph);
 
+    /** Constructor from a graph of another template instantiation, sharing its data. This is
+     * mainly used for getting a GraphFast<span> from a Graph whose kmers fit in 'span'
+     * (see applyFast). An exception is thrown if the data of the graph has another span.
+     * \param[in] graph : the graph whose data is shared. */
+    template<typename OtherNode, typename OtherEdge, typename OtherGraphDataVariant>
+    explicit GraphTemplate (const GraphTemplate<OtherNode, OtherEdge, OtherGraphDataVariant>& graph);
+
     /* Destructor. */
     ~GraphTemplate ();
 
     /** Affectation overload. */
     GraphTemplate& operator= (const GraphTemplate& graph);
 
+    /** Run an algorithm on the span-typed graph (see GraphFast) matching the kmer size of this
+     * graph. The span is resolved once, then the functor is called as
+     *      Functor<span>() (GraphFast<span>& graph, Parameter params)
+     * The algorithm works with nodes holding native kmer values, and each call to the graph
+     * (neighbors, contains, queryAbundance...) has no Integer variant dispatch.
+     * Algorithms like TraversalTemplate, Simplifications or BranchingAlgorithm take the
+     * GraphFast<span> type (and NodeFast<span>, EdgeFast<span>) as template parameters.
+     * \param[in] params : parameters given to the functor. */
+    template<template<size_t> class Functor, typename Parameter>
+    void applyFast (Parameter params) const;
+
     /**********************************************************************/
     /*                     GLOBAL ITERATOR METHODS                        */
     /**********************************************************************/
@@ -907,7 +927,13 @@ public:
     void resetNodeState () const ;
     void disableNodeState () const ; // see Graph.cpp for explanation
 
-    // deleted nodes, related to NodeState above
+    /** Delete a node: with MPHF, it is marked as deleted in the node states, otherwise it is removed
+     * from the nodes container when supported.
+     * With a cuckoo filter (-debloom cuckoo) and MPHF, the false positives of the filter are told apart
+     * from the solid nodes by the node checks (see GraphData::checkNode): they are not in the graph and
+     * deleting one does nothing. Without MPHF, deleting a false positive may remove the fingerprint of
+     * a solid node from the filter.
+     * \param[in] node : the node to be deleted */
     void deleteNode (Node& node) const;
     void deleteNodesByIndex(std::vector<bool> &bitmap, int nbCores = 1, gatb::core::system::ISynchronizer* synchro=NULL) const;
     bool isNodeDeleted(Node& node) const;
@@ -1177,10 +1203,11 @@ struct GraphData
     typedef typename gatb::core::kmer::impl::MPHFAlgorithm<span>::AbundanceMap   AbundanceMap;
     typedef typename gatb::core::kmer::impl::MPHFAlgorithm<span>::NodeStateMap   NodeStateMap;
     typedef typename gatb::core::kmer::impl::MPHFAlgorithm<span>::AdjacencyMap   AdjacencyMap;
+    typedef typename gatb::core::kmer::impl::MPHFAlgorithm<span>::NodeCheckMap   NodeCheckMap;
     typedef typename std::unordered_map<Type, std::pair<char,std::string>, NodeHasher<Type> > NodeCacheMap; // rudimentary for now
 
     /** Constructor. */
-    GraphData () : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecache(0) {}
+    GraphData () : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecheck(0), _nodecache(0), _bloom(0) {}
 
     /** Destructor. */
     ~GraphData ()
@@ -1192,11 +1219,13 @@ struct GraphData
         setAbundance (0);
         setNodeState (0);
         setAdjacency (0);
+        setNodeCheck (0);
         setNodeCache (0);
+        setBloom     (0);
     }
 
     /** Constructor (copy). */
-    GraphData (const GraphData& d) : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecache(0)
+    GraphData (const GraphData& d) : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecheck(0), _nodecache(0), _bloom(0)
     {
         setModel     (d._model);
         setSolid     (d._solid);
@@ -1205,7 +1234,9 @@ struct GraphData
         setAbundance (d._abundance);
         setNodeState (d._nodestate);
         setAdjacency (d._adjacency);
+        setNodeCheck (d._nodecheck);
         setNodeCache (d._nodecache);
+        setBloom     (d._bloom);
     }
 
     /** Assignment operator. */
@@ -1220,7 +1251,9 @@ struct GraphData
             setAbundance (d._abundance);
             setNodeState (d._nodestate);
             setAdjacency (d._adjacency);
+            setNodeCheck (d._nodecheck);
             setNodeCache (d._nodecache);
+            setBloom     (d._bloom);
         }
         return *this;
     }
@@ -1233,7 +1266,9 @@ struct GraphData
     AbundanceMap*         _abundance;
     NodeStateMap*         _nodestate;
     AdjacencyMap*         _adjacency;
+    NodeCheckMap*         _nodecheck; // only with a nodes container having false positives (cuckoo filter), see checkNode
     NodeCacheMap*         _nodecache; // so, nodecache also records branching node, but also more stuff. i'm keeping _branching for historical reasons.
+    tools::collections::impl::IBloom<Type>*   _bloom;     // Bloom filter of the solid kmers, only kept during the graph construction
 
     /** Setters. */
     void setModel       (Model*                                       model)      { SP_SETATTR (model);     }
@@ -1243,7 +1278,17 @@ struct GraphData
     void setAbundance   (AbundanceMap*          abundance)  { SP_SETATTR (abundance); }
     void setNodeState   (NodeStateMap*          nodestate)  { SP_SETATTR (nodestate); }
     void setAdjacency   (AdjacencyMap*          adjacency)  { SP_SETATTR (adjacency); }
+    void setNodeCheck   (NodeCheckMap*          nodecheck)  { SP_SETATTR (nodecheck); }
     void setNodeCache   (NodeCacheMap*          nodecache)  { _nodecache = nodecache; /* would like to do "SP_SETATTR (nodecache)" but nodecache is an unordered_map, not some type that derives from a smartpointer. so one day, address this. I'm not sure if it's important though. Anyway I'm phasing out NodeCache in favor of GraphUnitigs. */; }
+    void setBloom       (tools::collections::impl::IBloom<Type>*  bloom)      { SP_SETATTR (bloom);     }
+
+    /** Tell whether a MPHF index is the one of a kmer. A kmer that is not solid gets the index of some
+     * solid kmer: with a cuckoo filter, the graph has such (false positive) kmers, which must not see
+     * nor change the node state of this solid kmer. Without node checks, any index is accepted. */
+    bool checkNode (const Type& item, u_int64_t hashIndex)  const
+    {
+        return _nodecheck == NULL || _nodecheck->at(hashIndex) == gatb::core::kmer::impl::MPHFAlgorithm<span>::getNodeCheck (item);
+    }
 
     /** Shortcut. */
     bool contains (const Type& item)  const  {  
@@ -1253,6 +1298,13 @@ struct GraphData
         if (!res)
             return false;
 
+        /* a false positive of the container may share the MPHF index of a solid kmer */
+        if (_nodecheck != NULL && _nodestate == NULL)
+        {
+            unsigned long hashIndex = _nodecheck->getCode(item);
+            if (hashIndex == ULLONG_MAX || !checkNode (item, hashIndex)) return false;
+        }
+
         /* check if kmer is deleted*/
         // this is duplicated code from queryNodeState.
         // NOTE: this does a MPHF query for each bloom contains that answer true. costly!
@@ -1260,6 +1312,7 @@ struct GraphData
         {
             unsigned long hashIndex = ((_nodestate))->getCode(item);
 			if(hashIndex == ULLONG_MAX) return false;
+            if (!checkNode (item, hashIndex)) return false;
             unsigned char value = ((_nodestate))->at(hashIndex / 2);
             if ((hashIndex % 2) == 1)
                 value >>= 4;
@@ -1270,6 +1323,52 @@ struct GraphData
 
         return true;
     }
+
+    /** Batched version of contains: the container is queried once for the whole batch, then
+     * the deleted nodes (and the false positives, with node checks) are filtered out by chunks
+     * of 8 items: the MPHF codes, node states and checks of the found items of a chunk are
+     * prefetched first. */
+    void containsBatch (const Type* items, size_t n, u_int8_t* out)  const
+    {
+        _container->containsBatch (items, n, out);
+
+        if (_nodestate == NULL && _nodecheck == NULL)  { return; }
+
+        static const size_t BATCH = 8;
+        Type          found [BATCH];
+        size_t        idx   [BATCH];
+        u_int64_t     codes [BATCH];
+
+        for (size_t b=0; b<n; b+=BATCH)
+        {
+            size_t m = 0;
+            for (size_t i=b; i<std::min(n,b+BATCH); i++)  {  if (out[i])  {  found[m] = items[i];  idx[m++] = i;  }  }
+            if (m==0)  { continue; }
+
+            if (_nodestate != NULL)  {  _nodestate->getCode (found, m, codes);  }
+            else                     {  _nodecheck->getCode (found, m, codes);  }
+            for (size_t j=0; j<m; j++)
+            {
+                if (codes[j] == ULLONG_MAX)  { continue; }
+                if (_nodestate != NULL)  {  _nodestate->prefetch (codes[j] / 2);  }
+                if (_nodecheck != NULL)  {  _nodecheck->prefetch (codes[j]);      }
+            }
+
+            /* same check as in contains */
+            for (size_t j=0; j<m; j++)
+            {
+                u_int64_t hashIndex = codes[j];
+                if (hashIndex == ULLONG_MAX || !checkNode (found[j], hashIndex))  {  out[idx[j]] = 0;  continue;  }
+                if (_nodestate == NULL)  { continue; }
+                unsigned char value = _nodestate->at (hashIndex / 2);
+                if ((hashIndex % 2) == 1)
+                    value >>= 4;
+                value &= 0xF;
+                if (((value >> 1) & 1) == 1)
+                    out[idx[j]] = 0;
+            }
+        }
+    }
 };
 
 /* This definition is the basis for having a "generic" Graph class, ie. not relying on a template
@@ -1301,6 +1400,8 @@ template <size_t span>
 using EdgeFast = Edge_t<NodeFast<span> >;
 template <size_t span>
 using GraphDataVariantFast = boost::variant<GraphData<span> >; 
+template <size_t span>
+using GraphFast = GraphTemplate<NodeFast<span>, EdgeFast<span>, GraphDataVariantFast<span> >;
 
 
 template <typename Type, class Listener>
@@ -1347,6 +1448,67 @@ struct build_visitor_postsolid : public boost::static_visitor<>    {
 };
 
 
+/* copy the data of a graph into a variant holding the same GraphData type */
+template<typename GraphDataVariant>
+struct graph_data_visitor : public boost::static_visitor<>    {
+
+    GraphDataVariant& target;
+
+    graph_data_visitor (GraphDataVariant& aTarget) : target(aTarget) {}
+
+    template<size_t span>  void operator() (const GraphData<span>& data) const
+    {
+        assign (data, typename boost::mpl::contains<typename GraphDataVariant::types, GraphData<span> >::type());
+    }
+
+    template<size_t span>  void assign (const GraphData<span>& data, boost::mpl::true_)  const  {  target = data;  }
+
+    template<size_t span>  void assign (const GraphData<span>& data, boost::mpl::false_) const
+    {
+        throw system::Exception ("Graph of span %d can't be used with another span", span);
+    }
+};
+
+/* run an algorithm on the span-typed graph */
+template<typename Node, typename Edge, typename GraphDataVariant, template<size_t> class Functor, typename Parameter>
+struct apply_fast_visitor : public boost::static_visitor<>    {
+
+    const GraphTemplate<Node, Edge, GraphDataVariant>& graph;  Parameter params;
+
+    apply_fast_visitor (const GraphTemplate<Node, Edge, GraphDataVariant>& aGraph, Parameter aParams) : graph(aGraph), params(aParams) {}
+
+    template<size_t span>  void operator() (const GraphData<span>& data) const
+    {
+        GraphFast<span> graphFast (graph);
+        Functor<span>() (graphFast, params);
+    }
+};
+
+/********************************************************************************/
+template<typename Node, typename Edge, typename GraphDataVariant>
+template<typename OtherNode, typename OtherEdge, typename OtherGraphDataVariant>
+GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (const GraphTemplate<OtherNode, OtherEdge, OtherGraphDataVariant>& graph)
+    : _storageMode(graph._storageMode), _storage(0),
+      _variant(new GraphDataVariant()), _kmerSize(graph._kmerSize), _info("graph"), _name(graph._name), _state(graph._state),
+      _bloomKind(graph._bloomKind), _debloomKind(graph._debloomKind), _debloomImpl(graph._debloomImpl), _branchingKind(graph._branchingKind)
+{
+    setStorage (graph._storage);
+
+    if (graph._variant)
+    {
+        boost::apply_visitor (graph_data_visitor<GraphDataVariant> (*(GraphDataVariant*)_variant),  *(OtherGraphDataVariant*)graph._variant);
+    }
+}
+
+/********************************************************************************/
+template<typename Node, typename Edge, typename GraphDataVariant>
+template<template<size_t> class Functor, typename Parameter>
+void GraphTemplate<Node, Edge, GraphDataVariant>::applyFast (Parameter params) const
+{
+    boost::apply_visitor (apply_fast_visitor<Node, Edge, GraphDataVariant, Functor, Parameter> (*this, params),  *(GraphDataVariant*)_variant);
+}
+
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -31,6 +31,7 @@
 #include <gatb/tools/misc/impl/HostInfo.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 #include <gatb/tools/misc/impl/Tool.hpp>
+#include <gatb/tools/math/NucleotideCodec.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
@@ -210,6 +211,8 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (bank::IBank* bank, tools::misc
     /** We get the kmer size from the user parameters. */
     BaseGraph::_kmerSize = params->getInt (STR_KMER_SIZE);
     size_t integerPrecision = params->getInt (STR_INTEGER_PRECISION);
+    /** We set the number of threads inflating gzipped reads files during the build. */
+    if (params->get(STR_DECOMPRESS_THREADS))  {  Bank::setNbDecompressThreads (bank, params->getInt(STR_DECOMPRESS_THREADS));  }
     /** We configure the data variant according to the provided kmer size. */
     BaseGraph::setVariant (BaseGraph::_variant, BaseGraph::_kmerSize, integerPrecision);
     string unitigs_filename = "dummy.unitigs.fa"; // because there's already a bank, but we don't know its name maybe? so just to be safe, i'm setting a dummy unitigs file. anyway, this constructor is only called in tests i think, not by minia for sure.
@@ -933,6 +936,9 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
         /** We build a Bank instance for the provided reads uri. */
         bank::IBank* bank = Bank::open (params->getStr(STR_URI_INPUT));
 
+        /** We set the number of threads inflating gzipped reads files during the build. */
+        if (params->get(STR_DECOMPRESS_THREADS))  {  Bank::setNbDecompressThreads (bank, params->getInt(STR_DECOMPRESS_THREADS));  }
+
         /** We build the graph according to the wanted precision. */
         boost::apply_visitor ( build_visitor_solid<NodeFast<span>,EdgeFast<span>,GraphDataVariantFast<span>>(*this, bank,params),  *(GraphDataVariantFast<span>*)BaseGraph::_variant);
 
@@ -2038,29 +2044,21 @@ void GraphUnitigsTemplate<span>::disableNodeState() const
 template<size_t span>
 std::string GraphUnitigsTemplate<span>::internal_get_unitig_sequence(unsigned int id) const
 {
-    std::string unitig_seq;
+    /** The unitigs are packed by the nucleotide codec (first nucleotide in the high bits of a byte),
+     * so they are unpacked in place, without copying the packed bytes. */
+    const char* packed;
     if (pack_unitigs)
     {
        if (id == 0)
-           unitig_seq = packed_unitigs.substr(0, packed_unitigs_sizes[0]);
+           packed = packed_unitigs.data();
        else
-       {
-           uint64_t ps = packed_unitigs_sizes.prefix_sum(id);
-           unitig_seq = packed_unitigs.substr(ps, unitigs_sizes[id]);
-       }
+           packed = packed_unitigs.data() + packed_unitigs_sizes.prefix_sum(id);
     }
     else
-       unitig_seq = unitigs[id];
-    int i = unitigs_sizes[id];
-    std::string res(i,'x');
-    for (--i ; i >= 0; i--) {
-        const unsigned char c = (unitig_seq[i/4]);
-        const unsigned char byte = (c >> (2*(i % 4))) & 3;
-        if (byte == 2) 
-            res[i] = 'T';
-        else
-            res[i] = 'A' | (byte << 1);
-    }
+       packed = unitigs[id].data();
+
+    std::string res(unitigs_sizes[id],'x');
+    unpackNucleotides ((const u_int8_t*) packed, 0, res.size(), &res[0]);
     return res;
 }
 
@@ -2073,15 +2071,8 @@ unsigned int GraphUnitigsTemplate<span>::internal_get_unitig_length(unsigned int
 template<size_t span>
 std::string GraphUnitigsTemplate<span>::internal_compress_unitig(std::string seq) const
 {
-    unsigned int n = (seq.size()+3)/4;
-    unsigned char res[n];
-    for (size_t i = 0; i < n; i++)
-        res[i] = 0;
-
-    for (size_t i = 0; i < seq.size(); i++)
-        res[i / 4] |= ((seq[i] >> 1) & 3) << (2*(i % 4));
-    
-    std::string res_str(reinterpret_cast<const char *>(res), n);
+    std::string res_str (getPackedSize (seq.size()), 0);
+    packNucleotides (seq.data(), seq.size(), (u_int8_t*) &res_str[0], 0);
     return res_str;
 }
 
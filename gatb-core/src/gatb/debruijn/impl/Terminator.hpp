@@ -317,6 +317,12 @@ typedef TerminatorTemplate<Node, Edge, Graph> Terminator;
 typedef MPHFTerminatorTemplate<Node, Edge, Graph> MPHFTerminator; 
 typedef BranchingTerminatorTemplate<Node, Edge, Graph> BranchingTerminator; 
 
+/* span-typed terminators, to be used with GraphFast (see GraphTemplate::applyFast) */
+template <size_t span>
+using TerminatorFast = TerminatorTemplate<NodeFast<span>, EdgeFast<span>, GraphFast<span> >;
+template <size_t span>
+using BranchingTerminatorFast = BranchingTerminatorTemplate<NodeFast<span>, EdgeFast<span>, GraphFast<span> >;
+
 
 /********************************************************************************/
 } } } } /* end of namespaces. */
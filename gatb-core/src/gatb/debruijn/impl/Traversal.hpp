@@ -376,6 +376,12 @@ typedef MonumentTraversalTemplate<Node, Edge, Graph> MonumentTraversal;
 typedef NullTraversalTemplate<Node, Edge, Graph> NullTraversal; 
 typedef SimplePathsTraversalTemplate<Node, Edge, Graph> SimplePathsTraversal;
 
+/* span-typed traversals, to be used with GraphFast (see GraphTemplate::applyFast) */
+template <size_t span>
+using TraversalFast = TraversalTemplate<NodeFast<span>, EdgeFast<span>, GraphFast<span> >;
+template <size_t span>
+using MonumentTraversalFast = MonumentTraversalTemplate<NodeFast<span>, EdgeFast<span>, GraphFast<span> >;
+
 
 
 /********************************************************************************/
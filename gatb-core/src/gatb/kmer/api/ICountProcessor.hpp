@@ -59,6 +59,11 @@ namespace kmer      {
  * provided to the ICountProcessor clone, and accordingly to the actual implementation
  * class of the ICountProcessor interface, different processings can be done.
  *
+ * SortingCountAlgorithm actually provides the [kmer,counts] information by batches through
+ * the 'processBatch' method, which avoids one virtual call per kmer. CountProcessorAbstract
+ * implements 'processBatch' by calling 'process' for each kmer, so implementors may only
+ * provide 'process'; the DSK processors override 'processBatch' with a native version.
+ *
  * When all the clones have finished their job (in their own thread), the prototype
  * instance is called (in the main thread) via the 'finishClones' method, where
  * the prototype instance has access to the N clones before they are deleted. It allows
@@ -152,6 +157,28 @@ public:
      */
     virtual bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum=0) = 0;
 
+    /** Notification that a batch of [kmer,counts] is available. This is the same as calling
+     * 'process' for each kmer of the batch, but with only one virtual call for the whole batch;
+     * the data is provided as a structure of arrays.
+     * \param[in] partId : index of the current partition
+     * \param[in] kmers : array of nb kmers
+     * \param[in] counts : array of nb*nbBanks counts; the counts of kmers[i] are counts[i*nbBanks .. (i+1)*nbBanks-1]
+     * \param[in] nb : number of kmers in the batch
+     * \param[in] nbBanks : number of counts per kmer
+     * \param[in] sums : array of nb sums of occurrences (may be null, the sums are then computed from the counts)
+     * \param[out] selected : if not null, receives the (increasing) indexes of the kmers for which 'process' would return true
+     * \return the number of kmers for which 'process' would return true.
+     */
+    virtual size_t processBatch (
+        size_t             partId,
+        const Type*        kmers,
+        const CountNumber* counts,
+        size_t             nb,
+        size_t             nbBanks,
+        const CountNumber* sums     = 0,
+        u_int32_t*         selected = 0
+    ) = 0;
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
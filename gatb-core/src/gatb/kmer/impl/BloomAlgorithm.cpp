@@ -103,7 +103,7 @@ BloomAlgorithm<span>::BloomAlgorithm (
     IProperties*        options
 )
     :  Algorithm("bloom", nb_cores, options),
-       _kmerSize(kmerSize), _nbitsPerKmer(nbitsPerKmer), _bloomKind(bloomKind), _storage(storage), _solidIterable(0)
+       _kmerSize(kmerSize), _nbitsPerKmer(nbitsPerKmer), _bloomKind(bloomKind), _storage(storage), _solidIterable(0), _bloom(0)
 {
     setSolidIterable (solidIterable);
 }
@@ -119,7 +119,7 @@ BloomAlgorithm<span>::BloomAlgorithm (
 template<size_t span>
 BloomAlgorithm<span>::BloomAlgorithm (tools::storage::impl::Storage& storage)
     :  Algorithm("bloom", 0, 0),
-       _kmerSize(0), _nbitsPerKmer(0), _storage(storage), _solidIterable(0)
+       _kmerSize(0), _nbitsPerKmer(0), _storage(storage), _solidIterable(0), _bloom(0)
 {
     /** We get the kind in the storage. */
     string kind = _storage(this->getName()).getProperty ("kind");
@@ -143,6 +143,7 @@ template<size_t span>
 BloomAlgorithm<span>::~BloomAlgorithm ()
 {
     setSolidIterable (0);
+    setBloom         (0);
 }
 
 /*********************************************************************
@@ -166,24 +167,42 @@ void BloomAlgorithm<span>::execute ()
 
     if (estimatedBloomSize ==0 ) { estimatedBloomSize = 1000; }
 
-    /** We create the kmers iterator from the solid file. */
-    Iterator <Count>* itKmers = createIterator<Count> (
-        _solidIterable->iterator(),
-        solidKmersNb,
-        progressFormat1
-    );
-    LOCAL (itKmers);
+    /** A Bloom filter may have been filled during the kmers counting; it has been sized from the
+     * estimated number of solid kmers, so we keep it only if this estimation was good enough.
+     * Otherwise (too many false positives, or too much memory), we build it again. */
+    bool fromCounting = _bloom != 0
+        &&  _bloom->getBitSize() >= 0.75 * estimatedBloomSize
+        &&  _bloom->getBitSize() <= 2.00 * estimatedBloomSize;
 
-    /** We use a bloom builder. */
-    BloomBuilder<span> builder (estimatedBloomSize, nbHash, _kmerSize, _bloomKind, getDispatcher()->getExecutionUnitsNumber());
+    if (_bloom != 0 && fromCounting == false)
+    {
+        getInfo()->add (1, "counting_bitsize", "%ld", _bloom->getBitSize());
+
+        if (getInput()->get(STR_VERBOSE) && getInput()->getInt(STR_VERBOSE) > 0)
+        {
+            cout << "Warning: the Bloom filter filled during the counting has " << _bloom->getBitSize() << " bits instead of "
+                 << estimatedBloomSize << " for " << solidKmersNb << " solid kmers; it is built again from the solid kmers." << endl;
+        }
+    }
 
-    /** We instantiate the bloom object. */
-    IBloom<Type>* bloom = 0;
+    if (fromCounting == false)
     {
+        /** We create the kmers iterator from the solid file. */
+        Iterator <Count>* itKmers = createIterator<Count> (
+            _solidIterable->iterator(),
+            solidKmersNb,
+            progressFormat1
+        );
+
+        /** We use a bloom builder. */
+        BloomBuilder<span> builder (estimatedBloomSize, nbHash, _kmerSize, _bloomKind, getDispatcher()->getExecutionUnitsNumber());
+
+        /** We instantiate the bloom object. */
         TIME_INFO (getTimeInfo(), "build_from_kmers");
-        bloom = builder.build (itKmers);
+        setBloom (builder.build (itKmers));
     }
-    LOCAL (bloom);
+
+    IBloom<Type>* bloom = _bloom;
 
     /** We save the bloom. */
     StorageTools::singleton().saveBloom<Type> (_storage.getGroup(this->getName()), "bloom", bloom, _kmerSize);
@@ -194,6 +213,7 @@ void BloomAlgorithm<span>::execute ()
     getInfo()->add (2, "bitsize",        "%ld", bloom->getBitSize());
     getInfo()->add (2, "nb_hash",        "%d",  bloom->getNbHash());
     getInfo()->add (2, "nbits_per_kmer", "%f",  _nbitsPerKmer);
+    getInfo()->add (2, "from_counting",  "%d",  fromCounting);
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 
     /** We save the kind in the storage. */
@@ -73,6 +73,16 @@ public:
     /** */
     void execute ();
 
+    /** Set a Bloom filter already filled with the solid kmers (see CountProcessorBloom). If its size
+     * matches the actual number of solid kmers, 'execute' saves it instead of building a new one
+     * from the solid kmers.
+     * \param[in] bloom : the Bloom filter of the solid kmers. */
+    void setBloom (tools::collections::impl::IBloom<Type>* bloom)  {  SP_SETATTR(bloom); }
+
+    /** Get the Bloom filter saved by 'execute'.
+     * \return the Bloom filter. */
+    tools::collections::impl::IBloom<Type>* getBloom ()  { return _bloom; }
+
 private:
 
     /** */
@@ -90,6 +100,9 @@ private:
     /** */
     tools::collections::Iterable<Count>* _solidIterable;
     void setSolidIterable (tools::collections::Iterable<Count>* solidIterable)  {  SP_SETATTR(solidIterable); }
+
+    /** */
+    tools::collections::impl::IBloom<Type>* _bloom;
 };
 
 /********************************************************************************/
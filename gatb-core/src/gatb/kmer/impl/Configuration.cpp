@@ -73,9 +73,15 @@ Properties Configuration::getProperties() const
     result.add (1, "sequence_volume",   "%ld", _estimateSeqTotalSize / system::MBYTE);
     result.add (1, "kmers_number",      "%ld", _kmersNb);
     result.add (1, "kmers_volume",      "%ld", _volume);
+    result.add (1, "kmers_distinct_estimate", "%ld", _estimatedDistinctKmerNb);
+    result.add (1, "kmers_solid_estimate",    "%ld", _estimatedSolidKmerNb);
     result.add (1, "max_disk_space",    "%ld", _max_disk_space);
     result.add (1, "max_memory",        "%ld", _max_memory);
     result.add (1, "nb_passes",         "%d",  _nb_passes);
+    result.add (1, "superk_in_memory",  "%d",  _superk_in_memory);
+    result.add (1, "pipeline_passes",   "%d",  _pipeline_passes);
+    result.add (1, "bloom_in_counting", "%d",  _bloom_in_counting);
+    result.add (1, "hash_counting",     "%d",  _hash_counting);
     result.add (1, "nb_partitions",     "%d",  _nb_partitions);
     result.add (1, "nb_bits_per_kmer",  "%d",  _nb_bits_per_kmer);
     result.add (1, "nb_cores",          "%d",  _nbCores);
@@ -45,9 +45,10 @@ public:
       _solidityKind(tools::misc::KMER_SOLIDITY_SUM),
       _max_disk_space(0), _max_memory(0),
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0), _storage_type(tools::storage::impl::STORAGE_HDF5) ,
-      _isComputed(false), _nbCores_per_partition(0),
+      _estimate_kmers(false), _bloom_bits_per_kmer(0),
+      _isComputed(false), _nbCores_per_partition(0), _superk_in_memory(false), _pipeline_passes(false), _bloom_in_counting(false), _hash_counting(false),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _estimatedDistinctKmerNb(0), _estimatedSolidKmerNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -74,6 +75,13 @@ public:
 	std::vector<bool> _solidVec;
 	size_t _solidVecUserNb;
 
+    /** true if the numbers of distinct and solid kmers are estimated from a sample of the bank. */
+    bool        _estimate_kmers;
+
+    /** Number of bits per solid kmer of a Bloom filter to be filled during the counting
+     * (see CountProcessorBloom); 0 if none. */
+    float       _bloom_bits_per_kmer;
+
     /****************************************/
     /**             COMPUTED                */
     /****************************************/
@@ -82,6 +90,20 @@ public:
 
     size_t      _nbCores_per_partition;
 
+    /** true if the superkmers of the (single) pass are kept in RAM instead of temporary files. */
+    bool        _superk_in_memory;
+
+    /** true if the superkmers of pass N+1 are built while the partitions of pass N are counted. */
+    bool        _pipeline_passes;
+
+    /** true if the Bloom filter is filled during the counting; its memory is then taken from
+     * the memory of the counting. */
+    bool        _bloom_in_counting;
+
+    /** true if all the partitions are counted with hash tables, sized from the estimated number of
+     * distinct kmers, instead of sorted vectors. */
+    bool        _hash_counting;
+
     u_int64_t   _estimateSeqNb;
     u_int64_t   _estimateSeqTotalSize;
     u_int64_t   _estimateSeqMaxSize;
@@ -90,6 +112,11 @@ public:
     u_int64_t   _volume;
     u_int64_t   _kmersNb;
 
+    /** Estimations (from a sample of the bank) of the numbers of distinct and solid kmers;
+     * 0 if not computed (see _estimate_kmers). They are not saved with the configuration. */
+    u_int64_t   _estimatedDistinctKmerNb;
+    u_int64_t   _estimatedSolidKmerNb;
+
     u_int32_t   _nb_passes;
     u_int32_t   _nb_partitions;
 
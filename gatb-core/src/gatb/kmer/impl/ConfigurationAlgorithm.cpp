@@ -22,9 +22,10 @@
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
-#include <gatb/kmer/impl/LinearCounter.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
 
 #include <cmath>
+#include <map>
 
 /********************************************************************************/
 namespace gatb          {
@@ -47,6 +48,7 @@ using namespace gatb::core::tools::collections::impl;
 
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
+using namespace gatb::core::tools::dp;
 
 /********************************************************************************/
 
@@ -61,10 +63,16 @@ using namespace gatb::core::tools::misc::impl;
 ** REMARKS :
 *********************************************************************/
 
-// estimated the number of distinct kmers in a dataset
-// wrapper around a Linear Counter. Adapted from Kmergenie code.
-// why not a hyperloglog? it seems that the transition from the 32bit-hash initial implementation to 64bits, and supporting billions of elements, is nontrivial, so i didn't bother
-// probably deserves to be in its own file
+/* Estimates the numbers of distinct and solid kmers from a sample of the bank.
+ *
+ * All the kmers of the sample are inserted into a HyperLogLog sketch. Besides, the kmers whose
+ * hash code has its SAMPLING_BITS lowest bits null (ie. a fixed subset of about 1/2^SAMPLING_BITS
+ * of the distinct kmers) are counted exactly: their abundances give the ratio of solid kmers.
+ *
+ * If the sample is only a part of the bank, the abundance threshold is scaled by the sampled
+ * ratio. Solid kmers are then supposed to be all seen in the sample, while the number of
+ * non solid kmers (mostly sequencing errors) grows linearly with the number of sequences.
+ */
 template<size_t span>
 class EstimateNbDistinctKmers
 {
@@ -72,108 +80,74 @@ public:
 
     /** Shortcut. */
     typedef typename Kmer<span>::Type  Type;
-    typedef typename Kmer<span>::ModelDirect     ModelDirect;
-    typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
-#ifdef NONCANONICAL 
-    typedef typename Kmer<span>::template ModelMinimizer <ModelDirect>   Model;
+#ifdef NONCANONICAL
+    typedef typename Kmer<span>::ModelDirect     Model;
 #else
-    typedef typename Kmer<span>::template ModelMinimizer <ModelCanonical>   Model;
+    typedef typename Kmer<span>::ModelCanonical  Model;
 #endif
-    typedef typename Model::Kmer                        KmerType;
+    typedef typename Model::Kmer                 KmerType;
 
     /** */
-    void estimate()
-    {
-        nb_distinct_kmers =(unsigned long)( (float)(linearCounter->count( )) * ((float)nbKmersTotal / (float)nbProcessedKmers)); // dubious linear extrapolation, that's all I got
-
-        abs_error = abs((long)(nb_distinct_kmers-previous_nb_distinct_kmers));
-
-        previous_nb_distinct_kmers = nb_distinct_kmers;
-    }
+    EstimateNbDistinctKmers (size_t kmerSize) : _model(kmerSize), _nbSeqs(0)  {}
 
     /** */
     void operator() (Sequence& sequence)
     {
+        _nbSeqs ++;
+
         /** We build the kmers from the current sequence. */
-        if (model.build (sequence.getData(), kmers) == false)  {  throw "reached EOF"; return; }
+        if (_model.build (sequence.getData(), _kmers) == false)  {  return;  }
 
-        /** We loop over the kmers. */
-        for (size_t i=0; i<kmers.size(); i++)
+        for (size_t i=0; i<_kmers.size(); i++)
         {
-            linearCounter->add((kmers[i].value()));
-
-
-            // heuristics to stop early, i found that it's inaccurate with low coverage (e.g. on dsk/test/FiftyK.fastq)
-            /*
-            if (nbProcessedReads % eval_every_N_reads == 0 )
-            {
-
-                // let's see if the estimation converges..
-                // the following stopping condition will grossly over-estimate the number of distinct kmers
-                // but I expect the correct result to be in the same order of magnitude
-                // and better to overestimate than underestimate (for both dsk and kmergenie)
-                   estimate();
-                   bool debug = true;
-                   if (debug)
-                       printf("linear estimator at %ld kmers, number of distinct kmers estimated now: %ld, abs error: %ld\n",nbProcessedKmers, nb_distinct_kmers, abs_error);
-                   if (abs_error < previous_nb_distinct_kmers/20) // 5% error
-                   {
-                       throw "LinearCounter converged"; // well, "converged" is a big word
-                       return;
-                   }
-                   if (!linearCounter->is_accurate())
-                   {
-                   printf("LinearCounter is inaccurate";
-                   return;
-                   }
-
-            }*/
+            if (_kmers[i].isValid() == false)  { continue; }
 
-        }
-        nbProcessedKmers += kmers.size();
-        nbProcessedReads++;
-        //if (nbProcessedReads % 100000 == 0) printf("nb: %ld\n",nbProcessedReads);
+            u_int64_t code = hash1 (_kmers[i].value(), 0);
 
-        // disabled progress
-        //if (nbCurProgressKmers > 500000)   {  _progress.inc (nbCurProgressKmers);  nbCurProgressKmers = 0;  }
-    }
+            _sketch.insertHash (code);
 
-    EstimateNbDistinctKmers (Model& model, u_int32_t max_memory, unsigned long nb_kmers_total, tools::dp::IteratorListener* progress)
-        : model(model),  eval_every_N_reads(10000000),   nbKmersTotal(nb_kmers_total),
-        nbProcessedKmers(0), nbCurProgressKmers(0), previous_nb_distinct_kmers(0), nbProcessedReads(0), abs_error(0)
-        //, _progress  (progress,System::thread().newSynchronizer())
-    {
-        unsigned long size_linearCounter; // (in bits)
-        /* let's set it to just use half of all memory available at most, ok? this isn't very robust for huge dataset, so to be tested*/
-        /* if it's a tiny dataset, let's set it to total number of kmers */
-        size_linearCounter = std::min( nb_kmers_total, (unsigned long) (max_memory*8*1024*1024/2) );
-        linearCounter =  new LinearCounter<span>(size_linearCounter);
+            if ((code & SAMPLING_MASK) == 0)  {  _sampled[_kmers[i].value()] ++;  }
+        }
     }
 
-    unsigned long getEstimation()
+    /** Compute the estimations.
+     * \param[in] abundanceMin : abundance threshold of the solid kmers
+     * \param[in] ratio : ratio of the bank sequences seen by the estimator
+     * \param[out] nbDistinct : estimated number of distinct kmers in the bank
+     * \param[out] nbSolid : estimated number of solid kmers in the bank */
+    void getEstimations (CountNumber abundanceMin, double ratio, u_int64_t& nbDistinct, u_int64_t& nbSolid)
     {
-        estimate();
-        // soo.. if it's not accurate, let's assume we have a hugeload of kmers, and let's be safe, we return the total number of kmers
-        if (!linearCounter->is_accurate())
+        if (ratio <= 0 || ratio > 1)  { ratio = 1; }
+
+        /** The scaled threshold can't be lower than one occurrence. */
+        double threshold = std::max (abundanceMin*ratio, 1.0);
+
+        u_int64_t nbSampledSolid = 0;
+        for (typename map<Type,CountNumber>::iterator it = _sampled.begin(); it != _sampled.end(); ++it)
         {
-            cout << "Warning: linear counter was not accurate, returning worst-case estimation of number of distinct kmers";
-            return nbKmersTotal;
+            if (it->second >= threshold)  { nbSampledSolid++; }
         }
-        return nb_distinct_kmers;
+
+        double distinct   = _sketch.estimate();
+        double solidRatio = _sampled.empty() ? 0 : (double)nbSampledSolid / (double)_sampled.size();
+
+        nbSolid    = (u_int64_t) (distinct * solidRatio);
+        nbDistinct = nbSolid + (u_int64_t) ((distinct - nbSolid) / ratio);
     }
 
+    /** */
+    u_int64_t getNbSequences () const  { return _nbSeqs; }
+
 private:
 
-    /** Local resources. */
-    Model&    model;
-    unsigned long nbProcessedReads, nbProcessedKmers;
-    unsigned long nbCurProgressKmers;
-    unsigned long nbKmersTotal;
-    unsigned long abs_error;
-    vector<KmerType> kmers;
-    LinearCounter<span> *linearCounter;
-    int eval_every_N_reads;
-    unsigned long previous_nb_distinct_kmers, nb_distinct_kmers;
+    static const u_int64_t SAMPLING_BITS = 10;
+    static const u_int64_t SAMPLING_MASK = ((u_int64_t)1 << SAMPLING_BITS) - 1;
+
+    Model                    _model;
+    vector<KmerType>         _kmers;
+    HyperLogLog<Type>        _sketch;
+    map<Type,CountNumber>    _sampled;
+    u_int64_t                _nbSeqs;
 };
 
 
@@ -202,6 +176,7 @@ ConfigurationAlgorithm<span>::ConfigurationAlgorithm (bank::IBank* bank, IProper
     _config._max_disk_space     = input->getInt (STR_MAX_DISK);
     _config._max_memory         = input->getInt (STR_MAX_MEMORY);
     _config._nbCores            = input->get(STR_NB_CORES) ? input->getInt(STR_NB_CORES) : 0;
+    _config._estimate_kmers     = input->get(STR_ESTIMATE_KMERS) ? input->getInt(STR_ESTIMATE_KMERS) != 0 : false;
 
     _config._abundance = getSolidityThresholds(input);
 	
@@ -338,6 +313,20 @@ void ConfigurationAlgorithm<span>::execute ()
     assert (_config._max_disk_space > 0);
 
     _config._nb_passes = ( (_config._volume/4) / _config._max_disk_space ) + 1; //minim, approx volume /switched to approx /4 (was/3) because of more efficient superk storage
+
+    /** If the superkmers (approx volume/4, see above) take at most half of the memory, we keep them
+     * in RAM instead of temporary files, in a single pass; the counting then uses the remaining memory.
+     * Otherwise we fall back to the disk. Only the superkmers storage (solidity 'sum') supports it. */
+    u_int64_t volume_superk = _config._volume/4 + 1;
+    u_int32_t max_memory_count = _config._max_memory;
+
+    _config._superk_in_memory = (_config._solidityKind == KMER_SOLIDITY_SUM) && (2*volume_superk <= _config._max_memory);
+
+    if (_config._superk_in_memory)
+    {
+        _config._nb_passes = 1;
+        max_memory_count   = _config._max_memory - volume_superk;
+    }
     //_nb_passes = 1; //do not constrain nb passes on disk space anymore (anyway with minim, not very big)
     //increase it only if ram issue
 
@@ -351,56 +340,86 @@ void ConfigurationAlgorithm<span>::execute ()
         max_open_files /= 3; // will need to open twice in STORAGE_FILE instead of HDF5, so this adjustment is needed. needs to be fixed later by putting partitions inside the same file. but i'd rather not do it in the current messy collection/group/partition hdf5-inspired system. overall, that's a FIXME
     }
 
-#if 0
-    /* disabled by default; this was an experiment */
-    float est_volume_distinct_ratio;
-    if (_flagEstimateNbDistinctKmers)
+    /** We may estimate the numbers of distinct and solid kmers from a sample of the bank (the whole
+     * bank if it is small enough). This is one more (single threaded) pass over the sample, so it
+     * is done only on demand. */
+    if (_config._estimate_kmers)
     {
-        /* we estimate the volume of distinct kmers vs total number of kmers.
-         * we store it in the variable "est_volume_distinct_ratio"
-         * to compute it, we need a linear counter, let's call it now */
-
         TIME_INFO (getTimeInfo(), "estimate_distinct_kmers");
+
+        u_int64_t nbseq_sample = std::min (std::max (u_int64_t (_config._estimateSeqNb * 0.05), u_int64_t (100000ULL)), u_int64_t (1000000ULL));
+
         Iterator<Sequence>* itSeq = _bank->iterator();
         LOCAL (itSeq);
 
-        //_progress->setMessage (progressFormat0); // not touching progress here anymore
-        Model model (_kmerSize, _minim_size);
-        EstimateNbDistinctKmers<span> estimate_nb_distinct_kmers_function(model, _max_memory, kmersNb, _progress);
+        EstimateNbDistinctKmers<span> estimator (_config._kmerSize);
 
-        /** We launch the iteration of the sequences iterator with the created functors. */
-        try {
-            itSeq->iterate (estimate_nb_distinct_kmers_function);
-        }
-        catch (const char* except)
-        {
+        for (itSeq->first(); !itSeq->isDone() && estimator.getNbSequences() < nbseq_sample; itSeq->next())  {  estimator (itSeq->item());  }
 
-        }
-        _estimatedDistinctKmerNb = estimate_nb_distinct_kmers_function.getEstimation();
-        est_volume_distinct_ratio = (float) _estimatedDistinctKmerNb / (float)kmersNb;
-        //est_volume_distinct_ratio = 1; // for debug
-        /* est_volume_distinct_ratio == 1 mean that we guarantee worst case the memory usage,
-           the value mean that, on average, a k-mer will be seen 'est_volume_distinct_ratio' times */
-        // if wrongly estimated, the error 'OAHash: max rehashes..' can happen
-        printf ("LinearCounter done, estimated %ld number of distinct kmers, ratio to total number of kmers: %.2f\n", (long)_estimatedDistinctKmerNb, est_volume_distinct_ratio);
+        double ratio = itSeq->isDone() ? 1.0 : (double)estimator.getNbSequences() / (double)_config._estimateSeqNb;
+
+        estimator.getEstimations (_config._abundance[0].getBegin(), ratio, _config._estimatedDistinctKmerNb, _config._estimatedSolidKmerNb);
+
+        /** The estimation can't exceed the number of kmers. */
+        _config._estimatedDistinctKmerNb = std::min (_config._estimatedDistinctKmerNb, _config._kmersNb);
+        _config._estimatedSolidKmerNb    = std::min (_config._estimatedSolidKmerNb,    _config._estimatedDistinctKmerNb);
     }
-#endif
+
+    /** The size of a hash table only depends on the distinct kmers of a partition: if the hash tables
+     * need less memory than the sorted vectors, all the partitions are counted with hash tables (see
+     * SortingCountAlgorithm::fillSolidKmers_aux) and the partitions number is computed from their
+     * volume. The hash table is not used when the banks are counted separately. Note that the passes
+     * number doesn't change: the superkmers written on disk hold all the kmers, not only the distinct ones. */
+    u_int64_t volume_count = volume_minim;
+    _config._hash_counting = false;
+    if (_config._estimatedDistinctKmerNb > 0  &&  (_config._nb_banks == 1 || _config._solidityKind == KMER_SOLIDITY_SUM))
+    {
+        u_int64_t volume_hash = getHashCounterMemory (_config._estimatedDistinctKmerNb) / MBYTE + 1;
+
+        _config._hash_counting = volume_hash < volume_minim;
+        if (_config._hash_counting)  {  volume_count = volume_hash;  }
+    }
+
+    /** The Bloom filter filled during the counting (see CountProcessorBloom) is sized from the estimated
+     * number of solid kmers and lives during the whole counting: if it takes at most half of the counting
+     * memory, its size is taken from this memory, otherwise it will be built after the counting. Without
+     * estimation, or with 'auto' abundance thresholds, the number of solid kmers is unknown. */
+    bool autoAbundance = false;
+    for (size_t i=0; i<_config._abundance.size(); i++)  {  autoAbundance |= _config._abundance[i].getBegin() == -1;  }
+
+    u_int64_t volume_bloom = 0;
+    if (_config._bloom_bits_per_kmer > 0  &&  _config._estimatedSolidKmerNb > 0  &&  !autoAbundance)
+    {
+        volume_bloom = (u_int64_t) (_config._estimatedSolidKmerNb * _config._bloom_bits_per_kmer / 8) / MBYTE + 1;
+
+        if (2*volume_bloom <= max_memory_count)  {  max_memory_count -= volume_bloom;  }
+        else                                     {  volume_bloom = 0;                  }
+    }
+    _config._bloom_in_counting = volume_bloom > 0;
+
     u_int64_t volume_per_pass;
     do  {
 
         assert (_config._nb_passes > 0);
-        volume_per_pass = volume_minim / _config._nb_passes;
+        volume_per_pass = volume_count / _config._nb_passes;
 
-        assert (_config._max_memory > 0);
+        assert (max_memory_count > 0);
         //printf("volume_per_pass %lli  _nbCores %zu _max_memory %i \n",volume_per_pass, _nbCores,_max_memory);
 
         // _nb_partitions  = ( (volume_per_pass*_nbCores) / _max_memory ) + 1;
-        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / _config._max_memory ) + 1;
+        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / max_memory_count ) + 1;
 
         //printf("nb passes  %i  (nb part %i / %zu)\n",_nb_passes,_nb_partitions,max_open_files);
         //_nb_partitions = max_open_files; break;
 
         if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel >1)     { _config._nb_partitions_in_parallel  = _config._nb_partitions_in_parallel /2;  }
+        else if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel == 1 && _config._superk_in_memory)
+        {
+            /** Too many partitions for the memory left to the counting: we go back to the disk. */
+            _config._superk_in_memory = false;
+            _config._nb_passes        = ( (_config._volume/4) / _config._max_disk_space ) + 1;
+            max_memory_count          = _config._max_memory - volume_bloom;
+        }
         else if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel == 1)   { _config._nb_passes++;  }
         else                                                                            { break;         }
 
@@ -409,6 +428,11 @@ void ConfigurationAlgorithm<span>::execute ()
 
     //if (_config._nb_partitions < 50 &&  (max_open_files - _config._nb_partitions  > 30) ) _config._nb_partitions += 30; //a hack to have more partitions than 30
 
+    /** With several passes, the superkmers of the next pass can be built while the current pass is
+     * counted, provided that the disk can hold the temporary files of two passes at the same time. */
+    _config._pipeline_passes = (_config._solidityKind == KMER_SOLIDITY_SUM) && (_config._nb_passes > 1)
+        && (2 * ((_config._volume/4) / _config._nb_passes + 1) <= _config._max_disk_space);
+
     //round nb parti to upper multiple of _nb_partitions_in_parallel if possible
     int  incpart = _config._nb_partitions_in_parallel - _config._nb_partitions % _config._nb_partitions_in_parallel;
     incpart = incpart % _config._nb_partitions_in_parallel;
@@ -456,6 +480,27 @@ void ConfigurationAlgorithm<span>::execute ()
     getInfo()->add (1, _config.getProperties());
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : memory of a hash table counting an estimated number of distinct kmers
+** INPUT   : nbDistinctKmers : estimated number of distinct kmers
+** OUTPUT  :
+** RETURN  : the memory size in bytes
+** REMARKS : the capacity of a HashCounter is the first power of 2 whose keys and counts arrays
+**           take more than half of its memory, so a memory of 2*N*(item size) holds N cells;
+**           at most 70% of the cells are used (HashCounter default max load). We keep a
+**           factor 2 for the error of the estimation.
+*********************************************************************/
+template<size_t span>
+u_int64_t ConfigurationAlgorithm<span>::getHashCounterMemory (double nbDistinctKmers)
+{
+    static const double ESTIMATION_ERROR = 2;
+    static const double POWER_OF_2       = 2;
+    static const double MAX_LOAD         = 0.7;
+
+    return (u_int64_t) (ESTIMATION_ERROR * POWER_OF_2 * nbDistinctKmers * (sizeof(Type)+sizeof(CountNumber)) / MAX_LOAD);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
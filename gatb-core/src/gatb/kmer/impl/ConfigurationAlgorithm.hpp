@@ -54,6 +54,16 @@ public:
     /** */
     const Configuration&  getConfiguration() const { return _config; }
 
+    /** Ask for a Bloom filter filled during the counting; 'execute' keeps the memory for it if it fits
+     * (see Configuration::_bloom_in_counting).
+     * \param[in] nbitsPerKmer : number of bits per solid kmer of the Bloom filter */
+    void setBloomBitsPerKmer (float nbitsPerKmer)  { _config._bloom_bits_per_kmer = nbitsPerKmer; }
+
+    /** Memory to give to a HashCounter counting some estimated number of distinct kmers.
+     * \param[in] nbDistinctKmers : estimated number of distinct kmers
+     * \return the memory size in bytes */
+    static u_int64_t getHashCounterMemory (double nbDistinctKmers);
+
 private:
     /** */
     static std::vector<tools::misc::CountRange> getSolidityThresholds (tools::misc::IProperties* params);
@@ -26,6 +26,7 @@
 #include <gatb/kmer/impl/CountProcessorProxy.hpp>
 #include <gatb/kmer/impl/CountProcessorHistogram.hpp>
 #include <gatb/kmer/impl/CountProcessorDump.hpp>
+#include <gatb/kmer/impl/CountProcessorBloom.hpp>
 #include <gatb/kmer/impl/CountProcessorSolidity.hpp>
 #include <gatb/kmer/impl/CountProcessorCutoff.hpp>
 
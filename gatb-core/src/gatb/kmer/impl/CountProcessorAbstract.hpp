@@ -79,6 +79,26 @@ public:
     /** \copydoc ICountProcessor<span>::process */
     virtual bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum=0)  {  return true;  }
 
+    /** \copydoc ICountProcessor<span>::processBatch
+     * This default implementation is an adapter that calls 'process' for each kmer of the batch. */
+    virtual size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        CountVector count (nbBanks);
+        size_t nbSelected = 0;
+
+        for (size_t i=0; i<nb; i++)
+        {
+            for (size_t b=0; b<nbBanks; b++)  { count[b] = counts[i*nbBanks+b]; }
+
+            if (this->process (partId, kmers[i], count, getBatchSum (counts, nbBanks, sums, i)))
+            {
+                if (selected)  { selected[nbSelected] = i; }
+                nbSelected ++;
+            }
+        }
+        return nbSelected;
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -100,6 +120,31 @@ public:
         return res;
     }
 
+protected:
+
+    /** Get the sum of occurrences of the ith kmer of a batch.
+     * \param[in] counts : counts of the batch (see processBatch)
+     * \param[in] nbBanks : number of counts per kmer
+     * \param[in] sums : sums of the batch, possibly null
+     * \param[in] i : index of the kmer in the batch
+     * \return the provided sum if any, the sum of the counts otherwise. */
+    static CountNumber getBatchSum (const CountNumber* counts, size_t nbBanks, const CountNumber* sums, size_t i)
+    {
+        if (sums)  { return sums[i]; }
+        CountNumber sum=0; for (size_t b=0; b<nbBanks; b++)  { sum += counts[i*nbBanks+b]; }
+        return sum;
+    }
+
+    /** Fill the 'selected' output of processBatch when all the kmers of the batch are selected.
+     * \param[in] nb : number of kmers in the batch
+     * \param[out] selected : indexes to be filled, possibly null
+     * \return nb */
+    static size_t selectAll (size_t nb, u_int32_t* selected)
+    {
+        if (selected)  {  for (size_t i=0; i<nb; i++)  { selected[i] = i; }  }
+        return nb;
+    }
+
 private:
 
     std::string _name;
@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef _COUNT_PROCESSOR_BLOOM_HPP_
+#define _COUNT_PROCESSOR_BLOOM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/CountProcessorAbstract.hpp>
+#include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/misc/api/Enums.hpp>
+#include <math.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** The CountProcessorBloom implementation inserts kmers into a Bloom filter.
+ *
+ * The Bloom filter is created when the 'begin' method is called; since the number of
+ * solid kmers is not known yet, its size is computed from the number of solid kmers
+ * estimated by the configuration (see Configuration::_estimatedSolidKmerNb).
+ *
+ * The clones share the Bloom filter of the prototype and insert their kmers concurrently
+ * (the Bloom filters created by BloomFactory set their bits with atomic operations).
+ *
+ * The CountProcessorBloom implementation is likely to be used at the end of the DSK
+ * CountProcessorChain (histogram -> solidity -> dump -> bloom): the Bloom filter of the
+ * solid kmers is then built during the counting, instead of reading the solid kmers again
+ * afterwards (see BloomAlgorithm::setBloom).
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class CountProcessorBloom : public CountProcessorAbstract<span>
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename Kmer<span>::Type Type;
+
+    /** Constructor.
+     * \param[in] kmerSize : kmer size
+     * \param[in] nbitsPerKmer : number of bits per kmer of the Bloom filter
+     * \param[in] bloomKind : kind of Bloom filter
+     * \param[in] bloom : Bloom filter to be filled (for the clones) */
+    CountProcessorBloom (
+        size_t                                   kmerSize,
+        float                                    nbitsPerKmer,
+        tools::misc::BloomKind                   bloomKind = tools::misc::BLOOM_DEFAULT,
+        tools::collections::impl::IBloom<Type>*  bloom     = 0
+    )
+        : CountProcessorAbstract<span>("bloom"), _kmerSize(kmerSize), _nbitsPerKmer(nbitsPerKmer), _bloomKind(bloomKind), _bloom(0), _nbKmers(0)
+    {
+        setBloom (bloom);
+    }
+
+    /** Destructor */
+    virtual ~CountProcessorBloom ()  {  setBloom (0);  }
+
+    /********************************************************************/
+    /*   METHODS CALLED ON THE PROTOTYPE INSTANCE (in the main thread). */
+    /********************************************************************/
+
+    /** \copydoc ICountProcessor<span>::begin */
+    void begin (const Configuration& config)
+    {
+        u_int64_t bloomSize = (u_int64_t) (config._estimatedSolidKmerNb * _nbitsPerKmer);
+        size_t    nbHash    = (int)floorf (0.7*_nbitsPerKmer);
+
+        if (bloomSize == 0)  { bloomSize = 1000; }
+
+        setBloom (tools::collections::impl::BloomFactory::singleton().createBloom<Type> (_bloomKind, bloomSize, nbHash, _kmerSize));
+
+        _nbKmers = 0;
+    }
+
+    /** \copydoc ICountProcessor<span>::clone */
+    CountProcessorAbstract<span>* clone ()
+    {
+        /** Note : we share the Bloom filter for all the clones. */
+        return new CountProcessorBloom (_kmerSize, _nbitsPerKmer, _bloomKind, _bloom);
+    }
+
+    /** \copydoc ICountProcessor<span>::finishClones */
+    void finishClones (std::vector<ICountProcessor<span>*>& clones)
+    {
+        for (size_t i=0; i<clones.size(); i++)
+        {
+            /** We have to recover type information. */
+            if (CountProcessorBloom* clone = dynamic_cast<CountProcessorBloom*> (clones[i]))  {  _nbKmers += clone->_nbKmers;  }
+        }
+    }
+
+    /********************************************************************/
+    /*   METHODS CALLED ON ONE CLONED INSTANCE (in a separate thread).  */
+    /********************************************************************/
+
+    /** \copydoc ICountProcessor<span>::process */
+    bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum)
+    {
+        _bloom->insert (kmer);
+        _nbKmers ++;
+        return true;
+    }
+
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        for (size_t i=0; i<nb; i++)  {  _bloom->insert (kmers[i]);  }
+        _nbKmers += nb;
+
+        return this->selectAll (nb, selected);
+    }
+
+    /*****************************************************************/
+    /*                          MISCELLANEOUS.                       */
+    /*****************************************************************/
+
+    /** \copydoc ICountProcessor<span>::getProperties */
+    tools::misc::impl::Properties getProperties() const
+    {
+        tools::misc::impl::Properties result;
+
+        result.add (0, "bloom");
+        result.add (1, "kind",     "%s",  tools::misc::toString(_bloomKind));
+        result.add (1, "bitsize",  "%ld", _bloom ? _bloom->getBitSize() : 0);
+        result.add (1, "nb_kmers", "%ld", _nbKmers);
+
+        return result;
+    }
+
+    /** Get the Bloom filter filled with the kmers.
+     * \return the Bloom filter. */
+    tools::collections::impl::IBloom<Type>* getBloom ()  { return _bloom; }
+
+    /** Get the number of kmers inserted into the Bloom filter.
+     * \return the number of kmers. */
+    u_int64_t getNbKmers () const  { return _nbKmers; }
+
+private:
+
+    size_t                 _kmerSize;
+    float                  _nbitsPerKmer;
+    tools::misc::BloomKind _bloomKind;
+
+    tools::collections::impl::IBloom<Type>* _bloom;
+    void setBloom (tools::collections::impl::IBloom<Type>* bloom)  { SP_SETATTR(bloom); }
+
+    u_int64_t _nbKmers;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _COUNT_PROCESSOR_BLOOM_HPP_ */
@@ -133,6 +133,54 @@ public:
         return res;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch
+     * The batch is given to each item of the chain in turn; the kmers rejected by an item are
+     * removed from the batch given to the next items. */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        if (nb == 0)  { return 0; }
+
+        _kmers.resize     (nb);
+        _counts.resize    (nb*nbBanks);
+        _sums.resize      (nb);
+        _index.resize     (nb);
+        _selection.resize (nb);
+
+        /** The sums are computed once for all the items. */
+        if (sums == 0)
+        {
+            for (size_t i=0; i<nb; i++)  {  _sums[i] = this->computeSum (counts + i*nbBanks, nbBanks);  }
+            sums = &_sums[0];
+        }
+
+        for (size_t i=0; i<nb; i++)  {  _index[i] = i;  }
+
+        for (size_t i=0; nb>0 && i<_items.size(); i++)
+        {
+            size_t nbKept = _items[i]->processBatch (partId, kmers, counts, nb, nbBanks, sums, &_selection[0]);
+            if (nbKept == nb)  { continue; }
+
+            /** We compact the batch into the local buffers; since the selection is increasing,
+             * this also works when the current batch is already in these buffers. */
+            for (size_t j=0; j<nbKept; j++)
+            {
+                size_t k = _selection[j];
+                _kmers[j] = kmers[k];
+                for (size_t b=0; b<nbBanks; b++)  { _counts[j*nbBanks+b] = counts[k*nbBanks+b]; }
+                _sums [j] = sums  [k];
+                _index[j] = _index[k];
+            }
+
+            kmers  = &_kmers[0];
+            counts = &_counts[0];
+            sums   = &_sums[0];
+            nb     = nbKept;
+        }
+
+        if (selected)  {  for (size_t j=0; j<nb; j++)  { selected[j] = _index[j]; }  }
+        return nb;
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -168,9 +216,24 @@ protected:
 		return sum;
     }
 
+    /** Same as computeSum for the counts of one kmer of a batch. */
+    CountNumber computeSum (const CountNumber* count, size_t nbBanks) const
+    {
+        if (nbBanks==1)  { return count[0]; }
+        CountNumber sum=0; for (size_t k=0; k<nbBanks; k++)  { if (_solidVec.at(k)) sum+=count[k]; }
+        return sum;
+    }
+
     std::vector<CountProcessor*> _items;
 	
 	std::vector<bool> _solidVec;
+
+    /** Buffers used by processBatch for the kmers kept along the chain. */
+    std::vector<Type>        _kmers;
+    std::vector<CountNumber> _counts;
+    std::vector<CountNumber> _sums;
+    std::vector<u_int32_t>   _index;
+    std::vector<u_int32_t>   _selection;
 };
 
 /********************************************************************************/
@@ -123,6 +123,24 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        _sums.resize (nb);
+
+        /** Same convention as 'process': the histogram of a single bank gets the sum of all the counts,
+         * otherwise each histogram gets the counts of its own bank. */
+        for (size_t h=0; h<_histogramProcessors.size(); h++)
+        {
+            if (_histogramProcessors.size()==1)  {  for (size_t i=0; i<nb; i++)  { _sums[i] = this->getBatchSum (counts, nbBanks, 0, i); }  }
+            else                                 {  for (size_t i=0; i<nb; i++)  { _sums[i] = counts[i*nbBanks+h];                       }  }
+
+            _histogramProcessors[h]->processBatch (partId, kmers, counts, nb, nbBanks, nb ? &_sums[0] : 0);
+        }
+
+        return this->selectAll (nb, selected);
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -146,6 +164,9 @@ private:
     std::vector<CountProcessorHistogram<span>* > _histogramProcessors;
 
     std::vector<CountNumber> _cutoffs;
+
+    /** Sums given to the histograms by processBatch. */
+    std::vector<CountNumber> _sums;
 };
 
 /********************************************************************************/
@@ -151,6 +151,22 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        if (nb == 0)  { return 0; }
+
+        _batch.resize (nb);
+        for (size_t i=0; i<nb; i++)
+        {
+            _batch[i].value     = kmers[i];
+            _batch[i].abundance = this->getBatchSum (counts, nbBanks, sums, i);
+        }
+        this->_solidKmers->insert (&_batch[0], nb);
+
+        return this->selectAll (nb, selected);
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -215,6 +231,9 @@ private:
     void setSolidKmers (tools::collections::Bag<Count>* solidKmers)  {  SP_SETATTR(solidKmers);  }
 
     std::map<std::string,size_t> _namesOccur;
+
+    /** Counts built by processBatch before their insertion in the solid bag. */
+    std::vector<Count> _batch;
 };
 
 /********************************************************************************/
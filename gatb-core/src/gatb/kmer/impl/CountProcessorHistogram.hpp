@@ -123,6 +123,13 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        for (size_t i=0; i<nb; i++)  {  _histogram->inc (this->getBatchSum (counts, nbBanks, sums, i));  }
+        return this->selectAll (nb, selected);
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -83,6 +83,10 @@ public:
     bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum=0)
     {  return _ref->process (partId, kmer, count, sum);  }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {  return _ref->processBatch (partId, kmers, counts, nb, nbBanks, sums, selected);  }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -135,13 +135,33 @@ public:
     bool process (size_t partId, const typename Kmer<span>::Type& kmer, const CountVector& count, CountNumber sum)
     {
         /** We use static polymorphism here. */
-        bool result = static_cast<Derived*>(this)->check (count, sum);
+        bool result = static_cast<Derived*>(this)->check (count.empty() ? 0 : &count[0], count.size(), sum);
 
         _total ++;
         if (result)  { _ok++; }
         return result;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    size_t processBatch (size_t partId, const typename Kmer<span>::Type* kmers, const CountNumber* counts, size_t nb, size_t nbBanks, const CountNumber* sums=0, u_int32_t* selected=0)
+    {
+        Derived* derived = static_cast<Derived*>(this);
+        size_t nbSelected = 0;
+
+        for (size_t i=0; i<nb; i++)
+        {
+            if (derived->check (counts + i*nbBanks, nbBanks, this->getBatchSum (counts, nbBanks, sums, i)))
+            {
+                if (selected)  { selected[nbSelected] = i; }
+                nbSelected ++;
+            }
+        }
+
+        _total += nb;
+        _ok    += nbSelected;
+        return nbSelected;
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -183,7 +203,7 @@ public:
     CountProcessorSoliditySum (const std::vector<tools::misc::CountRange>& thresholds, std::vector<bool>& solidVec)
         : CountProcessorSolidityAbstract<span,CountProcessorSoliditySum<span> > (thresholds,solidVec)  {}
 
-    bool check (const CountVector& count, CountNumber sum)
+    bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
     {
         return this->_thresholds[0].includes (sum);
     }
@@ -203,9 +223,9 @@ public:
 	CountProcessorSolidityMax (const std::vector<tools::misc::CountRange>& thresholds, std::vector<bool>& solidVec)
         : CountProcessorSolidityAbstract<span,CountProcessorSolidityMax<span> > (thresholds,solidVec)  {}
 
-    bool check (const CountVector& count, CountNumber sum)
+    bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
     {
-        return this->_thresholds[0].includes (*std::max_element (count.begin(),count.end()));
+        return this->_thresholds[0].includes (*std::max_element (count, count+nbBanks));
     }
 
     std::string getName() const  { return std::string("max"); }
@@ -223,9 +243,9 @@ public:
     CountProcessorSolidityMin (const std::vector<tools::misc::CountRange>& thresholds, std::vector<bool>& solidVec)
         : CountProcessorSolidityAbstract<span,CountProcessorSolidityMin<span> > (thresholds,solidVec)  {}
 
-    bool check (const CountVector& count, CountNumber sum)
+    bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
     {
-        return this->_thresholds[0].includes (*std::min_element (count.begin(),count.end()));
+        return this->_thresholds[0].includes (*std::min_element (count, count+nbBanks));
     }
 
     std::string getName() const  { return std::string("min"); }
@@ -243,9 +263,9 @@ public:
     CountProcessorSolidityAll (const std::vector<tools::misc::CountRange>& thresholds, std::vector<bool>& solidVec)
         : CountProcessorSolidityAbstract<span,CountProcessorSolidityAll<span> > (thresholds,solidVec)  {}
 
-    bool check (const CountVector& count, CountNumber sum)
+    bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
     {
-        for (size_t i=0; i<count.size(); i++)  {  if (this->_thresholds[i].includes(count[i]) == false)   { return false; }  }
+        for (size_t i=0; i<nbBanks; i++)  {  if (this->_thresholds[i].includes(count[i]) == false)   { return false; }  }
         return true;
     }
 
@@ -264,9 +284,9 @@ public:
     CountProcessorSolidityOne (const std::vector<tools::misc::CountRange>& thresholds, std::vector<bool>& solidVec)
         : CountProcessorSolidityAbstract<span, CountProcessorSolidityOne<span> > (thresholds,solidVec)  {}
 
-    bool check (const CountVector& count, CountNumber sum)
+    bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
     {
-        for (size_t i=0; i<count.size(); i++)  {  if (this->_thresholds[i].includes(count[i]) == true)   { return true; }  }
+        for (size_t i=0; i<nbBanks; i++)  {  if (this->_thresholds[i].includes(count[i]) == true)   { return true; }  }
         return false;
     }
 
@@ -288,9 +308,9 @@ public:
 		: CountProcessorSolidityAbstract<span, CountProcessorSolidityCustom<span> > (thresholds,solidVec)  {}
 		
 		
-		bool check (const CountVector& count, CountNumber sum)
+		bool check (const CountNumber* count, size_t nbBanks, CountNumber sum)
 		{
-			for (size_t i=0; i<count.size(); i++)  {
+			for (size_t i=0; i<nbBanks; i++)  {
 				
 				if (this->_solidVec.at(i) == false &&   this->_thresholds[i].includes(count[i]) == true   )   { return false; }
 				else if (this->_solidVec.at(i) == true &&   this->_thresholds[i].includes(count[i]) == false  ) { return false; }
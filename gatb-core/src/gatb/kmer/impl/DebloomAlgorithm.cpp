@@ -112,7 +112,7 @@ DebloomAlgorithm<span>::DebloomAlgorithm (
        _kmerSize(kmerSize), _miniSize(miniSize),
        _bloomKind(bloomKind), _debloomKind(cascadingKind),
        _max_memory(max_memory),
-       _criticalNb(0), _solidIterable(0),  _container(0)
+       _modifiable(true), _criticalNb(0), _solidIterable(0),  _container(0), _bloom(0)
 {
     setSolidIterable    (solidIterable);
 
@@ -135,14 +135,15 @@ DebloomAlgorithm<span>::DebloomAlgorithm (
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-DebloomAlgorithm<span>::DebloomAlgorithm (tools::storage::impl::Storage& storage)
+DebloomAlgorithm<span>::DebloomAlgorithm (tools::storage::impl::Storage& storage, bool modifiable)
 :  Algorithm("debloom", 0, 0),
    _groupBloom(storage().getGroup   ("bloom")),
    _groupDebloom(storage().getGroup ("debloom")),
    _kmerSize(0),
    _debloomUri("debloom"),
    _max_memory(0),
-   _criticalNb(0), _solidIterable(0), _container(0)
+   _modifiable(modifiable),
+   _criticalNb(0), _solidIterable(0), _container(0), _bloom(0)
 {
     /** We retrieve the cascading kind from the storage. */
     parse (_groupDebloom.getProperty("kind"), _debloomKind);
@@ -166,6 +167,7 @@ DebloomAlgorithm<span>::~DebloomAlgorithm ()
 {
     setSolidIterable      (0);
     setDebloomStructures  (0);
+    setBloom              (0);
 }
 
 /*********************************************************************
@@ -181,9 +183,10 @@ IOptionsParser* DebloomAlgorithm<span>::getOptionsParser ()
 {
     IOptionsParser* parser = new OptionsParser ("bloom");
 
-    parser->push_back (new OptionOneParam (STR_BLOOM_TYPE,        "bloom type ('basic', 'cache', 'neighbor')",false, "neighbor"));
-    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original' or 'cascading')", false, "cascading"));
+    parser->push_back (new OptionOneParam (STR_BLOOM_TYPE,        "bloom type ('basic', 'cache', 'neighbor', 'blocked')",false, "neighbor"));
+    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original', 'cascading' or 'cuckoo')", false, "cascading"));
     parser->push_back (new OptionOneParam (STR_DEBLOOM_IMPL,      "debloom impl ('basic', 'minimizer')",      false, "minimizer"));
+    parser->push_back (new OptionOneParam (STR_CUCKOO_BITS,       "fingerprint size (4 to 16 bits) for debloom type 'cuckoo'", false, "12"));
 
     return parser;
 }
@@ -207,8 +210,12 @@ void DebloomAlgorithm<span>::execute ()
     IProperties* cfpProps = new Properties();  LOCAL (cfpProps);
     u_int64_t totalSizeCFP = 0;
 
-    /** We execute the debloom if needed. */
-    if (_debloomKind != DEBLOOM_NONE)
+    /** We execute the debloom if needed. A cuckoo filter holds the nodes by itself: no Bloom filter, no cFP. */
+    if (_debloomKind == DEBLOOM_CUCKOO)
+    {
+        createCuckoo (cfpProps, totalSizeCFP);
+    }
+    else if (_debloomKind != DEBLOOM_NONE)
     {
         execute_aux (bloomProps, cfpProps, totalSizeBloom, totalSizeCFP);
     }
@@ -259,7 +266,7 @@ void DebloomAlgorithm<span>::execute_aux (
     IBloom<Type>* bloom = createBloom (_solidIterable, bloomProps, totalSizeBloom);
     bloom->use ();
 #else
-    IBloom<Type>* bloom = StorageTools::singleton().loadBloom<Type> (_groupBloom, "bloom");
+    IBloom<Type>* bloom = getBloom ();
     bloom->use ();
     totalSizeBloom = bloom->getBitSize();
 #endif
@@ -612,6 +619,9 @@ void DebloomAlgorithm<span>::createCFP (
         }
     }
 
+    /** The cFP set may also be used in place from the mapped file of the storage. */
+    StorageTools::singleton().saveContainerMapped<Type> (_groupDebloom, "cfp", finalCriticalCollection);
+
     props->add (1, "nb", "%ld", _criticalNb);
     if (_criticalChecksum != 0)
     {
@@ -620,6 +630,47 @@ void DebloomAlgorithm<span>::createCFP (
     }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : insert the solid kmers into a cuckoo filter
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the solid kmers are read and inserted by several threads; the filter supports
+**           concurrent insertions.
+*********************************************************************/
+template<size_t span>
+void DebloomAlgorithm<span>::createCuckoo (IProperties* props, u_int64_t& totalSize)
+{
+    TIME_INFO (getTimeInfo(), "cuckoo");
+
+    size_t fingerprintBits = getInput()->get(STR_CUCKOO_BITS) ? getInput()->getInt(STR_CUCKOO_BITS) : 12;
+
+    CuckooFilter<Type>* filter = new CuckooFilter<Type> (_solidIterable->getNbItems(), fingerprintBits);
+    LOCAL (filter);
+
+    {
+        Iterator<Count>* itKmers = createIterator<Count> (
+            _solidIterable->iterator(),
+            _solidIterable->getNbItems(),
+            progressFormat6()
+        );
+        LOCAL (itKmers);
+
+        getDispatcher()->iterate (itKmers, [&] (const Count& kmer)  {  filter->insert (kmer.value);  });
+    }
+
+    /** We save the filter into the storage. */
+    StorageTools::singleton().saveCuckoo<Type> (_groupDebloom, "cuckoo", filter);
+
+    totalSize = 8*filter->getSize();
+
+    /** Some statistics. */
+    props->add (1, "cuckoo",           "%ld", totalSize);
+    props->add (1, "fingerprint_bits", "%ld", filter->getFingerprintBits());
+    props->add (1, "nb_buckets",       "%ld", filter->getNbBuckets());
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -651,6 +702,22 @@ float DebloomAlgorithm<span>::getNbBitsPerKmer (size_t kmerSize, DebloomKind deb
     return nbitsPerKmer;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+IBloom<typename DebloomAlgorithm<span>::Type>* DebloomAlgorithm<span>::getBloom ()
+{
+    if (_bloom != 0)  { return _bloom; }
+
+    return StorageTools::singleton().loadBloom<Type> (_groupBloom, "bloom");
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -668,7 +735,7 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
     {
         case DEBLOOM_NONE:
         {
-            IBloom<Type>* bloom = StorageTools::singleton().loadBloom<Type> (_groupBloom, "bloom");
+            IBloom<Type>* bloom = getBloom ();
 
             /** We build the set of critical false positive kmers. */
             setDebloomStructures (new debruijn::impl::ContainerNodeNoCFP<Type> (bloom));
@@ -679,7 +746,7 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
         case DEBLOOM_DEFAULT:
         default:
         {
-            IBloom<Type>*      bloom    = StorageTools::singleton().loadBloom<Type>     (_groupBloom,   "bloom");
+            IBloom<Type>*      bloom    = getBloom ();
             Container<Type>*   cFP      = StorageTools::singleton().loadContainer<Type> (_groupDebloom, "cfp");
 
             /** We build the set of critical false positive kmers. */
@@ -690,7 +757,7 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
 
         case DEBLOOM_CASCADING:
         {
-            IBloom<Type>*     bloom   = StorageTools::singleton().loadBloom<Type>     (_groupBloom,   "bloom");
+            IBloom<Type>*     bloom   = getBloom ();
             IBloom<Type>*     bloom2  = StorageTools::singleton().loadBloom<Type>     (_groupDebloom, "bloom2");
             IBloom<Type>*     bloom3  = StorageTools::singleton().loadBloom<Type>     (_groupDebloom, "bloom3");
             IBloom<Type>*     bloom4  = StorageTools::singleton().loadBloom<Type>     (_groupDebloom, "bloom4");
@@ -701,6 +768,15 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
 
             break;
         }
+
+        case DEBLOOM_CUCKOO:
+        {
+            CuckooFilter<Type>* filter = StorageTools::singleton().loadCuckoo<Type> (_groupDebloom, "cuckoo", _modifiable);
+
+            setDebloomStructures (new debruijn::impl::ContainerNodeCuckoo<Type> (filter));
+
+            break;
+        }
     }
 }
 /********************************************************************************/
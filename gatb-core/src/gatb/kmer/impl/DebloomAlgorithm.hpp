@@ -106,8 +106,10 @@ public:
 
     /** Constructor
      * \param[in] storage : storage object from which the cFP can be loaded.
+     * \param[in] modifiable : false if the nodes container is never modified (removal of nodes
+     *  from a cuckoo filter), so that it may be used in place from the mapped file of the storage.
      */
-    DebloomAlgorithm (tools::storage::impl::Storage& storage);
+    DebloomAlgorithm (tools::storage::impl::Storage& storage, bool modifiable=true);
 
     /** Destructor */
     virtual ~DebloomAlgorithm ();
@@ -130,6 +132,12 @@ public:
      * \return the container. */
     debruijn::IContainerNode<Type>* getContainerNode ()  { return _container; }
 
+    /** Set the Bloom filter of the solid kmers, when it is already in memory (for instance built
+     * during the kmers counting, see CountProcessorBloom). Otherwise, the Bloom filter is loaded
+     * from the 'bloom' group.
+     * \param[in] bloom : the Bloom filter of the solid kmers. */
+    void setBloom (gatb::core::tools::collections::impl::IBloom<Type>* bloom)  { SP_SETATTR(bloom); }
+
     /** Get the number of bits per kmer
      * \param[in] kmerSize : kmer size
      * \param[in] debloomKind : kind of debloom
@@ -176,6 +184,9 @@ protected:
     std::string  _debloomUri;
     size_t       _max_memory;
 
+    /** False if the nodes container can be used in place from the mapped file (read only). */
+    bool         _modifiable;
+
     u_int64_t _criticalNb;
     Type      _criticalChecksum;
 
@@ -188,12 +199,24 @@ protected:
      * already exists an object named Container, and it's certainly not a Debloom structure */
     void setDebloomStructures (debruijn::IContainerNode<Type>* container)  { SP_SETATTR(container); }
 
+    /** Bloom filter given by setBloom, if any. */
+    gatb::core::tools::collections::impl::IBloom<Type>* _bloom;
+
+    /** Get the Bloom filter of the solid kmers: the one given by setBloom, or the one of the storage.
+     * \return the Bloom filter. */
+    gatb::core::tools::collections::impl::IBloom<Type>* getBloom ();
+
     void createCFP (
         gatb::core::tools::collections::Collection<Type>*  criticalCollection,
         tools::misc::IProperties* props,
         u_int64_t& totalSize
     );
 
+    void createCuckoo (
+        tools::misc::IProperties* props,
+        u_int64_t& totalSize
+    );
+
     void loadDebloomStructures ();
 
     static const char* progressFormat1() { return "Debloom: read solid kmers              "; }
@@ -201,6 +224,7 @@ protected:
     static const char* progressFormat3() { return "Debloom: finalization                  "; }
     static const char* progressFormat4() { return "Debloom: cascading                     "; }
     static const char* progressFormat5() { return "Debloom: save                          "; }
+    static const char* progressFormat6() { return "Debloom: cuckoo filter                 "; }
 };
 
 /********************************************************************************/
@@ -311,7 +311,7 @@ void DebloomMinimizerAlgorithm<span>::execute_aux (
     /***************************************************/
     /** We create a bloom and insert solid kmers into. */
     /***************************************************/
-    IBloom<Type>* bloom = StorageTools::singleton().loadBloom<Type> (this->_groupBloom, "bloom");
+    IBloom<Type>* bloom = this->getBloom ();
     bloom->use ();
     totalSizeBloom = bloom->getBitSize();
 
@@ -0,0 +1,233 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HashCounter.hpp
+ *  \brief Concurrent hash table counting kmers occurrences
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_HASH_COUNTER_HPP_
+#define _GATB_CORE_KMER_IMPL_HASH_COUNTER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/kmer/impl/RadixSort.hpp>
+#include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/tools/misc/api/Abundance.hpp>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Lock free hash table counting the occurrences of kmers.
+ *
+ * The table uses open addressing with linear probing, with one array for the keys and
+ * one array for the counts. Several threads may call 'increment' at the same time:
+ *   - a free cell (null count) is taken by a compare and swap on its count, which is
+ *     set to a 'busy' value until the key is written
+ *   - the count of a known key is incremented with an atomic add.
+ *
+ * The number of items is bounded by a load factor; when the table is full, 'increment'
+ * fails for new keys (the caller has to dump the table content and clear it). Keys
+ * already in the table can still be incremented.
+ *
+ * The content can be retrieved sorted by key with 'sort' (not thread safe); the table
+ * has then to be cleared before being filled again.
+ */
+template<typename Type>
+class HashCounter
+{
+public:
+
+    /** Item type of the iterator over the sorted content. */
+    typedef tools::misc::Abundance<Type,CountNumber> Count;
+
+    /** Constructor.
+     * \param[in] memorySize : max memory (in bytes) used by the table
+     * \param[in] maxLoad : max ratio of used cells */
+    HashCounter (u_int64_t memorySize, float maxLoad=0.7)
+        : _keys(0), _counts(0), _capacity(1), _mask(0), _nbItems(0), _maxNbItems(0), _memory(system::impl::System::memory())
+    {
+        while (2*_capacity*(sizeof(Type)+sizeof(CountNumber)) <= memorySize)  { _capacity *= 2; }
+        if (_capacity < MIN_CAPACITY)  { _capacity = MIN_CAPACITY; }
+
+        _mask       = _capacity - 1;
+        _maxNbItems = (u_int64_t) (maxLoad * _capacity);
+
+        _keys   = (Type*)        _memory.calloc (_capacity, sizeof(Type));
+        _counts = (CountNumber*) _memory.calloc (_capacity, sizeof(CountNumber));
+    }
+
+    /** Destructor. */
+    ~HashCounter ()
+    {
+        _memory.free (_keys);
+        _memory.free (_counts);
+    }
+
+    /** Add one occurrence of a key. May be called concurrently by several threads.
+     * \param[in] key : the key
+     * \return false if the key is not in the table and the table is full, true otherwise. */
+    bool increment (const Type& key)
+    {
+        u_int64_t idx = hash1 (key, 0) & _mask;
+
+        for (u_int64_t nbProbes=0; nbProbes<_capacity; nbProbes++, idx = (idx+1) & _mask)
+        {
+            CountNumber count = load (idx);
+
+            if (count == 0)
+            {
+                /** We reserve room for a new item before trying to take the cell. */
+                if (__sync_add_and_fetch (&_nbItems, 1) > _maxNbItems)
+                {
+                    __sync_fetch_and_sub (&_nbItems, 1);
+                    return false;
+                }
+
+                if (__sync_bool_compare_and_swap (&_counts[idx], 0, BUSY))
+                {
+                    _keys[idx] = key;
+                    __sync_synchronize ();
+                    *(volatile CountNumber*) &_counts[idx] = 1;
+                    return true;
+                }
+
+                /** Another thread took the cell first; it may hold our key. */
+                __sync_fetch_and_sub (&_nbItems, 1);
+                count = load (idx);
+            }
+
+            /** We wait for the key of the cell to be written. */
+            while (count == BUSY)  { count = load (idx); }
+
+            if (_keys[idx] == key)
+            {
+                __sync_fetch_and_add (&_counts[idx], 1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /** Tell whether new keys can still be inserted.
+     * \return true if the max number of items is reached. */
+    bool isFull () const  { return _nbItems >= _maxNbItems; }
+
+    /** Get the number of distinct keys in the table.
+     * \return the number of keys. */
+    u_int64_t getNbItems () const  { return _nbItems; }
+
+    /** Get the max number of distinct keys in the table.
+     * \return the max number of keys. */
+    u_int64_t getMaxNbItems () const  { return _maxNbItems; }
+
+    /** Move the items at the beginning of the arrays and sort them by key. The table can no
+     * longer be filled until 'clear' is called. Not thread safe.
+     * \return the number of items, available through getKeys and getCounts. */
+    u_int64_t sort ()
+    {
+        u_int64_t nb = 0;
+        for (u_int64_t i=0; i<_capacity; i++)
+        {
+            if (_counts[i] != 0)
+            {
+                _keys  [nb] = _keys  [i];
+                _counts[nb] = _counts[i];
+                nb++;
+            }
+        }
+
+        RadixSort<Type,CountNumber>::sort (_keys, _counts, nb);
+
+        return nb;
+    }
+
+    /** Get the keys, sorted after a call to 'sort'.
+     * \return the keys array. */
+    const Type* getKeys () const  { return _keys; }
+
+    /** Get the counts of the keys, after a call to 'sort'.
+     * \return the counts array. */
+    const CountNumber* getCounts () const  { return _counts; }
+
+    /** Get an iterator over a range of the sorted items (see 'sort').
+     * \param[in] begin : index of the first item
+     * \param[in] end : index after the last item
+     * \return the iterator. */
+    tools::dp::Iterator<Count>* iterator (u_int64_t begin, u_int64_t end)  {  return new SortedIterator (*this, begin, end);  }
+
+    /** Remove all the items of the table. Not thread safe. */
+    void clear ()
+    {
+        _memory.memset (_counts, 0, _capacity * sizeof(CountNumber));
+        _nbItems = 0;
+    }
+
+private:
+
+    static const u_int64_t   MIN_CAPACITY = 1024;
+    static const CountNumber BUSY         = -1;
+
+    Type*        _keys;
+    CountNumber* _counts;
+
+    u_int64_t _capacity;
+    u_int64_t _mask;
+
+    u_int64_t _nbItems;
+    u_int64_t _maxNbItems;
+
+    system::IMemory& _memory;
+
+    CountNumber load (u_int64_t idx) const  { return *(volatile CountNumber*) &_counts[idx]; }
+
+    /** Iterator over a range of the sorted items. */
+    class SortedIterator : public tools::dp::Iterator<Count>
+    {
+    public:
+        SortedIterator (HashCounter& ref, u_int64_t begin, u_int64_t end) : _ref(ref), _begin(begin), _end(end), _idx(begin)  {}
+
+        void first ()  { _idx = _begin;  update(); }
+        void next  ()  { _idx ++;        update(); }
+        bool isDone()  { return _idx >= _end; }
+        Count& item () { return *(this->_item); }
+
+    private:
+        HashCounter& _ref;
+        u_int64_t    _begin;
+        u_int64_t    _end;
+        u_int64_t    _idx;
+
+        void update ()
+        {
+            if (_idx < _end)  {  this->_item->value = _ref._keys[_idx];  this->_item->abundance = _ref._counts[_idx];  }
+        }
+    };
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_HASH_COUNTER_HPP_ */
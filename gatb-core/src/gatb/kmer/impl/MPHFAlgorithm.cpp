@@ -89,7 +89,7 @@ MPHFAlgorithm<span,Abundance_t,NodeState_t>::MPHFAlgorithm (
     IProperties*        options
 )
     :  Algorithm("mphf", nbCores, options), _group(group), _name(name), _buildOrLoad(buildOrLoad),
-       _dataSize(0), _nb_abundances_above_precision(0), _solidCounts(0), _solidKmers(0), _abundanceMap(0), _nodeStateMap(0), _adjacencyMap(0), _progress(0)
+       _dataSize(0), _nb_abundances_above_precision(0), _solidCounts(0), _solidKmers(0), _abundanceMap(0), _nodeStateMap(0), _adjacencyMap(0), _nodeCheckMap(0), _progress(0)
 {
     /** We keep a reference on the solid kmers. */
     setSolidCounts (solidCounts);
@@ -110,8 +110,9 @@ MPHFAlgorithm<span,Abundance_t,NodeState_t>::MPHFAlgorithm (
             _abundanceMap->load (_group, _name);
         }
 
-        /** We populate the abundance hash table. */
-        populate ();
+        /** We populate the abundance hash table, unless its values can be used in place
+         * from the mapped file of the storage. */
+        if (_abundanceMap->loadValues (_group, _name) == false)  {  populate ();  }
 
         /** init a clean node state map */
         initNodeStates ();
@@ -135,6 +136,7 @@ MPHFAlgorithm<span,Abundance_t,NodeState_t>::~MPHFAlgorithm ()
     setAbundanceMap(0);
     setNodeStateMap(0);
     setAdjacencyMap(0);
+    setNodeCheckMap(0);
     setProgress    (0);
 }
 
@@ -178,6 +180,9 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::execute ()
 
         /** We populate the hash table. */
         populate ();
+
+        /** We may save the abundances into the mapped file of the storage. */
+        _abundanceMap->saveValues (_group, _name);
         
         /** init a clean node state map */
         initNodeStates ();
@@ -207,6 +212,38 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::initNodeStates()
     _nodeStateMap->useHashFrom(_abundanceMap, 2); // use abundancemap's MPHF, and allocate n/2 bytes
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the checks are saved into (or used in place from) the mapped file of the storage,
+**           like the abundances
+*********************************************************************/
+template<size_t span,typename Abundance_t,typename NodeState_t>
+void MPHFAlgorithm<span,Abundance_t,NodeState_t>::buildNodeChecks ()
+{
+    TIME_INFO (getTimeInfo(), "checks");
+
+    std::string name = _name + "_check";
+
+    setNodeCheckMap (new NodeCheckMap());
+    _nodeCheckMap->useHashFrom (_abundanceMap);
+
+    if (_nodeCheckMap->loadValues (_group, name) == true)  { return; }
+
+    Iterator<Type>* itKmers = _solidKmers->iterator();  LOCAL (itKmers);
+
+    for (itKmers->first(); !itKmers->isDone(); itKmers->next())
+    {
+        Type& kmer = itKmers->item();
+        _nodeCheckMap->at (_nodeCheckMap->getCode (kmer)) = getNodeCheck (kmer);
+    }
+
+    _nodeCheckMap->saveValues (_group, name);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -96,6 +96,12 @@ public:
     typedef u_int8_t Adjacency_t;
     typedef tools::collections::impl::MapMPHF<Type,Adjacency_t>  AdjacencyMap;
 
+    /** We define the type of the hash table of couples [kmer/node check]: a short fingerprint of the
+     * kmer owning each index, so that a kmer not used for building the MPHF (which gets the index
+     * of some other kmer) can be told apart, see buildNodeChecks. */
+    typedef u_int16_t NodeCheck_t;
+    typedef tools::collections::impl::MapMPHF<Type,NodeCheck_t>  NodeCheckMap;
+
 
     /** Constructor.
      * \param[in] group : storage group where to save the MPHF once built
@@ -131,6 +137,18 @@ public:
     AbundanceMap* getAbundanceMap () const  { return _abundanceMap; }
     NodeStateMap* getNodeStateMap () const  { return _nodeStateMap; }
     NodeStateMap* getAdjacencyMap () const  { return _adjacencyMap; }
+    NodeCheckMap* getNodeCheckMap () const  { return _nodeCheckMap; }
+
+    /** Set the node check of each entry in the hash table (from the solid kmers), or use the checks
+     * saved in the mapped file of the storage. This is needed only when the graph queries the MPHF
+     * with kmers that are not solid, ie. with a nodes container having false positives (cuckoo filter).
+     * Once done, getNodeCheckMap returns the checks. */
+    void buildNodeChecks ();
+
+    /** Get the node check of a kmer.
+     * \param[in] kmer : the kmer
+     * \return the check, to be compared to the one at the MPHF index of the kmer. */
+    static NodeCheck_t getNodeCheck (const Type& kmer)  {  return (NodeCheck_t) (hash1 (kmer, 0x5851f42d4c957f2dULL) >> 48);  }
 
 private:
 
@@ -152,9 +170,11 @@ private:
     AbundanceMap* _abundanceMap;
     NodeStateMap* _nodeStateMap;
     AdjacencyMap* _adjacencyMap;
+    NodeCheckMap* _nodeCheckMap;
     void setAbundanceMap (AbundanceMap* abundanceMap)  { SP_SETATTR(abundanceMap); }
     void setNodeStateMap (NodeStateMap* nodeStateMap)  { SP_SETATTR(nodeStateMap); }
     void setAdjacencyMap (AdjacencyMap* adjacencyMap)  { SP_SETATTR(adjacencyMap); }
+    void setNodeCheckMap (NodeCheckMap* nodeCheckMap)  { SP_SETATTR(nodeCheckMap); }
 
     /** Set the abundance for each entry in the hash table. */
     void populate ();
@@ -39,6 +39,8 @@
 #include <gatb/tools/misc/api/Abundance.hpp>
 
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/math/NucleotideCodec.hpp>
+#include <gatb/tools/math/NtHash.hpp>
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 
@@ -46,6 +48,7 @@
 #include <algorithm>
 #include <iostream>
 #include <bitset>
+#include <type_traits>
 
 extern const char bin2NT[] ;
 extern const char binrev[] ;
@@ -107,7 +110,9 @@ struct Kmer
     /** Forward declarations. */
     class ModelDirect;
     class ModelCanonical;
+    class ModelRollingHash;
     template<class Model, class Comparator> class ModelMinimizer;
+    struct ComparatorMinimizerHash;
 
     /** Now, we need to define what is a kmer for each kind of model.
      *
@@ -322,6 +327,42 @@ struct Kmer
        
      };
 
+    /** \brief Kmer type for the ModelRollingHash class.
+     *
+     * This class is a canonical kmer with a 64 bits hash, the same for the kmer and its reverse
+     * complement. The hash is updated in constant time from one kmer to the next one (see NtHash.hpp),
+     * so it can be given to the hash based structures (see IBloom::insertHash) instead of the kmer value.
+     *
+     *  NOTE: this class is not intended to be used directly by end users. Instead, the typedef definition
+     *  \ref ModelRollingHash::Kmer should be preferred.
+     */
+    class KmerRollingHash : public KmerCanonical
+    {
+    public:
+
+        /** Returns the canonical hash of the kmer.
+         * \return the hash value. */
+        u_int64_t hash () const  { return _forwardHash + _revcompHash; }
+
+    protected:
+        u_int64_t _forwardHash;
+        u_int64_t _revcompHash;
+        friend class ModelRollingHash;
+    };
+
+    /** Nothing is kept by a KmerMinimizer for comparing its mmers, except with ComparatorMinimizerHash. */
+    struct MinimizerNoKeys  {};
+
+    /** Hashes kept by a KmerMinimizer ordered by ComparatorMinimizerHash: the ntHash of the rightmost
+     * mmer of the kmer and of its reverse complement (rolled from one kmer to the next one), and the
+     * key of the minimizer. */
+    struct MinimizerHashKeys
+    {
+        u_int64_t forward;
+        u_int64_t revcomp;
+        u_int64_t minimizer;
+    };
+
     /** \brief Kmer type for the ModelMinimizer class.
      *
      * This class associates a kmer and its minimizer. It inherits from the Model::Kmer type
@@ -357,9 +398,12 @@ struct Kmer
 
     protected:
 
+        typedef typename std::conditional<std::is_same<Comparator, ComparatorMinimizerHash>::value, MinimizerHashKeys, MinimizerNoKeys>::type Keys;
+
         typename Model::Kmer _minimizer;
         int16_t              _position;
         bool                 _changed;
+        Keys                 _keys;
         friend class ModelMinimizer<Model,Comparator>;
     };
 
@@ -764,6 +808,69 @@ struct Kmer
             return true;
         }
 
+        /** Number of kmers computed at once by 'iterateCodec'. */
+        static const size_t CODEC_BLOCK_SIZE = 1024;
+
+        /** Iteration of the kmers of an ASCII sequence with the nucleotide codec (see NucleotideCodec.hpp),
+         * for kmers up to 32 nucleotides. The sequence is packed and reverse complemented by blocks, and the
+         * kmers of a block are extracted at once; the model sets each kmer through its 'setKmer' method.
+         * The kmers (including the invalid ones) and their indexes are the same as with 'iterate'.
+         *  \param[in] seq : the sequence to be iterated
+         *  \param[in] length : length of the sequence
+         *  \param[in] callback : functor called on each found kmer in the sequence
+         *  \param[in] withRevcomp : tells whether the reverse complement of the kmers is needed
+         *  \return true if kmers have been found, false otherwise.
+         */
+        template<typename Callback>
+        bool iterateCodec (const char* seq, size_t length, Callback callback, bool withRevcomp) const
+        {
+            if (length < _kmerSize)  { return false; }
+
+            size_t nbKmers = length - _kmerSize + 1;
+
+            u_int8_t  packed  [(CODEC_BLOCK_SIZE + 32) / 4];
+            u_int8_t  revcomp [(CODEC_BLOCK_SIZE + 32) / 4];
+            u_int64_t badMask [(CODEC_BLOCK_SIZE + 32 + 63) / 64];
+            u_int64_t forward [CODEC_BLOCK_SIZE];
+            u_int64_t reverse [CODEC_BLOCK_SIZE];
+
+            typename ModelImpl::Kmer result;
+
+            for (size_t start=0; start<nbKmers; start+=CODEC_BLOCK_SIZE)
+            {
+                size_t nb          = std::min (CODEC_BLOCK_SIZE, nbKmers - start);
+                size_t blockLength = nb + _kmerSize - 1;
+
+                size_t nbBad = tools::math::packNucleotides (seq + start, blockLength, packed, badMask);
+
+                if (withRevcomp)  {  tools::math::reverseComplementPacked (packed, blockLength, revcomp);  }
+
+                tools::math::buildKmers (packed, revcomp, blockLength, _kmerSize, forward, withRevcomp ? reverse : 0);
+
+                /** A kmer is invalid if a bad character is found up to 'kmerSize-1' positions before its end. */
+                int64_t lastBad = -1;
+                if (nbBad > 0)
+                {
+                    for (size_t i=0; i+1<_kmerSize; i++)  {  if ((badMask[i/64] >> (i%64)) & 1)  { lastBad = i; }  }
+                }
+
+                for (size_t i=0; i<nb; i++)
+                {
+                    if (nbBad > 0)
+                    {
+                        size_t end = i + _kmerSize - 1;
+                        if ((badMask[end/64] >> (end%64)) & 1)  { lastBad = end; }
+                    }
+
+                    static_cast<const ModelImpl*>(this)->setKmer (result, forward[i], withRevcomp ? reverse[i] : 0, lastBad < (int64_t)i);
+
+                    this->notification<Callback> (result, start + i, callback);
+                }
+            }
+
+            return true;
+        }
+
         template <class Callcack>
         void  notification (const Kmer& value, size_t idx, Callcack callback) const {  callback (value, idx);  }
 
@@ -799,6 +906,33 @@ struct Kmer
          * \param[in] kmerSize : size of the kmers handled by the model. */
         ModelDirect (size_t kmerSize=span-1) : ModelAbstract<ModelDirect, Kmer> (kmerSize) {}
 
+        /** The iteration from a Data object is the one of ModelAbstract. */
+        using ModelAbstract<ModelDirect, Kmer>::iterate;
+
+        /** Iterates the kmers of a sequence; ASCII sequences are processed by the nucleotide codec
+         * for kmers up to 32 nucleotides (see ModelAbstract::iterateCodec).
+         * \param[in] seq : the sequence to be iterated
+         * \param[in] length : length of the sequence
+         * \param[in] callback : functor called on each found kmer in the sequence
+         * \return true if kmers have been found, false otherwise. */
+        template<typename Callback, typename Convert>
+        bool iterate (const char* seq, size_t length, Callback callback) const
+        {
+            if (std::is_same<Convert,tools::misc::Data::ConvertASCII>::value && this->_kmerSize <= 32)  {  return this->iterateCodec (seq, length, callback, false);  }
+            return ModelAbstract<ModelDirect, Kmer>::template iterate<Callback,Convert> (seq, length, callback);
+        }
+
+        /** Sets a kmer computed by the nucleotide codec.
+         * \param[out] value : kmer to be set
+         * \param[in] forward : value of the kmer
+         * \param[in] revcomp : not used
+         * \param[in] isValid : tells whether the kmer is valid or not */
+        void setKmer (Kmer& value, u_int64_t forward, u_int64_t revcomp, bool isValid) const
+        {
+            value._value.setVal (forward);
+            value._isValid = isValid;
+        }
+
         /** Computes a kmer from a buffer holding nucleotides encoded in some format.
          * The way to interpret the buffer is done through the provided Convert template class.
          * \param[in] buffer : holds the nucleotides sequence from which the kmer has to be computed
@@ -848,6 +982,35 @@ struct Kmer
          * \param[in] kmerSize : size of the kmers handled by the model. */
         ModelCanonical (size_t kmerSize=span-1) : ModelAbstract<ModelCanonical, Kmer> (kmerSize) {}
 
+        /** The iteration from a Data object is the one of ModelAbstract. */
+        using ModelAbstract<ModelCanonical, Kmer>::iterate;
+
+        /** Iterates the kmers of a sequence; ASCII sequences are processed by the nucleotide codec
+         * for kmers up to 32 nucleotides (see ModelAbstract::iterateCodec).
+         * \param[in] seq : the sequence to be iterated
+         * \param[in] length : length of the sequence
+         * \param[in] callback : functor called on each found kmer in the sequence
+         * \return true if kmers have been found, false otherwise. */
+        template<typename Callback, typename Convert>
+        bool iterate (const char* seq, size_t length, Callback callback) const
+        {
+            if (std::is_same<Convert,tools::misc::Data::ConvertASCII>::value && this->_kmerSize <= 32)  {  return this->iterateCodec (seq, length, callback, true);  }
+            return ModelAbstract<ModelCanonical, Kmer>::template iterate<Callback,Convert> (seq, length, callback);
+        }
+
+        /** Sets a kmer computed by the nucleotide codec; the canonical form is computed here.
+         * \param[out] value : kmer to be set
+         * \param[in] forward : forward value of the kmer
+         * \param[in] revcomp : reverse complement value of the kmer
+         * \param[in] isValid : tells whether the kmer is valid or not */
+        void setKmer (Kmer& value, u_int64_t forward, u_int64_t revcomp, bool isValid) const
+        {
+            value.table[0].setVal (forward);
+            value.table[1].setVal (revcomp);
+            value._isValid = isValid;
+            value.updateChoice();
+        }
+
         /** Computes a kmer from a buffer holding nucleotides encoded in some format.
          * The way to interpret the buffer is done through the provided Convert template class.
          * \param[in] seq : holds the nucleotides sequence from which the kmer has to be computed
@@ -899,6 +1062,102 @@ struct Kmer
 
     /********************************************************************************/
 
+    /** \brief Model that handles canonical kmers with a rolling hash.
+     *
+     * The kmers are the ones of ModelCanonical; each kmer also has a canonical 64 bits hash
+     * (ntHash, see NtHash.hpp), computed in constant time from the hash of the previous kmer,
+     * whatever the kmer size. For kmers larger than 32 nucleotides, this saves hashing the
+     * several words of the kmer value.
+     *
+     * Example of use:
+     * \code
+     * Kmer<>::ModelRollingHash model (kmerSize);
+     * model.iterate (data, [&] (const Kmer<>::ModelRollingHash::Kmer& kmer, size_t idx)  {  bloom.insertHash (kmer.hash());  });
+     * \endcode
+     */
+    class ModelRollingHash :  public ModelAbstract<ModelRollingHash, Kmer<span>::KmerRollingHash>
+    {
+    public:
+
+        /** Kmer type for this kind of model.  */
+        typedef Kmer<span>::KmerRollingHash Kmer;
+
+        /** Constructor.
+         * \param[in] kmerSize : size of the kmers handled by the model. */
+        ModelRollingHash (size_t kmerSize=span-1) : ModelAbstract<ModelRollingHash, Kmer> (kmerSize), _canonicalModel(kmerSize)
+        {
+            /** Seeds of the outgoing and incoming nucleotides, rotated once for all. */
+            for (size_t c=0; c<4; c++)
+            {
+                _forwardOut[c] = tools::math::rol64 (tools::math::ntHashSeed (c),   kmerSize);
+                _revcompOut[c] = tools::math::ror64 (tools::math::ntHashSeed (c^2), 1);
+                _revcompIn [c] = tools::math::rol64 (tools::math::ntHashSeed (c^2), kmerSize-1);
+            }
+        }
+
+        /** Computes a kmer (and its hash) from a buffer holding nucleotides encoded in some format.
+         * \param[in] seq : holds the nucleotides sequence from which the kmer has to be computed
+         * \param[out] value : kmer as a result
+         * \param[in] startIndex : index of the first nucleotide of the kmer to retrieve in the buffer
+         */
+        template <class Convert>
+        int first (const char* seq, Kmer& value, size_t startIndex)   const
+        {
+            int result = _canonicalModel.template first<Convert> (seq, value, startIndex);
+            computeHashes (value.forward(), value._forwardHash, value._revcompHash);
+            return result;
+        }
+
+        /** Computes a kmer (and its hash) in a recursive way, ie. from a kmer and the next nucleotide.
+         * \param[in] c : next nucleotide
+         * \param[out] value : kmer to be updated with the provided next nucleotide
+         * \param[in] isValid : tells whether the updated kmer is valid or not
+         */
+        template <class Convert>
+        void  next (char c, Kmer& value, bool isValid)   const
+        {
+            /** The outgoing nucleotide is the first one of the forward kmer. */
+            u_int8_t out = value.forward()[this->_kmerSize-1];
+
+            _canonicalModel.template next<Convert> (c, value, isValid);
+
+            value._forwardHash = tools::math::rol64 (value._forwardHash, 1) ^ _forwardOut[out] ^ tools::math::ntHashSeed (c);
+            value._revcompHash = tools::math::ror64 (value._revcompHash, 1) ^ _revcompOut[out] ^ _revcompIn[(int)c];
+        }
+
+        /** Computes the canonical hash of a kmer from its value, for instance for querying structures
+         * filled with the hashes of iterated kmers. The kmer or its reverse complement give the same hash.
+         * \param[in] kmer : kmer value
+         * \return the hash of the kmer. */
+        u_int64_t getHash (const Type& kmer) const
+        {
+            u_int64_t forward, revcomp;
+            computeHashes (kmer, forward, revcomp);
+            return forward + revcomp;
+        }
+
+    private:
+
+        ModelCanonical _canonicalModel;
+
+        u_int64_t _forwardOut[4];
+        u_int64_t _revcompOut[4];
+        u_int64_t _revcompIn [4];
+
+        /** Hashes of a forward kmer and of its reverse complement, from scratch. */
+        void computeHashes (const Type& kmer, u_int64_t& forward, u_int64_t& revcomp) const
+        {
+            forward = revcomp = 0;
+            for (size_t j=0; j<this->_kmerSize; j++)
+            {
+                forward ^= tools::math::rol64 (tools::math::ntHashSeed (kmer[j]),   j);
+                revcomp ^= tools::math::rol64 (tools::math::ntHashSeed (kmer[j]^2), this->_kmerSize-1-j);
+            }
+        }
+    };
+
+    /********************************************************************************/
+
     struct ComparatorMinimizer
     {
         template<class Model>  void init (const Model& model, Type& best) const { best = model.getKmerMax(); }
@@ -977,6 +1236,96 @@ struct Kmer
         bool has_frequency;
     };
 
+    /** Compare the minimizers by their canonical ntHash (see NtHash.hpp), ie. in a random order
+     * that balances the minimizers better than the lexicographic one. The hash of a mmer is the one
+     * given by ModelRollingHash for the mmer size. ModelMinimizer keeps the hashes of the rightmost
+     * mmer and the key of the minimizer in its kmers (see MinimizerHashKeys) and rolls the hashes
+     * from one kmer to the next one, so it compares the mmers in constant time, like with the
+     * lexicographic order. The operator() computes the hashes of both mmers from scratch.
+     *
+     * The default minimizer (the largest mmer, also given to the forbidden mmers) is kept as the worst one.
+     * Frequency orders and ModelMinimizer::iterateBulk are not supported with this comparator. */
+    struct ComparatorMinimizerHash
+    {
+        template<class Model>  void init (const Model& model, Type& best)
+        {
+            best      = model.getKmerMax();
+            _max      = best.getVal();
+            _mmerSize = model.getKmerSize();
+
+            /** Seeds of the outgoing and incoming nucleotides, rotated once for all. */
+            for (size_t c=0; c<4; c++)
+            {
+                _forwardOut[c] = tools::math::rol64 (tools::math::ntHashSeed (c),   _mmerSize);
+                _revcompOut[c] = tools::math::ror64 (tools::math::ntHashSeed (c^2), 1);
+                _revcompIn [c] = tools::math::rol64 (tools::math::ntHashSeed (c^2), _mmerSize-1);
+            }
+        }
+
+        void include_frequency (uint32_t *freq_order)
+        {
+            throw system::Exception ("Minimizers frequency order not supported with the hash order");
+        }
+
+        /** Hashes of a mmer and of its reverse complement, from scratch. */
+        void computeHashes (u_int64_t mmer, u_int64_t& forward, u_int64_t& revcomp) const
+        {
+            forward = revcomp = 0;
+            for (size_t j=0; j<_mmerSize; j++, mmer >>= 2)
+            {
+                forward ^= tools::math::rol64 (tools::math::ntHashSeed (mmer),   j);
+                revcomp ^= tools::math::rol64 (tools::math::ntHashSeed (mmer^2), _mmerSize-1-j);
+            }
+        }
+
+        /** Hashes of the next mmer, from the hashes of a mmer, its first nucleotide 'out' and the next nucleotide 'in'. */
+        void rollNext (u_int64_t& forward, u_int64_t& revcomp, u_int8_t out, u_int8_t in) const
+        {
+            forward = tools::math::rol64 (forward, 1) ^ _forwardOut[out] ^ tools::math::ntHashSeed (in);
+            revcomp = tools::math::ror64 (revcomp, 1) ^ _revcompOut[out] ^ _revcompIn[in];
+        }
+
+        /** Hashes of the previous mmer, from the hashes of a mmer, its last nucleotide 'out' and the previous nucleotide 'in'. */
+        void rollPrevious (u_int64_t& forward, u_int64_t& revcomp, u_int8_t out, u_int8_t in) const
+        {
+            forward = tools::math::ror64 (forward ^ tools::math::ntHashSeed (out), 1) ^ tools::math::rol64 (tools::math::ntHashSeed (in), _mmerSize-1);
+            revcomp = tools::math::rol64 (revcomp ^ _revcompIn[out], 1) ^ tools::math::ntHashSeed (in^2);
+        }
+
+        /** Key of a mmer from its canonical hash, the default minimizer having the largest key. */
+        u_int64_t key (u_int64_t mmer, u_int64_t hash) const
+        {
+            return mmer == _max ? ~(u_int64_t)0 : hash >> 1;
+        }
+
+        /** Key of a mmer, from scratch. */
+        u_int64_t key (u_int64_t mmer) const
+        {
+            return key (mmer, tools::math::ntHashCanonical (mmer, _mmerSize));
+        }
+
+        /** Compare two mmers from their keys, ties being broken by the mmers values. */
+        bool compareHashes (u_int64_t keyA, u_int64_t a, u_int64_t keyB, u_int64_t b) const
+        {
+            return keyA == keyB ? a < b : keyA < keyB;
+        }
+
+        bool operator() (const Type& a_t, const Type& b_t) const
+        {
+            u_int64_t a = a_t.getVal();
+            u_int64_t b = b_t.getVal();
+            return compareHashes (key(a), a, key(b), b);
+        }
+
+        private:
+        u_int64_t _max;
+        size_t    _mmerSize;
+
+        u_int64_t _forwardOut[4];
+        u_int64_t _revcompOut[4];
+        u_int64_t _revcompIn [4];
+    };
+
 
     /** \brief Model that handles kmers of the Model type + a minimizer
      *
@@ -1009,7 +1358,7 @@ struct Kmer
          */
         ModelMinimizer (size_t kmerSize, size_t minimizerSize, Comparator cmp=Comparator(), uint32_t *freq_order=NULL)
             : ModelAbstract <ModelMinimizer<ModelType,Comparator>, Kmer > (kmerSize),
-              _kmerModel(kmerSize), _miniModel(minimizerSize), _cmp(cmp), _freq_order(freq_order)
+              _kmerModel(kmerSize), _miniModel(minimizerSize), _cmp(cmp), _freq_order(freq_order), _allowAllMmers(freq_order != NULL)
         {
             if (kmerSize < minimizerSize)  { throw system::Exception ("Bad values for kmer %d and minimizer %d", kmerSize, minimizerSize); }
 
@@ -1029,39 +1378,26 @@ struct Kmer
             _cmp.template init<ModelType> (getMmersModel(), tmp);
             _minimizerDefault.set (tmp); //////////max value of minim
 			
-			u_int64_t nbminims_total = ((u_int64_t)1 << (2*_minimizerSize));
-			_mmer_lut = (Type *) MALLOC(sizeof(Type) * nbminims_total ); //free that in destructor
-                
             /* if it's ModelDirect, don't do a revcomp; also, use slow method */
             ModelCanonical* isModelCanonical_p = dynamic_cast<ModelCanonical*>(&_kmerModel);
             bool isModelCanonical = isModelCanonical_p != NULL;
             _defaultFast = isModelCanonical;
 
-			for(u_int64_t ii=0; ii< nbminims_total; ii++)
-			{
-				Type mmer;
-				mmer.setVal(ii);
-				
-				// if(!is_allowed(mmer.getVal(),minimizerSize)) mmer = _mask;
-				// if(!is_allowed(rev_mmer.getVal(),minimizerSize)) rev_mmer = _mask;
-				
-				if (isModelCanonical)
-				{
-					Type rev_mmer = revcomp(mmer, minimizerSize);
-					if(rev_mmer < mmer) mmer = rev_mmer;
-					
-					//may be cleaner with this
-					//if (_cmp (rev_mmer, mmer ) == true)
-					//	mmer = rev_mmer;
-				}
-				
-				//std:: cout << "ii " << ii << " is allowed " << is_allowed(mmer.getVal(),minimizerSize) <<  " mmer getval " << mmer.getVal() << " is model canonical " << isModelCanonical << std::endl;
-				
-				if (!is_allowed(mmer.getVal(),minimizerSize))
-					mmer = _mask;
-				
-				_mmer_lut[ii] = mmer;
-			}
+            /** The LUT has 4^m entries; for big mmers, they are computed on the fly (see getMmerCode). */
+            _mmer_lut = 0;
+
+            if (_minimizerSize <= MMER_LUT_MAX_SIZE)
+            {
+                u_int64_t nbminims_total = ((u_int64_t)1 << (2*_minimizerSize));
+                _mmer_lut = (Type *) MALLOC(sizeof(Type) * nbminims_total ); //free that in destructor
+
+                for(u_int64_t ii=0; ii< nbminims_total; ii++)
+                {
+                    Type mmer;
+                    mmer.setVal(ii);
+                    _mmer_lut[ii] = computeMmerCode (mmer);
+                }
+            }
 
             if (freq_order)
                 setMinimizersFrequency(freq_order);
@@ -1113,7 +1449,8 @@ struct Kmer
             kmer._isValid = isValid;
 
             /** We extract the new mmer from the kmer. also applies the mmer_lut */
-            typename ModelType::Kmer mmer = kmer.extract (this->_mask, this->_shift,_mmer_lut);
+            typename ModelType::Kmer mmer;
+            mmer.set (getMmerCode (kmer.value(0)));
 
             /** We update the position of the previous minimizer. */
             kmer._position--;
@@ -1125,7 +1462,7 @@ struct Kmer
              *      1) the new mmer is the new minimizer
              *      2) the previous minimizer is invalid or out from the new kmer window.
              */
-            if (_cmp (mmer.value(), kmer._minimizer.value()) == true) // .value()
+            if (isNewMinimizer (mmer.value(), kmer, kmer._keys))
             {
                 kmer._minimizer = mmer; // extract() above has already done the job of querying mmer_lut for revcomp / forbidden kmers
                 kmer._position  = _nbMinimizers - 1;
@@ -1138,6 +1475,75 @@ struct Kmer
             }
         }
 
+        /** Work buffers of iterateBulk. They are kept from one sequence to another for avoiding
+         * allocations, so each thread iterating sequences should have its own instance. */
+        struct MinimizersBuffer
+        {
+            std::vector<u_int64_t> forward;
+            std::vector<u_int64_t> revcomp;
+            std::vector<u_int64_t> keys;
+            std::vector<u_int64_t> minimizers;
+        };
+
+        /** Iteration of the kmers from a data object through a functor, like 'iterate', but the
+         * minimizers of all the kmers of the sequence are computed in bulk with SIMD kernels (see
+         * FastMinimizer.hpp) instead of being updated one kmer after the other.
+         *
+         * The minimizers values and positions are the same as with 'iterate'; 'hasChanged' tells
+         * whether the minimizer value differs from the one of the previous kmer.
+         *
+         * Only the lexicographic and frequency orders of ComparatorMinimizerFrequencyOrLex (and
+         * ComparatorMinimizer) are supported, with minimizers up to 31 nucleotides.
+         * \param[in] data : the sequence of nucleotides as a Data object.
+         * \param[in] callback  : functor that handles one kmer
+         * \param[in] buffer : work buffers
+         * \return true if kmers have been found, false otherwise. */
+        template<typename Callback>
+        bool iterateBulk (tools::misc::Data& data, Callback callback, MinimizersBuffer& buffer) const
+        {
+            return this->template execute <Functor_iterateBulk<Callback> > (data.getEncoding(), Functor_iterateBulk<Callback>(data,callback,buffer));
+        }
+
+        /** Bulk iteration of the kmers of a sequence provided as a buffer (see the other iterateBulk).
+         * \param[in] seq : the sequence to be iterated
+         * \param[in] length : length of the sequence
+         * \param[in] callback : functor called on each found kmer in the sequence
+         * \param[in] buffer : work buffers
+         * \return true if kmers have been found, false otherwise. */
+        template<typename Callback, typename Convert>
+        bool iterateBulk (const char* seq, size_t length, Callback callback, MinimizersBuffer& buffer) const
+        {
+            if (std::is_same<Comparator, ComparatorMinimizerHash>::value)  {  throw system::Exception ("Bulk minimizers don't support the hash order");  }
+
+            int32_t nbKmers = length - this->_kmerSize + 1;
+            if (nbKmers <= 0)  { return false; }
+
+            /** We compute the minimizers keys of all the kmers of the sequence. */
+            computeMinimizersKeys<Convert> (seq, length, buffer);
+
+            Kmer result;
+
+            /** We compute the initial seed from the provided buffer. */
+            int indexBadChar = _kmerModel.template first<Convert> (seq, result, 0);
+            setMinimizer (result, 0, buffer);
+            callback (result, 0);
+
+            /** We compute the following kmers from the first one. */
+            for (size_t idx=this->_kmerSize, idxComputed=1; idx<length; idx++, idxComputed++)
+            {
+                tools::misc::Data::ConvertChar c = Convert::get (seq, idx);
+
+                if (c.second)  { indexBadChar = this->_kmerSize-1; }
+                else           { indexBadChar--;     }
+
+                _kmerModel.template next<Convert> (c.first, result, indexBadChar<0);
+                setMinimizer (result, idxComputed, buffer);
+                callback (result, idxComputed);
+            }
+
+            return true;
+        }
+
         /** Get the minimizer value of the provided kmer. Note that minimizers are supposed to be
          * of small sizes, so their values can fit a u_int64_t type.
          * \return the miminizer value as an integer. */
@@ -1213,11 +1619,14 @@ struct Kmer
         bool       _defaultFast;
 
         uint32_t *_freq_order;
+
+        /** True if the mmers with 'AA' inside have been kept in _mmer_lut. */
+        bool _allowAllMmers;
 		
 
         /** Tells whether a minimizer is valid or not, in order to skip minimizers
          *  that are too frequent. */
-        bool is_allowed (uint32_t mmer, uint32_t len)
+        bool is_allowed (u_int64_t mmer, uint32_t len) const
 		{
 			if (_freq_order) return true; // every minimizer is allowed in freq order
 			
@@ -1227,7 +1636,7 @@ struct Kmer
 			
 			//code to ban mmer with AA inside except if at the beginnning
 			// A C T G        00   01   10   11
-			_mmask_m1  = (1 << ((len-2)*2)) -1 ; //vire 2 premieres lettres m = 8  donne    00 00 11 11 11 11 11 11
+			_mmask_m1  = ((u_int64_t)1 << ((len-2)*2)) -1 ; //vire 2 premieres lettres m = 8  donne    00 00 11 11 11 11 11 11
 			_mask_0101 = 0x5555555555555555  ; //         01 01 01 01 01 01 01 01
 			_mask_ma1  = _mask_0101 & _mmask_m1;//        00 00 01 01 01 01 01 01
 			
@@ -1249,9 +1658,163 @@ struct Kmer
 			
 			return true;
 		}
+
+        /** Maximum mmer size for which the 4^m entries of _mmer_lut are computed. */
+        static const size_t MMER_LUT_MAX_SIZE = 14;
+
+        /** Computes the code of a mmer, ie. its canonical value (for canonical models)
+         * or the default '_mask' value when the mmer is not allowed. */
+        Type computeMmerCode (const Type& mmer) const
+        {
+            Type result = mmer;
+
+            if (_defaultFast)
+            {
+                Type rev_mmer = revcomp (result, _minimizerSize);
+                if (rev_mmer < result)  { result = rev_mmer; }
+            }
+
+            if (!is_allowed (result.getVal(), _minimizerSize))  { result = _mask; }
+
+            return result;
+        }
+
+        /** Returns the code of the most right mmer of the provided value, through _mmer_lut when available. */
+        Type getMmerCode (const Type& val) const
+        {
+            return _mmer_lut != 0 ? _mmer_lut[(val & _mask).getVal()] : computeMmerCode (val & _mask);
+        }
 		
+        /** Adaptor between the 'execute' method and the 'iterateBulk' method. */
+        template<class Callback>
+        struct Functor_iterateBulk
+        {
+            typedef bool Result;
+            tools::misc::Data& data; Callback callback; MinimizersBuffer& buffer;
+            Functor_iterateBulk (tools::misc::Data& data, Callback callback, MinimizersBuffer& buffer) : data(data), callback(callback), buffer(buffer) {}
+            template<class Convert>  Result operator() (const ModelAbstract <ModelMinimizer<ModelType,Comparator>, Kmer>* model)
+            {
+                return static_cast<const ModelMinimizer*>(model)->template iterateBulk<Callback, Convert> (data.getBuffer(), data.size(), callback, buffer);
+            }
+        };
+
+        /** Computes the keys of the mmers of a sequence, then the minimum key of each kmer. */
+        template<typename Convert>
+        void computeMinimizersKeys (const char* seq, size_t length, MinimizersBuffer& buffer) const
+        {
+            if (_minimizerSize > 31)  { throw system::Exception ("Bulk minimizers need minimizer size <= 31 (got %d)", _minimizerSize); }
+
+            size_t nbMmers = length - _minimizerSize + 1;
+            size_t nbKmers = length - this->_kmerSize + 1;
+
+            buffer.forward.resize    (nbMmers);
+            buffer.keys.resize       (nbMmers);
+            buffer.minimizers.resize (nbKmers);
+            if (_defaultFast)  { buffer.revcomp.resize (nbMmers); }
+
+            /** We compute the forward and reverse complement mmers in a rolling way. */
+            u_int64_t mmerMask = ((u_int64_t)1 << (2*_minimizerSize)) - 1;
+            size_t    rcShift  = 2*(_minimizerSize-1);
+            u_int64_t fw = 0;
+            u_int64_t rc = 0;
+
+            for (size_t idx=0; idx<length; idx++)
+            {
+                u_int64_t c = Convert::get (seq, idx).first & 3;
+
+                fw = ((fw << 2) | c) & mmerMask;
+                rc = (rc >> 2) | ((u_int64_t)comp_NT[c] << rcShift);
+
+                if (idx+1 >= _minimizerSize)
+                {
+                    buffer.forward [idx+1-_minimizerSize] = fw;
+                    if (_defaultFast)  { buffer.revcomp [idx+1-_minimizerSize] = rc; }
+                }
+            }
+
+            tools::math::computeMmerKeys (
+                buffer.forward.data(), _defaultFast ? buffer.revcomp.data() : 0, nbMmers, _minimizerSize,
+                _allowAllMmers, _freq_order, buffer.keys.data()
+            );
+
+            /** The forward mmers are no longer needed: their buffer is used as work buffer. */
+            tools::math::slidingWindowMin (buffer.keys.data(), nbMmers, _nbMinimizers, buffer.forward.data(), buffer.minimizers.data());
+        }
+
+        /** Set the minimizer of the kmer 'idx' of a sequence whose keys have been computed by
+         * computeMinimizersKeys. The previous minimizer of the kmer is the one of the kmer 'idx-1'. */
+        void setMinimizer (Kmer& kmer, size_t idx, const MinimizersBuffer& buffer) const
+        {
+            /** As in computeNewMinimizerOriginal, a mmer must be better than the default minimizer. */
+            u_int64_t defaultValue = _minimizerDefault.value().getVal();
+            u_int64_t defaultKey   = _freq_order ? (((u_int64_t)_freq_order[defaultValue] << 32) | defaultValue) : defaultValue;
+            u_int64_t key          = buffer.minimizers[idx];
+
+            u_int64_t previous = idx > 0 ? kmer._minimizer.value().getVal() : defaultValue;
+
+            if (key >= defaultKey)
+            {
+                kmer._minimizer = _minimizerDefault;
+                kmer._position  = -1;
+            }
+            else
+            {
+                u_int64_t value = _freq_order ? (key & 0xFFFFFFFF) : key;
+
+                /** The previous minimizer is still in the kmer: we keep its (older) occurrence. */
+                if (idx > 0 && value == previous && kmer._position > 0)
+                {
+                    kmer._position--;
+                }
+                else
+                {
+                    /** Otherwise we take the rightmost occurrence of the minimizer in the kmer. */
+                    const u_int64_t* keys = buffer.keys.data() + idx;
+                    int16_t pos = _nbMinimizers-1;
+                    while (pos > 0 && keys[pos] != key)  { pos--; }
+
+                    Type v;  v.setVal (value);
+                    kmer._minimizer.set (v);
+                    kmer._position = pos;
+                }
+            }
+
+            kmer._changed = (idx == 0) || (kmer._minimizer.value().getVal() != previous);
+        }
+
+        /** Tells whether the rightmost mmer of the kmer (just computed by 'next') is better than the
+         * current minimizer of the kmer. */
+        bool isNewMinimizer (const Type& mmer, Kmer& kmer, MinimizerNoKeys&) const
+        {
+            return _cmp (mmer, kmer._minimizer.value());
+        }
+
+        /** Same as above for the hash order: the hashes of the rightmost mmer are rolled from the
+         * ones of the previous kmer, and the mmer is compared to the key kept for the minimizer. */
+        bool isNewMinimizer (const Type& mmer, Kmer& kmer, MinimizerHashKeys& keys) const
+        {
+            const Type& val = kmer.value(0);
+
+            /** The outgoing nucleotide is no longer in the kmer when the kmer is the mmer. */
+            if (_nbMinimizers == 1)  {  _cmp.computeHashes ((val & _mask).getVal(), keys.forward, keys.revcomp);  }
+            else                     {  _cmp.rollNext (keys.forward, keys.revcomp, val[_minimizerSize], val[0]);  }
+
+            u_int64_t key = _cmp.key (mmer.getVal(), keys.forward + keys.revcomp);
+
+            if (_cmp.compareHashes (key, mmer.getVal(), keys.minimizer, kmer._minimizer.value().getVal()) == false)  { return false; }
+
+            keys.minimizer = key;
+            return true;
+        }
+
         /** Returns the minimizer of the provided vector of mmers. */
         void computeNewMinimizerOriginal(Kmer& kmer) const
+        {
+            computeNewMinimizerOriginal (kmer, kmer._keys);
+        }
+
+        /** Returns the minimizer of the provided vector of mmers, compared by the comparator. */
+        void computeNewMinimizerOriginal(Kmer& kmer, MinimizerNoKeys&) const
         {
             /** We update the attributes of the provided kmer. Note that an invalid minimizer is
              * memorized by convention by a negative minimizer position. */
@@ -1270,7 +1833,7 @@ struct Kmer
             {
 
                 /** We extract the most left mmer in the kmer. */
-                Type candidate_minim = _mmer_lut[(val & _mask).getVal()];
+                Type candidate_minim = getMmerCode (val);
 				
 
                 /** We check whether this mmer is the new minimizer. */
@@ -1285,6 +1848,47 @@ struct Kmer
                 val >>= 2;    
             }
         }
+
+        /** Returns the minimizer of the provided vector of mmers in the hash order. The hashes of the
+         * mmers are rolled from the rightmost one to the leftmost one; the ones of the rightmost mmer
+         * are kept in the kmer for the following kmers (see isNewMinimizer). */
+        void computeNewMinimizerOriginal(Kmer& kmer, MinimizerHashKeys& keys) const
+        {
+            kmer._minimizer = this->_minimizerDefault;
+            kmer._position  = -1;
+            kmer._changed   = true;
+
+            typename ModelType::Kmer mmer;
+
+            Type kmer_minimizer_value = kmer._minimizer.value();
+            Type val = kmer.value(0);
+
+            keys.minimizer = _cmp.key (kmer_minimizer_value.getVal(), 0);
+            _cmp.computeHashes ((val & _mask).getVal(), keys.forward, keys.revcomp);
+
+            u_int64_t forward = keys.forward;
+            u_int64_t revcomp = keys.revcomp;
+
+            for (int16_t idx=_nbMinimizers-1; idx>=0; idx--)
+            {
+                Type candidate_minim = getMmerCode (val);
+                u_int64_t key = _cmp.key (candidate_minim.getVal(), forward + revcomp);
+
+                if (_cmp.compareHashes (key, candidate_minim.getVal(), keys.minimizer, kmer_minimizer_value.getVal()) == true)
+                {
+                    mmer.set(candidate_minim);
+                    kmer._minimizer = mmer;
+                    kmer._position = idx;
+                    kmer_minimizer_value = candidate_minim;
+                    keys.minimizer = key;
+                }
+
+                /** The nucleotide before the mmer is still in the kmer for all the mmers but the leftmost one. */
+                if (idx > 0)  {  _cmp.rollPrevious (forward, revcomp, val[0], val[_minimizerSize]);  }
+
+                val >>= 2;
+            }
+        }
    
         /** Returns the minimizer of the provided vector of mmers, fast method (may fallback to normal method)
          * Note: only used for KmerCanonicals */
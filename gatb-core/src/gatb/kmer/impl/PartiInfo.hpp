@@ -23,8 +23,11 @@
 /********************************************************************************/
 
 #include <gatb/kmer/impl/Model.hpp>
+#include <gatb/bank/api/IBank.hpp>
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <queue>
+#include <vector>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb      {
@@ -33,6 +36,10 @@ namespace kmer      {
 namespace impl      {
 /********************************************************************************/
 
+/** Items of a partition coming from several banks: list of runs of consecutive items of a same bank,
+ * in the order of the partition. A run is the bank id and the number of items of the run. */
+typedef std::vector<std::pair<bank::BankIdType,size_t> > PartitionRuns;
+
 /** class containing info of each parti : exact number of kmers per parti
  *
  * will be computed by fillparti, then used by fillsolids
@@ -156,6 +163,69 @@ public:
         return _kxmer_per_mmer_bin[numbin];
     }
 
+    /** Get the partitions ordered by decreasing number of kxmers, ie. the order in which
+     * they should be scheduled for keeping the threads busy until the end of a pass.
+     * \return the partitions ids, largest partition first. */
+    std::vector<size_t> getPartitionsBySize () const
+    {
+        std::vector<std::pair<u_int64_t,size_t> > sizes (_nbpart);
+        for (int np=0; np<_nbpart; np++)  {  sizes[np] = std::make_pair (getNbSuperKmer(np), _nbpart - np);  }
+
+        /** Ties are broken by increasing partition id. */
+        std::sort (sizes.rbegin(), sizes.rend());
+
+        std::vector<size_t> result (_nbpart);
+        for (int np=0; np<_nbpart; np++)  {  result[np] = _nbpart - sizes[np].second;  }
+        return result;
+    }
+
+    /** Get the median number of kxmers of the non empty partitions.
+     * \return the median partition size. */
+    u_int64_t getNbSuperKmerMedian () const
+    {
+        std::vector<u_int64_t> sizes;
+        for (int np=0; np<_nbpart; np++)  {  if (getNbSuperKmer(np) > 0)  { sizes.push_back (getNbSuperKmer(np)); }  }
+
+        if (sizes.empty())  { return 0; }
+
+        std::nth_element (sizes.begin(), sizes.begin() + sizes.size()/2, sizes.end());
+        return sizes[sizes.size()/2];
+    }
+
+    /** Split the radix buckets of a partition into contiguous ranges holding roughly the same
+     * number of kxmers. Buckets are indexed as radix + 256*x (x being the kxmer size), so a range
+     * may span several kxmer sizes.
+     * \param[in] numpart : the partition
+     * \param[in] nbRanges : maximum number of ranges
+     * \param[out] ranges : inclusive [first,last] bucket ranges; empty ranges are not returned. */
+    void getRadixRanges (int numpart, size_t nbRanges, std::vector<std::pair<int,int> >& ranges) const
+    {
+        static const int nbBuckets = 256*xmer;
+
+        ranges.clear();
+
+        u_int64_t total = 0;
+        for (int b=0; b<nbBuckets; b++)  {  total += getNbKmer (numpart, b%256, b/256);  }
+
+        if (total == 0 || nbRanges == 0)  { return; }
+
+        u_int64_t target = (total + nbRanges - 1) / nbRanges;
+        u_int64_t current = 0;
+        int       first   = 0;
+
+        for (int b=0; b<nbBuckets; b++)
+        {
+            current += getNbKmer (numpart, b%256, b/256);
+
+            if (current >= target || b == nbBuckets-1)
+            {
+                if (current > 0)  {  ranges.push_back (std::make_pair (first, b));  }
+                first   = b+1;
+                current = 0;
+            }
+        }
+    }
+
     /** */
     void clear()
     {
@@ -18,9 +18,11 @@
 *****************************************************************************/
 
 #include <gatb/kmer/impl/PartitionsCommand.hpp>
+#include <gatb/kmer/impl/RadixSort.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/collections/impl/Hash16.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 
 using namespace std;
@@ -47,6 +49,9 @@ namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
 
 #define IX(x,rad) ((rad)+(256)*(x))
 
+/** Number of kmers buffered by PartitionsCommand::insert before calling ICountProcessor::processBatch. */
+static const size_t COUNT_PROCESSOR_BATCH_SIZE = 1024;
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -115,8 +120,32 @@ PartitionsCommand<span>::~PartitionsCommand()
 template<size_t span>
 void PartitionsCommand<span>::insert (const Type& kmer, const CounterBuilder& counter)
 {
-    /** We call the count processor instance with the information collected for the current kmer. */
-    _processor->process (_parti_num, kmer, counter.get());
+    /** We buffer the information collected for the current kmer; the count processor
+     * gets it by batches, which saves one virtual call per kmer. */
+    _batchKmers.push_back (kmer);
+    for (size_t b=0; b<counter.size(); b++)  { _batchCounts.push_back (counter[b]); }
+
+    if (_batchKmers.size() >= COUNT_PROCESSOR_BATCH_SIZE)  { flush(); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void PartitionsCommand<span>::flush ()
+{
+    size_t nb = _batchKmers.size();
+    if (nb == 0)  { return; }
+
+    _processor->processBatch (_parti_num, &_batchKmers[0], &_batchCounts[0], nb, _batchCounts.size() / nb);
+
+    _batchKmers.clear();
+    _batchCounts.clear();
 }
 
 	
@@ -163,8 +192,23 @@ PartitionsCommand_multibank<span>::~PartitionsCommand_multibank()
 template<size_t span>
 void PartitionsCommand_multibank<span>::insert (const Type& kmer, const CounterBuilder& counter)
 {
-	/** We call the count processor instance with the information collected for the current kmer. */
-	_processor->process (_parti_num, kmer, counter.get());
+	/** We buffer the information collected for the current kmer (see PartitionsCommand::insert). */
+	_batchKmers.push_back (kmer);
+	for (size_t b=0; b<counter.size(); b++)  { _batchCounts.push_back (counter[b]); }
+
+	if (_batchKmers.size() >= COUNT_PROCESSOR_BATCH_SIZE)  { flush(); }
+}
+
+template<size_t span>
+void PartitionsCommand_multibank<span>::flush ()
+{
+	size_t nb = _batchKmers.size();
+	if (nb == 0)  { return; }
+
+	_processor->processBatch (_parti_num, &_batchKmers[0], &_batchCounts[0], nb, _batchCounts.size() / nb);
+
+	_batchKmers.clear();
+	_batchCounts.clear();
 }
 /////////////////
 	
@@ -211,226 +255,49 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 {
 }
 
-	
-//will take N sorted files, will merge them to M files, by chunks of T files at a time
-	
-	template<size_t span>
-	class TempCountFileMerger
-	{
-		typedef typename Kmer<span>::Type  Type;
-		typedef tools::misc::Abundance<Type> abundance_t;
-		typedef std::pair< int , Type> ptcf; //  id pointer , kmer value
-		struct ptcfcomp { bool operator() (ptcf l,ptcf r) { return ((r.second) < (l.second)); } } ;
-		
-	public:
-		TempCountFileMerger(int reduceTarget, int chunksize) :_reduceTarget(reduceTarget), _chunksize(chunksize),_idx(0)
-		{
-		}
-		
-		std::vector<string>  mergeFiles(std::vector<string> filenames)
-		{
-			ptcf best_elem;
-			int best_p;
-			int current_ab = 0;
-			int previous_ab = 0;
-			Type current_kmer,previous_kmer;
-			
-			
-			while(filenames.size() > _reduceTarget)
-			{
-				
-				std::vector<string> currentFiles;
-				for(int ii=0; ii<_chunksize; ii++)
-				{
-					currentFiles.push_back(filenames.back()); filenames.pop_back();
-				}
-				
-				//the new file containing the merged counts
-				std::string newfname = currentFiles[0]  + Stringify::format ("_merged_%i", _idx++) ;
-				BagFile<abundance_t> * bagf = new BagFile<abundance_t>(newfname); LOCAL(bagf);
-				Bag<abundance_t> * currentbag =  new BagCache<abundance_t> (  bagf, 10000 ); LOCAL(currentbag);
-				
-				filenames.push_back(newfname);
-				
-				std::vector<Iterator<abundance_t>*> _tmpCountIterators;
-				
-				for(int ii=0; ii< currentFiles.size(); ii++)
-				{
-					_tmpCountIterators.push_back( new IteratorFile<abundance_t> (currentFiles[ii])  );
-				}
-				std::priority_queue< ptcf, std::vector<ptcf>,ptcfcomp > pq;
-				
-				
-				//// init all iterators  ////
-				for(int ii=0; ii< _tmpCountIterators.size(); ii++)
-				{
-					_tmpCountIterators[ii]->first();
-				}
-				
-				//////   init pq ////
-				for(int ii=0; ii< _tmpCountIterators.size(); ii++)
-				{
-					if( ! _tmpCountIterators[ii]->isDone())  {
-						pq.push(ptcf(ii,_tmpCountIterators[ii]->item().value) );
-					}
-				}
-				
-				//now merge the n sorted iterators and merge their kmer counts.
-				if(pq.size() != 0)
-				{
-					//get first pointer
-					best_elem = pq.top() ; pq.pop();
-					best_p = best_elem.first;
-					previous_ab = _tmpCountIterators[best_p]->item().abundance;
-					previous_kmer = best_elem.second;
-					
-					//go forward in this list
-					_tmpCountIterators[best_p]->next();
-					if (! _tmpCountIterators[best_p]->isDone())
-					{
-						pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-					}
-					
-					while (pq.size() != 0)
-					{
-						
-						//get  first pointer
-						best_elem = pq.top() ; pq.pop();
-						best_p = best_elem.first;
-						current_ab = _tmpCountIterators[best_p]->item().abundance;
-						current_kmer = best_elem.second;
-						
-						//go forward in this list
-						_tmpCountIterators[best_p]->next();
-						if (! _tmpCountIterators[best_p]->isDone())
-						{
-							pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-						}
-						
-						
-						if(current_kmer != previous_kmer)
-						{
-							//output previous kmer
-							currentbag->insert( abundance_t(previous_kmer,previous_ab) );
-							previous_kmer = current_kmer;
-							previous_ab = current_ab;
-						}
-						else
-						{
-							//merge counter
-							previous_ab += current_ab;
-						}
-					}
-					
-					//output last one
-					currentbag->insert( abundance_t(previous_kmer,previous_ab) );
-				}
-				
 
-				currentbag->flush();
-
-				
-				//cleanup
-				
-				for(int ii=0; ii< _tmpCountIterators.size(); ii++)
-				{
-					delete _tmpCountIterators[ii];
-				}
-				
-				
-				//erase used files
-				for(int ii=0; ii< currentFiles.size(); ii++)
-				{
-					std::string fname = currentFiles[ii];
-					system::impl::System::file().remove(fname);
-				}
-				
-			}
-			
-			
-			return filenames;
-		}
-		
-		private :
-		
-		int _reduceTarget;
-		int _chunksize;
-		int _idx;
-		
-	};
-	
-	
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
+/********************************************************************************/
+/** Command filling a HashCounter with the kmers of the superkmers of a partition.
+ * Several commands fill the same table at the same time, each one reading its own
+ * blocks of superkmers. A command stops when the partition has been read or when the
+ * table is full; the kmers that did not fit in the table are kept in an overflow vector.
+ */
 template<size_t span>
-void PartitionsByHashCommand<span>:: execute ()
+class HashFillCommand : public gatb::core::tools::dp::ICommand, public system::SmartPointer
 {
-	typedef typename tools::collections::impl::Hash16<Type>::cell cell_t;
+	typedef typename Kmer<span>::Type  Type;
 
-		this->_superKstorage->openFile("r",this->_parti_num);
-	
-	this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
-	
-	CounterBuilder solidCounter;
-		
-	/** We need a map for storing part of solid kmers. */
-	//OAHash<Type> hash (_hashMemory);
-	
-	Hash16<Type> hash16 (_hashMemory/MBYTE); // now use hash 16 to ensure always finish. needs more ram than OAHash but seems faster
-	
+public:
 
-	
-	
-	// If the partition holds kmers (and not superkmers), it would be :
-	//      for (it->first(); !it->isDone(); it->next())   {  hash.increment (it->item());  }
-	
-	DEBUG (("PartitionsByHashCommand::execute:  fillsolid parti num %i  by oahash --- mem %llu  MB\n",
-			this->_parti_num,_hashMemory/MBYTE
-));
-	
-	
-	typedef tools::misc::Abundance<Type> abundance_t;
-	std::vector<string> _tmpCountFileNames;
-	
+	HashFillCommand (tools::storage::impl::SuperKmerBinFiles* superKstorage, int fileId, int kmerSize, HashCounter<Type>& table)
+		: _superKstorage(superKstorage), _fileId(fileId), _kmerSize(kmerSize), _table(table), _isFileDone(false), _buffer(0), _buffer_size(0)  {}
+
+	~HashFillCommand ()  {  if (_buffer != 0)  { FREE (_buffer); }  }
 
-		//with decompactage
-		//superk
-		int ks = this->_kmerSize;
+	void execute ()
+	{
 		Type un; un.setVal(1);
-		//size_t _shift_val = Type::getSize() -8;
-		Type kmerMask = (un << (ks*2)) - un;
-		size_t shift = 2*(ks-1);
-		
+		Type kmerMask = (un << (_kmerSize*2)) - un;
+		size_t shift = 2*(_kmerSize-1);
+
 		Type _seedk;
-		
-		int _fileId = this->_parti_num;
-		unsigned char * _buffer = 0 ;
-		unsigned int _buffer_size = 0;
-		
-		
 
-		
 		unsigned int nb_bytes_read;
-		while(this->_superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId))
+		while (_overflow.empty() && !_table.isFull())
 		{
+			if (! _superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId))  {  _isFileDone = true;  break;  }
+
 			unsigned char * ptr = _buffer;
 			u_int8_t nbK; //number of kmers in the superkmer
 			u_int8_t newbyte=0;
-			
+
 			while(ptr < (_buffer+nb_bytes_read)) //decode whole block
 			{
 				//decode a superkmer
 				nbK = *ptr; ptr++;
-				//int nb_bytes_superk = (this->_kmerSize + nbK -1 +3) /4  ;
-				
-				int rem_size = this->_kmerSize;
-				
+
+				int rem_size = _kmerSize;
+
 				Type Tnewbyte;
 				int nbr=0;
 				_seedk.setVal(0);
@@ -441,300 +308,333 @@ void PartitionsByHashCommand<span>:: execute ()
 					_seedk =  _seedk  |  (Tnewbyte  << (8*nbr)) ;
 					rem_size -= 4; nbr++;
 				}
-				
+
 				int uid = 4; //uid = nb nt used in current newbyte
-				
+
 				//reste du seed kmer
 				if(rem_size>0)
 				{
 					newbyte = *ptr ; ptr++;
 					Tnewbyte.setVal(newbyte);
-					
+
 					_seedk = ( _seedk  |  (Tnewbyte  << (8*nbr)) ) ;
 					uid = rem_size;
 				}
 				_seedk = _seedk & kmerMask;
-				
-				
-				
+
 				u_int8_t rem = nbK;
 				Type temp = _seedk;
-				Type rev_temp = revcomp(temp,this->_kmerSize);
+				Type rev_temp = revcomp(temp,_kmerSize);
 				Type newnt ;
 				Type mink;
-				
-				
+
 				//iterate over kmers of this superk
 				for (int ii=0; ii< nbK; ii++,rem--)
 				{
-					
 #ifdef NONCANONICAL
 					mink = temp;
 #else
 					mink = std::min (rev_temp, temp);
 #endif
-					
-					
-					/** We insert the kmer into the hash. */
-					hash16.insert(mink);
-					
-					
+
+					/** We insert the kmer into the hash; if the table is full, we keep it for later. */
+					if (! _table.increment (mink))  {  _overflow.push_back (mink);  }
+
 					if(rem < 2) break; //no more kmers in this superkmer, the last one has just been eaten
-					
+
 					////////now decode next kmer of this superkmer ///////
-					
+
 					if(uid>=4) //read next byte
 					{
 						newbyte = *ptr ; ptr++;
 						Tnewbyte.setVal(newbyte);
 						uid =0;
 					}
-					
+
 					newnt = (Tnewbyte >> (2*uid))& 3; uid++;
 					temp = ((temp << 2 ) |  newnt   ) & kmerMask;
-					
+
 					newnt.setVal(comp_NT[newnt.getVal()]) ;
 					rev_temp = ((rev_temp >> 2 ) |  (newnt << shift) ) & kmerMask;
 				}
-				
+
 				//now go to next superk of this block, ptr should point to beginning of next superk
 			}
-			
-			//check if hashtable is getting too big : in that case dump it disk and resume with the emptied hashtable
-			//at the end merge-sort all the dumped files with the content of hash table
-			if(hash16.getByteSize() > _hashMemory) // to be improved (can be slightly larger than maxmemory by a block size)
-				//if(_tmpCountFileNames.size()<20) //force  dumps for testing
+		}
+	}
+
+	/** Tell whether the command stopped because there are no more superkmers to read. */
+	bool isFileDone () const  { return _isFileDone; }
+
+	/** Kmers that could not be inserted in the table. */
+	std::vector<Type>& getOverflow ()  { return _overflow; }
+
+private:
+
+	tools::storage::impl::SuperKmerBinFiles* _superKstorage;
+	int                _fileId;
+	int                _kmerSize;
+	HashCounter<Type>& _table;
+	bool               _isFileDone;
+	std::vector<Type>  _overflow;
+
+	unsigned char* _buffer;
+	unsigned int   _buffer_size;
+};
+
+/********************************************************************************/
+/** Command merging the counts of one range of kmer values: the runs dumped on disk for
+ * this range and the items of the (sorted) hash table in this range are merged with a
+ * loser tree into a single sorted file, occurrences of a same kmer being summed.
+ * Several such commands are run at the same time, one per range.
+ */
+template<size_t span>
+class HashMergeCommand : public gatb::core::tools::dp::ICommand, public system::SmartPointer
+{
+	typedef typename Kmer<span>::Type              Type;
+	typedef typename HashCounter<Type>::Count      Count;
+
+	/** Order of the counts by kmer value. */
+	struct CountLess  {  bool operator() (const Count& a, const Count& b) const  { return a.value < b.value; }  };
+
+public:
+
+	HashMergeCommand (const std::vector<std::string>& runs, HashCounter<Type>& table, u_int64_t begin, u_int64_t end, const std::string& outputName)
+		: _runs(runs), _table(table), _begin(begin), _end(end), _outputName(outputName)  {}
+
+	void execute ()
+	{
+		/** Too many runs would need too many opened files: we merge them by chunks first. */
+		std::vector<std::string> runs = _runs;
+		for (size_t idx=0; runs.size() > MAX_MERGED_RUNS; idx++)
+		{
+			std::vector<std::string> chunk (runs.begin(), runs.begin() + MAX_MERGED_RUNS);
+			runs.erase (runs.begin(), runs.begin() + MAX_MERGED_RUNS);
+
+			std::string name = _outputName + Stringify::format ("_merged_%d", idx);
+			merge (chunk, 0, name);
+			runs.push_back (name);
+		}
+
+		merge (runs, _table.iterator (_begin, _end), _outputName);
+	}
+
+private:
+
+	static const size_t MAX_MERGED_RUNS = 16;
+
+	std::vector<std::string> _runs;
+	HashCounter<Type>&       _table;
+	u_int64_t                _begin;
+	u_int64_t                _end;
+	std::string              _outputName;
+
+	/** Merge runs files (and possibly another sorted iterator) into a file; the runs files are removed. */
+	void merge (const std::vector<std::string>& runs, Iterator<Count>* other, const std::string& outputName)
+	{
+		{
+			std::vector<Iterator<Count>*> iterators;
+			for (size_t i=0; i<runs.size(); i++)  {  iterators.push_back (new IteratorFile<Count> (runs[i]));  }
+			if (other != 0)  {  iterators.push_back (other);  }
+
+			MergeIterator<Count,CountLess>* itMerge = new MergeIterator<Count,CountLess> (iterators);
+			LOCAL (itMerge);
+
+			BagFile<Count>* bagf = new BagFile<Count> (outputName);  LOCAL (bagf);
+			Bag<Count>*     bag  = new BagCache<Count> (bagf, 10000);  LOCAL (bag);
+
+			Count current;
+			bool  hasCurrent = false;
+
+			for (itMerge->first(); !itMerge->isDone(); itMerge->next())
 			{
-				//printf("splitting into subparts %lli KB / %lli KB  parti %i subpart %i \n",hash16.getByteSize()/1024,_hashMemory/1024 ,this->_parti_num,_tmpCountFiles.size()  );
-				//dump partial count to disk file
-				
-				
-				Iterator < cell_t >* itKmerAbundancePartial = hash16.iterator(true);
-				LOCAL (itKmerAbundancePartial);
-				
-				
-				std::string fname = this->_superKstorage->getFileName(this->_parti_num) + Stringify::format ("_subpart_%i", _tmpCountFileNames.size()) ;
-				_tmpCountFileNames.push_back(fname);
-				
-				BagFile<abundance_t> * bagf = new BagFile<abundance_t>(fname); LOCAL(bagf);
-				Bag<abundance_t> * currentbag =  new BagCache<abundance_t> (  bagf, 10000 ); LOCAL(currentbag);
-				
-				
-				for (itKmerAbundancePartial->first(); !itKmerAbundancePartial->isDone(); itKmerAbundancePartial->next())
+				const Count& count = itMerge->item();
+
+				if (hasCurrent && count.value == current.value)  {  current.abundance += count.abundance;  }
+				else
 				{
-					cell_t & cell = itKmerAbundancePartial->item();
-					currentbag->insert( abundance_t(cell.graine,cell.val) );
+					if (hasCurrent)  { bag->insert (current); }
+					current    = count;
+					hasCurrent = true;
 				}
-				
-				currentbag->flush();			
-				hash16.clear();
 			}
+			if (hasCurrent)  { bag->insert (current); }
+
+			bag->flush();
 		}
-		
-		
-		if(_buffer!=0)
-			free(_buffer);
-	
-	
 
-	/** We loop over the solid kmers map.
-	 * NOTE !!! we want the items to be sorted by kmer values (see finalize part of debloom). */
-	//Iterator < Abundance<Type> >* itKmerAbundance = hash.iterator(true);
-	//shortcut
-	Iterator < cell_t >* itKmerAbundance = hash16.iterator(true);
-	LOCAL (itKmerAbundance);
-	
-	
-	//now merge sort over current hash and over the sorted _tmpCountFiles
-	// : simple merge sort of n sorted iterators
-	
-	if(_tmpCountFileNames.size()!=0)
+		for (size_t i=0; i<runs.size(); i++)  {  system::impl::System::file().remove (runs[i]);  }
+	}
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : Dump the content of the hash table in a new run on disk and clear the table.
+** INPUT   : table : the full hash table
+**           splitters : kmer values splitting the partition into ranges (set by the first run)
+**           runs : for each range, the files of the runs dumped so far
+** OUTPUT  :
+** RETURN  :
+** REMARKS : each run is split in one file per range, so that the ranges can be merged
+**           independently
+*********************************************************************/
+template<size_t span>
+void PartitionsByHashCommand<span>::dumpRun (HashCounter<Type>& table, std::vector<Type>& splitters, std::vector<std::vector<std::string> >& runs)
+{
+	typedef typename HashCounter<Type>::Count Count;
+
+	u_int64_t          nbItems = table.sort();
+	const Type*        keys    = table.getKeys();
+	const CountNumber* counts  = table.getCounts();
+
+	/** The first run gives the kmer values splitting the partition into ranges of similar sizes
+	 * (the first run is a random sample of the kmers of the partition). */
+	if (splitters.size()+1 < runs.size() && nbItems > 0)
 	{
-		
-		TempCountFileMerger<span> tempCountFileMerger (10,10);
-		//will merge by chunk of 10 files at a time, until reach less than 10 files
-		_tmpCountFileNames = tempCountFileMerger.mergeFiles(_tmpCountFileNames);
-		//then will use code below to merge remaining files with the contents of the hash table
+		for (size_t r=1; r<runs.size(); r++)  {  splitters.push_back (keys[r*nbItems/runs.size()]);  }
+	}
 
-		std::vector<Iterator<abundance_t>*> _tmpCountIterators;
+	u_int64_t i = 0;
+	for (size_t r=0; r<runs.size(); r++)
+	{
+		std::string fname = this->_superKstorage->getFileName(this->_parti_num) + Stringify::format ("_subpart_%d_%d", runs[r].size(), r);
+		runs[r].push_back (fname);
 
-		//how to make sure there are not too many subpart files ?  and that we'll not reach the max open files limit ?
-		//we *could* merge  only some of them at a time ..  todo ?  --> done with TempCountFileMerger above
-		for(int ii=0; ii< _tmpCountFileNames.size(); ii++)
-		{
-			std::string fname = _tmpCountFileNames[ii];
-			_tmpCountIterators.push_back( new IteratorFile<abundance_t> (fname)  );
-		}
-	
-		// Note (guillaume) : code below is ugly because I have to manage itKmerAbundance (iterator over cell_t)
-		// and _tmpCountIterators (iterators over abundance_t) differently since they have different types
-		// I would have liked to transform  Iterator<cell_t>  to an Iterator<abundance_t>   with the following adaptor :
-		//
-		// 		struct cell2AbAdaptor  {  abundance_t operator() (cell_t& c)  { return abundance_t(c.graine,c.val) ; }  };
-		//Iterator<abundance_t>*   hashAbundance  = new IteratorAdaptor<cell_t,abundance_t,cell2AbAdaptor> (itKmerAbundance);
-	    //	but it turns out to be impossible because of the return by reference of the   item()  function.
-		//  Another solution would be to dump contents of hash to a file then read it, but inefficient
-		//  So, ugly code it is.  (see all the if(best_p==-1) below)
-		
-		
-		//setup the priority queue for merge sorting
-		typedef std::pair< int , Type> ptcf; //  id pointer , kmer value
-		struct ptcfcomp { bool operator() (ptcf l,ptcf r) { return ((r.second) < (l.second)); } } ;
-		std::priority_queue< ptcf, std::vector<ptcf>,ptcfcomp > pq;
-
-		//// init all iterators  ////
-		itKmerAbundance->first();
-		for(int ii=0; ii< _tmpCountIterators.size(); ii++)
-		{
-			_tmpCountIterators[ii]->first();
-		}
-		
-		//////   init pq ////
+		BagFile<Count>* bagf = new BagFile<Count> (fname);  LOCAL (bagf);
+		Bag<Count>*     bag  = new BagCache<Count> (bagf, 10000);  LOCAL (bag);
 
-		if(!itKmerAbundance->isDone())
-		{
-			pq.push(ptcf(-1,itKmerAbundance->item().graine) ); // -1  will mean in the  itKmerAbundance
-		}
-		
-		for(int ii=0; ii< _tmpCountIterators.size(); ii++)
+		for ( ; i<nbItems && (r >= splitters.size() || keys[i] < splitters[r]); i++)  {  bag->insert (Count (keys[i], counts[i]));  }
+
+		bag->flush();
+	}
+
+	table.clear();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the partition is counted by _nbCores threads filling a concurrent hash table.
+**           When the table is full, it is dumped on disk (sorted) and cleared; at the end,
+**           the runs and the table content are merged, one range of kmer values per thread.
+*********************************************************************/
+template<size_t span>
+void PartitionsByHashCommand<span>:: execute ()
+{
+	typedef typename HashCounter<Type>::Count Count;
+
+	this->_superKstorage->openFile("r",this->_parti_num);
+
+	this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
+
+	CounterBuilder solidCounter;
+
+	DEBUG (("PartitionsByHashCommand::execute:  fillsolid parti num %i  by hash --- mem %llu  MB\n",
+			this->_parti_num,_hashMemory/MBYTE
+	));
+
+	HashCounter<Type> table (_hashMemory);
+
+	Dispatcher dispatcher (this->_nbCores);
+
+	/** Kmer values splitting the partition into ranges and runs dumped on disk for each range. */
+	std::vector<Type>                       splitters;
+	std::vector<std::vector<std::string> >  runs (this->_nbCores);
+
+	std::vector<Type> pending;
+	bool isFileDone = false;
+
+	while (!isFileDone || !pending.empty())
+	{
+		/** We insert the kmers that did not fit in the table during the previous round. */
+		for (size_t i=0; i<pending.size(); i++)
 		{
-			if( ! _tmpCountIterators[ii]->isDone())  {
-				abundance_t &ab = _tmpCountIterators[ii]->item();
-				pq.push(ptcf(ii,ab.value) );
-			}
+			if (! table.increment (pending[i]))  {  dumpRun (table, splitters, runs);  table.increment (pending[i]);  }
 		}
-		
-		ptcf best_elem;
-		int best_p;
-		int current_ab = 0;
-		int previous_ab = 0;
-		Type current_kmer,previous_kmer;
-		
-	
-	    //now merge the n sorted iterators and merge their kmer counts.
-		if(pq.size() != 0)
+		pending.clear();
+
+		if (!isFileDone)
 		{
-			//get first pointer
-			best_elem = pq.top() ; pq.pop();
-			best_p = best_elem.first;
-			if(best_p==-1)
-			{
-				previous_ab = itKmerAbundance->item().val;
-			}
-			else
+			std::vector<HashFillCommand<span>*> fillers;
+			std::vector<ICommand*>              cmds;
+			for (size_t t=0; t<this->_nbCores; t++)
 			{
-				previous_ab = _tmpCountIterators[best_p]->item().abundance;
+				HashFillCommand<span>* cmd = new HashFillCommand<span> (this->_superKstorage, this->_parti_num, this->_kmerSize, table);
+				cmd->use();
+				fillers.push_back (cmd);
+				cmds.push_back    (cmd);
 			}
-			
-			previous_kmer = best_elem.second;
 
-			//go forward in this list
+			dispatcher.dispatchCommands (cmds, 0);
 
-			if(best_p==-1)
+			for (size_t t=0; t<fillers.size(); t++)
 			{
-				itKmerAbundance->next();
-				if (! itKmerAbundance->isDone())
-				{
-					pq.push(ptcf(-1,itKmerAbundance->item().graine) );
-				}
+				isFileDone = isFileDone || fillers[t]->isFileDone();
+				pending.insert (pending.end(), fillers[t]->getOverflow().begin(), fillers[t]->getOverflow().end());
+				fillers[t]->forget();
 			}
-			else
-			{
-				_tmpCountIterators[best_p]->next();
-				if (! _tmpCountIterators[best_p]->isDone())
-				{
-					pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-				}
-			}
-			
-			while (pq.size() != 0)
-			{
-				
-				//get  first pointer
-				best_elem = pq.top() ; pq.pop();
-				best_p = best_elem.first;
-				
-				if(best_p==-1)
-				{
-					current_ab = itKmerAbundance->item().val;
-				}
-				else
-				{
-					current_ab = _tmpCountIterators[best_p]->item().abundance;
-				}
-				current_kmer = best_elem.second;
-				
-				//go forward in this list
-				if(best_p==-1)
-				{
-					itKmerAbundance->next();
-					if (! itKmerAbundance->isDone())
-					{
-						pq.push(ptcf(-1,itKmerAbundance->item().graine) );
-					}
-				}
-				else
-				{
-					_tmpCountIterators[best_p]->next();
-					if (! _tmpCountIterators[best_p]->isDone())
-					{
-						pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-					}
-				}
+		}
 
-				if(current_kmer != previous_kmer)
-				{
-					//output previous kmer
-					solidCounter.set (previous_ab);
-					this->insert (previous_kmer, solidCounter);
-					previous_kmer = current_kmer;
-					previous_ab = current_ab;
-				}
-				else
-				{
-					//merge counter
-					previous_ab += current_ab;
-				}
-				
-			}
+		/** The table is full: we dump it on disk and go on with an empty table. */
+		if (!isFileDone || !pending.empty())  {  dumpRun (table, splitters, runs);  }
+	}
 
-			//output last one
-			solidCounter.set (previous_ab);
-			this->insert (previous_kmer, solidCounter);
-		}
-		
+	this->_superKstorage->closeFile(this->_parti_num);
 
-		//cleanup
-		for(int ii=0; ii< _tmpCountIterators.size(); ii++)
-		{
-			delete _tmpCountIterators[ii];
-		}
-		
-		
-		//erase sub files
-		for(int ii=0; ii< _tmpCountFileNames.size(); ii++)
+	/** NOTE !!! we want the items to be sorted by kmer values (see finalize part of debloom). */
+	u_int64_t          nbItems = table.sort();
+	const Type*        keys    = table.getKeys();
+	const CountNumber* counts  = table.getCounts();
+
+	if (runs[0].empty())
+	{
+		/** No run on disk: the table holds all the counts. */
+		for (u_int64_t i=0; i<nbItems; i++)
 		{
-			std::string fname = _tmpCountFileNames[ii];
-			system::impl::System::file().remove(fname);
+			solidCounter.set (counts[i]);
+			this->insert (keys[i], solidCounter);
 		}
-		
 	}
-	else // in that case no merging needed, just iterate the hash table and output kmer counts
+	else
 	{
-		for (itKmerAbundance->first(); !itKmerAbundance->isDone(); itKmerAbundance->next())
+		/** We merge each range of kmer values in its own thread, then give the merged ranges
+		 * to the count processor in order. */
+		std::vector<std::string> merged;
+		std::vector<ICommand*>   cmds;
+
+		u_int64_t begin = 0;
+		for (size_t r=0; r<runs.size(); r++)
 		{
-			
-			cell_t & cell = itKmerAbundance->item();
-			solidCounter.set (cell.val);
-			this->insert (cell.graine, solidCounter);
+			u_int64_t end = r < splitters.size() ? std::lower_bound (keys+begin, keys+nbItems, splitters[r]) - keys : nbItems;
+
+			merged.push_back (this->_superKstorage->getFileName(this->_parti_num) + Stringify::format ("_range_%d", r));
+			cmds.push_back (new HashMergeCommand<span> (runs[r], table, begin, end, merged.back()));
+
+			begin = end;
+		}
+
+		dispatcher.dispatchCommands (cmds, 0);
+
+		for (size_t r=0; r<merged.size(); r++)
+		{
+			{
+				IteratorFile<Count> itMerged (merged[r]);
+				for (itMerged.first(); !itMerged.isDone(); itMerged.next())
+				{
+					solidCounter.set (itMerged.item().abundance);
+					this->insert (itMerged.item().value, solidCounter);
+				}
+			}
+			system::impl::System::file().remove (merged[r]);
 		}
 	}
 
-	
-	this->_superKstorage->closeFile(this->_parti_num);
-	
 	this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) ); // this->_pInfo->getNbKmer(this->_parti_num)  kmers.size()
-	
+
+	this->flush ();
 	this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
 
@@ -1124,7 +1024,7 @@ public:
 		}
 		
 		if(_buffer!=0)
-			free(_buffer);
+			FREE(_buffer);
 	}
 private:
 	tools::storage::impl::SuperKmerBinFiles* _superKstorage;
@@ -1235,6 +1135,7 @@ void PartitionsByVectorCommand<span>::execute ()
     /** We update the progress bar. */
     this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) );
 
+    this->flush ();
     this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
 
@@ -1399,46 +1300,19 @@ public:
     /** */
     void execute ()
     {
-        vector<size_t> idx;
-        vector<Tmp>    tmp;
-
         for (int ii=_deb; ii <=_fin; ii++)
         {
             if (_radix_sizes[ii] > 0)
             {
-                /** Shortcuts. */
-                Type* kmers = _radix_kmers  [ii];
-
+                /** Kmers are sorted with a radix sort; in multibank mode the bank ids
+                 * are moved along with the kmers. */
                 if (_bankIdMatrix)
                 {
-                    /** NOT OPTIMAL AT ALL... in particular we have to use 'idx' and 'tmp' vectors
-                     * which may use (a lot of ?) memory. */
-
-                    /** Shortcut. */
-                    bank::BankIdType* banksId = _bankIdMatrix [ii];
-
-                    /** NOTE: we sort the indexes, not the items. */
-                    idx.resize (_radix_sizes[ii]);
-                    for (size_t i=0; i<idx.size(); i++)  { idx[i]=i; }
-
-                    std::sort (idx.begin(), idx.end(), Cmp(kmers));
-
-                    /** Now, we have to reorder the two provided vectors with the same order. */
-                    tmp.resize (idx.size());
-                    for (size_t i=0; i<idx.size(); i++)
-                    {
-                        tmp[i].kmer = kmers  [idx[i]];
-                        tmp[i].id   = banksId[idx[i]];
-                    }
-                    for (size_t i=0; i<idx.size(); i++)
-                    {
-                        kmers  [i] = tmp[i].kmer;
-                        banksId[i] = tmp[i].id;
-                    }
+                    RadixSort<Type,bank::BankIdType>::sort (_radix_kmers[ii], _bankIdMatrix[ii], _radix_sizes[ii]);
                 }
                 else
                 {
-                    std::sort (&kmers[0] , &kmers[ _radix_sizes[ii]]);
+                    RadixSort<Type>::sort (_radix_kmers[ii], _radix_sizes[ii]);
                 }
             }
         }
@@ -1446,15 +1320,6 @@ public:
 
 private :
 
-    struct Tmp { Type kmer;  bank::BankIdType id;};
-
-    struct Cmp
-    {
-        Type* _kmers;
-        Cmp (Type* kmers) : _kmers(kmers) {}
-        bool operator() (size_t a, size_t b)  { return _kmers[a] < _kmers[b]; }
-    };
-
     int        _deb;
     int        _fin;
     Type**     _radix_kmers;
@@ -1475,32 +1340,25 @@ void PartitionsByVectorCommand<span>::executeSort ()
 {
     TIME_INFO (this->_timeInfo, "2.sort");
 
-    vector<ICommand*> cmds;
+    /** The radix buckets of all the kxmer sizes are split into one range per core, each range
+     * holding roughly the same number of items, so a skewed radix distribution doesn't leave
+     * threads idle (the dispatcher uses one thread per command). */
+    vector<pair<int,int> > ranges;
+    this->_pInfo.getRadixRanges (this->_parti_num, this->_nbCores, ranges);
 
-    int nwork = 256 / this->_nbCores;
+    vector<ICommand*> cmds;
 
-    for (size_t xx=0; xx < (KX+1); xx++)
+    for (size_t r=0; r<ranges.size(); r++)
     {
-        cmds.clear();
-
-        //fill cmd work vector
-        for (size_t tid=0; tid < this->_nbCores; tid++)
-        {
-            int deb = 0 + tid * nwork;
-            int fin = (tid+1) * nwork -1; // thread will do inclusive range [begin -- end ]
-            if(tid == this->_nbCores-1)  { fin = 255; }
-
-            // mettre dans le  SortCommand le master radix_kmers et range a traiter
-            cmds.push_back (new SortCommand<span> (
-                _radix_kmers+ IX(xx,0),
-                (_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
-                deb, fin,
-                _radix_sizes + IX(xx,0)
-            ));
-        }
-
-        _dispatcher->dispatchCommands (cmds, 0);
+        cmds.push_back (new SortCommand<span> (
+            _radix_kmers,
+            _bankIdMatrix,
+            ranges[r].first, ranges[r].second,
+            _radix_sizes
+        ));
     }
+
+    _dispatcher->dispatchCommands (cmds, 0);
 }
 
 /*********************************************************************
@@ -1821,10 +1679,11 @@ PartitionsByVectorCommand_multibank<span>:: PartitionsByVectorCommand_multibank
 																				 size_t              nbCores,
 																				 size_t              kmerSize,
 																				 MemAllocator&       pool,
-																				 vector<size_t>&     offsets
+																				 const PartitionRuns& runs,
+																				 size_t              nbBanks
 																				 )
 : PartitionsCommand_multibank<span> (partition, processor, cacheSize,  progress, timeInfo, pInfo, passi, parti,nbCores,kmerSize,pool),
-_radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _nbItemsPerBankPerPart(offsets)
+_radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _runs(runs), _nbBanks(nbBanks)
 {
 	_dispatcher = new Dispatcher (this->_nbCores);
 }
@@ -1866,7 +1725,7 @@ void PartitionsByVectorCommand_multibank<span>::execute ()
 	_r_idx        = (uint64_t*)  CALLOC (256*(KX+1),sizeof(uint64_t));
 	
 	/** We need extra information for kmers counting in case of several input banks. */
-	if (_nbItemsPerBankPerPart.size() > 1) { _bankIdMatrix = (bank::BankIdType**) MALLOC (256*(KX+1)*sizeof(bank::BankIdType*)); }
+	if (_nbBanks > 1)                      { _bankIdMatrix = (bank::BankIdType**) MALLOC (256*(KX+1)*sizeof(bank::BankIdType*)); }
 	else                                   { _bankIdMatrix = 0; }
 	
 	/** We have 3 phases here: read, sort and dump. */
@@ -1883,6 +1742,7 @@ void PartitionsByVectorCommand_multibank<span>::execute ()
 	/** We update the progress bar. */
 	this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) );
 	
+	this->flush ();
 	this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
 
@@ -1893,17 +1753,18 @@ void PartitionsByVectorCommand_multibank<span>::executeRead ()
 	
 
 	
-	/** Recall that the attribute _offsets has a size equals to the number of banks + 1 as input
-	 * and for each bank, it holds the number of items found for the currently processed partition.
+	/** Recall that the attribute _runs gives the content of the currently processed partition
+	 * as runs of items of a same bank (a bank may have several runs if the banks were read at the
+	 * same time):
 	 *
-	 *               bank0   bank1   ...   bankI
-	 *   offsets :    xxx     xxx           xxx
-	 *               <------------------------->
-	 *                current partition content
+	 *               bankI   bankJ   bankI  ...  bankK
+	 *   runs :       xxx     xxx     xxx         xxx
+	 *               <-------------------------------->
+	 *                   current partition content
 	 */
 	
- DEBUG (("_offsets.size=%d  OFFSETS: ", _nbItemsPerBankPerPart.size() ));
- for (size_t j=0; j<_nbItemsPerBankPerPart.size(); j++)  {  DEBUG (("%6d ", _nbItemsPerBankPerPart[j]));  }  DEBUG (("\n"));
+ DEBUG (("_runs.size=%d  RUNS: ", _runs.size() ));
+ for (size_t j=0; j<_runs.size(); j++)  {  DEBUG (("%d:%6d ", _runs[j].first, _runs[j].second));  }  DEBUG (("\n"));
 	
 	uint64_t sum_nbxmer =0;
 	
@@ -1956,8 +1817,8 @@ void PartitionsByVectorCommand_multibank<span>::executeRead ()
 	/** HOW TO COUNT KMERS BY SET OF READS ?
 	 * Now, we are going to read the temporary partition built during the previous phase and fill
 	 * the _radix_kmers attribute. We also need to know in _radix_kmers what is the contribution of
-	 * each bank. We therefore need to iterate the current partition by bank (using the information
-	 * of _offsets). */
+	 * each bank. We therefore need to iterate the current partition by run of a same bank (using the
+	 * information of _runs). */
 	
 	if (_bankIdMatrix)
 	{
@@ -1965,16 +1826,20 @@ void PartitionsByVectorCommand_multibank<span>::executeRead ()
 		Iterator<Type>* itGlobal = this->_partition.iterator();
 		LOCAL (itGlobal);
 		
-		/** We iterate the banks. */
-		for (size_t b=0; b<_nbItemsPerBankPerPart.size(); b++)
+		/** We iterate the runs. */
+		for (size_t r=0; r<_runs.size(); r++)
 		{
 			/** We truncate the global iterator.
-			 * NB : we initialize (ie call 'first') the global iterator only at first call (for b==0). */
-			Iterator<Type>* itLocal = new TruncateIterator<Type> (*itGlobal, _nbItemsPerBankPerPart[b], b==0 ? true : false);
+			 * NB : we initialize (ie call 'first') the global iterator only at first call (for r==0). */
+			Iterator<Type>* itLocal = new TruncateIterator<Type> (*itGlobal, _runs[r].second, r==0 ? true : false);
 			LOCAL (itLocal);
 			
-			/** We iterate this local iterator. */
-			_dispatcher->iterate (itLocal, SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, b), 10000); //must be even , reading by pairs
+			SuperKReader<span> reader (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, _runs[r].first);
+
+			/** We iterate this local iterator; small runs (banks read at the same time) are read
+			 * by the current thread, which avoids launching threads for each run. */
+			if (_runs[r].second < 10000 * this->_nbCores)  {  for (itLocal->first(); !itLocal->isDone(); itLocal->next())  {  reader (itLocal->item());  }  }
+			else                                            {  _dispatcher->iterate (itLocal, reader, 10000);  } //must be even , reading by pairs
 		}
 		
 		/** We check that the global iterator is finished. */
@@ -2040,7 +1905,7 @@ void PartitionsByVectorCommand_multibank<span>::executeDump ()
 	
 	std::priority_queue< kxp, std::vector<kxp>,kxpcomp > pq;
 	
-	size_t nbBanks = _nbItemsPerBankPerPart.size();
+	size_t nbBanks = _nbBanks;
 	if (nbBanks == 0) nbBanks = 1;
 	
 	CounterBuilder solidCounter (nbBanks);
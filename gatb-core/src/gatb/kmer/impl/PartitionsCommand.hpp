@@ -25,6 +25,7 @@
 #include <gatb/bank/api/IBank.hpp>
 
 #include <gatb/kmer/impl/PartiInfo.hpp>
+#include <gatb/kmer/impl/HashCounter.hpp>
 #include <gatb/kmer/api/ICountProcessor.hpp>
 
 #include <gatb/tools/collections/api/Iterable.hpp>
@@ -150,6 +151,13 @@ protected:
 	
     void insert (const Type& kmer, const CounterBuilder& count);
 
+    /** Send the kmers buffered by 'insert' to the count processor; must be called before 'endPart'. */
+    void flush ();
+
+    /** Kmers (and their counts, nbBanks per kmer) waiting to be sent to the count processor. */
+    std::vector<Type>        _batchKmers;
+    std::vector<CountNumber> _batchCounts;
+
     tools::misc::impl::TimeInfo& _globalTimeInfo;
     tools::misc::impl::TimeInfo  _timeInfo;
 
@@ -197,6 +205,9 @@ public:
 
 private:
     u_int64_t _hashMemory;
+
+    /** Dump the content of the (full) hash table on disk and clear it. */
+    void dumpRun (HashCounter<Type>& table, std::vector<Type>& splitters, std::vector<std::vector<std::string> >& runs);
 };
 		
 /********************************************************************************/
@@ -320,6 +331,13 @@ protected:
 	gatb::core::tools::misc::impl::MemAllocator&            _pool;
 	
 	void insert (const Type& kmer, const CounterBuilder& count);
+
+	/** Send the kmers buffered by 'insert' to the count processor; must be called before 'endPart'. */
+	void flush ();
+
+	/** Kmers (and their counts, nbBanks per kmer) waiting to be sent to the count processor. */
+	std::vector<Type>        _batchKmers;
+	std::vector<CountNumber> _batchCounts;
 	
 	tools::misc::impl::TimeInfo& _globalTimeInfo;
 	tools::misc::impl::TimeInfo  _timeInfo;
@@ -360,7 +378,8 @@ public:
 										 size_t                                          nbCores,
 										 size_t                                          kmerSize,
 										 gatb::core::tools::misc::impl::MemAllocator&    pool,
-										 std::vector<size_t>&                            offsets
+										 const PartitionRuns&                            runs,
+										 size_t                                          nbBanks
 										 );
 	
 	/** Destructor. */
@@ -385,7 +404,9 @@ private:
 	void executeSort   ();
 	void executeDump   ();
 	
-	std::vector<size_t> _nbItemsPerBankPerPart;
+	/** Runs of items of each bank in the partition, and number of banks. */
+	PartitionRuns _runs;
+	size_t        _nbBanks;
 };
 /********************************************************************************/
 } } } } /* end of namespaces. */
@@ -0,0 +1,169 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file RadixSort.hpp
+ *  \brief In-place MSD radix sort of kmers, with an optional companion array
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_
+#define _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <algorithm>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief In-place most significant digit radix sort of kmers.
+ *
+ * The sort works on Kmer<span>::Type values (ie. LargeInt<N>), using one byte as digit
+ * (see LargeInt::getByte), so the words of a LargeInt are processed one after the other
+ * from the most significant one. Each level permutes the items in place (american flag
+ * sort) and small buckets are finished by an insertion sort.
+ *
+ * An optional companion array (for instance the bank ids of the kmers in multibank mode)
+ * may be provided; its items are moved along with the kmers.
+ *
+ * Example:
+ * \code
+ *   RadixSort<Type>::sort (kmers, nbKmers);
+ *   RadixSort<Type,bank::BankIdType>::sort (kmers, banksId, nbKmers);
+ * \endcode
+ */
+template<typename Type, typename Companion=u_int8_t>
+class RadixSort
+{
+public:
+
+    /** Sort an array of kmers.
+     * \param[in] items : the kmers to be sorted
+     * \param[in] nb : number of kmers */
+    static void sort (Type* items, size_t nb)  {  sort (items, (Companion*)0, nb);  }
+
+    /** Sort an array of kmers and reorder a companion array in the same way.
+     * \param[in] items : the kmers to be sorted
+     * \param[in] companion : array of nb items moved like the kmers (may be null)
+     * \param[in] nb : number of kmers */
+    static void sort (Type* items, Companion* companion, size_t nb)
+    {
+        if (nb < 2)  { return; }
+
+        /** We look for the most significant non null byte of the whole array; in DSK
+         * the upper bytes of the kmers are often 0 (k smaller than the span). */
+        Type all = items[0];
+        for (size_t i=1; i<nb; i++)  {  all = all | items[i];  }
+
+        int digit = Type::getSize()/8 - 1;
+        while (digit > 0 && all.getByte(digit) == 0)  { digit--; }
+
+        sortDigit (items, companion, nb, digit);
+    }
+
+private:
+
+    /** Buckets smaller than this are sorted by insertion. */
+    static const size_t INSERTION_THRESHOLD = 32;
+
+    /** */
+    static void swapItems (Type* items, Companion* companion, size_t a, size_t b)
+    {
+        std::swap (items[a], items[b]);
+        if (companion)  { std::swap (companion[a], companion[b]); }
+    }
+
+    /** */
+    static void insertionSort (Type* items, Companion* companion, size_t nb)
+    {
+        for (size_t i=1; i<nb; i++)
+        {
+            Type      k = items[i];
+            Companion c = companion ? companion[i] : Companion();
+            size_t    j = i;
+
+            for ( ; j>0 && k < items[j-1]; j--)
+            {
+                items[j] = items[j-1];
+                if (companion)  { companion[j] = companion[j-1]; }
+            }
+
+            items[j] = k;
+            if (companion)  { companion[j] = c; }
+        }
+    }
+
+    /** Sort the items on the given byte and recurse on each bucket with the next byte. */
+    static void sortDigit (Type* items, Companion* companion, size_t nb, int digit)
+    {
+        for (;;)
+        {
+            if (nb <= INSERTION_THRESHOLD)  {  insertionSort (items, companion, nb);  return;  }
+
+            size_t count[256];
+            for (size_t b=0; b<256; b++)  { count[b] = 0; }
+            for (size_t i=0; i<nb; i++)   { count[items[i].getByte(digit)] ++; }
+
+            /** All the items share the same digit (typically the radix of the DSK bucket):
+             * nothing to permute, we go directly to the next digit. */
+            if (count[items[0].getByte(digit)] == nb)
+            {
+                if (digit == 0)  { return; }
+                digit--;
+                continue;
+            }
+
+            size_t head[256];
+            size_t tail[256];
+            size_t offset = 0;
+            for (size_t b=0; b<256; b++)  {  head[b] = offset;  offset += count[b];  tail[b] = offset;  }
+
+            /** In place permutation: each item is moved to its bucket by following cycles. */
+            for (size_t b=0; b<256; b++)
+            {
+                while (head[b] < tail[b])
+                {
+                    u_int8_t d = items[head[b]].getByte(digit);
+                    if (d == b)  { head[b]++; }
+                    else         { swapItems (items, companion, head[b], head[d]++); }
+                }
+            }
+
+            if (digit == 0)  { return; }
+
+            offset = 0;
+            for (size_t b=0; b<256; b++)
+            {
+                if (count[b] > 1)  {  sortDigit (items+offset, companion ? companion+offset : 0, count[b], digit-1);  }
+                offset += count[b];
+            }
+            return;
+        }
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_ */
@@ -150,7 +150,8 @@ public:
         SuperKmer superKmer (_kmersize, _miniSize);
 
 		//iteration et traitement au fil de l'eau, without large kmer buffer (only small buffer for superkmer now )
-		_model.iterate(sequence.getData(), KmerFunctor<KmerType>(this,superKmer,maxs));
+		//the minimizers of the whole sequence are computed in bulk
+		_model.iterateBulk(sequence.getData(), KmerFunctor<KmerType>(this,superKmer,maxs), _minimizersBuffer);
 		
         //output last superK
         processSuperkmer (superKmer);
@@ -197,6 +198,9 @@ protected:
     BankStats&       _bankStatsGlobal;
     BankStats        _bankStatsLocal;
 
+    /** Work buffers for computing the minimizers of a sequence. */
+    typename Model::MinimizersBuffer _minimizersBuffer;
+
     /** Primitive of the template method operator() */
     virtual void processSuperkmer (SuperKmer& superKmer) { _nbSuperKmers++; }
 };
@@ -30,6 +30,7 @@
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/bank/impl/Bank.hpp>
+#include <gatb/bank/impl/BankComposite.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
 #include <cmath>
 
@@ -95,7 +96,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0), _tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0), _tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0),_superKstorageNext(0), _nbCoresFill(0), _nbCoresCount(0), _nbOversizedParts(0)
 {
 }
 
@@ -111,7 +112,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IBank* bank, IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0),_superKstorageNext(0), _nbCoresFill(0), _nbCoresCount(0), _nbOversizedParts(0)
 {
     setBank (bank);
 }
@@ -135,7 +136,7 @@ SortingCountAlgorithm<span>::SortingCountAlgorithm (
 )
   : Algorithm("dsk", config._nbCores, params),
     _config(config), _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0),_superKstorageNext(0), _nbCoresFill(0), _nbCoresCount(0), _nbOversizedParts(0)
 {
     setBank       (bank);
     setRepartitor (repartitor);
@@ -227,6 +228,7 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "10"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
+    devParser->push_back (new OptionOneParam (STR_ESTIMATE_KMERS,    "estimate the distinct and solid kmers from a sample of the reads (0=no, 1=yes, one more pass)", false, "0"));
     parser->push_back (devParser);
 
     return parser;
@@ -260,7 +262,8 @@ template<size_t span>
 ICountProcessor<span>* SortingCountAlgorithm<span>::getDefaultProcessor (
     tools::misc::IProperties*       params,
     tools::storage::impl::Storage*  dskStorage,
-    tools::storage::impl::Storage*  otherStorage
+    tools::storage::impl::Storage*  otherStorage,
+    ICountProcessor<span>*          extraProcessor
 )
 {
     CountProcessor* result = 0;
@@ -273,6 +276,7 @@ ICountProcessor<span>* SortingCountAlgorithm<span>::getDefaultProcessor (
      *      1) histogram
      *      2) solidity filter
      *      3) if solidity filter passed, dump to file system
+     *      4) if provided, the extra processor (which gets only the solid kmers)
      */
     result = new CountProcessorChain<span> (
 
@@ -288,6 +292,7 @@ ICountProcessor<span>* SortingCountAlgorithm<span>::getDefaultProcessor (
             dskStorage->getGroup("dsk"),
             params->getInt(STR_KMER_SIZE)
         ),
+        extraProcessor,
         NULL
     );
 
@@ -348,12 +353,13 @@ vector<ICountProcessor<span>*> SortingCountAlgorithm<span>::getDefaultProcessorV
     Configuration&  config,
     IProperties*    params,
     Storage*        dskStorage,
-    Storage*        otherStorage
+    Storage*        otherStorage,
+    ICountProcessor<span>* extraProcessor
 )
 {
     vector<ICountProcessor<span>*> result;
 
-    ICountProcessor<span>* dskProcessor = getDefaultProcessor (params, dskStorage, otherStorage);
+    ICountProcessor<span>* dskProcessor = getDefaultProcessor (params, dskStorage, otherStorage, extraProcessor);
 
     /** Now, we define the vector of count processors to be given to the SortingCountAlgorithm.
      * The choice depends on the presence of "auto" min abundance in the configuration. */
@@ -487,6 +493,50 @@ void SortingCountAlgorithm<span>::configure ()
     ));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+/** In pipelined mode, the fill of the next pass and the counting of the current pass are two
+ * commands run at the same time; each one measures its own duration. */
+template<size_t span>
+class SortingCountAlgorithm<span>::PassCommand : public ICommand, public system::SmartPointer
+{
+public:
+
+    PassCommand (SortingCountAlgorithm& algo, bool fill, size_t pass, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo)
+        : _algo(algo), _fill(fill), _pass(pass), _itSeq(itSeq), _pInfo(pInfo), _duration(0) {}
+
+    void execute ()
+    {
+        u_int32_t t0 = System::time().getTimeStamp();
+
+        /** The fill uses its own time info, since the counting updates the one of the algorithm. */
+        if (_fill)  {  _algo.fillPartitions (_pass, _itSeq, _pInfo, _timeInfo);  }
+        else        {  _algo.fillSolidKmers (_pass, _pInfo);  }
+
+        _duration = System::time().getTimeStamp() - t0;
+    }
+
+    TimeInfo& getTimeInfo ()  { return _timeInfo; }
+
+    u_int32_t getDuration () const  { return _duration; }
+
+private:
+
+    SortingCountAlgorithm& _algo;
+    bool                   _fill;
+    size_t                 _pass;
+    Iterator<Sequence>*    _itSeq;
+    PartiInfo<5>&          _pInfo;
+    TimeInfo               _timeInfo;
+    u_int32_t              _duration;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -537,18 +587,73 @@ void SortingCountAlgorithm<span>::execute ()
     /*************************************************************/
     /*                         MAIN LOOP                         */
     /*************************************************************/
+    /** Time (in ms) during which the fill of a pass and the counting of the previous one were both running. */
+    u_int32_t overlapTime = 0;
+
     /** We loop N times the bank. For each pass, we will consider a subset of the whole kmers set of the bank. */
-    for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+    if (_config._pipeline_passes == false)
     {
-        DEBUG (("SortingCountAlgorithm<span>::execute  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
+        for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+        {
+            DEBUG (("SortingCountAlgorithm<span>::execute  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
+
+            pInfo.clear();
+
+            /** 1) We fill the partition files. */
+            fillPartitions (current_pass, itSeq, pInfo, getTimeInfo());
+
+            /** 2) We fill the kmers solid file from the partition files. */
+            fillSolidKmers (current_pass, pInfo);
+        }
+    }
+    else
+    {
+        /** Pipelined passes: the first pass is filled alone, then the partitions of pass N are counted
+         * while the superkmers of pass N+1 are built (into _superKstorageNext). */
+        PartiInfo<5> pInfoNext (_config._nb_partitions, _config._minim_size);
+
+        size_t nbCores = getDispatcher()->getExecutionUnitsNumber();
 
         pInfo.clear();
+        fillPartitions (0, itSeq, pInfo, getTimeInfo());
+
+        for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+        {
+            DEBUG (("SortingCountAlgorithm<span>::execute  pipelined pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
+
+            bool hasNext = current_pass+1 < _config._nb_passes;
+
+            if (hasNext == false)  {  fillSolidKmers (current_pass, pInfo);  break;  }
+
+            pInfoNext.clear();
 
-        /** 1) We fill the partition files. */
-        fillPartitions (current_pass, itSeq, pInfo);
+            PassCommand* fillCmd  = new PassCommand (*this, true,  current_pass+1, itSeq, pInfoNext);  LOCAL (fillCmd);
+            PassCommand* countCmd = new PassCommand (*this, false, current_pass,   itSeq, pInfo);      LOCAL (countCmd);
 
-        /** 2) We fill the kmers solid file from the partition files. */
-        fillSolidKmers (current_pass, pInfo);
+            vector<ICommand*> cmds;
+            cmds.push_back (fillCmd);
+            cmds.push_back (countCmd);
+
+            /** Both steps share the cores, otherwise each one would use all of them. */
+            _nbCoresFill  = std::max (nbCores/2, (size_t)1);
+            _nbCoresCount = std::max (nbCores - _nbCoresFill, (size_t)1);
+
+            Dispatcher(cmds.size()).dispatchCommands (cmds, 0);
+
+            _nbCoresFill  = 0;
+            _nbCoresCount = 0;
+
+            getTimeInfo() += fillCmd->getTimeInfo();
+            overlapTime   += std::min (fillCmd->getDuration(), countCmd->getDuration());
+
+            /** The next pass becomes the current one. */
+            delete _superKstorage;
+            _superKstorage     = _superKstorageNext;
+            _superKstorageNext = 0;
+
+            pInfo.clear();
+            pInfo += pInfoNext;
+        }
     }
 
     /** We notify the count processor about the stop of the main loop. */
@@ -619,6 +724,16 @@ void SortingCountAlgorithm<span>::execute ()
 	getInfo()->add (3, "avg superk length ","%.2f",(nbtotalk/(float) nbtotalsuperk));
 	getInfo()->add (3, "minimizer density ","%.2f",(nbtotalsuperk/(float)nbtotalk)*(_config._kmerSize - _config._minim_size +2));
 	
+	getInfo()->add (2, "schedule");
+	getInfo()->add (3, "nb oversized partitions","%lld",_nbOversizedParts);
+
+	if (_config._pipeline_passes)
+	{
+		getInfo()->add (2, "pipeline");
+		getInfo()->add (3, "nb passes overlapped","%d",_config._nb_passes-1);
+		getInfo()->add (3, "fill/count overlap (s)","%.3f",overlapTime/1000.0);
+	}
+
 	if(_config._solidityKind == KMER_SOLIDITY_SUM)
 	{
 		getInfo()->add (3, "total size (MB)","%lld",totaltmp/1024LL/1024LL);
@@ -643,6 +758,59 @@ void SortingCountAlgorithm<span>::execute ()
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 }
 
+/********************************************************************************/
+/* This class writes items into the partitions for several threads (one lock per partition),
+ * and records for each partition the runs of consecutive items of a same bank. The banks may
+ * then be read at the same time and still be told apart when counting the partitions.
+ *
+ * The items are given by blocks of whole superkmers, so a run never splits a superkmer.
+ */
+template<typename Type>
+class PartitionRunsWriter
+{
+public:
+
+    /** Constructor.
+     * \param[in] partition : partitions to be written (may be null, nothing is written then)
+     * \param[out] runs : runs of each partition, reset here. */
+    PartitionRunsWriter (Partition<Type>* partition, std::vector<PartitionRuns>& runs)
+        : _partition(partition), _runs(runs)
+    {
+        _runs.clear();
+        _runs.resize (_partition ? _partition->size() : 0);
+        for (size_t p=0; p<_runs.size(); p++)  {  _synchros.push_back (System::thread().newSynchronizer());  }
+    }
+
+    /** Destructor. */
+    ~PartitionRunsWriter ()
+    {
+        for (size_t p=0; p<_synchros.size(); p++)  {  delete _synchros[p];  }
+    }
+
+    /** Append items of a bank to a partition.
+     * \param[in] p : index of the partition
+     * \param[in] bankId : bank of the items
+     * \param[in] items : items to be written */
+    void insert (size_t p, bank::BankIdType bankId, const std::vector<Type>& items)
+    {
+        if (items.empty())  { return; }
+
+        LocalSynchronizer ls (_synchros[p]);
+
+        (*_partition)[p].insert (items.data(), items.size());
+
+        PartitionRuns& runs = _runs[p];
+        if (!runs.empty() && runs.back().first == bankId)  {  runs.back().second += items.size();  }
+        else                                               {  runs.push_back (std::make_pair (bankId, items.size()));  }
+    }
+
+private:
+
+    Partition<Type>*             _partition;
+    std::vector<PartitionRuns>&  _runs;
+    std::vector<ISynchronizer*>  _synchros;
+};
+
 /********************************************************************************/
 /* This functor class takes a Sequence as input, splits it into super kmers and
  * serialize them into partitions.
@@ -812,11 +980,12 @@ public:
              * => this will give us the partition where to dump the superkmer. */
             size_t p = this->_repartition (superKmer.minimizer);
 
-            /** We save the superkmer into the right partition. */
-//			if(newSuperKmerStorage)
-//				superKmer.save (_superkmerFiles,p);
-//			else
-				superKmer.save ((this->_partition)[p]);
+            /** We save the superkmer into the cache of the right partition; the cache is written
+             * between two superkmers, so the partition runs hold whole superkmers. */
+            CacheBag bag (_cache[p]);
+            superKmer.save (bag);
+
+            if (_cache[p].size() >= _nbCacheItems)  {  flushCache (p);  }
 
 	
 			//for debug purposes
@@ -889,7 +1058,7 @@ public:
         size_t             nbCacheItems,
         IteratorListener*  progress,
         BankStats&         bankStats,
-        Partition<Type>*   partition,
+        PartitionRunsWriter<Type>* partition,
         Repartitor&        repartition,
         PartiInfo<5>&      pInfo,
 		SuperKmerBinFiles* superKstorage
@@ -898,7 +1067,7 @@ public:
         _kx(4),
         _extern_pInfo(pInfo) , _local_pInfo(nbPartitions,model.getMmersModel().getKmerSize()),
         _repartition (repartition)
-	    ,_partition (*partition, nbCacheItems, 0)/*, _superkmerFiles(superKstorage,nbCacheItems* sizeof(Type))*/
+	    ,_partition (partition), _cache (nbPartitions), _nbCacheItems (nbCacheItems), _bankId (0)
     {
         _mask_radix.setVal((int64_t) 255);
         _mask_radix = _mask_radix << ((this->_kmersize - 4)*2); //get first 4 nt  of the kmers (heavy weight)
@@ -908,12 +1077,16 @@ public:
     /** Destructor. */
     ~FillPartitions ()
     {
-		//printf("destruc fillparti _superkmerFiles %p \n",_superkmerFiles);
+		/** We write the remaining cached items. */
+		for (size_t p=0; p<_cache.size(); p++)  {  flushCache (p);  }
 
         //add to global parti_info
         _extern_pInfo += _local_pInfo;
     }
 
+    /** Set the bank of the sequences, so their items are told apart from the items of other banks. */
+    void setBankId (bank::BankIdType bankId)  { _bankId = bankId; }
+
 private:
 
     size_t        _kx;
@@ -923,8 +1096,23 @@ private:
     Repartitor&   _repartition;
 	
     /** Shared resources (must support concurrent accesses). */
-    PartitionCacheType <Type> _partition;
-//	CacheSuperKmerBinFiles _superkmerFiles;
+    PartitionRunsWriter<Type>* _partition;
+
+    /** Items cached for each partition before being written. */
+    std::vector <std::vector<Type> > _cache;
+    size_t                           _nbCacheItems;
+    bank::BankIdType                 _bankId;
+
+    void flushCache (size_t p)  {  _partition->insert (p, _bankId, _cache[p]);  _cache[p].clear();  }
+
+    /** Bag appending the items of a superkmer to a partition cache. */
+    struct CacheBag : public Bag<Type>, public system::SmartPointer
+    {
+        CacheBag (std::vector<Type>& items) : _items(items)  {}
+        void insert (const Type& item)  { _items.push_back (item); }
+        void flush ()  {}
+        std::vector<Type>& _items;
+    };
 	
 	
 
@@ -1050,6 +1238,9 @@ private:
 			_extern_pInfo += _local_pInfo;
 		}
 		
+		/** Set the bank of the sequences; not needed here since the counts of the banks are summed. */
+		void setBankId (bank::BankIdType bankId)  {}
+		
 	private:
 		
 		size_t        _kx;
@@ -1067,6 +1258,134 @@ private:
 		Type getHeavyWeight (const Type& kmer) const  {  return (kmer & this->_mask_radix) >> ((this->_kmersize - 4)*2);  }
 	};
 	
+/********************************************************************************/
+/* This command takes the parts of the banks in turn (several commands share the list of parts)
+ * and feeds each part to its own clone of a functor, set with the bank of the part. Since a part
+ * is iterated by a single command, no lock is needed for getting the sequences; only the functor
+ * creation and destruction are synchronized (in order to have global BanksStats correctly computed).
+ */
+template<typename Functor>
+class FillPartsCommand : public ICommand, public system::SmartPointer
+{
+public:
+
+    /** Part of a bank: index of the bank and iterator over the part. */
+    typedef std::pair<BankIdType, Iterator<Sequence>*> Part;
+
+    /** Constructor.
+     * \param[in] parts : parts to be iterated, shared by the commands
+     * \param[in] nextPart : index of the next part to be iterated, shared by the commands
+     * \param[in] functor : functor to be cloned for each part
+     * \param[in] synchro : synchronizer for the functors destruction */
+    FillPartsCommand (std::vector<Part>& parts, size_t& nextPart, Functor& functor, ISynchronizer* synchro)
+        : _parts(parts), _nextPart(nextPart), _functor(functor), _synchro(synchro)  {}
+
+    /** \copydoc ICommand::execute */
+    void execute ()
+    {
+        for (size_t idx = __sync_fetch_and_add (&_nextPart, 1);  idx < _parts.size();  idx = __sync_fetch_and_add (&_nextPart, 1))
+        {
+            /** The functor is cloned under the lock, like it is destroyed. */
+            _synchro->lock();
+            Functor* fct = new Functor (_functor);
+            _synchro->unlock();
+
+            fct->setBankId (_parts[idx].first);
+
+            Iterator<Sequence>* it = _parts[idx].second;
+            for (it->first(); !it->isDone(); it->next())  {  (*fct) (it->item());  }
+
+            /** We release the resources of the part (opened file for instance) at once. */
+            it->finalize();
+
+            _synchro->lock();
+            delete fct;
+            _synchro->unlock();
+        }
+    }
+
+private:
+    std::vector<Part>& _parts;
+    size_t&            _nextPart;
+    Functor&           _functor;
+    ISynchronizer*     _synchro;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : with many small banks, reading them at the same time avoids waiting for the
+**           end of each bank (and the cost of opening it) before going on with the next one.
+*********************************************************************/
+template<size_t span>
+template<typename Functor>
+void SortingCountAlgorithm<span>::fillPartitionsWith (Functor& functor, std::vector<Iterator<Sequence>*>& itBanks)
+{
+    typedef typename FillPartsCommand<Functor>::Part Part;
+
+    /** With pipelined passes, the fill only gets its share of the cores (see execute). */
+    Dispatcher  fillDispatcher (_nbCoresFill);
+    IDispatcher* dispatcher = _nbCoresFill > 0 ? &fillDispatcher : getDispatcher();
+
+    size_t nbCores = dispatcher->getExecutionUnitsNumber();
+
+    /** We get the banks matching the iterators of the composition. */
+    vector<IBank*> banks;
+    if (BankComposite* composite = dynamic_cast<BankComposite*> (_bank))  {  banks = composite->getBanks();  }
+    else                                                               {  banks.push_back (_bank);  }
+
+    /** We split the banks into parts (uncompressed FASTA/FASTQ files, binary banks... can be split into
+     * several parts). We need at least one part per thread, otherwise we read one bank at a time. */
+    vector<Part> parts;
+    if (nbCores > 1 && banks.size() == itBanks.size())
+    {
+        size_t nbPartsPerBank = (nbCores + banks.size() - 1) / banks.size();
+
+        for (size_t i=0; i<banks.size(); i++)
+        {
+            vector<Iterator<Sequence>*> its = banks[i]->iterators (nbPartsPerBank);
+            for (size_t j=0; j<its.size(); j++)  {  its[j]->use();  parts.push_back (Part (i, its[j]));  }
+        }
+
+        if (parts.size() < nbCores)
+        {
+            for (size_t j=0; j<parts.size(); j++)  {  parts[j].second->forget();  }
+            parts.clear();
+        }
+    }
+
+    if (parts.empty() == false)
+    {
+        /** Each thread takes the parts in turn, until there is no more part. */
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+        LOCAL (synchro);
+
+        size_t nextPart = 0;
+
+        vector<ICommand*> cmds;
+        for (size_t i=0; i<nbCores; i++)  {  cmds.push_back (new FillPartsCommand<Functor> (parts, nextPart, functor, synchro));  }
+
+        dispatcher->dispatchCommands (cmds, 0);
+
+        for (size_t j=0; j<parts.size(); j++)  {  parts[j].second->forget();  }
+    }
+    else
+    {
+        /** Each thread will read synchronously the current bank. */
+        for (size_t i=0; i<itBanks.size(); i++)
+        {
+            functor.setBankId (i);
+            dispatcher->iterate (itBanks[i], functor, 1000, true);
+        }
+    }
+
+    //GR: close the input banks here with call to finalize
+    for (size_t i=0; i<itBanks.size(); i++)  {  itBanks[i]->finalize();  }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -1076,9 +1395,13 @@ private:
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo, TimeInfo& timeInfo)
 	{
-		TIME_INFO (getTimeInfo(), "fill_partitions");
+		TIME_INFO (timeInfo, "fill_partitions");
+
+		/** With pipelined passes, the passes after the first one are filled while the previous one
+		 * is counted from _superKstorage; they use their own storage. */
+		SuperKmerBinFiles*& superKstorage = (_config._pipeline_passes && pass > 0) ? _superKstorageNext : _superKstorage;
 		
 		DEBUG (("SortingCountAlgorithm<span>::fillPartitions  _kmerSize=%d _minim_size=%d \n", _config._kmerSize, _config._minim_size));
 		
@@ -1098,17 +1421,21 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		}
 		else
 		{
-			/** We build the temporary storage name from the output storage name. */
-			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("superK_partitions");
+			/** We build the temporary storage name from the output storage name. With pipelined passes,
+			 * the storages of two passes are alive together, so each pass has its own directory. */
+			string superKname = _config._pipeline_passes ? Stringify::format ("superK_partitions_%ld", pass) : string ("superK_partitions");
+			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename(superKname);
 			
 			
-			if(_superKstorage!=0)
+			if(superKstorage!=0)
 			{
-				delete _superKstorage;
-				_superKstorage =0;
+				delete superKstorage;
+				superKstorage =0;
 			}
 			
-			_superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions) ;
+			/** The fill threads write their superkmer blocks without locking the partition files.
+			 * The superkmers may also be kept in RAM if the configuration found enough memory for them. */
+			superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions, true, _config._superk_in_memory) ;
 			
 		}
 		/** We update the message of the progress bar. */
@@ -1122,8 +1449,9 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		
 		Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
 		
-		/** We have to reinit the progress instance since it may have been used by SampleRepart before. */
-		_progress->init();
+		/** We have to reinit the progress instance since it may have been used by SampleRepart before.
+		 * With pipelined passes, the progress is then shared with the counting of the previous pass. */
+		if (pass == 0 || _config._pipeline_passes == false)  {  _progress->init();  }
 		
 		/** We may have several input banks instead of a single one. */
 		std::vector<Iterator<Sequence>*> itBanks =  itSeq->getComposition();
@@ -1141,53 +1469,46 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		 */
 		_nbKmersPerPartitionPerBank.clear();
 		
-		/** We launch the iteration of the sequences iterator with the created functors. */
-		for (size_t i=0; i<itBanks.size(); i++)
+		/** In case of several banks, the partitions items are written as runs of items of a same bank. */
+		PartitionRunsWriter<Type> runsWriter (_config._solidityKind != KMER_SOLIDITY_SUM ? _tmpPartitions : 0, _partitionRuns);
+		
+		/** We fill the partitions. The FillPartitions destructors are synchronized (in order to have
+		 * global BanksStats correctly computed). */
+		if(_config._solidityKind == KMER_SOLIDITY_SUM)
+		{
+			FillPartitions<span,true> functor (
+				model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo,superKstorage
+			);
+			fillPartitionsWith (functor, itBanks);
+		}
+		else
+		{
+			FillPartitions<span,false> functor (
+				model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, &runsWriter, *_repartitor, pInfo,superKstorage
+			);
+			fillPartitionsWith (functor, itBanks);
+		}
+		
+		if(_config._solidityKind != KMER_SOLIDITY_SUM)
 		{
-			size_t groupSize   = 1000;
-			bool deleteSynchro = true;
-			
-			/** We fill the partitions. Each thread will read synchronously and will call FillPartitions
-			 * in a synchronous way (in order to have global BanksStats correctly computed). */
-			
-			if(_config._solidityKind == KMER_SOLIDITY_SUM)
-			{
-				getDispatcher()->iterate (itBanks[i], FillPartitions<span,true> (
-																			model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo,_superKstorage
-																			), groupSize, deleteSynchro);
-			}
-			else
-			{
-				getDispatcher()->iterate (itBanks[i], FillPartitions<span,false> (
-																				 model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo,_superKstorage
-																				 ), groupSize, deleteSynchro);
-			}
-			
-			
 			/** We flush the partitions in order to be sure to have the exact number of items per partition. */
-			if(_config._solidityKind != KMER_SOLIDITY_SUM)
+			_tmpPartitions->flush();
+			
+			/** We get the number of items of each bank in each partition. */
+			_nbKmersPerPartitionPerBank.assign (itBanks.size(), vector<size_t> (_config._nb_partitions, 0));
+			for (size_t p=0; p<_partitionRuns.size(); p++)
 			{
-				_tmpPartitions->flush();
-				
-				/** We get a snapshot of items number in each partition. */
-				vector<size_t> nbItems;
-				for (size_t p=0; p<_config._nb_partitions; p++)
+				for (size_t r=0; r<_partitionRuns[p].size(); r++)
 				{
-				 nbItems.push_back ((*_tmpPartitions)[p].getNbItems()); //todo for multi count
+					_nbKmersPerPartitionPerBank[_partitionRuns[p][r].first][p] += _partitionRuns[p][r].second;
 				}
-				
-				/** We add the current number of kmers in each partition for the reached ith bank. */
-				_nbKmersPerPartitionPerBank.push_back (nbItems);
 			}
-			
-			//GR: close the input bank here with call to finalize
-			itBanks[i]->finalize();
 		}
 		
 		if(_config._solidityKind == KMER_SOLIDITY_SUM)
 		{
-			_superKstorage->flushFiles();
-			_superKstorage->closeFiles();
+			superKstorage->flushFiles();
+			superKstorage->closeFiles();
 		}
 		
 		
@@ -1202,21 +1523,88 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-std::vector<size_t> SortingCountAlgorithm<span>::getNbCoresList (PartiInfo<5>& pInfo)
+u_int64_t SortingCountAlgorithm<span>::getMemoryForCounting ()
+{
+    u_int64_t result = _config._max_memory*MBYTE;
+
+    if (_config._superk_in_memory && _superKstorage != 0)
+    {
+        u_int64_t total, biggest, smallest;  float mean;
+        _superKstorage->getFilesStats (total, biggest, smallest, mean);
+
+        /** The configuration made sure that the superkmers take at most half of the memory;
+         * we keep this half anyway if the estimation was wrong. */
+        result = std::max (result - std::min (total, result), result/2);
+    }
+
+    /** With pipelined passes, the caches of the threads filling the next pass are alive during the counting. */
+    if (_config._pipeline_passes)
+    {
+        size_t    nbCoresFill = _nbCoresFill > 0 ? _nbCoresFill : _config._nbCores;
+        u_int64_t fillCaches  = (u_int64_t)_config._nb_cached_items_per_core_per_part * _config._nb_partitions * nbCoresFill * sizeof(Type);
+        result = std::max (result - std::min (fillCaches, result), result/2);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+std::vector < std::vector<typename SortingCountAlgorithm<span>::PartitionJob> > SortingCountAlgorithm<span>::getPartitionsSchedule (PartiInfo<5>& pInfo)
 {
-    std::vector<size_t> result;
+    /** A partition is considered as oversized when it is this times bigger than the median one. */
+    static const u_int64_t SKEW_FACTOR = 4;
+
+    std::vector < std::vector<PartitionJob> > result;
+
+    /** The biggest partitions are counted first: the last groups of the pass are then made of small
+     * partitions, which reduces the time the threads wait for the slowest partition of a group. */
+    std::vector<size_t> order = pInfo.getPartitionsBySize ();
 
-    for (size_t p=0; p<_config._nb_partitions; )
+    u_int64_t skewThreshold = SKEW_FACTOR * pInfo.getNbSuperKmerMedian();
+
+    size_t nbCoresAll       = _config._nb_partitions_in_parallel * _config._nbCores_per_partition;
+    size_t nbParallel       = _config._nb_partitions_in_parallel;
+    size_t nbCoresPartition = _config._nbCores_per_partition;
+
+    /** With pipelined passes, the counting only gets its share of the cores (see execute). */
+    if (_nbCoresCount > 0  &&  _nbCoresCount < nbCoresAll)
+    {
+        nbCoresAll       = _nbCoresCount;
+        nbCoresPartition = std::min (nbCoresPartition, nbCoresAll);
+        nbParallel       = std::max (std::min (nbParallel, nbCoresAll / nbCoresPartition), (size_t)1);
+    }
+
+    for (size_t idx=0; idx<order.size(); )
     {
-        u_int64_t ram_total = 0;
-        size_t i=0;
-        for (i=0; i< _config._nb_partitions_in_parallel && p<_config._nb_partitions
-            && (ram_total ==0  || ((ram_total+(pInfo.getNbSuperKmer(p)*getSizeofPerItem()))  <= _config._max_memory*MBYTE)) ; i++, p++)
+        std::vector<PartitionJob> group;
+
+        /** An oversized partition would set the duration of its group; we rather give it all the
+         * cores, its radix buckets being then read and sorted in parallel. */
+        if (nbParallel > 1  &&  pInfo.getNbSuperKmer(order[idx]) > skewThreshold)
         {
-            ram_total += pInfo.getNbSuperKmer(p)*getSizeofPerItem();
+            group.push_back (PartitionJob (order[idx++], nbCoresAll));
+            _nbOversizedParts ++;
+        }
+        else
+        {
+            u_int64_t ram_total = 0;
+            for ( ; group.size() < nbParallel && idx<order.size()
+                && (ram_total ==0  || ((ram_total+(pInfo.getNbSuperKmer(order[idx])*getSizeofPerItem()))  <= getMemoryForCounting())) ; idx++)
+            {
+                ram_total += pInfo.getNbSuperKmer(order[idx])*getSizeofPerItem();
+                group.push_back (PartitionJob (order[idx], nbCoresPartition));
+            }
         }
 
-        result.push_back (i);
+        result.push_back (group);
     }
 
     return result;
@@ -1267,26 +1655,25 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
     /** We retrieve the list of cores number for dispatching N partitions in N threads.
      *  We need to know these numbers for allocating the N maps according to the maximum allowed memory.
      */
-    vector<size_t> coreList = getNbCoresList(pInfo); //uses _nb_partitions_in_parallel
+    vector < vector<PartitionJob> > schedule = getPartitionsSchedule(pInfo); //uses _nb_partitions_in_parallel
 
     /** We need a memory allocator. We give the cores number in order to compute an extra memory
      * allocation for alignment constraints. */
     MemAllocator pool (_config._nbCores);
 
-    size_t p = 0;
-    for (size_t i=0; i<coreList.size(); i++)
+    for (size_t i=0; i<schedule.size(); i++)
     {
         vector<ICommand*> cmds;
 
         /** We use a vector to hold all the current CountProcessor clones. */
         vector<CountProcessor*> clones;
 
-        size_t currentNbCores = coreList[i];
+        size_t currentNbCores = schedule[i].size();
         assert (currentNbCores > 0);
 
         /** We correct the number of memory per map according to the max allowed memory.
          * Note that _max_memory has initially been divided by the user provided cores number. */
-        u_int64_t mem = (_config._max_memory*MBYTE)/currentNbCores;
+        u_int64_t mem = getMemoryForCounting()/currentNbCores;
 
         /** We need to cache the solid kmers partitions.
          *  NOTE : it is important to save solid kmers by big chunks (ie cache size) in each partition.
@@ -1303,8 +1690,10 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
         ));
 
         /** We build a list of 'currentNbCores' commands to be dispatched each one in one thread. */
-        for (size_t j=0; j<currentNbCores; j++, p++)
+        for (size_t j=0; j<currentNbCores; j++)
         {
+            size_t p = schedule[i][j].partId;
+
             ISynchronizer* synchro = System::thread().newSynchronizer();
             LOCAL (synchro);
 
@@ -1330,20 +1719,30 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 
             //still use hash if by vector would be too large even with single part at a time
 			//I thought it was not possible to have memoryPartition > _max_memory  && currentNbCores>1 , but inf fact it is possible when
-			// some partitions are of size 0 (see getNbCoresList)
-			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > (_config._max_memory*MBYTE) ) )  && !forceVector)
+			// some partitions are of size 0 (see getPartitionsSchedule)
+			//the configuration may also have chosen the hash for all partitions (see ConfigurationAlgorithm)
+			if ( (_config._hash_counting || (memoryPartition > mem && currentNbCores==1) || ( memoryPartition > getMemoryForCounting() ) )  && !forceVector)
             {
                 if (pool.getCapacity() != 0)  {  pool.reserve(0);  }
 
+                /** The hash table doesn't need to be bigger than the distinct kmers of the partition,
+                 * estimated from the number of distinct kmers of the bank. */
+                u_int64_t hashMemory = mem;
+                if (_config._estimatedDistinctKmerNb > 0 && _config._kmersNb > 0)
+                {
+                    double    nbDistinct = (double)_config._estimatedDistinctKmerNb * pInfo.getNbKmer(p) / _config._kmersNb;
+                    u_int64_t neededMem  = ConfigurationAlgorithm<span>::getHashCounterMemory (nbDistinct);
+                    hashMemory = std::min (mem, std::max (neededMem, (u_int64_t)MBYTE));
+                }
 
 					cmd = new PartitionsByHashCommand<span>   (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, mem,_superKstorage
+															   pInfo, pass, p, schedule[i][j].nbCores, _config._kmerSize, pool, hashMemory,_superKstorage
 															   );
             }
             else
             {
-                u_int64_t memoryPoolSize = _config._max_memory*MBYTE;
+                u_int64_t memoryPoolSize = getMemoryForCounting();
 
                 /** In case of forcing sorted vector (multiple banks counting for instance), we may have a
                  * partition bigger than the max memory. */
@@ -1388,40 +1787,22 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
                 if (pool.getCapacity() == 0)  {  pool.reserve (memoryPoolSize); }
 				else if (memoryPoolSize > pool.getCapacity()) { pool.reserve(0); pool.reserve (memoryPoolSize); }
 
-                /** Recall that we got the following matrix in _nbKmersPerPartitionPerBank
-                 *
-                 *           part0  part1  part2 ... partJ
-                 *   bank0    xxx    xxx    xxx       xxx
-                 *   bank1    xxx    xxx    xxx       xxx
-                 *    ...
-                 *   bankI    xxx    xxx    xxx       xxx
-                 *
-                 *   Now, for the current partition p, we want the number of items found for each bank.
-                 *
-                 *              bank0   bank1   ...   bankI
-                 *   offsets :   xxx     xxx           xxx
-                 */
+                /** No information about the banks is needed when their counts are summed. */
                 vector<size_t> nbItemsPerBankPerPart;
-                if ( _config._solidityKind != KMER_SOLIDITY_SUM)
-                {
-                    for (size_t i=0; i<_nbKmersPerPartitionPerBank.size(); i++)
-                    {
-                        nbItemsPerBankPerPart.push_back (_nbKmersPerPartitionPerBank[i][p] - (i==0 ? 0 : _nbKmersPerPartitionPerBank[i-1][p]) );
-                    }
-                }
 
 				if ( _config._solidityKind == KMER_SOLIDITY_SUM)
 				{
 					cmd = new PartitionsByVectorCommand<span> (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
+															   pInfo, pass, p, schedule[i][j].nbCores, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
 															   );
 				}
 				else
 				{
+					/** The partition is read by runs of items of a same bank (see _partitionRuns). */
 					cmd = new PartitionsByVectorCommand_multibank<span> (
 															   (*_tmpPartitions)[p], processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart
+															   pInfo, pass, p, schedule[i][j].nbCores, _config._kmerSize, pool, _partitionRuns[p], _nbKmersPerPartitionPerBank.size()
 															   );
 				}
 
@@ -128,25 +128,30 @@ public:
      * \param[in] params : used for configuring the processor
      * \param[in] dskStorage : storage for dumping [kmer,count] couples
      * \param[in] otherStorage : used for histogram for instance
+     * \param[in] extraProcessor : if not null, processor put at the end of the chain (after the dump), for instance
+     *            for building some structure from the solid kmers (see CountProcessorBloom)
      * \return a CountProcessor instance
      */
     static CountProcessor* getDefaultProcessor (
         tools::misc::IProperties*       params,
         tools::storage::impl::Storage*  dskStorage,
-        tools::storage::impl::Storage*  otherStorage = 0
+        tools::storage::impl::Storage*  otherStorage   = 0,
+        ICountProcessor<span>*          extraProcessor = 0
     );
 
     /** Creates a vector holding the default CountProcessor configuration
      * \param[in] params : used for configuring the processor
      * \param[in] dskStorage : storage for dumping [kmer,count] couples
      * \param[in] otherStorage : used for histogram for instance
+     * \param[in] extraProcessor : if not null, processor put at the end of the default chain (see getDefaultProcessor)
      * \return a vector of CountProcessor instances
      */
     static std::vector<ICountProcessor<span>*> getDefaultProcessorVector (
         Configuration&                  config,
         tools::misc::IProperties*       params,
         tools::storage::impl::Storage*  dskStorage,
-        tools::storage::impl::Storage*  otherStorage = 0
+        tools::storage::impl::Storage*  otherStorage   = 0,
+        ICountProcessor<span>*          extraProcessor = 0
     );
 
     /** Process the kmers counting. It is mainly composed of a loop over the passes, and for each pass :
@@ -199,8 +204,20 @@ private:
     /** Fill partition files (for a given pass) from a sequence iterator.
      * \param[in] pass  : current pass whose value is used for choosing the partition file
      * \param[in] itSeq : sequences iterator whose sequence are cut into kmers to be split.
+     * \param[in] timeInfo : time info where the fill duration is added
      */
-    void fillPartitions (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo);
+    void fillPartitions (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo, tools::misc::impl::TimeInfo& timeInfo);
+
+    /** Feed a functor with the sequences of the banks. If the banks can be split into enough parts, the
+     * parts (possibly from different banks) are read at the same time, each one by its own thread; otherwise,
+     * the banks are read one after another, each one by all the threads.
+     * \param[in] functor : functor cloned for each part or thread; its bank id is set before the cloning.
+     * \param[in] itBanks : iterators of the banks (composition of the sequences iterator) */
+    template<typename Functor>
+    void fillPartitionsWith (Functor& functor, std::vector<gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>*>& itBanks);
+
+    /** Command filling the partitions of a pass or counting them, used for pipelining the passes. */
+    class PassCommand;
 
     /** Fill the solid kmers bag from the partition files (one partition after another one).
      * \param[in] solidKmers : bag to put the solid kmers into.
@@ -212,8 +229,19 @@ private:
      */
     void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo);
 
-    /** */
-    std::vector <size_t> getNbCoresList (PartiInfo<5>& pInfo);
+    /** Counting job of one partition, with the number of cores used for counting it. */
+    struct PartitionJob
+    {
+        PartitionJob (size_t partId=0, size_t nbCores=1) : partId(partId), nbCores(nbCores)  {}
+        size_t partId;
+        size_t nbCores;
+    };
+
+    /** Get the groups of partitions counted simultaneously during a pass. Partitions are scheduled
+     * largest first; a partition much bigger than the median one is counted alone with all the cores.
+     * \param[in] pInfo : information about the partitions of the pass
+     * \return the groups of jobs, one group being dispatched after the other. */
+    std::vector < std::vector<PartitionJob> > getPartitionsSchedule (PartiInfo<5>& pInfo);
 
     /** Handle on the configuration information. */
     kmer::impl::Configuration _config;
@@ -246,12 +274,21 @@ private:
      * IMPORTANT : we may have to count both the size of Type and the size for the bank id. */
     int getSizeofPerItem () const { return Type::getSize()/8 + ((_nbKmersPerPartitionPerBank.size()>1 && _config._solidityKind != tools::misc::KMER_SOLIDITY_SUM) ? sizeof(bank::BankIdType) : 0); }
 
+    /** Get the memory size (in bytes) available for counting the partitions.
+     * IMPORTANT : when the superkmers are kept in RAM, their volume is not available. */
+    u_int64_t getMemoryForCounting ();
+
     tools::misc::impl::TimeInfo _fillTimeInfo;
 
     BankStats _bankStats;
 
+    /** Number of items of each bank (rows) in each partition (columns). */
     std::vector <std::vector<size_t> > _nbKmersPerPartitionPerBank;
 
+    /** For each partition, runs of items of a same bank; the banks may be interleaved when they
+     * are read at the same time. */
+    std::vector <PartitionRuns> _partitionRuns;
+
     tools::storage::impl::StorageMode_e _storage_type;
     tools::storage::impl::Storage* _storage;
     void setStorage (tools::storage::impl::Storage* storage)  { SP_SETATTR(storage); }
@@ -259,6 +296,15 @@ private:
 	
 	//superkmer efficient storage
 	tools::storage::impl::SuperKmerBinFiles* _superKstorage;
+	//superkmers of the next pass, filled while the current one is counted (pipelined passes)
+	tools::storage::impl::SuperKmerBinFiles* _superKstorageNext;
+
+	/** Cores given to the fill and to the counting while they overlap (pipelined passes); 0 means all the cores. */
+	size_t _nbCoresFill;
+	size_t _nbCoresCount;
+
+	/** Number of partitions counted alone with all the cores (see getPartitionsSchedule). */
+	u_int64_t _nbOversizedParts;
 	std::string _tmpStorageName_superK;
 };
 
@@ -30,6 +30,7 @@
 
 #include <gatb/system/api/types.hpp>
 #include <string>
+#include <cstdio>
 
 /********************************************************************************/
 namespace gatb      {
@@ -108,6 +109,14 @@ public:
      * \return number of  items successfully written */
     virtual size_t fwrite (const void* ptr, size_t size, size_t nmemb) = 0;
 
+    /** Writes a buffer into the file at a given offset, without using nor moving the current
+     * file position. Several threads may write disjoint regions of the same file concurrently.
+     * \param[in] ptr : the buffer to be written
+     * \param[in] size : size of the buffer (in bytes)
+     * \param[in] offset : position in the file where the buffer is written
+     * \return number of bytes successfully written */
+    virtual size_t pwrite (const void* ptr, size_t size, u_int64_t offset) = 0;
+
     /** Flush the file.
      */
     virtual void flush () = 0;
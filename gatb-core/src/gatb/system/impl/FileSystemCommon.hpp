@@ -127,6 +127,21 @@ public:
         return ::fwrite (ptr, size, nmemb, getHandle());
     }
 
+    /** \copydoc IFile::pwrite */
+    size_t pwrite (const void* ptr, size_t size, u_int64_t offset)
+    {
+        const char* buffer = (const char*) ptr;
+        size_t      done   = 0;
+
+        while (done < size)
+        {
+            ssize_t nb = ::pwrite (fileno(getHandle()), buffer + done, size - done, offset + done);
+            if (nb <= 0)  { break; }
+            done += nb;
+        }
+        return done;
+    }
+
     /** \copydoc IFile::flush */
     void flush ()  { if (isOpen())  {  fflush (getHandle()); } }
 
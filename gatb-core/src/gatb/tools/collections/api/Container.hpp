@@ -31,6 +31,7 @@
 /********************************************************************************/
 
 #include <gatb/system/api/ISmartPointer.hpp>
+#include <gatb/system/api/types.hpp>
 
 /********************************************************************************/
 namespace gatb          {
@@ -53,6 +54,16 @@ public:
     /** Tells whether an item exists or not
      * \return true if the item exists, false otherwise */
     virtual bool contains (const Item& item) = 0;
+
+    /** Tells whether items exist or not. Implementations may resolve the items of the batch
+     * together, for instance by prefetching the memory of all the items before testing them.
+     * \param[in] items : items to be looked for
+     * \param[in] n : number of items
+     * \param[out] out : out[i] is 1 if items[i] exists, 0 otherwise */
+    virtual void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        for (size_t i=0; i<n; i++)  {  out[i] = contains (items[i]);  }
+    }
 };
 
 /********************************************************************************/
@@ -19,6 +19,13 @@
 
 #include <gatb/tools/collections/impl/Bloom.hpp>
 
+/** The SIMD kernels of BloomBlocked are compiled with function specific target attributes and
+ * selected at runtime according to the CPU, so the library doesn't require AVX to be built or run. */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define GATB_BLOOM_SIMD 1
+    #include <immintrin.h>
+#endif
+
 /********************************************************************************/
 namespace gatb          {
 namespace core          {
@@ -38,6 +45,121 @@ u_int8_t bit_mask [] = {
     0x80   //10000000
 };
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : kernels of BloomBlocked::testBlock
+** INPUT   : a block of 256 bits (aligned on 32 bytes) and a mask
+** OUTPUT  :
+** RETURN  : true if all the bits of the mask are set in the block
+** REMARKS :
+*********************************************************************/
+static bool testBlock_scalar (const u_int32_t* block, const u_int32_t* mask)
+{
+    for (size_t i=0; i<8; i++)  {  if ((block[i] & mask[i]) != mask[i])  {  return false;  }  }
+    return true;
+}
+
+static void testBlocks_scalar (const u_int32_t* const* blocks, const u_int32_t* masks, size_t n, u_int8_t* out)
+{
+    for (size_t i=0; i<n; i++)  {  out[i] = testBlock_scalar (blocks[i], masks + 8*i);  }
+}
+
+#ifdef GATB_BLOOM_SIMD
+
+__attribute__((target("sse4.1")))
+static bool testBlock_sse4 (const u_int32_t* block, const u_int32_t* mask)
+{
+    return _mm_testc_si128 (_mm_load_si128 ((const __m128i*) block),     _mm_loadu_si128 ((const __m128i*) mask))
+        && _mm_testc_si128 (_mm_load_si128 ((const __m128i*) (block+4)), _mm_loadu_si128 ((const __m128i*) (mask+4)));
+}
+
+__attribute__((target("sse4.1")))
+static void testBlocks_sse4 (const u_int32_t* const* blocks, const u_int32_t* masks, size_t n, u_int8_t* out)
+{
+    for (size_t i=0; i<n; i++)  {  out[i] = testBlock_sse4 (blocks[i], masks + 8*i);  }
+}
+
+__attribute__((target("avx2")))
+static bool testBlock_avx2 (const u_int32_t* block, const u_int32_t* mask)
+{
+    return _mm256_testc_si256 (_mm256_load_si256 ((const __m256i*) block), _mm256_loadu_si256 ((const __m256i*) mask));
+}
+
+__attribute__((target("avx2")))
+static void testBlocks_avx2 (const u_int32_t* const* blocks, const u_int32_t* masks, size_t n, u_int8_t* out)
+{
+    for (size_t i=0; i<n; i++)  {  out[i] = testBlock_avx2 (blocks[i], masks + 8*i);  }
+}
+
+#endif /* GATB_BLOOM_SIMD */
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : runtime selection of the kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+enum BlockTestKernel_e  { KERNEL_SCALAR, KERNEL_SSE4, KERNEL_AVX2 };
+
+static BlockTestKernel_e selectKernel ()
+{
+#ifdef GATB_BLOOM_SIMD
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))    { return KERNEL_AVX2; }
+    if (__builtin_cpu_supports ("sse4.1"))  { return KERNEL_SSE4; }
+#endif
+    return KERNEL_SCALAR;
+}
+
+static BlockTestKernel_e getKernel ()
+{
+    /** Thread safe initialization (C++11). */
+    static const BlockTestKernel_e kernel = selectKernel ();
+    return kernel;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BlockTestKernel getBlockTestKernel ()
+{
+    switch (getKernel())
+    {
+#ifdef GATB_BLOOM_SIMD
+        case KERNEL_AVX2:  return testBlock_avx2;
+        case KERNEL_SSE4:  return testBlock_sse4;
+#endif
+        default:           return testBlock_scalar;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the test of each block is inlined in the batch kernels
+*********************************************************************/
+BlockTestBatchKernel getBlockTestBatchKernel ()
+{
+    switch (getKernel())
+    {
+#ifdef GATB_BLOOM_SIMD
+        case KERNEL_AVX2:  return testBlocks_avx2;
+        case KERNEL_SSE4:  return testBlocks_sse4;
+#endif
+        default:           return testBlocks_scalar;
+    }
+}
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
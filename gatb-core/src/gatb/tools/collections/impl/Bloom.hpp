@@ -74,6 +74,12 @@ public:
      * \return the hash code for the item. */
     u_int64_t operator ()  (const Item& key, size_t idx)  {  return hash1 (key, seed_tab[idx]);  }
 
+    /** Get a hash code for a hash function and an item given by a 64 bits hash.
+     * \param[in] hash : hash of the item (see IBloom::insertHash)
+     * \param[in] idx : index of the hash function to be used
+     * \return the hash code for the item. */
+    u_int64_t fromHash (u_int64_t hash, size_t idx)  {  return math::LargeInt<1>::hash64 (hash, seed_tab[idx]);  }
+
 private:
 
     /* */
@@ -121,6 +127,15 @@ public:
      * \return Bloom filter's bit set. */
     virtual u_int8_t*& getArray    () = 0;
 
+    /** Use an external bit set (for instance a section of a mapped file) instead of the bit set
+     * allocated by the Bloom filter, which is released. The external bit set must hold getSize()
+     * bytes, with the layout of getArray.
+     * Note: some implementation may not provide this service.
+     * \param[in] array : the bit set to be used
+     * \param[in] owner : object owning the memory of the bit set, kept as long as the Bloom filter; if null,
+     *  the bit set (allocated by malloc) is released by the Bloom filter */
+    virtual void useArray (u_int8_t* array, system::ISmartPointer* owner)  {  throw system::ExceptionNotImplemented ();  }
+
     /** Get the size of the Bloom filter (in bytes).
      * \return the size of the bit set of the Bloom filter */
     virtual u_int64_t  getSize     () = 0;
@@ -158,6 +173,17 @@ public:
      */
     virtual std::bitset<8> contains8 (const Item& item) = 0;
 
+    /** Insert an item given by a 64 bits hash, for instance the rolling hash of a kmer (see
+     * ModelRollingHash), which saves hashing the item itself. The bits set for a hash are not the
+     * ones set for the item: a filter filled with 'insertHash' must be queried with 'containsHash'.
+     * \param[in] hash : hash of the item to insert. */
+    virtual void insertHash (u_int64_t hash) = 0;
+
+    /** Tells whether an item given by a 64 bits hash is in the Bloom filter (see insertHash).
+     * \param[in] hash : hash of the item to test.
+     * \return the presence or not of the item */
+    virtual bool containsHash (u_int64_t hash) = 0;
+
     /** Get the name of the implementation class.
      * \return the class name. */
     virtual std::string  getName   () const  = 0;
@@ -182,11 +208,12 @@ public:
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] nbHash : number of hash functions to use */
     BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4)
-        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false)
+        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false), _arrayOwner(0)
     {
         nchar  = (1+tai/8LL);
-        blooma = (unsigned char *) MALLOC (nchar*sizeof(unsigned char)); // 1 bit per elem
-        system::impl::System::memory().memset (blooma, 0, nchar*sizeof(unsigned char));
+        /** Zeroed pages are given lazily by the system, which costs nothing if the bit set is then
+         * replaced by useArray. */
+        blooma = (unsigned char *) CALLOC (nchar, sizeof(unsigned char)); // 1 bit per elem
 
         /** We look whether the provided size is a power of 2 or not.
          *   => if we have a power of two, we can optimize the modulo operations. */
@@ -201,7 +228,8 @@ public:
     /** Destructor. */
     virtual ~BloomContainer ()
     {
-        system::impl::System::memory().free (blooma);
+        if (_arrayOwner == 0)  {  system::impl::System::memory().free (blooma);  }
+        setArrayOwner (0);
     }
 
     /** \copydoc IBloom::getNbHash */
@@ -233,6 +261,53 @@ public:
         return true;
     }
 
+    /** \copydoc IBloom::containsHash. */
+    bool containsHash (u_int64_t hash)
+    {
+        for (size_t i=0; i<n_hash_func; i++)
+        {
+            u_int64_t h1 = _hash.fromHash (hash,i);
+            h1 = isSizePowOf2 ? (h1 & tai) : (h1 % tai);
+            if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
+        }
+        return true;
+    }
+
+    /** Batched version of contains: the bit positions of a chunk of items are all computed
+     * and prefetched before the first one is tested, so the cache misses of the chunk overlap.
+     * Above MAX_KEYS hash functions, the items are tested one by one.
+     * \copydoc Container::containsBatch. */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        static const size_t BATCH    = 8;
+        static const size_t MAX_KEYS = 20;
+
+        if (n_hash_func > MAX_KEYS)  {  Container<Item>::containsBatch (items, n, out);  return;  }
+
+        u_int64_t keys [BATCH][MAX_KEYS];
+
+        for (size_t b=0; b<n; b+=BATCH)
+        {
+            size_t m = std::min (BATCH, n-b);
+
+            for (size_t i=0; i<m; i++)
+            {
+                getKeys (items[b+i], keys[i]);
+                for (size_t j=0; j<n_hash_func; j++)  {  __builtin_prefetch (&(blooma [keys[i][j] >> 3]), 0, 3);  }
+            }
+
+            for (size_t i=0; i<m; i++)
+            {
+                out[b+i] = 1;
+                for (size_t j=0; j<n_hash_func; j++)
+                {
+                    u_int64_t h1 = keys[i][j];
+                    if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  out[b+i] = 0;  break;  }
+                }
+            }
+        }
+    }
+
     /** \copydoc IBloom::contains4. */
 	virtual std::bitset<4> contains4 (const Item& item, bool right)
     {   throw system::ExceptionNotImplemented ();  }
@@ -244,6 +319,14 @@ public:
     /** \copydoc IBloom::getArray. */
     virtual u_int8_t*& getArray     ()  { return blooma; }
 
+    /** \copydoc IBloom::useArray. */
+    virtual void useArray (u_int8_t* array, system::ISmartPointer* owner)
+    {
+        if (_arrayOwner == 0)  {  system::impl::System::memory().free (blooma);  }
+        setArrayOwner (owner);
+        blooma = array;
+    }
+
     /** \copydoc IBloom::getSize. */
     virtual u_int64_t  getSize      ()  { return nchar;  }
 
@@ -255,6 +338,18 @@ public:
 
 protected:
 
+    /** Compute the positions of the bits of an item, as read by contains.
+     * \param[in] item : the item
+     * \param[out] keys : the n_hash_func bit positions of the item */
+    virtual void getKeys (const Item& item, u_int64_t* keys)
+    {
+        for (size_t i=0; i<n_hash_func; i++)
+        {
+            u_int64_t h1 = _hash (item,i);
+            keys[i] = isSizePowOf2 ? (h1 & tai) : (h1 % tai);
+        }
+    }
+
     HashFunctors<Item> _hash;
     size_t n_hash_func;
 
@@ -262,6 +357,9 @@ protected:
     u_int64_t tai;
     u_int64_t nchar;
     bool      isSizePowOf2;
+
+    system::ISmartPointer* _arrayOwner;
+    void setArrayOwner (system::ISmartPointer* arrayOwner)  { SP_SETATTR(arrayOwner); }
 };
 
 /********************************************************************************/
@@ -295,6 +393,17 @@ public:
         }
     }
 
+    /** \copydoc IBloom::insertHash. */
+    void insertHash (u_int64_t hash)
+    {
+        for (size_t i=0; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = this->_hash.fromHash (hash,i);
+            h1 = this->isSizePowOf2 ? (h1 & this->tai) : (h1 % this->tai);
+            this->blooma [h1 >> 3] |= bit_mask[h1 & 7];
+        }
+    }
+
     /** \copydoc Bag::flush */
     void flush ()  {}
 
@@ -342,6 +451,9 @@ public:
     /** \copydoc IBloom::getArray */
     u_int8_t*& getArray    () { return a; }
 
+    /** \copydoc IBloom::useArray */
+    void useArray (u_int8_t* array, system::ISmartPointer* owner)  {}
+
     /** \copydoc IBloom::getSize */
     u_int64_t  getSize     () { return 0; }
 
@@ -366,6 +478,12 @@ public:
     /** \copydoc IBloom::insert */
     void insert (const Item& item) {}
 
+    /** \copydoc IBloom::containsHash */
+    bool containsHash (u_int64_t hash) { return false; }
+
+    /** \copydoc IBloom::insertHash */
+    void insertHash (u_int64_t hash) {}
+
     /** \copydoc IBloom::flush  */
     void flush ()  {}
 
@@ -411,6 +529,17 @@ public:
         }
     }
 
+    /** \copydoc IBloom::insertHash. */
+    void insertHash (u_int64_t hash)
+    {
+        for (size_t i=0; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = this->_hash.fromHash (hash,i);
+            h1 = this->isSizePowOf2 ? (h1 & this->tai) : (h1 % this->tai);
+            __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
+        }
+    }
+
     /** \copydoc IBloom::getName*/
     std::string  getName () const { return "basic"; }
 };
@@ -432,10 +561,10 @@ public:
     
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
-     * \param[in] nbHash : number of hash functions to use
+     * \param[in] nbHash : number of hash functions to use (at most 20)
      * \param[in] block_nbits : size of the block (actual 2^nbits) */
     BloomCacheCoherent (u_int64_t tai_bloom, size_t nbHash = 4,size_t block_nbits = 12)
-        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), nbHash),_nbits_BlockSize(block_nbits)
+        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), std::min (nbHash, (size_t)MAX_HASH)),_nbits_BlockSize(block_nbits)
     {
         _mask_block = (1<<_nbits_BlockSize) - 1;
         _reduced_tai = this->tai -  2*(1<<_nbits_BlockSize) ;//2* for neighbor coherent
@@ -457,6 +586,35 @@ public:
             __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
         }
     }
+
+    /** \copydoc IBloom::insertHash. */
+    void insertHash (u_int64_t hash)
+    {
+        u_int64_t h0 = this->_hash.fromHash (hash,0) % _reduced_tai;
+
+        __sync_fetch_and_or (this->blooma + (h0 >> 3), bit_mask[h0 & 7]);
+
+        for (size_t i=1; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = h0  + (math::LargeInt<1>::simplehash16_64 (hash, i) & _mask_block);
+            __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
+        }
+    }
+
+    /** \copydoc IBloom::containsHash. */
+    bool containsHash (u_int64_t hash)
+    {
+        u_int64_t h0 = this->_hash.fromHash (hash,0) % _reduced_tai;
+
+        if ((this->blooma[h0 >> 3 ] & bit_mask[h0 & 7]) ==0 )  {  return false;  }
+
+        for (size_t i=1; i<this->n_hash_func; i++)
+        {
+            u_int64_t h1 = h0  + (math::LargeInt<1>::simplehash16_64 (hash, i) & _mask_block);
+            if ((this->blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
+        }
+        return true;
+    }
     
     /** \copydoc IBloom::getName*/
     std::string  getName () const { return "cache"; }
@@ -496,6 +654,17 @@ public:
     }
     
 protected:
+
+    /** Maximum number of hash functions: size of the arrays of hash values of the lookups. */
+    static const size_t MAX_HASH = 20;
+
+    /** \copydoc BloomContainer::getKeys */
+    void getKeys (const Item& item, u_int64_t* keys)
+    {
+        keys[0] = this->_hash (item,0) % _reduced_tai;
+        for (size_t i=1; i<this->n_hash_func; i++)  {  keys[i] = keys[0] + (simplehash16( item, i) & _mask_block);  }
+    }
+
     u_int64_t _mask_block;
     size_t    _nbits_BlockSize;
     u_int64_t _reduced_tai;
@@ -518,7 +687,7 @@ public:
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] kmersize : kmer size
-     * \param[in] nbHash : number of hash functions to use
+     * \param[in] nbHash : number of hash functions to use (at most 20)
      * \param[in] block_nbits : size of the block (actual 2^nbits) */
     BloomNeighborCoherent (u_int64_t tai_bloom, size_t kmersize , size_t nbHash = 4,size_t block_nbits = 12 )  :
     BloomCacheCoherent<Item> (tai_bloom , nbHash,block_nbits), _kmerSize(kmersize)
@@ -809,6 +978,24 @@ public:
         return result;
     }
 
+protected:
+
+    /** \copydoc BloomContainer::getKeys */
+    void getKeys (const Item& item, u_int64_t* keys)
+    {
+        Item suffix = item & 3 ;
+        Item prefix = (item & _prefmask)  >> ((_kmerSize-2)*2);
+        prefix += suffix;
+        prefix = prefix  & 15 ;
+
+        Item hashpart = ( item >> 2 ) & _maskkm2 ;  // delete 1 nt at each side
+        Item rev =  revcomp(hashpart,_kmerSize-2);
+        if(rev<hashpart) hashpart = rev; //transform to canonical
+
+        keys[0] = (this->_hash (hashpart,0) % this->_reduced_tai) + cano2[prefix.getVal()];
+        for (size_t i=1; i<this->n_hash_func; i++)  {  keys[i] = keys[0] + (simplehash16( hashpart, i) & this->_mask_block);  }
+    }
+
 private:
     unsigned int cano2[16];
     Item _maskkm2;
@@ -1234,6 +1421,259 @@ private:
 	
 /********************************************************************************/
 
+/** Kernel telling whether all the bits of a mask are set in a block of 256 bits.
+ * \param[in] block : the block, aligned on 32 bytes
+ * \param[in] mask : the mask (8 words, not aligned)
+ * \return true if (block & mask) == mask */
+typedef bool (*BlockTestKernel) (const u_int32_t* block, const u_int32_t* mask);
+
+/** Kernel testing several blocks with their masks in one call.
+ * \param[in] blocks : the blocks, aligned on 32 bytes
+ * \param[in] masks : the masks, 8 words for each block
+ * \param[in] n : number of blocks
+ * \param[out] out : for each block, 1 if (block & mask) == mask, 0 otherwise */
+typedef void (*BlockTestBatchKernel) (const u_int32_t* const* blocks, const u_int32_t* masks, size_t n, u_int8_t* out);
+
+/** Get the block test kernel selected at runtime for the current CPU (AVX2, SSE4.1 or scalar).
+ * \return the kernel. */
+BlockTestKernel getBlockTestKernel ();
+
+/** Get the batch version of the kernel returned by getBlockTestKernel.
+ * \return the kernel. */
+BlockTestBatchKernel getBlockTestBatchKernel ();
+
+/********************************************************************************/
+
+/** \brief Bloom filter implementation with one register sized block per item
+ *
+ * This implementation is a blocked Bloom filter: the filter is an array of blocks of
+ * 256 bits (the size of an AVX2 register). One hash code selects the block of an item, and
+ * the k bits of the item (up to 16) are set in this block, the position of each bit being
+ * given by a multiplicative hash of the same hash code.
+ *
+ * The array is aligned on 64 bytes, so a query touches only one cache line, and the k bits
+ * are tested at once (one AVX2 test, or two SSE4.1 tests, or a loop when none is available,
+ * the kernel being selected at runtime according to the CPU, see getBlockTestKernel).
+ * The kernel is called through a pointer, so a single query pays an indirect call;
+ * containsBatch calls the batch kernel once per chunk of items instead.
+ * The price is a slightly higher false positive rate than the other implementations for the
+ * same size.
+ *
+ * Since the item is hashed once, the neighbors queries (contains4, contains8) are plain
+ * queries of the canonical neighbors; this means that this implementation should be used
+ * only with Item being a canonical kmer for these methods.
+ */
+template <typename Item> class BloomBlocked : public IBloom<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] tai_bloom : size (in bits) of the bloom filter, rounded up to a number of blocks.
+     * \param[in] kmersize : kmer size (used for the neighbors queries)
+     * \param[in] nbHash : number of bits set per item (at most 16) */
+    BloomBlocked (u_int64_t tai_bloom, size_t kmersize, size_t nbHash = 8)
+        : _hash(1), n_hash_func(std::min (nbHash, (size_t)MAX_HASH)), _kmerSize(kmersize),
+          _raw(0), blooma(0), _nbBlocks(0), _testMask(getBlockTestKernel()), _testMaskBatch(getBlockTestBatchKernel()), _arrayOwner(0)
+    {
+        _nbBlocks = std::max ((u_int64_t)1, (tai_bloom + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK);
+
+        /** The blocks have to be aligned on the cache lines. */
+        _raw   = (u_int8_t*) CALLOC (getSize() + CACHE_LINE, sizeof(u_int8_t));
+        blooma = _raw + (CACHE_LINE - ((uintptr_t)_raw % CACHE_LINE)) % CACHE_LINE;
+
+        if (_kmerSize > 0)
+        {
+            Item un;  un.setVal(1);
+            _kmerMask = (un << (_kmerSize*2)) - un;
+        }
+    }
+
+    /** Destructor. */
+    ~BloomBlocked ()  {  system::impl::System::memory().free (_raw);  setArrayOwner (0);  }
+
+    /** \copydoc Bag::insert. */
+    void insert (const Item& item)  {  setBlock (_hash (item,0));  }
+
+    /** \copydoc IBloom::insertHash. */
+    void insertHash (u_int64_t hash)  {  setBlock (_hash.fromHash (hash,0));  }
+
+    /** \copydoc Container::contains. */
+    bool contains (const Item& item)  {  u_int64_t h = _hash (item,0);  return testBlock (getBlock (h), h);  }
+
+    /** \copydoc IBloom::containsHash. */
+    bool containsHash (u_int64_t hash)  {  u_int64_t h = _hash.fromHash (hash,0);  return testBlock (getBlock (h), h);  }
+
+    /** \copydoc Container::containsBatch
+     * The blocks of a chunk of items are prefetched while their masks are computed, then
+     * the chunk is tested with one call of the batch kernel. */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        static const size_t BATCH = 8;
+        u_int64_t        hashes [BATCH];
+        const u_int32_t* blocks [BATCH];
+        u_int32_t        masks  [BATCH*WORDS_PER_BLOCK];
+
+        BlockTestBatchKernel testMasks = _testMaskBatch;
+
+        for (size_t b=0; b<n; b+=BATCH)
+        {
+            size_t m = std::min (BATCH, n-b);
+            for (size_t i=0; i<m; i++)
+            {
+                hashes[i] = _hash (items[b+i], 0);
+                blocks[i] = getBlock (hashes[i]);
+                __builtin_prefetch (blocks[i], 0, 3);
+            }
+            for (size_t i=0; i<m; i++)  {  makeMask (hashes[i], masks + i*WORDS_PER_BLOCK);  }
+
+            testMasks (blocks, masks, m, out+b);
+        }
+    }
+
+    /** \copydoc IBloom::contains4
+     * The 4 neighbors are made canonical, then their blocks are prefetched before being tested. */
+    std::bitset<4> contains4 (const Item& item, bool right)
+    {
+        Item elem = right ? ((item << 2) & _kmerMask) : (item >> 2);
+
+        u_int64_t hashes[4];
+        for (size_t nt=0; nt<4; nt++)
+        {
+            Item neighbor;  neighbor.setVal (nt);
+            neighbor = right ? (elem + neighbor) : (elem + (neighbor << ((_kmerSize-1)*2)));
+
+            Item rev = revcomp (neighbor, _kmerSize);
+            hashes[nt] = _hash (rev < neighbor ? rev : neighbor, 0);
+            __builtin_prefetch (getBlock (hashes[nt]), 0, 3);
+        }
+
+        std::bitset<4> resu;
+        for (size_t nt=0; nt<4; nt++)  {  resu.set (nt, testBlock (getBlock (hashes[nt]), hashes[nt]));  }
+        return resu;
+    }
+
+    /** \copydoc IBloom::contains8 */
+    std::bitset<8> contains8 (const Item& item)
+    {
+        std::bitset<4> resultRight = this->contains4 (item, true);
+        std::bitset<4> resultLeft  = this->contains4 (item, false);
+        std::bitset<8> result;
+        size_t i=0;
+        for (size_t j=0; j<4; j++)  { result.set (i++, resultRight[j]); }
+        for (size_t j=0; j<4; j++)  { result.set (i++, resultLeft [j]); }
+        return result;
+    }
+
+    /** \copydoc Bag::flush */
+    void flush ()  {}
+
+    /** \copydoc IBloom::getArray. */
+    u_int8_t*& getArray    ()  { return blooma; }
+
+    /** \copydoc IBloom::useArray. The blocks stay aligned on the cache lines as long as the
+     * array is (a mapped section is page aligned). */
+    void useArray (u_int8_t* array, system::ISmartPointer* owner)
+    {
+        system::impl::System::memory().free (_raw);
+        _raw   = owner==0 ? array : 0;
+        blooma = array;
+        setArrayOwner (owner);
+    }
+
+    /** \copydoc IBloom::getSize. */
+    u_int64_t  getSize     ()  { return _nbBlocks * BITS_PER_BLOCK / 8;  }
+
+    /** \copydoc IBloom::getBitSize. */
+    u_int64_t  getBitSize  ()  { return _nbBlocks * BITS_PER_BLOCK;  }
+
+    /** \copydoc IBloom::getNbHash */
+    size_t     getNbHash   () const { return n_hash_func; }
+
+    /** \copydoc IBloom::getName*/
+    std::string  getName () const { return "blocked"; }
+
+    /** \copydoc IBloom::weight*/
+    unsigned long weight()
+    {
+        unsigned long weight = 0;
+        for (u_int64_t i=0; i<getSize(); i++)  {  weight += __builtin_popcount (blooma[i]);  }
+        return weight;
+    }
+
+private:
+
+    static const size_t WORDS_PER_BLOCK = 8;
+    static const size_t MAX_HASH        = 16;
+    static const size_t BITS_PER_BLOCK  = 32*WORDS_PER_BLOCK;
+    static const size_t CACHE_LINE      = 64;
+
+    /** Get the block of a hash code; the high bits of the hash code are mapped to [0,nbBlocks[
+     * without a modulo. */
+    u_int32_t* getBlock (u_int64_t hash) const
+    {
+#if defined(__SIZEOF_INT128__)
+        u_int64_t idx = (u_int64_t) (((unsigned __int128) hash * _nbBlocks) >> 64);
+#else
+        u_int64_t idx = (hash >> 32) % _nbBlocks;
+#endif
+        return (u_int32_t*) blooma + idx*WORDS_PER_BLOCK;
+    }
+
+    /** Compute the k bits of the block from the low bits of the hash code, each one with its own
+     * multiplicative hash. */
+    void makeMask (u_int64_t hash, u_int32_t* mask) const
+    {
+        static const u_int32_t salt[MAX_HASH] =
+        {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+            0x9e3779b1U, 0x85ebca77U, 0xc2b2ae3dU, 0x27d4eb2fU, 0x165667b1U, 0xd3a2646dU, 0xfd7046c5U, 0xb55a4f09U
+        };
+        u_int32_t key = (u_int32_t) hash;
+
+        for (size_t i=0; i<WORDS_PER_BLOCK; i++)  {  mask[i] = 0;  }
+        for (size_t i=0; i<n_hash_func; i++)
+        {
+            u_int32_t bit = (key * salt[i]) >> 24;
+            mask[bit >> 5] |= 1U << (bit & 31);
+        }
+    }
+
+    /** Set the bits of the mask of the hash code in its block. */
+    void setBlock (u_int64_t hash)
+    {
+        u_int32_t* block = getBlock (hash);
+        u_int32_t  mask[WORDS_PER_BLOCK];
+        makeMask (hash, mask);
+
+        for (size_t i=0; i<WORDS_PER_BLOCK; i++)  {  if (mask[i])  {  __sync_fetch_and_or (block + i, mask[i]);  }  }
+    }
+
+    /** Tell whether all the bits of the mask of the hash code are set in the block. */
+    bool testBlock (const u_int32_t* block, u_int64_t hash) const
+    {
+        u_int32_t mask[WORDS_PER_BLOCK];
+        makeMask (hash, mask);
+        return _testMask (block, mask);
+    }
+
+    HashFunctors<Item> _hash;
+    size_t    n_hash_func;
+    size_t    _kmerSize;
+    Item      _kmerMask;
+
+    u_int8_t* _raw;
+    u_int8_t* blooma;
+    u_int64_t _nbBlocks;
+
+    BlockTestKernel      _testMask;
+    BlockTestBatchKernel _testMaskBatch;
+
+    system::ISmartPointer* _arrayOwner;
+    void setArrayOwner (system::ISmartPointer* arrayOwner)  { SP_SETATTR(arrayOwner); }
+};
+
+/********************************************************************************/
+
 /** \brief Factory that creates IBloom instances
  *
  */
@@ -1259,6 +1699,7 @@ public:
             case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash);
             case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
 			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash);
+            case tools::misc::BLOOM_BLOCKED:   return new BloomBlocked<T>          (tai_bloom, kmersize, nbHash);
             case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
             default:        throw system::Exception ("bad Bloom kind %d in createBloom", kind);
         }
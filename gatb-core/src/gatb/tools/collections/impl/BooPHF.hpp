@@ -33,6 +33,8 @@
 #include <BooPHF/BooPHF.h>
 
 #include <random> // for mt19937_64
+#include <sstream>
+#include <cstring>
 
 /********************************************************************************/
 namespace gatb        {
@@ -259,13 +261,178 @@ private:
 
     typedef boomphf::mphf<  Key, hasher_t  > boophf_t;
 
+    /** Read only view of a hash function saved by boophf_t::save into a mapped file (or into a
+     * Buffer): the bit arrays of the levels and their ranks are used in place, only the final hash
+     * (a few keys) is read. The lookup is the same as boophf_t::lookup; the memory read by a lookup
+     * can also be prefetched, which boophf_t doesn't provide. */
+    class mapped_boophf_t
+    {
+    public:
+
+        mapped_boophf_t () : _nelem(0), _lastbitsetrank(0)  {}
+
+        /** Use the hash function saved at the given address, which must be 8 bytes aligned
+         * (see BooPHF::save) and live longer than this object. */
+        void map (const char* ptr)
+        {
+            double gamma = 0;  int nbLevels = 0;
+            read (ptr, gamma);  read (ptr, nbLevels);  read (ptr, _lastbitsetrank);  read (ptr, _nelem);
+
+            /** Same size of the levels as computed by boophf_t::load. */
+            double    probaCollision = 1.0 - pow (((gamma*(double)_nelem - 1) / (gamma*(double)_nelem)), _nelem-1);
+            u_int64_t hashDomain     = (size_t) (ceil (double(_nelem) * gamma));
+
+            _levels.resize (nbLevels);
+            for (int i=0; i<nbLevels; i++)
+            {
+                Level& level = _levels[i];
+
+                level.hashDomain = (((u_int64_t) (hashDomain * pow (probaCollision, i)) + 63) / 64) * 64;
+                if (level.hashDomain == 0)  { level.hashDomain = 64; }
+
+                u_int64_t size = 0, nbWords = 0;  size_t nbRanks = 0;
+                read (ptr, size);  read (ptr, nbWords);
+                level.bits  = (const u_int64_t*) ptr;  ptr += nbWords * sizeof(u_int64_t);
+                read (ptr, nbRanks);
+                level.ranks = (const u_int64_t*) ptr;  ptr += nbRanks * sizeof(u_int64_t);
+            }
+
+            size_t nbFinal = 0;  read (ptr, nbFinal);
+            _finalHash.clear();
+            for (size_t i=0; i<nbFinal; i++)
+            {
+                Key key;  u_int64_t value = 0;
+                read (ptr, key);  read (ptr, value);
+                _finalHash[key] = value;
+            }
+        }
+
+        /** \copydoc boophf_t::lookup */
+        u_int64_t lookup (const Key& key)
+        {
+            if (_levels.empty())  { return ULLONG_MAX; }
+
+            boomphf::hash_pair_t bbhash;
+            u_int64_t hash  = 0;
+            size_t    level = 0;
+            size_t    last  = _levels.size() - 1;
+
+            for ( ; level<last; level++)
+            {
+                if      (level == 0)  { hash = _hasher.h0 (bbhash, key); }
+                else if (level == 1)  { hash = _hasher.h1 (bbhash, key); }
+                else                  { hash = _hasher.next (bbhash);    }
+
+                if (get (_levels[level], hash % _levels[level].hashDomain))  { break; }
+            }
+
+            if (level == last)
+            {
+                typename std::unordered_map<Key,u_int64_t,hasher_t>::const_iterator it = _finalHash.find (key);
+                return it == _finalHash.end() ? ULLONG_MAX : it->second + _lastbitsetrank;
+            }
+
+            return rank (_levels[level], hash % _levels[level].hashDomain);
+        }
+
+        /** Prefetch the memory of the first level for a later lookup, most keys being found at this level. */
+        void prefetch (const Key& key)
+        {
+            if (_levels.size() < 2)  { return; }
+
+            boomphf::hash_pair_t bbhash;
+            u_int64_t pos = _hasher.h0 (bbhash, key) % _levels[0].hashDomain;
+
+            __builtin_prefetch (_levels[0].bits  + pos / 64,            0, 3);
+            __builtin_prefetch (_levels[0].ranks + pos / BITS_PER_RANK, 0, 3);
+        }
+
+        /** \copydoc boophf_t::nbKeys */
+        u_int64_t nbKeys () const  { return _nelem; }
+
+    private:
+
+        /** Number of bits per rank sample, as in boomphf::bitVector. */
+        static const u_int64_t BITS_PER_RANK = 512;
+
+        struct Level
+        {
+            Level () : hashDomain(0), bits(0), ranks(0)  {}
+            u_int64_t        hashDomain;
+            const u_int64_t* bits;
+            const u_int64_t* ranks;
+        };
+
+        template<typename T> static void read (const char*& ptr, T& value)  {  memcpy (&value, ptr, sizeof(T));  ptr += sizeof(T);  }
+
+        static bool get (const Level& level, u_int64_t pos)  {  return (level.bits[pos / 64] >> (pos % 64)) & 1;  }
+
+        static u_int64_t rank (const Level& level, u_int64_t pos)
+        {
+            u_int64_t word  = pos / 64;
+            u_int64_t block = pos / BITS_PER_RANK;
+            u_int64_t r     = level.ranks[block];
+
+            for (u_int64_t w = block * BITS_PER_RANK / 64; w < word; w++)  {  r += boomphf::popcount_64 (level.bits[w]);  }
+
+            return r + boomphf::popcount_64 (level.bits[word] & ((u_int64_t(1) << (pos % 64)) - 1));
+        }
+
+        boomphf::XorshiftHashFunctors<Key,hasher_t>  _hasher;
+        std::vector<Level>                          _levels;
+        std::unordered_map<Key,u_int64_t,hasher_t>  _finalHash;
+        u_int64_t                                   _nelem;
+        u_int64_t                                   _lastbitsetrank;
+    };
+
+    /** Padding written before the hash function in the mapped file: the number of levels being
+     * saved as an int, it puts the bit arrays on 8 bytes boundaries. */
+    static const size_t MAPPED_PADDING = 4;
+
+    /** Memory holding a hash function saved by boophf_t::save after MAPPED_PADDING bytes, with the
+     * same alignment as in the mapped file. */
+    class Buffer : public system::SmartPointer
+    {
+    public:
+        Buffer (const std::string& data) : _words ((data.size() + 7) / 8)  {  memcpy (_words.data(), data.data(), data.size());  }
+        const char* data () const  { return (const char*) _words.data(); }
+    private:
+        std::vector<u_int64_t> _words;
+    };
+
 public:
 
     /** Definition of a hash value. */
     typedef u_int64_t Code;
 
     /** Constructor. */
-    BooPHF () : isBuilt(false), nbKeys(0)  {}
+    BooPHF () : isBuilt(false), nbKeys(0), _data(0), _dataSize(0), _mapping(0)  {}
+
+    /** Copy constructor. A hash function used in place from a mapped file (or a buffer) is shared, not copied. */
+    BooPHF (const BooPHF& other) : bphf(other.bphf), mbphf(other.mbphf), isBuilt(other.isBuilt), nbKeys(other.nbKeys),
+        _data(other._data), _dataSize(other._dataSize), _mapping(0)
+    {
+        setMapping (other._mapping);
+    }
+
+    /** Assignment operator. */
+    BooPHF& operator= (const BooPHF& other)
+    {
+        if (this != &other)
+        {
+            bphf    = other.bphf;
+            mbphf   = other.mbphf;
+            isBuilt   = other.isBuilt;
+            nbKeys    = other.nbKeys;
+            _data     = other._data;
+            _dataSize = other._dataSize;
+            setMapping (other._mapping);
+        }
+        return *this;
+    }
+
+    /** Destructor. */
+    ~BooPHF ()  {  setMapping (0);  }
 
     /** Build the hash function from a set of items.
      * \param[in] iterable : keys iterator
@@ -292,6 +459,8 @@ public:
 
         isBuilt = true;
         nbKeys  = iterable->getNbItems();
+
+        useBuffer ();
     }
 
     /** Returns the hash code for the given key. WARNING : default implementation here will
@@ -300,20 +469,48 @@ public:
      * \return the hash value. */
     Code operator () (const Key& key)
     {
-        return bphf.lookup (key);
+        return _mapping ? mbphf.lookup (key) : bphf.lookup (key);
+    }
+
+    /** Prefetch the memory needed for hashing the given key; this is useful for hashing
+     * several keys in a row (see MapMPHF::getCode).
+     * \param[in] key : the key to be hashed later */
+    void prefetch (const Key& key)
+    {
+        if (_mapping)  { mbphf.prefetch (key); }
     }
 
     /** Returns the number of keys.
      * \return keys number */
-    size_t size() const { return bphf.nbKeys(); }
+    size_t size() const { return _mapping ? mbphf.nbKeys() : bphf.nbKeys(); }
 
-    /** Load hash function from a collection*/
+    /** Load hash function from a collection. If the storage has a mapped file holding the hash
+     * function, its bit arrays are used in place (see mapped_boophf_t) instead of being read
+     * from the collection. */
     size_t load (tools::storage::impl::Group& group, const std::string& name)
     {
-        /** We need an input stream for the given collection given by group/name. */
-        tools::storage::impl::Storage::istream is (group, name);
+        tools::storage::impl::Storage*    storage    = group.getStorage();
+        tools::storage::impl::MappedFile* mappedFile = storage ? storage->getMappedFile() : 0;
+        std::string                       section    = tools::storage::impl::Storage::getSectionName (group, name);
+
 		bphf =  boophf_t();
-        bphf.load (is);
+        mbphf = mapped_boophf_t();
+        _data = 0;  _dataSize = 0;
+
+        if (mappedFile != 0  &&  mappedFile->hasSection (section))
+        {
+            _data = (const char*) mappedFile->getSection (section, _dataSize);
+            mbphf.map (_data + MAPPED_PADDING);
+            setMapping (mappedFile);
+        }
+        else
+        {
+            /** We need an input stream for the given collection given by group/name. */
+            tools::storage::impl::Storage::istream is (group, name);
+            bphf.load (is);
+            setMapping (0);
+            useBuffer ();
+        }
         return size();
     }
 
@@ -323,17 +520,63 @@ public:
     {
         /** We need an output stream for the given collection given by group/name. */
         tools::storage::impl::Storage::ostream os (group, name);
-        bphf.save (os);
+        if (_mapping)  {  os.write (_data + MAPPED_PADDING, _dataSize - MAPPED_PADDING);  }
+        else           {  bphf.save (os);  }
         /** We set the number of keys as an attribute of the group. */
         group.addProperty ("nb_keys", misc::impl::Stringify().format("%d",nbKeys)); // FIXME: maybe overflow here
+
+        /** The hash function is also written into the mapped file of the storage, if any. */
+        tools::storage::impl::Storage* storage = group.getStorage();
+        if (storage != 0  &&  storage->getMappedFileWriter() != 0)
+        {
+            tools::storage::impl::MappedFileWriter::ostream mos (*storage->getMappedFileWriter(), tools::storage::impl::Storage::getSectionName (group, name));
+            if (_mapping)  {  mos.write (_data, _dataSize);  }
+            else
+            {
+                const char padding[MAPPED_PADDING] = { 0 };
+                mos.write (padding, MAPPED_PADDING);
+                bphf.save (mos);
+            }
+        }
+
         return os.tellp();
     }
 
 private:
 
-    boophf_t  bphf;
-    bool      isBuilt;
-    size_t    nbKeys;
+    boophf_t         bphf;
+    mapped_boophf_t  mbphf;
+    bool             isBuilt;
+    size_t           nbKeys;
+
+    /** Hash function saved by boophf_t::save (after MAPPED_PADDING bytes), used in place by mbphf. */
+    const char*      _data;
+    u_int64_t        _dataSize;
+
+    /** Owner of the memory of the hash function bit arrays, if they are used in place (mbphf). */
+    system::ISmartPointer* _mapping;
+    void setMapping (system::ISmartPointer* mapping)  { SP_SETATTR(mapping); }
+
+    /** Use the hash function of bphf through mbphf, as if it were mapped from a file, so that
+     * the lookups can be prefetched; bphf is then released. An empty hash function is kept as is. */
+    void useBuffer ()
+    {
+        if (bphf.nbKeys() == 0)  { return; }
+
+        std::ostringstream os;
+        const char padding[MAPPED_PADDING] = { 0 };
+        os.write (padding, MAPPED_PADDING);
+        bphf.save (os);
+        bphf = boophf_t();
+
+        std::string data = os.str();
+        Buffer*     buffer = new Buffer (data);
+        setMapping (buffer);
+
+        _data     = buffer->data();
+        _dataSize = data.size();
+        mbphf.map (_data + MAPPED_PADDING);
+    }
 
 private:
 
@@ -55,23 +55,45 @@ public:
     /** Constructor.
      * \param[in] it : iterator over the items of the container. They are all inserted in the vector
      * and the vector is then sorted. */
-    ContainerSet (dp::Iterator<Item>* it)
+    ContainerSet (dp::Iterator<Item>* it) : _begin(0), _end(0), _owner(0)
     {
         LOCAL (it);
         for (it->first(); !it->isDone(); it->next())  {  _items.push_back (it->item());  }
 
         std::sort (_items.begin(), _items.end());
+
+        _begin = _items.data();
+        _end   = _begin + _items.size();
     }
-    
+
+    /** Constructor. The items are used in place, without copy (for instance from a mapped file).
+     * \param[in] items : sorted items of the container
+     * \param[in] nb : number of items
+     * \param[in] owner : object owning the memory of the items, kept as long as the container */
+    ContainerSet (const Item* items, size_t nb, system::ISmartPointer* owner) : _begin(items), _end(items+nb), _owner(0)
+    {
+        setOwner (owner);
+    }
+
+    /** Destructor. */
+    ~ContainerSet ()  {  setOwner (0);  }
+
     /** \copydoc Container::contains */
     bool contains (const Item& item)
     {
-        return std::binary_search (_items.begin(), _items.end(), item);
+        return std::binary_search (_begin, _end, item);
     }
 
 private:
     
     std::vector<Item> _items;
+
+    /** Range of the sorted items: either the vector, or some external memory. */
+    const Item* _begin;
+    const Item* _end;
+
+    system::ISmartPointer* _owner;
+    void setOwner (system::ISmartPointer* owner)  { SP_SETATTR(owner); }
 };
 
 /********************************************************************************/
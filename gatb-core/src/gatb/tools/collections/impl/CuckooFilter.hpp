@@ -0,0 +1,334 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file CuckooFilter.hpp
+ *  \brief Cuckoo filter implementation
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_CUCKOO_FILTER_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_CUCKOO_FILTER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/system/api/Exception.hpp>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Cuckoo filter
+ *
+ * A cuckoo filter stores a small fingerprint of each inserted item in one of two candidate
+ * buckets; an item is said to be in the filter if its fingerprint is found in one of its two
+ * buckets. Compared to a Bloom filter, it supports the removal of an (inserted) item, and a
+ * query reads two memory words only.
+ *
+ * Each bucket is one 64 bits word holding 64/f fingerprints of f bits (from 4 to 16 bits), so
+ * a bucket is read, and a fingerprint removed, with one (atomic) memory access. The false
+ * positive rate is about 2*(64/f)/2^f, ie. 0.24% for 12 bits fingerprints.
+ *
+ * The alternate bucket of a fingerprint stored in bucket i is (H(fp) - i) modulo the number
+ * of buckets, which is an involution; the number of buckets hence doesn't need to be a power
+ * of two and the filter is sized for the expected number of items.
+ *
+ * Insertions may be done concurrently: an empty slot is filled with a compare and swap on its
+ * bucket, and only the (rare) insertions needing to move fingerprints are serialized. Queries and
+ * removals may be done concurrently too, but not during insertions since a moved fingerprint is
+ * missing from the table for a short time.
+ */
+template <typename Item> class CuckooFilter : public Container<Item>, public Bag<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbItems : expected number of items in the filter
+     * \param[in] fingerprintBits : number of bits of the fingerprints, from 4 to 16 */
+    CuckooFilter (u_int64_t nbItems, size_t fingerprintBits = 12)
+        : _hash(1), _capacity(nbItems), _fpBits(fingerprintBits), _slots(0), _nbBuckets(0), _table(0),
+          _victimFp(0), _victimIdx(0), _nbItems(0), _arrayOwner(0), _synchro(0)
+    {
+        if (_fpBits < 4 || _fpBits > 16)  {  throw system::Exception ("bad fingerprint size %d for cuckoo filter (4 to 16 bits)", _fpBits);  }
+
+        _slots     = 64 / _fpBits;
+        _fpMask    = (1ULL << _fpBits) - 1;
+        /** The buckets are filled at 90% at most, which makes insertion failures unlikely. */
+        _nbBuckets = (u_int64_t) (nbItems / (_slots * 0.9)) + 1;
+        _table     = (u_int64_t*) CALLOC (_nbBuckets, sizeof(u_int64_t));
+
+        setSynchro (system::impl::System::thread().newSynchronizer());
+    }
+
+    /** Destructor. */
+    ~CuckooFilter ()
+    {
+        if (_arrayOwner == 0)  {  system::impl::System::memory().free (_table);  }
+        setArrayOwner (0);
+        setSynchro    (0);
+    }
+
+    /** \copydoc Bag::insert
+     * Throws an exception if the filter is full. May be called concurrently. */
+    void insert (const Item& item)
+    {
+        u_int64_t fp, i1;
+        locate (_hash (item,0), fp, i1);
+
+        if (addInBucket (i1, fp) || addInBucket (alternate (i1, fp), fp))  {  __sync_fetch_and_add (&_nbItems, 1);  return;  }
+
+        /** Both buckets are full: we move fingerprints to their alternate bucket, one insertion
+         * at a time (other threads may still fill empty slots meanwhile). */
+        system::LocalSynchronizer localsynchro (_synchro);
+
+        u_int64_t idx = (fp & 1) ? i1 : alternate (i1, fp);
+
+        for (size_t kick=0; kick<MAX_KICKS; kick++)
+        {
+            /** We swap our fingerprint with one of the bucket (not always the same one). */
+            size_t slot = (kick + idx) % _slots;
+            fp  = swapSlot (idx, slot, fp);
+            if (fp == 0)  {  __sync_fetch_and_add (&_nbItems, 1);  return;  }
+            idx = alternate (idx, fp);
+
+            if (addInBucket (idx, fp))  {  __sync_fetch_and_add (&_nbItems, 1);  return;  }
+        }
+
+        /** The last fingerprint without bucket is kept aside. */
+        if (_victimFp != 0)  {  throw system::Exception ("cuckoo filter is full (%lld items)", (long long)_nbItems);  }
+
+        _victimFp  = fp;
+        _victimIdx = idx;
+        __sync_fetch_and_add (&_nbItems, 1);
+    }
+
+    /** \copydoc Bag::flush */
+    void flush ()  {}
+
+    /** \copydoc Container::contains */
+    bool contains (const Item& item)
+    {
+        u_int64_t fp, i1;
+        locate (_hash (item,0), fp, i1);
+        return containsFp (fp, i1, alternate (i1, fp));
+    }
+
+    /** \copydoc Container::containsBatch
+     * The two buckets of a chunk of items are prefetched before being tested. */
+    void containsBatch (const Item* items, size_t n, u_int8_t* out)
+    {
+        static const size_t BATCH = 8;
+        u_int64_t fp[BATCH], i1[BATCH], i2[BATCH];
+
+        for (size_t b=0; b<n; b+=BATCH)
+        {
+            size_t m = std::min (BATCH, n-b);
+            for (size_t i=0; i<m; i++)
+            {
+                locate (_hash (items[b+i],0), fp[i], i1[i]);
+                i2[i] = alternate (i1[i], fp[i]);
+                __builtin_prefetch (_table + i1[i], 0, 3);
+                __builtin_prefetch (_table + i2[i], 0, 3);
+            }
+            for (size_t i=0; i<m; i++)  {  out[b+i] = containsFp (fp[i], i1[i], i2[i]);  }
+        }
+    }
+
+    /** Remove an item from the filter. Only items actually inserted should be removed, otherwise
+     * an inserted item sharing the same fingerprint and buckets would be removed instead.
+     * \param[in] item : the item to be removed
+     * \return true if a fingerprint of the item has been found and removed, false otherwise. */
+    bool remove (const Item& item)
+    {
+        u_int64_t fp, i1;
+        locate (_hash (item,0), fp, i1);
+        u_int64_t i2 = alternate (i1, fp);
+
+        if (removeFromBucket (i1, fp) || removeFromBucket (i2, fp))  {  __sync_fetch_and_sub (&_nbItems, 1);  return true;  }
+
+        if (_victimFp == fp && (_victimIdx == i1 || _victimIdx == i2))
+        {
+            if (__sync_bool_compare_and_swap (&_victimFp, fp, 0))  {  __sync_fetch_and_sub (&_nbItems, 1);  return true;  }
+        }
+        return false;
+    }
+
+    /** Get the table of buckets.
+     * \return the buckets. */
+    u_int8_t* getArray ()  { return (u_int8_t*) _table; }
+
+    /** Use an external table of buckets (for instance a section of a mapped file) instead of the
+     * table allocated by the filter, which is released. The external table must hold getSize() bytes.
+     * \param[in] array : the table to be used
+     * \param[in] owner : object owning the memory of the table, kept as long as the filter; if null,
+     *  the table (allocated by malloc) is released by the filter */
+    void useArray (u_int8_t* array, system::ISmartPointer* owner)
+    {
+        if (_arrayOwner == 0)  {  system::impl::System::memory().free (_table);  }
+        _table = (u_int64_t*) array;
+        setArrayOwner (owner);
+    }
+
+    /** Get the size of the table of buckets.
+     * \return the size (in bytes) of the table. */
+    u_int64_t getSize () const  { return _nbBuckets * sizeof(u_int64_t); }
+
+    /** \return the expected number of items given to the constructor. */
+    u_int64_t getCapacity () const  { return _capacity; }
+
+    /** \return the number of buckets. */
+    u_int64_t getNbBuckets () const  { return _nbBuckets; }
+
+    /** \return the number of bits of the fingerprints. */
+    size_t getFingerprintBits () const  { return _fpBits; }
+
+    /** \return the number of items in the filter. */
+    u_int64_t getNbItems () const  { return _nbItems; }
+
+    /** Get the fingerprint kept aside when the buckets were full, needed for saving the filter.
+     * \param[out] fp : the fingerprint (0 if none)
+     * \param[out] idx : the bucket of the fingerprint */
+    void getVictim (u_int64_t& fp, u_int64_t& idx) const  {  fp = _victimFp;  idx = _victimIdx;  }
+
+    /** Restore the state of a loaded filter.
+     * \param[in] nbItems : number of items in the filter
+     * \param[in] fp : the fingerprint kept aside (see getVictim)
+     * \param[in] idx : the bucket of the fingerprint kept aside */
+    void setState (u_int64_t nbItems, u_int64_t fp, u_int64_t idx)  {  _nbItems = nbItems;  _victimFp = fp;  _victimIdx = idx;  }
+
+    /** Get the name of the implementation.
+     * \return the name. */
+    std::string getName () const  { return "cuckoo"; }
+
+private:
+
+    static const size_t MAX_KICKS = 500;
+
+    HashFunctors<Item> _hash;
+
+    u_int64_t  _capacity;
+    size_t     _fpBits;
+    size_t     _slots;
+    u_int64_t  _fpMask;
+    u_int64_t  _nbBuckets;
+    u_int64_t* _table;
+
+    u_int64_t  _victimFp;
+    u_int64_t  _victimIdx;
+    u_int64_t  _nbItems;
+
+    system::ISmartPointer* _arrayOwner;
+    void setArrayOwner (system::ISmartPointer* arrayOwner)  { SP_SETATTR(arrayOwner); }
+
+    /** Serializes the insertions moving fingerprints. */
+    system::ISynchronizer* _synchro;
+    void setSynchro (system::ISynchronizer* synchro)  { SP_SETATTR(synchro); }
+
+    /** Map a 64 bits value to [0,nbBuckets[ without a modulo. */
+    u_int64_t reduce (u_int64_t value) const
+    {
+#if defined(__SIZEOF_INT128__)
+        return (u_int64_t) (((unsigned __int128) value * _nbBuckets) >> 64);
+#else
+        return (value >> 32) % _nbBuckets;
+#endif
+    }
+
+    /** The fingerprint comes from the low bits of the hash code (0 means an empty slot), the
+     * first bucket from the high bits. */
+    void locate (u_int64_t hash, u_int64_t& fp, u_int64_t& idx) const
+    {
+        fp  = hash & _fpMask;
+        if (fp == 0)  { fp = 1; }
+        idx = reduce (hash);
+    }
+
+    /** The other bucket of a fingerprint. */
+    u_int64_t alternate (u_int64_t idx, u_int64_t fp) const
+    {
+        u_int64_t r = reduce (fp * 0xc6a4a7935bd1e995ULL);
+        return r >= idx ? r - idx : r + _nbBuckets - idx;
+    }
+
+    u_int64_t getSlot (u_int64_t bucket, size_t slot) const  {  return (bucket >> (slot*_fpBits)) & _fpMask;  }
+
+    /** Put a fingerprint in a slot with a compare and swap on the whole bucket.
+     * \return the fingerprint previously in the slot (0 if it was empty). */
+    u_int64_t swapSlot (u_int64_t idx, size_t slot, u_int64_t fp)
+    {
+        u_int64_t shift = slot*_fpBits;
+        while (true)
+        {
+            u_int64_t bucket = _table[idx];
+            u_int64_t filled = (bucket & ~(_fpMask << shift)) | (fp << shift);
+            if (__sync_bool_compare_and_swap (_table + idx, bucket, filled))  {  return getSlot (bucket, slot);  }
+        }
+    }
+
+    bool bucketContains (u_int64_t bucket, u_int64_t fp) const
+    {
+        for (size_t s=0; s<_slots; s++)  {  if (getSlot (bucket, s) == fp)  { return true; }  }
+        return false;
+    }
+
+    bool containsFp (u_int64_t fp, u_int64_t i1, u_int64_t i2) const
+    {
+        return bucketContains (_table[i1], fp) || bucketContains (_table[i2], fp)
+            || (_victimFp == fp && (_victimIdx == i1 || _victimIdx == i2));
+    }
+
+    /** An empty slot is filled with a compare and swap on the whole bucket, so concurrent
+     * insertions are safe. */
+    bool addInBucket (u_int64_t idx, u_int64_t fp)
+    {
+        for (size_t s=0; s<_slots; )
+        {
+            u_int64_t bucket = _table[idx];
+            if (getSlot (bucket, s) != 0)  { s++;  continue; }
+
+            u_int64_t filled = bucket | (fp << (s*_fpBits));
+            if (__sync_bool_compare_and_swap (_table + idx, bucket, filled))  { return true; }
+        }
+        return false;
+    }
+
+    /** The slot is cleared with a compare and swap on the whole bucket, so concurrent removals
+     * (and queries) are safe. */
+    bool removeFromBucket (u_int64_t idx, u_int64_t fp)
+    {
+        for (size_t s=0; s<_slots; )
+        {
+            u_int64_t bucket = _table[idx];
+            if (getSlot (bucket, s) != fp)  { s++;  continue; }
+
+            u_int64_t cleared = bucket & ~(_fpMask << (s*_fpBits));
+            if (__sync_bool_compare_and_swap (_table + idx, bucket, cleared))  { return true; }
+        }
+        return false;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_CUCKOO_FILTER_HPP_ */
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HyperLogLog.hpp
+ *  \brief HyperLogLog cardinality estimator
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/system/api/Exception.hpp>
+#include <gatb/system/api/types.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Estimate the number of distinct items of a set with a HyperLogLog sketch.
+ *
+ * The sketch holds 2^precision registers of one byte: the first 'precision' bits of
+ * the 64 bits hash code of an item select a register, which keeps the max rank of
+ * the first set bit found in the remaining bits. The relative standard error of the
+ * estimation is about 1.04/sqrt(2^precision), ie. 0.8% for the default precision
+ * (16 KBytes of registers).
+ *
+ * Since the hash codes have 64 bits, no large range correction is needed; the small
+ * range is corrected by linear counting on the empty registers.
+ *
+ * Sketches with the same precision and seed can be merged, for instance when each
+ * thread fills its own sketch.
+ *
+ * Example:
+ * \code
+ *   HyperLogLog<Type> hll;
+ *   for (...)  {  hll.insert (kmer);  }
+ *   u_int64_t nbDistinct = hll.estimate();
+ * \endcode
+ */
+template <typename Item> class HyperLogLog
+{
+public:
+
+    /** Constructor.
+     * \param[in] precision : log2 of the number of registers, in [4..18]
+     * \param[in] seed : seed of the hash function */
+    HyperLogLog (size_t precision=14, u_int64_t seed=0) : _precision(precision), _seed(seed)
+    {
+        if (precision < 4 || precision > 18)  { throw system::Exception ("HyperLogLog: bad precision %d (should be in [4..18])", precision); }
+
+        _registers.resize ((size_t)1 << _precision, 0);
+    }
+
+    /** Add an item to the sketch.
+     * \param[in] item : the item */
+    void insert (const Item& item)  {  insertHash (hash1 (item, _seed));  }
+
+    /** Add an item through its hash code; useful when the hash code is also used for
+     * something else (sampling for instance).
+     * \param[in] code : 64 bits hash code of the item. */
+    void insertHash (u_int64_t code)
+    {
+        size_t idx = code >> (64 - _precision);
+
+        /** The sentinel bit bounds the rank to 64-precision+1. */
+        u_int64_t remaining = (code << _precision) | ((u_int64_t)1 << (_precision - 1));
+        u_int8_t  rank      = __builtin_clzll (remaining) + 1;
+
+        if (rank > _registers[idx])  { _registers[idx] = rank; }
+    }
+
+    /** Merge another sketch into this one. The result is the sketch of the union of both sets.
+     * \param[in] other : sketch built with the same precision and seed */
+    void merge (const HyperLogLog& other)
+    {
+        if (other._precision != _precision || other._seed != _seed)  { throw system::Exception ("HyperLogLog: can't merge sketches of different kinds"); }
+
+        for (size_t i=0; i<_registers.size(); i++)
+        {
+            if (other._registers[i] > _registers[i])  { _registers[i] = other._registers[i]; }
+        }
+    }
+
+    /** Estimate the number of distinct items inserted so far.
+     * \return the estimation. */
+    u_int64_t estimate () const
+    {
+        double m     = _registers.size();
+        double sum   = 0;
+        size_t zeros = 0;
+
+        for (size_t i=0; i<_registers.size(); i++)
+        {
+            sum += std::ldexp (1.0, -(int)_registers[i]);
+            if (_registers[i] == 0)  { zeros++; }
+        }
+
+        double alpha  = m >= 128 ? 0.7213 / (1.0 + 1.079/m) : (m >= 64 ? 0.709 : (m >= 32 ? 0.697 : 0.673));
+        double result = alpha * m * m / sum;
+
+        /** Small range correction. */
+        if (result <= 2.5*m && zeros > 0)  {  result = m * std::log (m / zeros);  }
+
+        return (u_int64_t) (result + 0.5);
+    }
+
+    /** Remove all the items of the sketch. */
+    void clear ()  {  std::fill (_registers.begin(), _registers.end(), 0);  }
+
+    /** Get the precision of the sketch.
+     * \return the log2 of the number of registers. */
+    size_t getPrecision () const  { return _precision; }
+
+private:
+
+    size_t                _precision;
+    u_int64_t             _seed;
+    std::vector<u_int8_t> _registers;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_ */
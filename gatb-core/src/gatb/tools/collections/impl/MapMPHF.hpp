@@ -48,7 +48,7 @@ namespace gatb        {
 					 *
 					 * Using BooPHF, the memory usage is about 3-4 bits per key.
 					 *
-					 * The values can be stored in a simple vector. The keys are not stored in memory, only
+					 * The values can be stored in a simple array. The keys are not stored in memory, only
 					 * the mphf is needed.
 					 *
 					 * Note that such an implementation can't afford to add items into the map (it's static).
@@ -62,7 +62,10 @@ namespace gatb        {
 						typedef BooPHF<Key, Adaptator> Hash;
 						
 						/** Default constructor. */
-						MapMPHF () : hash() {}
+						MapMPHF () : hash(), data(0), nbData(0), _mapping(0) {}
+
+						/** Destructor. */
+						~MapMPHF ()  {  setData (0, 0, 0);  }
 						
 						/** Build the hash function from a set of items.
 						 * \param[in] keys : iterable over the keys of the hash table
@@ -73,9 +76,8 @@ namespace gatb        {
 							/** We build the hash function. */
 							hash.build (&keys, nbThreads, progress);
 							
-							/** We resize the vector of Value objects. */
-							data.resize (keys.getNbItems());
-							clearData();
+							/** We allocate the (zeroed) array of Value objects. */
+							allocateData (keys.getNbItems());
 							initDiscretizationScheme();
 						}
 						
@@ -157,16 +159,15 @@ namespace gatb        {
 						}
 						
 						/* use the hash from another MapMPHF class. hmm is this smartpointer legit?
-						 * also allocate n/x data elements
+						 * also allocate n/x data elements; the other map may hold another type of values.
 						 */
-						void useHashFrom (MapMPHF *other, int x = 1)
+						template <class OtherValue>
+						void useHashFrom (MapMPHF<Key,OtherValue,Adaptator> *other, int x = 1)
 						{
 							hash = other->hash;
 							
-							/** We resize the vector of Value objects. */
-							data.resize ((unsigned long)((hash.size()) / (unsigned long)x) + 1LL); // that +1 and not (hash.size+x-1) / x
-							
-							clearData();
+							/** We allocate the (zeroed) array of Value objects. */
+							allocateData ((unsigned long)((hash.size()) / (unsigned long)x) + 1LL); // that +1 and not (hash.size+x-1) / x
 						}
 						
 						/** Save the hash function into a Group object.
@@ -185,11 +186,44 @@ namespace gatb        {
 							/** We load the hash function. */
 							size_t nbKeys = hash.load (group, name);
 							
-							/** We resize the vector of Value objects. */
-							data.resize (nbKeys);
-							clearData();
+							/** We allocate the (zeroed) array of Value objects. */
+							allocateData (nbKeys);
 							initDiscretizationScheme();
 						}
+
+						/** Save the values into the mapped file of the storage of a group, if this file is
+						 * being written (see Storage::createMappedFile).
+						 * \param[in] group : group where the MPHF is saved
+						 * \param[in] name : name of the MPHF */
+						void saveValues (tools::storage::impl::Group& group, const std::string& name)
+						{
+							tools::storage::impl::Storage* storage = group.getStorage();
+							if (storage == 0  ||  storage->getMappedFileWriter() == 0)  { return; }
+
+							storage->getMappedFileWriter()->addSection (getValuesSectionName (group, name), data, nbData*sizeof(Value));
+						}
+
+						/** Use in place the values saved by saveValues, if the storage of the group has a
+						 * mapped file holding them. The values are then not to be computed again.
+						 * \param[in] group : group where the MPHF is saved
+						 * \param[in] name : name of the MPHF
+						 * \return true if the values are used from the mapped file, false otherwise. */
+						bool loadValues (tools::storage::impl::Group& group, const std::string& name)
+						{
+							tools::storage::impl::Storage*    storage    = group.getStorage();
+							tools::storage::impl::MappedFile* mappedFile = storage ? storage->getMappedFile() : 0;
+							std::string                       section    = getValuesSectionName (group, name);
+
+							if (mappedFile == 0  ||  mappedFile->hasSection (section) == false)  { return false; }
+
+							u_int64_t size   = 0;
+							Value*    values = (Value*) mappedFile->getSection (section, size);
+
+							if (size != nbData*sizeof(Value))  {  throw system::Exception ("bad size for MPHF values '%s' in mapped file", section.c_str());  }
+
+							setData (values, nbData, mappedFile);
+							return true;
+						}
 						
 						/** Get the value for a given key
 						 * \param[in] key : the key
@@ -215,24 +249,64 @@ namespace gatb        {
 						
 						/** Get the hash code of the given key. */
 						typename Hash::Code getCode (const Key& key) { return hash(key); }
+
+						/** Get the hash codes of a batch of keys: the memory of all the keys is
+						 * prefetched before they are hashed, so the cache misses overlap.
+						 * \param[in] keys : the keys
+						 * \param[in] n : number of keys
+						 * \param[out] codes : hash codes of the keys */
+						void getCode (const Key* keys, size_t n, typename Hash::Code* codes)
+						{
+							for (size_t i=0; i<n; i++)  {  hash.prefetch (keys[i]);  }
+							for (size_t i=0; i<n; i++)  {  codes[i] = hash (keys[i]);  }
+						}
+
+						/** Prefetch the value for a given hash code.
+						 * \param[in] code : the hash code */
+						void prefetch (typename Hash::Code code)  {  __builtin_prefetch (&data[code], 0, 3);  }
 						
 						/** Get the number of keys.
 						 * \return keys number. */
 						size_t size() const { return hash.size(); }
 						
 						void clearData() { 
-							for (unsigned long i = 0; i < data.size(); i ++)
-								data[i] = 0;
+							memset (data, 0, nbData*sizeof(Value));
 						}
 						
 						std::vector<int>   _abundanceDiscretization;
 
 					private:
 						
+						template <class K, class V, class A>  friend class MapMPHF;
+
 						Hash               hash;
-						std::vector<Value> data;
-						
+
+						/** Values, either allocated or used in place from a mapped file (owned by _mapping). */
+						Value*             data;
+						size_t             nbData;
+						system::ISmartPointer* _mapping;
+						void setMapping (system::ISmartPointer* mapping)  { SP_SETATTR(mapping); }
+
+						void setData (Value* values, size_t nb, system::ISmartPointer* mapping)
+						{
+							if (_mapping == 0)  {  FREE (data);  }
+							data   = values;
+							nbData = nb;
+							setMapping (mapping);
+						}
+
+						/** Zeroed pages are given lazily by the system, so a big array costs nothing
+						 * until it is written (or until it is replaced by loadValues). */
+						void allocateData (size_t nb)  {  setData ((Value*) CALLOC (std::max (nb, (size_t)1), sizeof(Value)), nb, 0);  }
+
+						std::string getValuesSectionName (tools::storage::impl::Group& group, const std::string& name)
+						{
+							return tools::storage::impl::Storage::getSectionName (group, name) + ".values";
+						}
 						
+						/** No copy: the values may be owned by the map. */
+						MapMPHF (const MapMPHF&);
+						MapMPHF& operator= (const MapMPHF&);
 					};
 					
 					/********************************************************************************/
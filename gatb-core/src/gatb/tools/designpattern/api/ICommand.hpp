@@ -222,6 +222,47 @@ public:
         return status;
     }
 
+    /** Iterate several iterators at once, one per thread. The iterators must be independent (for instance
+     * disjoint parts of a bank, see IBank::iterators), so each thread iterates its own iterator without any lock.
+     * The provided functor is cloned once per iterator; the same remarks as for the other 'iterate' methods
+     * hold for its copy constructor.
+     *
+     * Note that the number of threads is the number of iterators, whatever the number of execution units
+     * of the dispatcher.
+     *
+     * \param[in] iterators : the iterators to be iterated; they are released at the end of the iteration.
+     * \param[in] functor : functor object to be cloned, one per iterator
+     * \param[in] deleteSynchro : if false, destructor of functors are called in each thread; if true, destructor of functors are called synchronously
+     */
+    template <typename Item, typename Functor>
+    Status iterate (const std::vector<Iterator<Item>*>& iterators, const Functor& functor, bool deleteSynchro = false)
+    {
+        Status status;
+
+        /** We create a common synchronizer, only used for deleting the functors. */
+        system::ISynchronizer* synchro = newSynchro();
+
+        /** We create one command per iterator, with its own copy of the functor. */
+        std::vector<ICommand*> commands;
+        for (size_t i=0; i<iterators.size(); i++)
+        {
+            commands.push_back (new IteratorsCommand<Item,Functor> (iterators[i], new Functor (functor), *synchro, deleteSynchro));
+        }
+
+        /** We dispatch the commands. */
+        status.time = dispatchCommands (commands);
+
+        /** We get rid of the synchronizer. */
+        delete synchro;
+
+        /** We set the status. */
+        status.nbCores   = commands.size();
+        status.groupSize = 0;
+
+        /** We return the status. */
+        return status;
+    }
+
     /** Set the number of items to be retrieved from the iterator by one thread in a synchronized way.
      * \param[in] groupSize : number of items to be retrieved. */
     virtual void   setGroupSize (size_t groupSize) = 0;
@@ -337,6 +378,44 @@ protected:
         size_t                 _groupSize;
         bool                   _deleteSynchro;
     };
+
+    /* Inner class for iterating in one thread an iterator that is not shared with other threads. */
+    template <typename Item, typename Functor> class IteratorsCommand : public ICommand, public system::SmartPointer
+    {
+    public:
+        /** Constructor.
+         * \param[in] it : iterator to be used by this command only (released by the destructor)
+         * \param[in] fct : functor fed with the iterated items (deleted at the end of the execution)
+         * \param[in] synchro : shared synchronizer for deleting the functors
+         * \param[in] deleteSynchro : tells whether the functor is deleted under the synchronizer lock.
+         */
+        IteratorsCommand (Iterator<Item>* it, Functor* fct, system::ISynchronizer& synchro, bool deleteSynchro)
+            : _it(0), _fct(fct), _synchro(synchro), _deleteSynchro(deleteSynchro)  { setIt (it); }
+
+        /** Destructor. */
+        ~IteratorsCommand ()  { setIt (0); }
+
+        /** Implementation of the ICommand interface.*/
+        void execute ()
+        {
+            for (_it->first(); !_it->isDone(); _it->next())  {  (*_fct) (_it->item());  }
+
+            /** We release the resources of the iterator (opened files for instance) at once. */
+            _it->finalize();
+
+            if (_deleteSynchro)  { _synchro.lock (); }
+            delete _fct;
+            if (_deleteSynchro)  { _synchro.unlock (); }
+        }
+
+    private:
+        Iterator<Item>*        _it;
+        void setIt (Iterator<Item>* it)  { SP_SETATTR(it); }
+
+        Functor*               _fct;
+        system::ISynchronizer& _synchro;
+        bool                   _deleteSynchro;
+    };
 };
 
 /********************************************************************************/
@@ -29,6 +29,8 @@
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 #include <set>
 #include <list>
+#include <functional>
+#include <algorithm>
 #include <boost/variant.hpp>
 
 /********************************************************************************/
@@ -707,13 +709,16 @@ template <class Item> class VectorIterator2 : public Iterator<Item>
 {
 public:
 
-    VectorIterator2 (std::vector<Item>& items) : _items(items), _idx(0), _nb (items.size())  {}
+    VectorIterator2 (std::vector<Item>& items) : _items(items), _idx(0), _begin(0), _nb (items.size())  {}
+
+    /** Constructor for iterating the items of the range [begin,end[ of the vector. */
+    VectorIterator2 (std::vector<Item>& items, size_t begin, size_t end) : _items(items), _idx(0), _begin(begin), _nb (std::min (end, items.size()))  {}
 
     /** */
     virtual ~VectorIterator2 () {}
 
     /** \copydoc  Iterator::first */
-    void first()  {  _idx = -1;  next ();  }
+    void first()  {  _idx = _begin-1;  next ();  }
 
     /** \copydoc  Iterator::next */
     void next()  { ++_idx;  if (_idx < _nb ) { *(this->_item) = (_items[_idx]); }  }
@@ -727,6 +732,7 @@ public:
 protected:
     std::vector<Item>& _items;
     int32_t            _idx;
+    int32_t            _begin;
     int32_t            _nb;
 };
 
@@ -978,6 +984,107 @@ private:
     }
 };
 
+
+/********************************************************************************/
+/** \brief Merge iterator
+ *
+ * This iterator takes a list of sorted iterators as input and iterates the union of
+ * their items in sorted order (k-way merge). Items that compare equal are all iterated,
+ * the ones of the first iterators first.
+ *
+ * The merge uses a loser tree: after each item, only the path from the leaf of the
+ * iterator that provided the item to the root is replayed, ie. log2(k) comparisons.
+ *
+ * The Comparator functor tells whether an item is strictly lower than another one.
+ */
+template <class Item, class Comparator=std::less<Item> >
+class MergeIterator : public Iterator <Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] iterators : the sorted iterators to be merged
+     * \param[in] comparator : strict order used for sorting the iterators
+     */
+    MergeIterator (const std::vector <Iterator<Item>*>&  iterators, const Comparator& comparator=Comparator())
+        : _iterators(iterators), _comparator(comparator), _losers(iterators.size()), _winner(-1)
+    {
+        for (size_t i=0; i<_iterators.size(); i++)  { _iterators[i]->use(); }
+    }
+
+    /** Destructor. */
+    virtual ~MergeIterator ()
+    {
+        for (size_t i=0; i<_iterators.size(); i++)  { _iterators[i]->forget(); }
+    }
+
+    /** \copydoc Iterator::first */
+    void first()
+    {
+        for (size_t i=0; i<_iterators.size(); i++)  { _iterators[i]->first(); }
+
+        _winner = _iterators.empty() ? -1 : build (1);
+    }
+
+    /** \copydoc Iterator::next */
+    void next()
+    {
+        _iterators[_winner]->next();
+
+        /** We replay the matches from the leaf of the winner up to the root. */
+        int winner = _winner;
+        for (size_t node=(winner + _iterators.size())/2; node>0; node/=2)
+        {
+            if (beats (_losers[node], winner))  {  std::swap (_losers[node], winner);  }
+        }
+        _winner = winner;
+    }
+
+    /** \copydoc Iterator::isDone */
+    bool isDone() { return _winner < 0 || _iterators[_winner]->isDone(); }
+
+    /** \copydoc Iterator::item */
+    Item& item ()  {  return _iterators[_winner]->item(); }
+
+    /** Get a vector holding the composite structure of the iterator. */
+    virtual std::vector<Iterator<Item>*> getComposition() { return _iterators; }
+
+private:
+
+    std::vector <Iterator<Item>*>  _iterators;
+
+    Comparator _comparator;
+
+    /** Loser of the match played at each internal node (index 1..k-1); the leaves are
+     * the nodes k..2k-1, leaf k+i being the iterator i. */
+    std::vector<int> _losers;
+
+    /** Index of the iterator holding the current item. */
+    int _winner;
+
+    /** Tell whether iterator a wins against iterator b (ie. has a lower current item);
+     * finished iterators lose against everybody. Ties are won by the lowest index. */
+    bool beats (int a, int b)
+    {
+        if (_iterators[a]->isDone())  { return false; }
+        if (_iterators[b]->isDone())  { return true;  }
+        if (_comparator (_iterators[a]->item(), _iterators[b]->item()))  { return true;  }
+        if (_comparator (_iterators[b]->item(), _iterators[a]->item()))  { return false; }
+        return a < b;
+    }
+
+    /** Play the matches of the subtree of the given node and return its winner. */
+    int build (size_t node)
+    {
+        if (node >= _iterators.size())  { return node - _iterators.size(); }
+
+        int left  = build (2*node);
+        int right = build (2*node+1);
+
+        if (beats (left, right))  { _losers[node] = right;  return left;  }
+        else                      { _losers[node] = left;   return right; }
+    }
+};
 	
 /********************************************************************************/
 /** \brief Iterator adaptation from one type to another one
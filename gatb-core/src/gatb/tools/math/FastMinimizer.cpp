@@ -0,0 +1,349 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/tools/math/FastMinimizer.hpp>
+
+#include <algorithm>
+
+/** The SIMD kernels are compiled with function specific target attributes and selected at
+ * runtime according to the CPU, so the library doesn't require AVX to be built or run. */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define GATB_MINIMIZER_SIMD 1
+    #include <immintrin.h>
+#endif
+
+#define DEBUG(a)  //printf a
+
+using namespace std;
+
+/********************************************************************************/
+namespace gatb {  namespace core { namespace tools {  namespace math {
+/********************************************************************************/
+
+/** Masks used for the mmers keys. */
+struct MmerMasks
+{
+    MmerMasks (size_t mmerSize)
+    {
+        mmer = ((u_int64_t)1 << (2*mmerSize)) - 1;
+
+        /** Mask of the 'AA inside' check (see ModelMinimizer::is_allowed); the first nucleotides
+         * of the mmer are excluded. */
+        noAA = mmerSize > 2 ? (((u_int64_t)1 << ((mmerSize-2)*2)) - 1) & 0x5555555555555555ULL : 0;
+    }
+
+    u_int64_t mmer;
+    u_int64_t noAA;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : scalar kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : also used for the tails of the SIMD kernels
+*********************************************************************/
+static inline u_int64_t mmerKey_scalar (u_int64_t fw, const u_int64_t* revcomp, size_t i, const MmerMasks& masks, bool allowAll)
+{
+    u_int64_t v = fw;
+    if (revcomp && revcomp[i] < v)  { v = revcomp[i]; }
+
+    if (!allowAll)
+    {
+        u_int64_t a1 = ~(v | (v >> 2));
+        a1 = ((a1 >> 1) & a1) & masks.noAA;
+        if (a1 != 0)  { v = masks.mmer; }
+    }
+
+    return v;
+}
+
+static void computeMmerKeys_scalar (
+    const u_int64_t* forward, const u_int64_t* revcomp, size_t begin, size_t nbMmers,
+    const MmerMasks& masks, bool allowAll, u_int64_t* keys
+)
+{
+    for (size_t i=begin; i<nbMmers; i++)  {  keys[i] = mmerKey_scalar (forward[i], revcomp, i, masks, allowAll);  }
+}
+
+/** Sparse table: after the pass of length 'len', tmp[i] is the minimum of keys[i..i+2*len-1]. */
+static void minPass_scalar (u_int64_t* tmp, const u_int64_t* src, size_t begin, size_t end, size_t len)
+{
+    for (size_t i=begin; i<end; i++)  {  tmp[i] = std::min (src[i], src[i+len]);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : AVX2 kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+#ifdef GATB_MINIMIZER_SIMD
+
+/** AVX2 has no unsigned 64 bits comparison: we flip the sign bits before a signed one. */
+__attribute__((target("avx2")))
+static inline __m256i min_epu64_avx2 (__m256i a, __m256i b)
+{
+    const __m256i sign = _mm256_set1_epi64x ((long long)0x8000000000000000ULL);
+    __m256i gt = _mm256_cmpgt_epi64 (_mm256_xor_si256 (a, sign), _mm256_xor_si256 (b, sign));
+    return _mm256_blendv_epi8 (a, b, gt);
+}
+
+__attribute__((target("avx2")))
+static void computeMmerKeys_avx2 (
+    const u_int64_t* forward, const u_int64_t* revcomp, size_t nbMmers,
+    const MmerMasks& masks, bool allowAll, u_int64_t* keys
+)
+{
+    const __m256i mmerMask = _mm256_set1_epi64x ((long long)masks.mmer);
+    const __m256i noAAMask = _mm256_set1_epi64x ((long long)masks.noAA);
+    const __m256i ones     = _mm256_set1_epi64x (-1);
+    const __m256i zero     = _mm256_setzero_si256 ();
+
+    size_t i = 0;
+    for ( ; i+4 <= nbMmers; i+=4)
+    {
+        __m256i v = _mm256_loadu_si256 ((const __m256i*) (forward+i));
+        if (revcomp)  {  v = min_epu64_avx2 (v, _mm256_loadu_si256 ((const __m256i*) (revcomp+i)));  }
+
+        if (!allowAll)
+        {
+            __m256i a1 = _mm256_xor_si256 (_mm256_or_si256 (v, _mm256_srli_epi64 (v, 2)), ones);
+            a1 = _mm256_and_si256 (_mm256_and_si256 (_mm256_srli_epi64 (a1, 1), a1), noAAMask);
+            __m256i allowed = _mm256_cmpeq_epi64 (a1, zero);
+            v = _mm256_blendv_epi8 (mmerMask, v, allowed);
+        }
+
+        _mm256_storeu_si256 ((__m256i*) (keys+i), v);
+    }
+
+    computeMmerKeys_scalar (forward, revcomp, i, nbMmers, masks, allowAll, keys);
+}
+
+__attribute__((target("avx2")))
+static void minPass_avx2 (u_int64_t* tmp, const u_int64_t* src, size_t end, size_t len)
+{
+    /** Note: when tmp==src, the two loads of an iteration are done before its store, and the
+     * stores only touch items already read, so the pass can be done in place. */
+    size_t i = 0;
+    for ( ; i+4 <= end; i+=4)
+    {
+        __m256i a = _mm256_loadu_si256 ((const __m256i*) (src+i));
+        __m256i b = _mm256_loadu_si256 ((const __m256i*) (src+i+len));
+        _mm256_storeu_si256 ((__m256i*) (tmp+i), min_epu64_avx2 (a, b));
+    }
+
+    minPass_scalar (tmp, src, i, end, len);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : AVX-512 kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : gcc 12 reports false 'maybe-uninitialized' warnings in its own avx512 headers
+*********************************************************************/
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+static void computeMmerKeys_avx512 (
+    const u_int64_t* forward, const u_int64_t* revcomp, size_t nbMmers,
+    const MmerMasks& masks, bool allowAll, u_int64_t* keys
+)
+{
+    const __m512i mmerMask = _mm512_set1_epi64 ((long long)masks.mmer);
+    const __m512i noAAMask = _mm512_set1_epi64 ((long long)masks.noAA);
+    const __m512i ones     = _mm512_set1_epi64 (-1);
+
+    size_t i = 0;
+    for ( ; i+8 <= nbMmers; i+=8)
+    {
+        __m512i v = _mm512_loadu_si512 ((const void*) (forward+i));
+        if (revcomp)  {  v = _mm512_min_epu64 (v, _mm512_loadu_si512 ((const void*) (revcomp+i)));  }
+
+        if (!allowAll)
+        {
+            __m512i a1 = _mm512_xor_si512 (_mm512_or_si512 (v, _mm512_srli_epi64 (v, 2)), ones);
+            a1 = _mm512_and_si512 (_mm512_srli_epi64 (a1, 1), a1);
+            __mmask8 forbidden = _mm512_test_epi64_mask (a1, noAAMask);
+            v = _mm512_mask_blend_epi64 (forbidden, v, mmerMask);
+        }
+
+        _mm512_storeu_si512 ((void*) (keys+i), v);
+    }
+
+    computeMmerKeys_scalar (forward, revcomp, i, nbMmers, masks, allowAll, keys);
+}
+
+__attribute__((target("avx512f")))
+static void minPass_avx512 (u_int64_t* tmp, const u_int64_t* src, size_t end, size_t len)
+{
+    size_t i = 0;
+    for ( ; i+8 <= end; i+=8)
+    {
+        __m512i a = _mm512_loadu_si512 ((const void*) (src+i));
+        __m512i b = _mm512_loadu_si512 ((const void*) (src+i+len));
+        _mm512_storeu_si512 ((void*) (tmp+i), _mm512_min_epu64 (a, b));
+    }
+
+    minPass_scalar (tmp, src, i, end, len);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+#endif /* GATB_MINIMIZER_SIMD */
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : runtime selection of the kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+enum MinimizerKernel_e  { KERNEL_SCALAR, KERNEL_AVX2, KERNEL_AVX512 };
+
+static MinimizerKernel_e selectKernel ()
+{
+#ifdef GATB_MINIMIZER_SIMD
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx512f"))  { return KERNEL_AVX512; }
+    if (__builtin_cpu_supports ("avx2"))     { return KERNEL_AVX2;   }
+#endif
+    return KERNEL_SCALAR;
+}
+
+static MinimizerKernel_e getKernel ()
+{
+    /** Thread safe initialization (C++11). */
+    static const MinimizerKernel_e kernel = selectKernel ();
+    return kernel;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+const char* getMinimizerKernelName ()
+{
+    switch (getKernel())
+    {
+        case KERNEL_AVX512: return "avx512";
+        case KERNEL_AVX2:   return "avx2";
+        default:            return "scalar";
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void computeMmerKeys (
+    const u_int64_t* forward, const u_int64_t* revcomp, size_t nbMmers, size_t mmerSize,
+    bool allowAll, const u_int32_t* freqOrder, u_int64_t* keys
+)
+{
+    MmerMasks masks (mmerSize);
+
+    switch (getKernel())
+    {
+#ifdef GATB_MINIMIZER_SIMD
+        case KERNEL_AVX512: computeMmerKeys_avx512 (forward, revcomp, nbMmers, masks, allowAll, keys);  break;
+        case KERNEL_AVX2:   computeMmerKeys_avx2   (forward, revcomp, nbMmers, masks, allowAll, keys);  break;
+#endif
+        default:            computeMmerKeys_scalar (forward, revcomp, 0, nbMmers, masks, allowAll, keys);  break;
+    }
+
+    /** The frequency ranks are gathered afterwards; the rank is put in the high bits of the key
+     * so that ties are broken by the mmers values, as ComparatorMinimizerFrequencyOrLex does. */
+    if (freqOrder)
+    {
+        for (size_t i=0; i<nbMmers; i++)  {  keys[i] = ((u_int64_t)freqOrder[keys[i]] << 32) | keys[i];  }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : we build a sparse table (tmp[i] = min of keys[i..i+len-1] with len the largest
+**           power of 2 not greater than the window), each pass being a vertical min of two
+**           shifted arrays; a window minimum is then the min of two overlapping ranges.
+*********************************************************************/
+void slidingWindowMin (const u_int64_t* keys, size_t nbKeys, size_t window, u_int64_t* tmp, u_int64_t* result)
+{
+    if (window == 0 || nbKeys < window)  { return; }
+
+    MinimizerKernel_e kernel = getKernel();
+
+    const u_int64_t* src = keys;
+    size_t len = 1;
+
+    for ( ; 2*len <= window; len *= 2)
+    {
+        /** Number of items of the table for ranges of 2*len keys. */
+        size_t end = nbKeys - 2*len + 1;
+
+        switch (kernel)
+        {
+#ifdef GATB_MINIMIZER_SIMD
+            case KERNEL_AVX512: minPass_avx512 (tmp, src, end, len);  break;
+            case KERNEL_AVX2:   minPass_avx2   (tmp, src, end, len);  break;
+#endif
+            default:            minPass_scalar (tmp, src, 0, end, len);  break;
+        }
+
+        src = tmp;
+    }
+
+    size_t nbWindows = nbKeys - window + 1;
+    size_t offset    = window - len;
+
+    switch (kernel)
+    {
+#ifdef GATB_MINIMIZER_SIMD
+        case KERNEL_AVX512: minPass_avx512 (result, src, nbWindows, offset);  break;
+        case KERNEL_AVX2:   minPass_avx2   (result, src, nbWindows, offset);  break;
+#endif
+        default:            minPass_scalar (result, src, 0, nbWindows, offset);  break;
+    }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -21,6 +21,9 @@
  *  \date 01/03/2013
  *  \author edrezen
  *  \brief Fast computation of lexicographical minimizers wtih no-AA-inside constraint
+ *
+ *  This file also declares the SIMD kernels computing the minimizers of all the kmers
+ *  of a sequence in bulk (see ModelMinimizer::iterateBulk).
  */
 
 
@@ -29,6 +32,9 @@
 
 
 #include <stdint.h>
+#include <sys/types.h>
+#include <cstddef>
+#include <algorithm>
 
 extern const unsigned char revcomp_4NT[];
 
@@ -151,4 +157,45 @@ template<typename T, typename minimizer_type> inline void fastLexiMinimizerChunk
     } // end while (minimizers)
 }
 
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace math      {
+/********************************************************************************/
+
+/** Computes the keys of the mmers of a sequence; the minimizer of a kmer is the mmer with
+ * the smallest key. Each mmer is replaced by its canonical value (if 'revcomp' is provided) and
+ * by the mmer of maximal value if it holds 'AA' elsewhere than at its beginning (unless
+ * 'allowAll'). With a frequency order, the key is (freqOrder[mmer] << 32) | mmer, otherwise
+ * it is the mmer itself.
+ * \param[in] forward : forward mmers of the sequence
+ * \param[in] revcomp : reverse complement of the mmers (null for direct mmers)
+ * \param[in] nbMmers : number of mmers
+ * \param[in] mmerSize : size of the mmers (at most 31, at most 16 with a frequency order)
+ * \param[in] allowAll : true if mmers with 'AA' inside are allowed
+ * \param[in] freqOrder : rank of each mmer in the frequency order (null for lexicographic order)
+ * \param[out] keys : the nbMmers keys */
+void computeMmerKeys (
+    const u_int64_t* forward, const u_int64_t* revcomp, size_t nbMmers, size_t mmerSize,
+    bool allowAll, const u_int32_t* freqOrder, u_int64_t* keys
+);
+
+/** Computes the minimum of each window of 'window' consecutive keys, ie. the minimizer keys
+ * of the nbKeys-window+1 kmers of a sequence.
+ * \param[in] keys : the keys of the mmers
+ * \param[in] nbKeys : number of keys
+ * \param[in] window : number of mmers in a kmer
+ * \param[in] tmp : work buffer of nbKeys items
+ * \param[out] result : the nbKeys-window+1 window minima */
+void slidingWindowMin (const u_int64_t* keys, size_t nbKeys, size_t window, u_int64_t* tmp, u_int64_t* result);
+
+/** Get the name of the kernel selected at runtime for the current CPU.
+ * \return "avx512", "avx2" or "scalar" */
+const char* getMinimizerKernelName ();
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
 #endif
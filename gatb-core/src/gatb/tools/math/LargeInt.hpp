@@ -37,6 +37,10 @@
 #include <iostream>
 #include <hdf5/hdf5.h>
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 #include <gatb/system/api/Exception.hpp>
 #include <gatb/system/api/config.hpp>
 #include <gatb/tools/math/NativeInt64.hpp>
@@ -83,9 +87,9 @@ namespace math  {
  *  This template class may have a specialization for precision=2. If the used operating
  *  system allows it, native 128 bits integers are used.
  *
- *  In the other cases, the LargeInt provides a generic integer calculus class. Note that
- *  such an implementation could be optimized in several ways, including direct assembly
- *  code for maximum speed.
+ *  In the other cases, the LargeInt provides a generic integer calculus class. For precisions
+ *  2 (without native 128 bits integers), 3 and 4, the shifts and revcomp are
+ *  specialized (see LargeIntWords.pri).
  *
  *  The LargeInt class is hugely used throughout the GATB project since it encodes kmers values.
  *
@@ -699,6 +703,14 @@ public:
     u_int8_t  operator[]  (size_t idx) const    {  
         return (this->value[idx/32] >> (2*(idx % 32))) & 3; }
 
+    /** Access the ith byte of the integer, 0 being the least significant one. Used as a digit
+     * by radix sorts, without building shifted temporary LargeInt objects.
+     * \param[in] idx : index of the byte to be retrieved
+     * \return the byte value
+     */
+    u_int8_t  getByte  (size_t idx) const    {
+        return (this->value[idx/8] >> (8*(idx % 8))) & 0xFF; }
+
 private:
     u_int64_t value[precision];
    
@@ -879,6 +891,11 @@ template<int precision> inline void justSweepForAA(const LargeInt<precision>& x,
 /********************************************************************************/
 #include <gatb/tools/math/LargeInt2.pri> 
 
+/********************************************************************************/
+/****************    SPECIALIZED METHODS FOR precision=2,3,4     ****************/
+/********************************************************************************/
+#include <gatb/tools/math/LargeIntWords.pri>
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
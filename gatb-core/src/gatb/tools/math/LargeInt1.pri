@@ -84,6 +84,9 @@ public:
 
     u_int8_t  operator[]  (size_t idx) const   {  return (value >> (2*idx)) & 3; }
 
+    /** Access the ith byte (used as digit by radix sorts). */
+    u_int8_t  getByte  (size_t idx) const   {  return (value >> (8*idx)) & 0xFF; }
+
     /********************************************************************************/
     friend std::ostream & operator<<(std::ostream & s, const LargeInt<1> & l)
     {
@@ -78,6 +78,9 @@ public:
 
     u_int8_t  operator[]  (size_t idx) const   {  return (value >> (2*idx)) & 3; }
 
+    /** Access the ith byte (used as digit by radix sorts). */
+    u_int8_t  getByte  (size_t idx) const   {  return (value >> (8*idx)) & 0xFF; }
+
     /** Output stream overload. NOTE: for easier process, dump the value in hexadecimal.
      * \param[in] os : the output stream
      * \param[in] in : the integer value to be output.
@@ -0,0 +1,167 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file LargeIntWords.pri
+ *  \brief Specialized methods of LargeInt for precisions 2, 3 and 4
+ *
+ * The generic LargeInt loops over its 64 bits words with runtime shifts and branches.
+ * For the precisions of the kmer spans 64, 96 and 128, the hot methods (shifts and revcomp)
+ * are specialized here:
+ *   - two consecutive words are handled as one unsigned 128 bits integer, so the shifts
+ *     compile into shld/shrd instructions, without branches
+ *   - revcomp works on 128 bits SSE lanes (one byte shuffle reverses a lane) instead of a
+ *     lookup table per byte.
+ *
+ * The words layout is the one of the generic class, so the values (and their hashes) are
+ * the same as with the generic methods. The other methods are kept generic: the compiler
+ * already unrolls their loops, and the comparisons exit early on the most significant word,
+ * which is faster than a branchless comparison of all the words.
+ *
+ * Note: this file is included inside the math namespace; the SSE header is included by LargeInt.hpp.
+ */
+
+/********************************************************************************/
+#if defined(__SIZEOF_INT128__)
+/********************************************************************************/
+
+/** \brief Operations on a fixed number of 64 bits words (least significant word first)
+ *
+ * The loops have a compile time number of iterations and are unrolled by the compiler.
+ */
+template<int nbWords>  struct LargeIntWords
+{
+    typedef unsigned __int128 Word2;
+
+    /** Left shift of the words. */
+    static inline void shiftLeft (u_int64_t* __restrict__ res, const u_int64_t* __restrict__ x, int coeff)
+    {
+        /** Most frequent case (a kmer is shifted by one nucleotide): kept small enough to be inlined. */
+        if (coeff >= 64)  {  shiftLeftWords (res, x, coeff);  return;  }
+
+        for (int i=nbWords-1; i>0; i--)
+        {
+            res[i] = (u_int64_t) (((((Word2)x[i]) << 64 | x[i-1]) << coeff) >> 64);
+        }
+        res[0] = x[0] << coeff;
+    }
+
+    /** Right shift of the words. */
+    static inline void shiftRight (u_int64_t* __restrict__ res, const u_int64_t* __restrict__ x, int coeff)
+    {
+        if (coeff >= 64)  {  shiftRightWords (res, x, coeff);  return;  }
+
+        for (int i=0; i<nbWords-1; i++)
+        {
+            res[i] = (u_int64_t) ((((Word2)x[i+1]) << 64 | x[i]) >> coeff);
+        }
+        res[nbWords-1] = x[nbWords-1] >> coeff;
+    }
+
+    /** Left shift of the words by at least one word. */
+    static void shiftLeftWords (u_int64_t* __restrict__ res, const u_int64_t* __restrict__ x, int coeff)
+    {
+        const int large_shift = coeff / 64;
+        const int small_shift = coeff % 64;
+
+        for (int i=nbWords-1; i>=0; i--)
+        {
+            u_int64_t high = (i-large_shift   >= 0) ? x[i-large_shift]   : 0;
+            u_int64_t low  = (i-large_shift-1 >= 0) ? x[i-large_shift-1] : 0;
+            res[i] = (u_int64_t) (((((Word2)high) << 64 | low) << small_shift) >> 64);
+        }
+    }
+
+    /** Right shift of the words by at least one word. */
+    static void shiftRightWords (u_int64_t* __restrict__ res, const u_int64_t* __restrict__ x, int coeff)
+    {
+        const int large_shift = coeff / 64;
+        const int small_shift = coeff % 64;
+
+        for (int i=0; i<nbWords; i++)
+        {
+            u_int64_t low  = (i+large_shift   < nbWords) ? x[i+large_shift]   : 0;
+            u_int64_t high = (i+large_shift+1 < nbWords) ? x[i+large_shift+1] : 0;
+            res[i] = (u_int64_t) ((((Word2)high) << 64 | low) >> small_shift);
+        }
+    }
+
+    /** Reverse complement of one word: the 32 nucleotides are reversed, and complemented
+     * (A<->T and C<->G, ie. a xor with 2 given the encoding A=0, C=1, T=2 and G=3). */
+    static inline u_int64_t revcompWord (u_int64_t x)
+    {
+        x = __builtin_bswap64 (x);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        return x ^ 0xAAAAAAAAAAAAAAAAULL;
+    }
+
+    /** Reverse complement of the words (all the nucleotides of the words): the result
+     * still has to be shifted according to the kmer size. */
+    static inline void revcomp (u_int64_t* __restrict__ res, const u_int64_t* __restrict__ x)
+    {
+        int i = 0;
+#ifdef __SSSE3__
+        const __m128i reverseBytes = _mm_set_epi8 (0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+        const __m128i mask4        = _mm_set1_epi8 (0x0F);
+        const __m128i mask2        = _mm_set1_epi8 (0x33);
+        const __m128i complement   = _mm_set1_epi8 ((char)0xAA);
+
+        /** A lane of two words gives the two last reversed words. */
+        for ( ; i+1<nbWords; i+=2)
+        {
+            __m128i v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*) (x+i)), reverseBytes);
+            v = _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (v, 4), mask4), _mm_slli_epi16 (_mm_and_si128 (v, mask4), 4));
+            v = _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (v, 2), mask2), _mm_slli_epi16 (_mm_and_si128 (v, mask2), 2));
+            _mm_storeu_si128 ((__m128i*) (res+nbWords-2-i), _mm_xor_si128 (v, complement));
+        }
+#endif
+        for ( ; i<nbWords; i++)  {  res[nbWords-1-i] = revcompWord (x[i]);  }
+    }
+};
+
+/********************************************************************************/
+/** Specialization of the hot methods of LargeInt<precision> with LargeIntWords<precision>. */
+#define LARGEINT_WORDS_SPECIALIZATION(precision)                                                                            \
+                                                                                                                            \
+template<> inline LargeInt<precision> LargeInt<precision>::operator<< (const int& coeff) const                              \
+{   LargeInt<precision> result;  LargeIntWords<precision>::shiftLeft (result.value, this->value, coeff);  return result;  }  \
+                                                                                                                            \
+template<> inline LargeInt<precision> LargeInt<precision>::operator>> (const int& coeff) const                              \
+{   LargeInt<precision> result;  LargeIntWords<precision>::shiftRight (result.value, this->value, coeff);  return result;  } \
+                                                                                                                            \
+template<> inline LargeInt<precision> revcomp<precision> (const LargeInt<precision>& x, size_t sizeKmer)                    \
+{                                                                                                                           \
+    LargeInt<precision> tmp, res;                                                                                           \
+    LargeIntWords<precision>::revcomp    (tmp.value, x.value);                                                              \
+    LargeIntWords<precision>::shiftRight (res.value, tmp.value, 2*(32*precision - sizeKmer));                               \
+    return res;                                                                                                             \
+}
+
+/** Precision 2 has its own class when native 128 bits integers are enabled (see LargeInt2.pri). */
+#if  INT128_FOUND != 1
+LARGEINT_WORDS_SPECIALIZATION(2)
+#endif
+LARGEINT_WORDS_SPECIALIZATION(3)
+LARGEINT_WORDS_SPECIALIZATION(4)
+
+#undef LARGEINT_WORDS_SPECIALIZATION
+
+/********************************************************************************/
+#endif // __SIZEOF_INT128__
+/********************************************************************************/
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file NtHash.hpp
+ *  \brief Rolling hash of nucleotides sequences (ntHash)
+ *
+ *  The hash of a kmer s[0..k-1] is the XOR of the seeds of its nucleotides, the seed of s[i]
+ *  being rotated by k-1-i bits. Going to the next kmer then only needs rotations and XOR
+ *  with the seeds of the outgoing and incoming nucleotides, whatever the kmer size.
+ *
+ *  The hash of the reverse complement is computed the same way, so the canonical hash (sum of
+ *  both) is the same for a kmer and its reverse complement.
+ *
+ *  Reference: Mohamadi et al., "ntHash: recursive nucleotide hashing", Bioinformatics 2016.
+ */
+
+#ifndef _GATB_CORE_TOOLS_MATH_NT_HASH_HPP_
+#define _GATB_CORE_TOOLS_MATH_NT_HASH_HPP_
+
+/********************************************************************************/
+
+#include <sys/types.h>
+#include <cstddef>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace math      {
+/********************************************************************************/
+
+/** Rotate a 64 bits word to the left.
+ * \param[in] x : word to be rotated
+ * \param[in] n : number of bits (modulo 64)
+ * \return the rotated word. */
+inline u_int64_t rol64 (u_int64_t x, size_t n)  {  n &= 63;  return (x << n) | (x >> ((64-n) & 63));  }
+
+/** Rotate a 64 bits word to the right.
+ * \param[in] x : word to be rotated
+ * \param[in] n : number of bits (modulo 64)
+ * \return the rotated word. */
+inline u_int64_t ror64 (u_int64_t x, size_t n)  {  n &= 63;  return (x >> n) | (x << ((64-n) & 63));  }
+
+/** Seed of a nucleotide for the ntHash rolling hash.
+ * \param[in] code : nucleotide code (A=0, C=1, T=2, G=3)
+ * \return the seed. */
+inline u_int64_t ntHashSeed (size_t code)
+{
+    static const u_int64_t seeds[4] =
+    {
+        0x3c8bfbb395c60474ULL,  /* A */
+        0x3193c18562a02b4cULL,  /* C */
+        0x295549f54be24456ULL,  /* T */
+        0x20323ed082572324ULL   /* G */
+    };
+    return seeds[code & 3];
+}
+
+/** Canonical hash of a kmer of at most 32 nucleotides, computed from scratch. It is the hash
+ * given by a rolling computation (see ModelRollingHash).
+ * \param[in] kmer : kmer value (last nucleotide in the low bits)
+ * \param[in] kmerSize : size of the kmer
+ * \return the canonical hash. */
+inline u_int64_t ntHashCanonical (u_int64_t kmer, size_t kmerSize)
+{
+    u_int64_t forward = 0;
+    u_int64_t revcomp = 0;
+
+    for (size_t j=0; j<kmerSize; j++, kmer >>= 2)
+    {
+        forward ^= rol64 (ntHashSeed (kmer),   j);
+        revcomp ^= rol64 (ntHashSeed (kmer^2), kmerSize-1-j);
+    }
+
+    return forward + revcomp;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MATH_NT_HASH_HPP_ */
@@ -0,0 +1,584 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include <gatb/tools/math/NucleotideCodec.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+/** The SIMD kernels are compiled with function specific target attributes and selected at
+ * runtime according to the CPU (see FastMinimizer.cpp). */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define GATB_CODEC_SIMD 1
+    #include <immintrin.h>
+#endif
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core { namespace tools {  namespace math {
+/********************************************************************************/
+
+/** ASCII character of each code. */
+static const char CODE_TO_ASCII[4] = { 'A', 'C', 'T', 'G' };
+
+/** Reverse the 4 codes of a byte and complement them. */
+static inline u_int8_t revcompByte (u_int8_t b)
+{
+    b = ((b >> 2) & 0x33) | ((b & 0x33) << 2);
+    b = (b >> 4) | (b << 4);
+    return b ^ 0xAA;
+}
+
+/** Read 8 bytes as a big endian word (ie. the first nucleotide in the high bits); the bytes
+ * beyond 'size' are read as 0. */
+static inline u_int64_t loadWord (const u_int8_t* packed, size_t offset, size_t size)
+{
+    u_int64_t w = 0;
+    if (offset + 8 <= size)  {  memcpy (&w, packed + offset, 8);  return __builtin_bswap64 (w);  }
+    for (size_t b=0; b<8; b++)  {  w = (w << 8) | (offset+b < size ? packed[offset+b] : 0);  }
+    return w;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : scalar kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : also used for the heads and tails of the SIMD kernels
+*********************************************************************/
+static size_t pack_scalar (const char* ascii, size_t begin, size_t length, u_int8_t* packed, u_int64_t* badMask)
+{
+    size_t nbBad = 0;
+
+    for (size_t i=begin; i<length; i+=4)
+    {
+        u_int8_t b = 0;
+        for (size_t j=i; j<i+4; j++)
+        {
+            u_int8_t c = j<length ? ascii[j] : 0;
+            b = (b << 2) | ((c >> 1) & 3);
+
+            if (c & 8)
+            {
+                nbBad++;
+                if (badMask)  { badMask[j/64] |= (u_int64_t)1 << (j%64); }
+            }
+        }
+        packed[i/4] = b;
+    }
+
+    return nbBad;
+}
+
+static void unpack_scalar (const u_int8_t* packed, size_t start, size_t begin, size_t end, char* ascii)
+{
+    for (size_t i=begin; i<end; i++)
+    {
+        size_t p = start + i;
+        ascii[i] = CODE_TO_ASCII [(packed[p>>2] >> (6 - 2*(p&3))) & 3];
+    }
+}
+
+static void revcompBytes_scalar (const u_int8_t* packed, size_t begin, size_t nbBytes, u_int8_t* result)
+{
+    for (size_t j=begin; j<nbBytes; j++)  {  result[j] = revcompByte (packed[nbBytes-1-j]);  }
+}
+
+/** The kmer at position i is read from one or two big endian words. */
+static inline u_int64_t kmerAt (const u_int8_t* packed, size_t size, size_t i, size_t kmerSize)
+{
+    size_t    shift = 2*(i&3);
+    u_int64_t w     = loadWord (packed, i>>2, size) << shift;
+    if (shift + 2*kmerSize > 64)  {  w |= loadWord (packed, (i>>2) + 8, size) >> (64-shift);  }
+    return w >> (64 - 2*kmerSize);
+}
+
+/** Kmers of a packed sequence; with 'reversed', the kmer i is stored at index nbKmers-1-i. */
+static void extractKmers_scalar (const u_int8_t* packed, size_t size, size_t begin, size_t nbKmers, size_t kmerSize, bool reversed, u_int64_t* kmers)
+{
+    for (size_t i=begin; i<nbKmers; i++)
+    {
+        kmers[reversed ? nbKmers-1-i : i] = kmerAt (packed, size, i, kmerSize);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : SSE4 kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : they return the number of items processed, the remaining ones are left to the scalar kernels
+*********************************************************************/
+#ifdef GATB_CODEC_SIMD
+
+/** 16 characters are packed into 4 bytes: the codes are weighted by 4 and 1 for pairs of bytes,
+ * then by 16 and 1 for pairs of 16 bits words; the bytes of the 32 bits words are then gathered. */
+__attribute__((target("sse4.1")))
+static size_t pack_sse4 (const char* ascii, size_t length, u_int8_t* packed, u_int64_t* badMask, size_t& nbBad)
+{
+    const __m128i three  = _mm_set1_epi8  (3);
+    const __m128i w1     = _mm_set1_epi16 (0x0104);
+    const __m128i w2     = _mm_set1_epi32 (0x00010010);
+    const __m128i gather = _mm_setr_epi8  (0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for ( ; i+16 <= length; i += 16)
+    {
+        __m128i c     = _mm_loadu_si128 ((const __m128i*) (ascii + i));
+        __m128i codes = _mm_and_si128 (_mm_srli_epi16 (c, 1), three);
+
+        /** Bit 3 of each character goes to bit 7 for the movemask. */
+        u_int32_t bad = _mm_movemask_epi8 (_mm_slli_epi16 (c, 4));
+
+        __m128i v = _mm_shuffle_epi8 (_mm_madd_epi16 (_mm_maddubs_epi16 (codes, w1), w2), gather);
+        u_int32_t word = _mm_cvtsi128_si32 (v);
+        memcpy (packed + i/4, &word, 4);
+
+        if (bad)
+        {
+            nbBad += __builtin_popcount (bad);
+            if (badMask)  { badMask[i/64] |= (u_int64_t)bad << (i%64); }
+        }
+    }
+
+    return i;
+}
+
+/** 4 bytes are spread over 16 bytes; each byte then keeps the code matching its position. */
+__attribute__((target("sse4.1")))
+static size_t unpack_sse4 (const u_int8_t* packed, size_t start, size_t begin, size_t end, char* ascii)
+{
+    const __m128i spread = _mm_setr_epi8  (0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+    const __m128i lut    = _mm_setr_epi8  ('A', 'C', 'T', 'G', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i m0     = _mm_set1_epi32 (0x00000003);
+    const __m128i m1     = _mm_set1_epi32 (0x00000300);
+    const __m128i m2     = _mm_set1_epi32 (0x00030000);
+    const __m128i m3     = _mm_set1_epi32 (0x03000000);
+
+    size_t i = begin;
+    for ( ; i+16 <= end; i += 16)
+    {
+        u_int32_t word;
+        memcpy (&word, packed + (start+i)/4, 4);
+
+        __m128i b = _mm_shuffle_epi8 (_mm_cvtsi32_si128 (word), spread);
+        __m128i r = _mm_or_si128 (
+            _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (b, 6), m0), _mm_and_si128 (_mm_srli_epi16 (b, 4), m1)),
+            _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (b, 2), m2), _mm_and_si128 (b, m3))
+        );
+
+        _mm_storeu_si128 ((__m128i*) (ascii + i), _mm_shuffle_epi8 (lut, r));
+    }
+
+    return i;
+}
+
+/** The bytes are reversed, then the codes within each byte through two nibbles lookup tables. */
+__attribute__((target("sse4.1")))
+static size_t revcompBytes_sse4 (const u_int8_t* packed, size_t nbBytes, u_int8_t* result)
+{
+    const __m128i reverse = _mm_setr_epi8 (15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i lutLow  = _mm_setr_epi8 (0x00, 0x40, (char)0x80, (char)0xC0, 0x10, 0x50, (char)0x90, (char)0xD0, 0x20, 0x60, (char)0xA0, (char)0xE0, 0x30, 0x70, (char)0xB0, (char)0xF0);
+    const __m128i lutHigh = _mm_setr_epi8 (0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m128i nibble  = _mm_set1_epi8 (0x0F);
+    const __m128i comp    = _mm_set1_epi8 ((char)0xAA);
+
+    size_t j = 0;
+    for ( ; j+16 <= nbBytes; j += 16)
+    {
+        __m128i v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*) (packed + nbBytes - 16 - j)), reverse);
+
+        __m128i r = _mm_or_si128 (
+            _mm_shuffle_epi8 (lutLow,  _mm_and_si128 (v, nibble)),
+            _mm_shuffle_epi8 (lutHigh, _mm_and_si128 (_mm_srli_epi16 (v, 4), nibble))
+        );
+
+        _mm_storeu_si128 ((__m128i*) (result + j), _mm_xor_si128 (r, comp));
+    }
+
+    return j;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : AVX2 kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : same algorithms as the SSE4 kernels, on 32 bytes
+*********************************************************************/
+__attribute__((target("avx2")))
+static size_t pack_avx2 (const char* ascii, size_t length, u_int8_t* packed, u_int64_t* badMask, size_t& nbBad)
+{
+    const __m256i three  = _mm256_set1_epi8  (3);
+    const __m256i w1     = _mm256_set1_epi16 (0x0104);
+    const __m256i w2     = _mm256_set1_epi32 (0x00010010);
+    const __m256i gather = _mm256_setr_epi8  (
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+    );
+    const __m256i lanes  = _mm256_setr_epi32 (0, 4, 0, 0, 0, 0, 0, 0);
+
+    size_t i = 0;
+    for ( ; i+32 <= length; i += 32)
+    {
+        __m256i c     = _mm256_loadu_si256 ((const __m256i*) (ascii + i));
+        __m256i codes = _mm256_and_si256 (_mm256_srli_epi16 (c, 1), three);
+
+        u_int32_t bad = _mm256_movemask_epi8 (_mm256_slli_epi16 (c, 4));
+
+        __m256i v = _mm256_shuffle_epi8 (_mm256_madd_epi16 (_mm256_maddubs_epi16 (codes, w1), w2), gather);
+        v = _mm256_permutevar8x32_epi32 (v, lanes);
+        _mm_storel_epi64 ((__m128i*) (packed + i/4), _mm256_castsi256_si128 (v));
+
+        if (bad)
+        {
+            nbBad += __builtin_popcount (bad);
+            if (badMask)  { badMask[i/64] |= (u_int64_t)bad << (i%64); }
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t unpack_avx2 (const u_int8_t* packed, size_t start, size_t begin, size_t end, char* ascii)
+{
+    const __m256i spread = _mm256_setr_epi8  (
+        0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+        4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+    );
+    const __m256i lut = _mm256_setr_epi8 (
+        'A', 'C', 'T', 'G', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        'A', 'C', 'T', 'G', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    );
+    const __m256i m0 = _mm256_set1_epi32 (0x00000003);
+    const __m256i m1 = _mm256_set1_epi32 (0x00000300);
+    const __m256i m2 = _mm256_set1_epi32 (0x00030000);
+    const __m256i m3 = _mm256_set1_epi32 (0x03000000);
+
+    size_t i = begin;
+    for ( ; i+32 <= end; i += 32)
+    {
+        long long word;
+        memcpy (&word, packed + (start+i)/4, 8);
+
+        __m256i b = _mm256_shuffle_epi8 (_mm256_set1_epi64x (word), spread);
+        __m256i r = _mm256_or_si256 (
+            _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi16 (b, 6), m0), _mm256_and_si256 (_mm256_srli_epi16 (b, 4), m1)),
+            _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi16 (b, 2), m2), _mm256_and_si256 (b, m3))
+        );
+
+        _mm256_storeu_si256 ((__m256i*) (ascii + i), _mm256_shuffle_epi8 (lut, r));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t revcompBytes_avx2 (const u_int8_t* packed, size_t nbBytes, u_int8_t* result)
+{
+    const __m256i reverse = _mm256_setr_epi8 (
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+    );
+    const __m256i lutLow  = _mm256_setr_epi8 (
+        0x00, 0x40, (char)0x80, (char)0xC0, 0x10, 0x50, (char)0x90, (char)0xD0, 0x20, 0x60, (char)0xA0, (char)0xE0, 0x30, 0x70, (char)0xB0, (char)0xF0,
+        0x00, 0x40, (char)0x80, (char)0xC0, 0x10, 0x50, (char)0x90, (char)0xD0, 0x20, 0x60, (char)0xA0, (char)0xE0, 0x30, 0x70, (char)0xB0, (char)0xF0
+    );
+    const __m256i lutHigh = _mm256_setr_epi8 (
+        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+    );
+    const __m256i nibble = _mm256_set1_epi8 (0x0F);
+    const __m256i comp   = _mm256_set1_epi8 ((char)0xAA);
+
+    size_t j = 0;
+    for ( ; j+32 <= nbBytes; j += 32)
+    {
+        /** The bytes are reversed within each lane, then the two lanes are swapped. */
+        __m256i v = _mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i*) (packed + nbBytes - 32 - j)), reverse);
+        v = _mm256_permute4x64_epi64 (v, 0x4E);
+
+        __m256i r = _mm256_or_si256 (
+            _mm256_shuffle_epi8 (lutLow,  _mm256_and_si256 (v, nibble)),
+            _mm256_shuffle_epi8 (lutHigh, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibble))
+        );
+
+        _mm256_storeu_si256 ((__m256i*) (result + j), _mm256_xor_si256 (r, comp));
+    }
+
+    return j;
+}
+
+/** Kmers i..i+3 (i multiple of 4) all begin in the same word: each lane shifts it by its own
+ * number of nucleotides. The words are read while they are fully inside the packed sequence. */
+__attribute__((target("avx2")))
+static size_t extractKmers_avx2 (const u_int8_t* packed, size_t size, size_t nbKmers, size_t kmerSize, bool reversed, u_int64_t* kmers)
+{
+    const __m256i shiftLeft  = _mm256_setr_epi64x (0, 2, 4, 6);
+    const __m256i shiftRight = _mm256_setr_epi64x (64, 62, 60, 58);
+    const __m128i shiftKmer  = _mm_cvtsi32_si128 (64 - 2*kmerSize);
+    const bool    twoWords   = kmerSize > 29;
+
+    size_t i = 0;
+    for ( ; i+4 <= nbKmers && (i>>2) + 16 <= size; i += 4)
+    {
+        u_int64_t w1, w2;
+        memcpy (&w1, packed + (i>>2),     8);
+        memcpy (&w2, packed + (i>>2) + 8, 8);
+
+        __m256i v = _mm256_sllv_epi64 (_mm256_set1_epi64x (__builtin_bswap64 (w1)), shiftLeft);
+        if (twoWords)  {  v = _mm256_or_si256 (v, _mm256_srlv_epi64 (_mm256_set1_epi64x (__builtin_bswap64 (w2)), shiftRight));  }
+        v = _mm256_srl_epi64 (v, shiftKmer);
+
+        if (reversed)  {  _mm256_storeu_si256 ((__m256i*) (kmers + nbKmers - 4 - i), _mm256_permute4x64_epi64 (v, 0x1B));  }
+        else           {  _mm256_storeu_si256 ((__m256i*) (kmers + i), v);  }
+    }
+
+    return i;
+}
+
+#endif
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : runtime selection of the kernels
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+enum CodecKernel_e  { KERNEL_SCALAR, KERNEL_SSE4, KERNEL_AVX2 };
+
+static bool isSupported (CodecKernel_e kernel)
+{
+#ifdef GATB_CODEC_SIMD
+    __builtin_cpu_init ();
+    switch (kernel)
+    {
+        case KERNEL_AVX2:  return __builtin_cpu_supports ("avx2");
+        case KERNEL_SSE4:  return __builtin_cpu_supports ("sse4.1");
+        default:           return true;
+    }
+#else
+    return kernel == KERNEL_SCALAR;
+#endif
+}
+
+static CodecKernel_e selectKernel ()
+{
+    if (isSupported (KERNEL_AVX2))  { return KERNEL_AVX2; }
+    if (isSupported (KERNEL_SSE4))  { return KERNEL_SSE4; }
+    return KERNEL_SCALAR;
+}
+
+static CodecKernel_e& getKernel ()
+{
+    /** Thread safe initialization (C++11). */
+    static CodecKernel_e kernel = selectKernel ();
+    return kernel;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+const char* getCodecKernelName ()
+{
+    switch (getKernel())
+    {
+        case KERNEL_AVX2:  return "avx2";
+        case KERNEL_SSE4:  return "sse4";
+        default:           return "scalar";
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool setCodecKernel (const char* name)
+{
+    CodecKernel_e kernel;
+
+         if (strcmp (name, "avx2")   == 0)  { kernel = KERNEL_AVX2;   }
+    else if (strcmp (name, "sse4")   == 0)  { kernel = KERNEL_SSE4;   }
+    else if (strcmp (name, "scalar") == 0)  { kernel = KERNEL_SCALAR; }
+    else                                    { return false;           }
+
+    if (!isSupported (kernel))  { return false; }
+
+    getKernel() = kernel;
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t packNucleotides (const char* ascii, size_t length, u_int8_t* packed, u_int64_t* badMask)
+{
+    if (badMask)  {  memset (badMask, 0, ((length+63)/64) * sizeof(u_int64_t));  }
+
+    size_t nbBad = 0;
+    size_t done  = 0;
+
+    switch (getKernel())
+    {
+#ifdef GATB_CODEC_SIMD
+        case KERNEL_AVX2:  done = pack_avx2 (ascii, length, packed, badMask, nbBad);  break;
+        case KERNEL_SSE4:  done = pack_sse4 (ascii, length, packed, badMask, nbBad);  break;
+#endif
+        default:  break;
+    }
+
+    return nbBad + pack_scalar (ascii, done, length, packed, badMask);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the nucleotides are unpacked one by one until the next one begins a byte
+*********************************************************************/
+void unpackNucleotides (const u_int8_t* packed, size_t start, size_t length, char* ascii)
+{
+    size_t head = std::min (length, (4 - (start & 3)) & 3);
+    unpack_scalar (packed, start, 0, head, ascii);
+
+    size_t done = head;
+
+    switch (getKernel())
+    {
+#ifdef GATB_CODEC_SIMD
+        case KERNEL_AVX2:  done = unpack_avx2 (packed, start, head, length, ascii);  break;
+        case KERNEL_SSE4:  done = unpack_sse4 (packed, start, head, length, ascii);  break;
+#endif
+        default:  break;
+    }
+
+    unpack_scalar (packed, start, done, length, ascii);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the bytes are reversed and complemented; if the last byte is not full, its
+**           unused codes are now at the beginning, so the result is shifted to the left.
+*********************************************************************/
+void reverseComplementPacked (const u_int8_t* packed, size_t length, u_int8_t* result)
+{
+    size_t nbBytes = getPackedSize (length);
+    size_t done    = 0;
+
+    switch (getKernel())
+    {
+#ifdef GATB_CODEC_SIMD
+        case KERNEL_AVX2:  done = revcompBytes_avx2 (packed, nbBytes, result);  break;
+        case KERNEL_SSE4:  done = revcompBytes_sse4 (packed, nbBytes, result);  break;
+#endif
+        default:  break;
+    }
+
+    revcompBytes_scalar (packed, done, nbBytes, result);
+
+    size_t shift = 2 * (4*nbBytes - length);
+    if (shift == 0)  { return; }
+
+    /** The shift is done by big endian words; each one takes the high bits of the next byte. */
+    size_t j = 0;
+    for ( ; j+9 <= nbBytes; j += 8)
+    {
+        u_int64_t w;
+        memcpy (&w, result + j, 8);
+        w = (__builtin_bswap64 (w) << shift) | (result[j+8] >> (8-shift));
+        w = __builtin_bswap64 (w);
+        memcpy (result + j, &w, 8);
+    }
+    for ( ; j+1 < nbBytes; j++)  {  result[j] = (result[j] << shift) | (result[j+1] >> (8-shift));  }
+
+    result[nbBytes-1] <<= shift;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the reverse complement of the kmer i is the kmer nbKmers-1-i of the reverse
+**           complement of the sequence.
+*********************************************************************/
+void buildKmers (
+    const u_int8_t* packed, const u_int8_t* revcompPacked, size_t length, size_t kmerSize,
+    u_int64_t* forward, u_int64_t* revcomp
+)
+{
+    if (kmerSize == 0 || kmerSize > 32 || length < kmerSize)  { return; }
+
+    size_t nbKmers = length - kmerSize + 1;
+    size_t size    = getPackedSize (length);
+
+    for (size_t loop=0; loop<2; loop++)
+    {
+        const u_int8_t* seq   = loop==0 ? packed  : revcompPacked;
+        u_int64_t*      kmers = loop==0 ? forward : revcomp;
+        bool reversed         = loop==1;
+
+        if (kmers == 0)  { continue; }
+
+        size_t done = 0;
+
+        switch (getKernel())
+        {
+#ifdef GATB_CODEC_SIMD
+            case KERNEL_AVX2:  done = extractKmers_avx2 (seq, size, nbKmers, kmerSize, reversed, kmers);  break;
+#endif
+            default:  break;
+        }
+
+        extractKmers_scalar (seq, size, done, nbKmers, kmerSize, reversed, kmers);
+    }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,104 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+/** \file NucleotideCodec.hpp
+ *  \brief Conversion of nucleotides sequences between ASCII and 2 bits codes, with SIMD kernels
+ *
+ *  The nucleotides are coded as elsewhere in GATB: A=0, C=1, T=2 and G=3, ie. bits 1 and 2 of
+ *  the ASCII character (see Data::ConvertASCII); the complement of a code is 'code^2'.
+ *
+ *  A packed sequence holds 4 nucleotides per byte, the first one in the high bits of its byte
+ *  (as Data::BINARY); the unused bits of the last byte are 0.
+ *
+ *  The kernels come in AVX2, SSE4 and scalar versions; the version is picked at runtime from
+ *  the CPU, so the library doesn't require AVX to be built or run.
+ */
+
+#ifndef _GATB_CORE_TOOLS_MATH_NUCLEOTIDE_CODEC_HPP_
+#define _GATB_CORE_TOOLS_MATH_NUCLEOTIDE_CODEC_HPP_
+
+/********************************************************************************/
+
+#include <sys/types.h>
+#include <cstddef>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace math      {
+/********************************************************************************/
+
+/** Get the number of bytes of a packed sequence.
+ * \param[in] length : number of nucleotides
+ * \return the size of the packed sequence in bytes. */
+inline size_t getPackedSize (size_t length)  { return (length+3) / 4; }
+
+/** Pack ASCII nucleotides into 2 bits codes. A character that is not a nucleotide (ie. with bit 3
+ * set, like N) gets the code given by Data::ConvertASCII, and is reported in 'badMask'.
+ * \param[in] ascii : the nucleotides
+ * \param[in] length : number of nucleotides
+ * \param[out] packed : the getPackedSize(length) bytes of the packed sequence
+ * \param[out] badMask : bit i%64 of word i/64 is set if the character i is not a nucleotide;
+ *                       (length+63)/64 words (may be null)
+ * \return the number of characters that are not nucleotides. */
+size_t packNucleotides (const char* ascii, size_t length, u_int8_t* packed, u_int64_t* badMask);
+
+/** Unpack 2 bits codes into upper case ASCII nucleotides.
+ * \param[in] packed : a packed sequence
+ * \param[in] start : index of the first nucleotide to be unpacked
+ * \param[in] length : number of nucleotides to be unpacked
+ * \param[out] ascii : the 'length' nucleotides (not null terminated) */
+void unpackNucleotides (const u_int8_t* packed, size_t start, size_t length, char* ascii);
+
+/** Compute the reverse complement of a packed sequence.
+ * \param[in] packed : the packed sequence
+ * \param[in] length : number of nucleotides
+ * \param[out] result : the getPackedSize(length) bytes of the packed reverse complement */
+void reverseComplementPacked (const u_int8_t* packed, size_t length, u_int8_t* result);
+
+/** Compute all the kmers (up to 32 nucleotides) of a packed sequence, with their reverse
+ * complements; the canonical kmer at position i is min(forward[i],revcomp[i]).
+ * \param[in] packed : the packed sequence
+ * \param[in] revcompPacked : the reverse complement of the packed sequence (see reverseComplementPacked)
+ * \param[in] length : number of nucleotides
+ * \param[in] kmerSize : size of the kmers (at most 32)
+ * \param[out] forward : the length-kmerSize+1 forward kmers
+ * \param[out] revcomp : the length-kmerSize+1 reverse complement kmers (may be null) */
+void buildKmers (
+    const u_int8_t* packed, const u_int8_t* revcompPacked, size_t length, size_t kmerSize,
+    u_int64_t* forward, u_int64_t* revcomp
+);
+
+/** Get the name of the kernel selected at runtime for the current CPU.
+ * \return "avx2", "sse4" or "scalar" */
+const char* getCodecKernelName ();
+
+/** Force the kernel to be used (for tests and benchmarks). A kernel not supported by the CPU
+ * is not selected.
+ * \param[in] name : "avx2", "sse4" or "scalar"
+ * \return true if the kernel is selected. */
+bool setCodecKernel (const char* name);
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MATH_NUCLEOTIDE_CODEC_HPP_ */
@@ -77,6 +77,8 @@ enum BloomKind
     BLOOM_CACHE,
     /** Implementation of Bloom filters improving CPU cache management. */
     BLOOM_NEIGHBOR,
+    /** Implementation of Bloom filters testing the bits of an item in one register sized block. */
+    BLOOM_BLOCKED,
     BLOOM_DEFAULT
 };
 
@@ -89,6 +91,7 @@ static void parse (const std::string& s, BloomKind& kind)
     else if (s == "basic")       { kind = BLOOM_BASIC;  }
     else if (s == "cache")       { kind = BLOOM_CACHE; }
 	else if (s == "neighbor")    { kind = BLOOM_NEIGHBOR; }
+    else if (s == "blocked")     { kind = BLOOM_BLOCKED; }
     else if (s == "default")     { kind = BLOOM_CACHE; }
     else   { throw system::Exception ("bad Bloom kind '%s'", s.c_str()); }
 }
@@ -104,6 +107,7 @@ static const char* toString (BloomKind kind)
         case BLOOM_BASIC:     return "basic";
         case BLOOM_CACHE:     return "cache";
 		case BLOOM_NEIGHBOR:  return "neighbor";
+        case BLOOM_BLOCKED:   return "blocked";
         case BLOOM_DEFAULT:   return "cache";
         default:        throw system::Exception ("bad Bloom kind %d", kind);
     }
@@ -120,6 +124,8 @@ enum DebloomKind
     DEBLOOM_ORIGINAL,
     /** Save cFP with cascading Bloom filters. */
     DEBLOOM_CASCADING,
+    /** No Bloom nor cFP: the nodes are stored in a cuckoo filter. */
+    DEBLOOM_CUCKOO,
     DEBLOOM_DEFAULT
 };
 
@@ -131,6 +137,7 @@ static void parse (const std::string& s, DebloomKind& kind)
          if (s == "none")       { kind = DEBLOOM_NONE;      }
     else if (s == "original")   { kind = DEBLOOM_ORIGINAL;  }
     else if (s == "cascading")  { kind = DEBLOOM_CASCADING; }
+    else if (s == "cuckoo")     { kind = DEBLOOM_CUCKOO;    }
     else if (s == "default")    { kind = DEBLOOM_CASCADING; }
     else   { throw system::Exception ("bad debloom kind '%s'", s.c_str()); }
 }
@@ -145,6 +152,7 @@ static std::string toString (DebloomKind kind)
         case DEBLOOM_NONE:      return "none";
         case DEBLOOM_ORIGINAL:  return "original";
         case DEBLOOM_CASCADING: return "cascading";
+        case DEBLOOM_CUCKOO:    return "cuckoo";
         case DEBLOOM_DEFAULT:   return "cascading";
         default:        throw system::Exception ("bad debloom kind %d", kind);
     }
@@ -94,6 +94,7 @@ public:
     const char* prefix         ()  { return "-prefix";         }
     const char* progress_bar   ()  { return "-bargraph";       }
     const char* nb_cores       ()  { return "-nb-cores";       }
+    const char* decompress_threads ()  { return "-decompress-threads"; }
     const char* partition_type ()  { return "-partition-type"; }
     const char* histogram_max  ()  { return "-histo-max";      }
     const char* uri_debloom    ()  { return "-debloom";        }
@@ -107,6 +108,7 @@ public:
     const char* bloom_type     ()  { return "-bloom";          }
     const char* debloom_type   ()  { return "-debloom";        }
     const char* debloom_impl   ()  { return "-debloom-impl";   }
+    const char* cuckoo_bits    ()  { return "-cuckoo-bits";    }
     const char* branching_type ()  { return "-branching-nodes";}
     const char* topology_stats ()  { return "-topology-stats";}
     const char* uri_solid_kmers()  { return "-solid-kmers-out";    }
@@ -119,6 +121,7 @@ public:
     const char* compress_level()   { return "-out-compress"; }
     const char* config_only()      { return "-config-only"; }
     const char* storage_type()     { return "-storage-type"; }
+    const char* estimate_kmers()   { return "-estimate-kmers"; }
 
     const char* attr_uri_input      ()  { return "input";           }
     const char* attr_kmer_size      ()  { return "kmer_size";       }
@@ -147,6 +150,7 @@ public:
 #define STR_PREFIX              gatb::core::tools::misc::StringRepository::singleton().prefix ()
 #define STR_PROGRESS_BAR        gatb::core::tools::misc::StringRepository::singleton().progress_bar ()
 #define STR_NB_CORES            gatb::core::tools::misc::StringRepository::singleton().nb_cores ()
+#define STR_DECOMPRESS_THREADS  gatb::core::tools::misc::StringRepository::singleton().decompress_threads ()
 #define STR_PARTITION_TYPE      gatb::core::tools::misc::StringRepository::singleton().partition_type ()
 #define STR_HISTOGRAM_MAX       gatb::core::tools::misc::StringRepository::singleton().histogram_max ()
 #define STR_URI_DEBLOOM         gatb::core::tools::misc::StringRepository::singleton().uri_debloom ()
@@ -160,6 +164,7 @@ public:
 #define STR_BLOOM_TYPE          gatb::core::tools::misc::StringRepository::singleton().bloom_type()
 #define STR_DEBLOOM_TYPE        gatb::core::tools::misc::StringRepository::singleton().debloom_type()
 #define STR_DEBLOOM_IMPL        gatb::core::tools::misc::StringRepository::singleton().debloom_impl()
+#define STR_CUCKOO_BITS         gatb::core::tools::misc::StringRepository::singleton().cuckoo_bits()
 #define STR_BRANCHING_TYPE      gatb::core::tools::misc::StringRepository::singleton().branching_type()
 #define STR_TOPOLOGY_STATS      gatb::core::tools::misc::StringRepository::singleton().topology_stats()
 #define STR_URI_SOLID_KMERS     gatb::core::tools::misc::StringRepository::singleton().uri_solid_kmers()
@@ -171,6 +176,7 @@ public:
 #define STR_COMPRESS_LEVEL      gatb::core::tools::misc::StringRepository::singleton().compress_level()
 #define STR_CONFIG_ONLY         gatb::core::tools::misc::StringRepository::singleton().config_only()
 #define STR_STORAGE_TYPE        gatb::core::tools::misc::StringRepository::singleton().storage_type ()
+#define STR_ESTIMATE_KMERS      gatb::core::tools::misc::StringRepository::singleton().estimate_kmers ()
 
 /********************************************************************************/
 
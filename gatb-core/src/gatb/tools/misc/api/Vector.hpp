@@ -31,6 +31,8 @@
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <gatb/system/impl/System.hpp>
 
+#include <algorithm>
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -85,12 +87,24 @@ public:
      * \return the retrieved character. */
     T& operator[]  (size_t idx)  { return _buffer[idx]; }
 
-    /** Resize the current vector.
+    /** Resize the current vector. If the data is a reference, it is copied into an allocated buffer.
      * \param[in] aSize : new size of the vector. */
     void resize (size_t aSize)
     {
+        if (_isAllocated == false && _buffer != 0)
+        {
+            char* buffer = (char*) MALLOC (aSize*sizeof(char));
+            memcpy (buffer, _buffer, std::min ((size_t)_size, aSize)*sizeof(char));
+            _buffer = buffer;
+
+            /** We get rid of the referred data if any. */
+            setRef (0);
+        }
+        else
+        {
+            _buffer = (char*) REALLOC (_buffer, aSize*sizeof(char));
+        }
         _size        = aSize;
-        _buffer      = (char*) REALLOC (_buffer, _size*sizeof(char));
         _isAllocated = true;
     }
 
@@ -104,6 +118,8 @@ public:
      * \param[in] length : size of the data */
     void setRef (Vector* ref, size_t offset, size_t length)
     {
+        if (_isAllocated && _buffer)  {  FREE (_buffer);  }
+
         setRef (ref);
         _buffer      = _ref->_buffer + offset;
         _size        = length;
@@ -115,6 +131,9 @@ public:
      * \param[in] length : size of the data */
     void setRef (T* buffer, size_t length)
     {
+        /** We release the data previously owned by the instance, if any. */
+        if (_isAllocated && _buffer)  {  FREE (_buffer);  }
+
         _buffer      = buffer;
         _size        = length;
         _isAllocated = false;
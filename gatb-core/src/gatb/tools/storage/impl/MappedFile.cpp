@@ -0,0 +1,260 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/tools/storage/impl/MappedFile.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace storage   {
+namespace impl      {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the mapping is for reading only: the pages are the ones of the page cache, no
+**           memory is reserved for private copies.
+*********************************************************************/
+MappedFile::MappedFile (const std::string& filename) : _filename(filename), _addr(0), _size(0)
+{
+    _size = System::file().getSize (filename);
+
+    int   fd   = _size >= sizeof(MappedFileFormat::Header) ? open (filename.c_str(), O_RDONLY) : -1;
+    void* addr = fd >= 0 ? mmap (0, _size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+    if (fd >= 0)  { close (fd); }
+
+    if (addr == MAP_FAILED)  {  throw Exception ("unable to map file '%s'", filename.c_str());  }
+
+    _addr = (u_int8_t*) addr;
+
+    /** The sections are mostly read at random (Bloom filters, MPHF...), so no read ahead. */
+    madvise (_addr, _size, MADV_RANDOM);
+
+    /** We check the header. */
+    const MappedFileFormat::Header* header = (const MappedFileFormat::Header*) _addr;
+
+    if (strncmp (header->magic, MappedFileFormat::magic(), sizeof(header->magic)) != 0
+        ||  header->version != MappedFileFormat::VERSION
+        ||  header->tableOffset + header->nbSections * sizeof(MappedFileFormat::Entry) > _size
+    )
+    {
+        munmap (_addr, _size);
+        throw Exception ("bad layout for mapped file '%s'", filename.c_str());
+    }
+
+    /** We read the sections table. */
+    const MappedFileFormat::Entry* entries = (const MappedFileFormat::Entry*) (_addr + header->tableOffset);
+
+    for (u_int64_t i=0; i<header->nbSections; i++)
+    {
+        if (entries[i].offset + entries[i].size > _size)
+        {
+            munmap (_addr, _size);
+            throw Exception ("bad section in mapped file '%s'", filename.c_str());
+        }
+
+        string name (entries[i].name, strnlen (entries[i].name, sizeof(entries[i].name)));
+        _sections[name] = make_pair (entries[i].offset, entries[i].size);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+MappedFile::~MappedFile ()
+{
+    munmap (_addr, _size);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int8_t* MappedFile::getSection (const std::string& name, u_int64_t& size) const
+{
+    map<string, pair<u_int64_t,u_int64_t> >::const_iterator it = _sections.find (name);
+
+    if (it == _sections.end())  {  throw Exception ("no section '%s' in mapped file '%s'", name.c_str(), _filename.c_str());  }
+
+    size = it->second.second;
+    return _addr + it->second.first;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+MappedFileWriter::MappedFileWriter (const std::string& filename)
+    : _filename(filename), _file(0), _inSection(false), _end(sizeof(MappedFileFormat::Header))
+{
+    _file = System::file().newFile (getTemporaryFilename(), "wb+");
+
+    if (_file == 0 || _file->isOpen() == false)  {  throw Exception ("unable to create mapped file '%s'", filename.c_str());  }
+
+    /** An empty but valid file. */
+    writeTable ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a section not ended is dropped (the table still describes the previous sections).
+**           The file is written under a temporary name and renamed here: a previous file that
+**           is still mapped by some process is not truncated under its feet.
+*********************************************************************/
+MappedFileWriter::~MappedFileWriter ()
+{
+    delete _file;
+
+    System::file().rename (getTemporaryFilename(), _filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void MappedFileWriter::beginSection (const std::string& name)
+{
+    if (_inSection)                                 {  throw Exception ("mapped file '%s': section '%s' not ended", _filename.c_str(), _current.name);  }
+    if (name.size() >= sizeof(_current.name))      {  throw Exception ("mapped file '%s': section name '%s' too long", _filename.c_str(), name.c_str());  }
+    if (hasSection (name))                          {  throw Exception ("mapped file '%s': section '%s' already exists", _filename.c_str(), name.c_str());  }
+
+    memset (&_current, 0, sizeof(_current));
+    strncpy (_current.name, name.c_str(), sizeof(_current.name)-1);
+    _current.offset = MappedFileFormat::align (_end);
+    _current.size   = 0;
+
+    _file->seeko (_current.offset, SEEK_SET);
+
+    _inSection = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void MappedFileWriter::write (const void* data, u_int64_t size)
+{
+    if (size == 0)  { return; }
+
+    if (_file->fwrite (data, size, 1) != 1)  {  throw Exception ("unable to write into mapped file '%s'", _filename.c_str());  }
+
+    _current.size += size;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void MappedFileWriter::endSection ()
+{
+    _entries.push_back (_current);
+    _end       = _current.offset + _current.size;
+    _inSection = false;
+
+    writeTable ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool MappedFileWriter::hasSection (const std::string& name) const
+{
+    for (size_t i=0; i<_entries.size(); i++)  {  if (name == _entries[i].name)  { return true; }  }
+    return false;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : write the sections table after the last section, then the header
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the next section will overwrite the table (it starts on the next page boundary)
+*********************************************************************/
+void MappedFileWriter::writeTable ()
+{
+    MappedFileFormat::Header header;
+    memset (&header, 0, sizeof(header));
+    strncpy (header.magic, MappedFileFormat::magic(), sizeof(header.magic));
+    header.version     = MappedFileFormat::VERSION;
+    header.tableOffset = _end;
+    header.nbSections  = _entries.size();
+
+    _file->seeko (_end, SEEK_SET);
+    if (_entries.empty() == false)  {  _file->fwrite (_entries.data(), sizeof(MappedFileFormat::Entry), _entries.size());  }
+
+    _file->seeko (0, SEEK_SET);
+    if (_file->fwrite (&header, sizeof(header), 1) != 1)  {  throw Exception ("unable to write into mapped file '%s'", _filename.c_str());  }
+
+    _file->flush ();
+}
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file MappedFile.hpp
+ *  \brief Native file made of page aligned sections, meant to be mmaped
+ *
+ *  This file holds the reader and the writer of the native file that a storage may
+ *  have alongside its HDF5 file (see Storage::getMappedFile).
+ */
+
+#ifndef _GATB_CORE_TOOLS_STORAGE_IMPL_MAPPED_FILE_HPP_
+#define _GATB_CORE_TOOLS_STORAGE_IMPL_MAPPED_FILE_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/ISmartPointer.hpp>
+#include <gatb/system/api/IFileSystem.hpp>
+#include <gatb/system/api/types.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <streambuf>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace storage   {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Layout of the native mapped file.
+ *
+ *  The file is made of:
+ *    - a header (magic string, version, offset and size of the sections table) in the first page
+ *    - named sections, each one starting on a page boundary
+ *    - the sections table (name, offset and size of each section), after the last section
+ *
+ *  Since the sections are page aligned, they can be used in place once the file is mmaped:
+ *  nothing is copied at load time, and only the pages actually read are loaded in memory.
+ */
+struct MappedFileFormat
+{
+    /** Alignment of the sections. */
+    static const u_int64_t PAGE_SIZE = 4096;
+
+    /** Version of the layout. */
+    static const u_int64_t VERSION = 1;
+
+    /** Header of the file. */
+    struct Header
+    {
+        char      magic[8];
+        u_int64_t version;
+        u_int64_t tableOffset;
+        u_int64_t nbSections;
+    };
+
+    /** Entry of the sections table. */
+    struct Entry
+    {
+        char      name[48];
+        u_int64_t offset;
+        u_int64_t size;
+    };
+
+    /** Magic string of the file. */
+    static const char* magic ()  { return "GATBMAP"; }
+
+    /** Round an offset up to the next page boundary. */
+    static u_int64_t align (u_int64_t offset)  { return (offset + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE; }
+};
+
+/********************************************************************************/
+
+/** \brief Read access to a native mapped file.
+ *
+ * The whole file is mmaped for reading only (the pages are the ones of the page cache) and
+ * the sections are given as pointers into the mapping: writing into a section faults, so an
+ * object that may be modified must copy its section. The mapping lives as long as the
+ * MappedFile instance, so objects using a section should keep a reference on it.
+ */
+class MappedFile : public system::SmartPointer
+{
+public:
+
+    /** Constructor. Throws an exception if the file can't be mapped or has a bad layout.
+     * \param[in] filename : the native mapped file. */
+    MappedFile (const std::string& filename);
+
+    /** Destructor. */
+    ~MappedFile ();
+
+    /** Tells whether a section exists.
+     * \param[in] name : name of the section
+     * \return true if the section exists, false otherwise. */
+    bool hasSection (const std::string& name) const  {  return _sections.find(name) != _sections.end();  }
+
+    /** Get a section. Throws an exception if the section doesn't exist.
+     * \param[in] name : name of the section
+     * \param[out] size : size (in bytes) of the section
+     * \return the address of the (page aligned) section in the mapping, for reading only. */
+    u_int8_t* getSection (const std::string& name, u_int64_t& size) const;
+
+    /** \return the name of the file. */
+    const std::string& getFilename () const  { return _filename; }
+
+private:
+
+    std::string _filename;
+    u_int8_t*   _addr;
+    u_int64_t   _size;
+
+    std::map<std::string, std::pair<u_int64_t,u_int64_t> > _sections;
+};
+
+/********************************************************************************/
+
+/** \brief Write access to a native mapped file.
+ *
+ * Sections are appended one after the other; the sections table and the header are
+ * rewritten each time a section is ended, so the file is consistent between two sections.
+ */
+class MappedFileWriter : public system::SmartPointer
+{
+public:
+
+    /** Constructor. The file is written under a temporary name until the writer is destroyed;
+     * it then replaces the file of the given name, if any.
+     * \param[in] filename : the native mapped file. */
+    MappedFileWriter (const std::string& filename);
+
+    /** Destructor. The written file gets its final name. */
+    ~MappedFileWriter ();
+
+    /** Start a new section.
+     * \param[in] name : name of the section. */
+    void beginSection (const std::string& name);
+
+    /** Append data to the current section.
+     * \param[in] data : data to be written
+     * \param[in] size : size (in bytes) of the data */
+    void write (const void* data, u_int64_t size);
+
+    /** End the current section. */
+    void endSection ();
+
+    /** Write a whole section.
+     * \param[in] name : name of the section
+     * \param[in] data : content of the section
+     * \param[in] size : size (in bytes) of the section */
+    void addSection (const std::string& name, const void* data, u_int64_t size)
+    {
+        beginSection (name);
+        write (data, size);
+        endSection ();
+    }
+
+    /** Tells whether a section has been written.
+     * \param[in] name : name of the section
+     * \return true if the section exists, false otherwise. */
+    bool hasSection (const std::string& name) const;
+
+    /** Output stream writing into a new section, for objects having a std::ostream serialization.
+     * The section is ended when the stream is destroyed. */
+    class ostream : public std::ostream
+    {
+    public:
+        ostream (MappedFileWriter& writer, const std::string& name)
+            : std::ostream(0), _buf(writer)  {  writer.beginSection (name);  rdbuf (&_buf);  }
+        ~ostream ()  {  _buf.pubsync();  _buf.getWriter().endSection();  }
+
+    private:
+
+        class streambuf : public std::streambuf
+        {
+        public:
+            streambuf (MappedFileWriter& writer) : _writer(writer)  {  setp (_buffer, _buffer + sizeof(_buffer));  }
+            MappedFileWriter& getWriter ()  { return _writer; }
+        protected:
+            int overflow (int c)
+            {
+                sync ();
+                if (c != traits_type::eof())  {  *pptr() = traits_type::to_char_type(c);  pbump(1);  }
+                return traits_type::not_eof (c);
+            }
+            int sync ()
+            {
+                _writer.write (pbase(), pptr()-pbase());
+                setp (_buffer, _buffer + sizeof(_buffer));
+                return 0;
+            }
+        private:
+            MappedFileWriter& _writer;
+            char _buffer[64*1024];
+        };
+
+        streambuf _buf;
+    };
+
+private:
+
+    std::string    _filename;
+    system::IFile* _file;
+
+    std::vector<MappedFileFormat::Entry> _entries;
+    MappedFileFormat::Entry              _current;
+    bool                                 _inSection;
+
+    /** End of the last section. */
+    u_int64_t _end;
+
+    void writeTable ();
+
+    std::string getTemporaryFilename () const  { return _filename + ".tmp"; }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_STORAGE_IMPL_MAPPED_FILE_HPP_ */
@@ -34,7 +34,7 @@ namespace gatb { namespace core {  namespace tools {  namespace storage {  names
 ** REMARKS :
 *********************************************************************/
 Storage::Storage (StorageMode_e mode, const std::string& name, bool autoRemove)
-    : Cell(0, ""), _name(name), _factory(0), _root(0), _autoRemove(autoRemove)
+    : Cell(0, ""), _name(name), _factory(0), _root(0), _autoRemove(autoRemove), _mappedFile(0), _mappedFileWriter(0)
 {
     setFactory (new StorageFactory (mode));
 }
@@ -51,6 +51,9 @@ Storage::~Storage ()
 {
     setRoot    (0);
     setFactory (0);
+
+    setMappedFile       (0);
+    setMappedFileWriter (0);
 }
 
 /*********************************************************************
@@ -107,6 +110,60 @@ void Storage::setFactory (StorageFactory* factory)
     SP_SETATTR(factory);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+std::string Storage::getMappedFilename () const
+{
+    std::string prefix = _name;
+
+    if (prefix.size() >= 3 && prefix.compare (prefix.size()-3, 3, ".h5") == 0)  {  prefix.resize (prefix.size()-3);  }
+
+    return prefix + ".mmap";
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the file is mapped at first call; a file being written is not mapped.
+*********************************************************************/
+MappedFile* Storage::getMappedFile ()
+{
+    if (_mappedFile == 0  &&  _mappedFileWriter == 0)
+    {
+        std::string filename = getMappedFilename();
+
+        if (system::impl::System::file().doesExist (filename))  {  setMappedFile (new MappedFile (filename));  }
+    }
+
+    return _mappedFileWriter == 0 ? _mappedFile : 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+MappedFileWriter* Storage::createMappedFile ()
+{
+    /** The new file replaces the previous one once closed, so the previous mapping is released. */
+    setMappedFile       (0);
+    setMappedFileWriter (new MappedFileWriter (getMappedFilename()));
+
+    return _mappedFileWriter;
+}
+
 /********************************************************************************
              #####   #######  ######   #######     #     #     #
             #     #     #     #     #  #          # #    ##   ##
@@ -307,11 +364,17 @@ Storage::istream::~istream ()
 ////////// SuperKmerBinFiles //////////
 ///////////////////////////////////////
 	
-SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files) : _basefilename(name), _path(path),_nb_files(nb_files)
+SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool lockFree, bool inMemory) : _basefilename(name), _path(path),_nb_files(nb_files), _lockFree(lockFree), _inMemory(inMemory)
 {
 	_nbKmerperFile.resize(_nb_files,0);
 	_FileSize.resize(_nb_files,0);
 	
+	if(_inMemory)
+	{
+		_memBlocks.resize(_nb_files);
+		_memReadIdx.resize(_nb_files,0);
+	}
+	
 	openFiles("wb"); //at construction will open file for writing
 	// then use close() and openFiles() to open for reading
 	
@@ -319,6 +382,9 @@ SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string&
 
 void SuperKmerBinFiles::openFile( const char* mode, int fileId)
 {
+	//in memory, (re)opening a file only rewinds its blocks list
+	if(_inMemory)  { _memReadIdx[fileId] = 0; return; }
+	
 	std::stringstream ss;
 	ss << _basefilename << "." << fileId;
 		
@@ -332,8 +398,24 @@ void SuperKmerBinFiles::openFiles( const char* mode)
 	_files.resize(_nb_files,0);
 	_synchros.resize(_nb_files,0);
 	
+	//the directory is created in memory too : the hash counting puts its runs next to the partitions files
 	system::impl::System::file().mkdir(_path, 0755);
 
+	if(_inMemory)
+	{
+		//no file here, the synchros live as long as the object (see destructor)
+		for(unsigned int ii=0;ii<_files.size();ii++)
+		{
+			if(_synchros[ii]==0)
+			{
+				_synchros[ii] = system::impl::System::thread().newSynchronizer();
+				_synchros[ii]->use();
+			}
+			_memReadIdx[ii] = 0;
+		}
+		return;
+	}
+
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		std::stringstream ss;
@@ -359,6 +441,25 @@ std::string SuperKmerBinFiles::getFileName(int fileId)
 	
 int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id)
 {
+	if(_inMemory)
+	{
+		_synchros[file_id]->lock();
+		size_t idx = _memReadIdx[file_id]++;
+		_synchros[file_id]->unlock();
+		
+		if(idx >= _memBlocks[file_id].size())  { return 0; }
+		
+		//no copy : the reader gets the block itself, and its previous buffer (the block it has just read) is released
+		if(*block != 0)  { FREE (*block); }
+		
+		*block          = _memBlocks[file_id][idx].first;
+		*nb_bytes_read  = _memBlocks[file_id][idx].second;
+		*max_block_size = *nb_bytes_read;
+		_memBlocks[file_id][idx].first = 0;
+		
+		return *nb_bytes_read;
+	}
+	
 	_synchros[file_id]->lock();
 	
 	//block header
@@ -373,7 +474,7 @@ int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block
 	
 	if(*nb_bytes_read > *max_block_size)
 	{
-		*block = (unsigned char *) realloc(*block, *nb_bytes_read);
+		*block = (unsigned char *) REALLOC(*block, *nb_bytes_read);
 		*max_block_size = *nb_bytes_read;
 	}
 	
@@ -417,6 +518,30 @@ void SuperKmerBinFiles::getFilesStats(u_int64_t & total, u_int64_t & biggest, u_
 	
 void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers)
 {
+	if(_inMemory)
+	{
+		//the block itself is kept, only the blocks list is protected
+		_synchros[file_id]->lock();
+		_memBlocks[file_id].push_back(std::make_pair(block, block_size));
+		_nbKmerperFile[file_id]+=nbkmers;
+		_FileSize[file_id] += block_size+sizeof(block_size);
+		_synchros[file_id]->unlock();
+		return;
+	}
+	
+	if(_lockFree)
+	{
+		//reserve the region of the block (header + block) at the end of the file
+		u_int64_t offset = __sync_fetch_and_add (&_FileSize[file_id], block_size+sizeof(block_size));
+		__sync_fetch_and_add (&_nbKmerperFile[file_id], nbkmers);
+
+		if (_files[file_id]->pwrite(&block_size, sizeof(block_size), offset) != sizeof(block_size)
+		||  _files[file_id]->pwrite(block, block_size, offset+sizeof(block_size)) != block_size)
+		{
+			throw system::Exception ("SuperKmerBinFiles: unable to write block in %s", getFileName(file_id).c_str());
+		}
+		return;
+	}
 
 	_synchros[file_id]->lock();
 	
@@ -450,6 +575,17 @@ void SuperKmerBinFiles::flushFiles()
 
 void SuperKmerBinFiles::eraseFiles()
 {
+	if(_inMemory)
+	{
+		for(unsigned int ii=0;ii<_memBlocks.size();ii++)
+		{
+			for(unsigned int jj=0;jj<_memBlocks[ii].size();jj++)  { if(_memBlocks[ii][jj].first!=0)  { FREE (_memBlocks[ii][jj].first); } }
+			std::vector< std::pair<u_int8_t*,unsigned int> >().swap(_memBlocks[ii]);
+		}
+		system::impl::System::file().rmdir(_path);
+		return;
+	}
+	
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		std::stringstream ss;
@@ -462,6 +598,14 @@ void SuperKmerBinFiles::eraseFiles()
 
 void SuperKmerBinFiles::closeFile(  int fileId)
 {
+	//in memory, the partition has been read : the blocks not handed over to a reader are released
+	if(_inMemory)
+	{
+		for(unsigned int jj=0;jj<_memBlocks[fileId].size();jj++)  { if(_memBlocks[fileId][jj].first!=0)  { FREE (_memBlocks[fileId][jj].first); } }
+		std::vector< std::pair<u_int8_t*,unsigned int> >().swap(_memBlocks[fileId]);
+		return;
+	}
+	
 	if(_files[fileId]!=0)
 	{
 		delete _files[fileId];
@@ -473,6 +617,8 @@ void SuperKmerBinFiles::closeFile(  int fileId)
 	
 void SuperKmerBinFiles::closeFiles()
 {
+	if(_inMemory)  { return; }
+	
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		if(_files[ii]!=0)
@@ -488,6 +634,11 @@ SuperKmerBinFiles::~SuperKmerBinFiles()
 {
 	this->closeFiles();
 	this->eraseFiles();
+	
+	if(_inMemory)
+	{
+		for(unsigned int ii=0;ii<_synchros.size();ii++)  { if(_synchros[ii]!=0)  { _synchros[ii]->forget(); } }
+	}
 }
 	
 int SuperKmerBinFiles::nbFiles()
@@ -556,7 +707,18 @@ void CacheSuperKmerBinFiles::flush(int file_id)
 {
 	if(_buffers_idx[file_id]!=0)
 	{
-		_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+		if(_ref->isInMemory())
+		{
+			//the buffer itself is kept by _ref, a new one is allocated at the next insertion.
+			//a buffer less than half full (last flushes) is shrunk first
+			if(2*_buffers_idx[file_id] < _buffer_max_capacity)  { _buffers[file_id] = (u_int8_t*) REALLOC (_buffers[file_id], _buffers_idx[file_id]); }
+			_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+			_buffers[file_id] = 0;
+		}
+		else
+		{
+			_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+		}
 		
 		_buffers_idx[file_id]=0;
 		_nbKmerperFile[file_id] = 0;
@@ -571,6 +733,8 @@ void CacheSuperKmerBinFiles::insertSuperkmer(u_int8_t* superk, int nb_bytes, u_i
 		flush(file_id);
 	}
 	
+	if(_buffers[file_id]==0)  { _buffers[file_id] = (u_int8_t*) MALLOC (sizeof(u_int8_t) * _buffer_max_capacity); }
+	
 	_buffers[file_id][_buffers_idx[file_id]++] = nbk;
 	
 	memcpy(_buffers[file_id] + _buffers_idx[file_id]  , superk,nb_bytes);
@@ -584,7 +748,7 @@ CacheSuperKmerBinFiles::~CacheSuperKmerBinFiles()
 	this->flushAll();
 	for(unsigned int ii=0; ii<_buffers.size();ii++ )
 	{
-		FREE (_buffers[ii]);
+		if(_buffers[ii]!=0)  { FREE (_buffers[ii]); }
 	}
 }
 /********************************************************************************/
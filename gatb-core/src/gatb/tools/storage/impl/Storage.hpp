@@ -35,6 +35,7 @@
 /********************************************************************************/
 
 #include <gatb/tools/storage/impl/Cell.hpp>
+#include <gatb/tools/storage/impl/MappedFile.hpp>
 
 #include <gatb/tools/collections/api/Collection.hpp>
 #include <gatb/tools/collections/impl/CollectionAbstract.hpp>
@@ -82,6 +83,7 @@ class Group;
 template <typename Type>  class Partition;
 template <typename Type>  class CollectionNode;
 
+class Storage;
 class StorageFactory;
 
 /********************************************************************************
@@ -195,6 +197,10 @@ public:
     /** \copydoc Cell::remove */
     void remove ();
 
+    /** Get the storage holding the group.
+     * \return the storage, or 0 if the group doesn't belong to a storage. */
+    Storage* getStorage ();
+
     /** Associate a [key,value] to the group. Note: according to the kind of storage,
      * this feature may be not supported (looks like it's only supported in HDF5).
      * \param[in] key : key
@@ -250,7 +256,14 @@ public:
 	
 	//construtor will open the files for writing
 	//use closeFiles to close them all then openFiles to open in different mode
-	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files);
+	//with lockFree, writeBlock does not lock the file : each block atomically reserves its region
+	//at the end of the file and is written there with pwrite, so threads flushing their caches
+	//in the same partition do not wait for each other. Reading is the same in both modes.
+	//with inMemory, the partitions are not written on disk (only their directory is created, for the runs
+	//that the hash counting puts next to them, see getFileName) : the blocks given to writeBlock are kept
+	//in RAM as they are, and readBlock hands each of them over to its reader, so a partition can be read
+	//only once and its memory is released while it is read.
+	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool lockFree=false, bool inMemory=false);
 	
 	~SuperKmerBinFiles();
 
@@ -262,10 +275,15 @@ public:
 	void closeFile(  int fileId);
 
 	//read/write block of superkmers to filefile_id
-	//readBlock will re-allocate the block buffer if needed (current size passed by max_block_size)
+	//readBlock will re-allocate the block buffer if needed (current size passed by max_block_size),
+	//the buffer must be allocated/released with MALLOC/REALLOC/FREE.
+	//in memory, readBlock gives the stored block itself in place of the buffer, and releases the buffer,
+	//writeBlock keeps the block itself : it must be allocated with MALLOC and the caller must not use it anymore.
 	int readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id);
 	void writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers);
 
+	bool isInMemory() const { return _inMemory; }
+
 	int nbFiles();
 	int getNbItems(int fileId);
 	
@@ -285,6 +303,11 @@ private:
 	std::vector<system::IFile* > _files;
 	std::vector <system::ISynchronizer*> _synchros;
 	int _nb_files;
+	bool _lockFree;
+	
+	bool _inMemory;
+	std::vector< std::vector< std::pair<u_int8_t*,unsigned int> > > _memBlocks;
+	std::vector<size_t> _memReadIdx;
 };
 
 
@@ -544,6 +567,34 @@ public:
     /** */
     StorageFactory* getFactory() const { return _factory; }
 
+    /** Get the name of the native mapped file that may live alongside the storage (see MappedFile):
+     * the name of the storage without its ".h5" suffix, with a ".mmap" suffix.
+     * \return the name of the mapped file. */
+    std::string getMappedFilename () const;
+
+    /** Get the native mapped file of the storage, whose sections are used in place by the data
+     * structures having one (Bloom filter, false positive set, MPHF...) instead of being read from the storage.
+     * \return the mapped file, or 0 if it doesn't exist or is being written. */
+    MappedFile* getMappedFile ();
+
+    /** Create the native mapped file of the storage. The data structures saved in the storage
+     * afterwards also write their section in this file, until closeMappedFile is called.
+     * \return the writer of the mapped file. */
+    MappedFileWriter* createMappedFile ();
+
+    /** Close the native mapped file being written; it replaces the previous one, if any. */
+    void closeMappedFile ()  {  setMappedFileWriter (0);  }
+
+    /** Get the writer of the native mapped file, if createMappedFile has been called.
+     * \return the writer, or 0 if none. */
+    MappedFileWriter* getMappedFileWriter ()  { return _mappedFileWriter; }
+
+    /** Get the name of the section of a data structure in the mapped file.
+     * \param[in] group : group holding the data structure
+     * \param[in] name : name of the data structure in the group
+     * \return the section name. */
+    static std::string getSectionName (Group& group, const std::string& name)  {  return group.getFullId('/') + "/" + name;  }
+
     /** WRAPPER C++ OUTPUT STREAM */
     class ostream : public std::ostream
     {
@@ -573,6 +624,12 @@ protected:
     void setRoot (Group* root)  { SP_SETATTR(root); }
 
     bool _autoRemove;
+
+    MappedFile* _mappedFile;
+    void setMappedFile (MappedFile* mappedFile)  { SP_SETATTR(mappedFile); }
+
+    MappedFileWriter* _mappedFileWriter;
+    void setMappedFileWriter (MappedFileWriter* mappedFileWriter)  { SP_SETATTR(mappedFileWriter); }
 };
 
 /********************************************************************************
@@ -156,6 +156,14 @@ inline CollectionNode<Type>&  Group::getCollection (const std::string& name)
     return *result;
 }
 
+/*********************************************************************
+*********************************************************************/
+inline Storage* Group::getStorage ()
+{
+    ICell* cell = this;  while (cell->getParent() != 0)  {  cell = cell->getParent();  }
+    return dynamic_cast<Storage*> (cell);
+}
+
 /*********************************************************************
 *********************************************************************/
 inline void Group::remove ()
@@ -196,7 +196,11 @@ private:
         StorageHDF5 (StorageMode_e mode, const std::string& name, bool deleteIfExist, bool autoRemove, bool dont_add_extension = false, bool append = false)
             : Storage (mode, name, autoRemove), _fileId(0), _name(name), _dont_add_extension(dont_add_extension)
         {
-            if (deleteIfExist)  {  system::impl::System::file().remove (getActualName());  }
+            if (deleteIfExist)
+            {
+                system::impl::System::file().remove (getActualName());
+                system::impl::System::file().remove (getMappedFilename());
+            }
 
             /** We test the actual name exists in filesystem. */
             bool exists = system::impl::System::file().doesExist(getActualName());
@@ -226,7 +230,9 @@ private:
 
         void remove ()
         {
+            closeMappedFile ();
             system::impl::System::file().remove (getActualName());
+            system::impl::System::file().remove (getMappedFilename());
         }
 
 
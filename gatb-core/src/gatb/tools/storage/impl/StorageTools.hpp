@@ -36,6 +36,7 @@
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/collections/impl/Bloom.hpp>
 #include <gatb/tools/collections/impl/ContainerSet.hpp>
+#include <gatb/tools/collections/impl/CuckooFilter.hpp>
 
 
 /********************************************************************************/
@@ -80,10 +81,40 @@ public:
      */
     template<typename T>  collections::Container<T>*  loadContainer (Group& group, const std::string& name)
     {
+        /** The sorted items may be used in place from the mapped file of the storage (see saveContainerMapped). */
+        MappedFile* mappedFile = getMappedFile (group);
+        std::string section    = Storage::getSectionName (group, name);
+
+        if (mappedFile != 0  &&  mappedFile->hasSection (section))
+        {
+            u_int64_t size  = 0;
+            T*        items = (T*) mappedFile->getSection (section, size);
+            return new collections::impl::ContainerSet<T> (items, size / sizeof(T), mappedFile);
+        }
+
         collections::Collection<T>*  storageCollection = & group.getCollection<T> (name);
         return new collections::impl::ContainerSet<T> (storageCollection->iterator());
     }
 
+    /** Save the sorted items of a Collection instance into the mapped file of the storage of a group,
+     * if this file is being written (see Storage::createMappedFile); loadContainer then uses them in place.
+     * \param[in] group : group where the collection is saved
+     * \param[in] name : name of the collection in the group
+     * \param[in] collection : Collection instance to be saved.
+     */
+    template<typename T>  void saveContainerMapped (Group& group, const std::string& name, collections::Collection<T>* collection)
+    {
+        MappedFileWriter* writer = getMappedFileWriter (group);
+        if (writer == 0)  { return; }
+
+        std::vector<T> items;
+        tools::dp::Iterator<T>* it = collection->iterator();   LOCAL(it);
+        for (it->first(); !it->isDone(); it->next())  {  items.push_back (it->item());  }
+        std::sort (items.begin(), items.end());
+
+        writer->addSection (Storage::getSectionName (group, name), items.data(), items.size()*sizeof(T));
+    }
+
     /** Save a Bloom filter into a group
      * \param[in] group : group where the IBloom instance has to be saved
      * \param[in] name : name of the Bloom filter in the group
@@ -118,6 +149,12 @@ public:
         bloomCollection->addProperty ("nb_hash",   ss2.str());
         bloomCollection->addProperty ("type",      bloom->getName());
         bloomCollection->addProperty ("kmer_size", ss3.str());
+
+        /** The bit set is also written into the mapped file of the storage, if any. */
+        if (MappedFileWriter* writer = getMappedFileWriter (group))
+        {
+            writer->addSection (Storage::getSectionName (group, name), bloom->getArray(), bloom->getSize());
+        }
     }
 
     /** Load a Bloom filter from a group
@@ -138,7 +175,20 @@ public:
             bloomArray->getProperty("kmer_size")
         );
 
-        if (bloomMode == 0)
+        /** The bit set may be used in place from the mapped file of the storage. */
+        MappedFile* mappedFile = getMappedFile (group);
+        std::string section    = Storage::getSectionName (group, name);
+
+        if (mappedFile != 0  &&  mappedFile->hasSection (section))
+        {
+            u_int64_t size  = 0;
+            u_int8_t* array = mappedFile->getSection (section, size);
+
+            if (size != bloom->getSize())  {  throw system::Exception ("bad size for Bloom filter '%s' in mapped file", section.c_str());  }
+
+            bloom->useArray (array, mappedFile);
+        }
+        else if (bloomMode == 0)
         {
             /** We set the bloom with the provided array given as an iterable of NativeInt8 objects. */
             bloomArray->getItems ((tools::math::NativeInt8*&)bloom->getArray());
@@ -155,8 +205,92 @@ public:
         return bloom;
     }
 
+    /** Save a cuckoo filter into a group
+     * \param[in] group : group where the CuckooFilter instance has to be saved
+     * \param[in] name : name of the cuckoo filter in the group
+     * \param[in] filter : cuckoo filter to be saved
+     */
+    template<typename T>  void saveCuckoo (Group& group, const std::string& name, collections::impl::CuckooFilter<T>* filter)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        tools::storage::impl::Storage::ostream os (group, name);
+        os.write (reinterpret_cast<char const*>(filter->getArray()), filter->getSize()*sizeof(char));
+        os.flush();
+
+        u_int64_t victimFp=0, victimIdx=0;
+        filter->getVictim (victimFp, victimIdx);
+
+        std::stringstream ss1;  ss1 <<  filter->getCapacity();
+        std::stringstream ss2;  ss2 <<  filter->getFingerprintBits();
+        std::stringstream ss3;  ss3 <<  filter->getNbItems();
+        std::stringstream ss4;  ss4 <<  victimFp;
+        std::stringstream ss5;  ss5 <<  victimIdx;
+
+        filterCollection->addProperty ("capacity",         ss1.str());
+        filterCollection->addProperty ("fingerprint_bits", ss2.str());
+        filterCollection->addProperty ("nb_items",         ss3.str());
+        filterCollection->addProperty ("victim_fp",        ss4.str());
+        filterCollection->addProperty ("victim_idx",       ss5.str());
+
+        /** The buckets are also written into the mapped file of the storage, if any. */
+        if (MappedFileWriter* writer = getMappedFileWriter (group))
+        {
+            writer->addSection (Storage::getSectionName (group, name), filter->getArray(), filter->getSize());
+        }
+    }
+
+    /** Load a cuckoo filter from a group
+     * \param[in] group : group where the cuckoo filter is
+     * \param[in] name : name of the cuckoo filter in the group
+     * \param[in] modifiable : true if items may be removed from the filter; the buckets are then
+     *  copied from the mapped file of the storage instead of being used in place (read only)
+     * \return the cuckoo filter
+     */
+    template<typename T>  collections::impl::CuckooFilter<T>*  loadCuckoo (Group& group, const std::string& name, bool modifiable=true)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        collections::impl::CuckooFilter<T>* filter = new collections::impl::CuckooFilter<T> (
+            atoll (filterCollection->getProperty("capacity").c_str()),
+            atoi  (filterCollection->getProperty("fingerprint_bits").c_str())
+        );
+
+        filter->setState (
+            atoll (filterCollection->getProperty("nb_items").c_str()),
+            atoll (filterCollection->getProperty("victim_fp").c_str()),
+            atoll (filterCollection->getProperty("victim_idx").c_str())
+        );
+
+        /** The buckets may be used in place from the mapped file of the storage, if not modified. */
+        MappedFile* mappedFile = getMappedFile (group);
+        std::string section    = Storage::getSectionName (group, name);
+
+        if (mappedFile != 0  &&  mappedFile->hasSection (section))
+        {
+            u_int64_t size  = 0;
+            u_int8_t* array = mappedFile->getSection (section, size);
+
+            if (size != filter->getSize())  {  throw system::Exception ("bad size for cuckoo filter '%s' in mapped file", section.c_str());  }
+
+            if (modifiable)  {  memcpy (filter->getArray(), array, size);     }
+            else             {  filter->useArray (array, mappedFile);  }
+        }
+        else
+        {
+            tools::storage::impl::Storage::istream is (group, name);
+            is.read (reinterpret_cast<char*>(filter->getArray()), filter->getSize()*sizeof(char));
+        }
+
+        return filter;
+    }
+
 private:
 
+    /** Shortcuts on the mapped file of the storage of a group. */
+    MappedFile*       getMappedFile       (Group& group)  {  Storage* s = group.getStorage();  return s ? s->getMappedFile()       : 0;  }
+    MappedFileWriter* getMappedFileWriter (Group& group)  {  Storage* s = group.getStorage();  return s ? s->getMappedFileWriter() : 0;  }
+
     /** We keep the possibility to load/save Bloom filters in two different ways.
      * The old one (with 'insert') has the drawback that the Bloom filter was read/written in
      * one shot, which made big memory usage by HDF5 (one buffer for memory, one buffer for file).
@@ -19,22 +19,12 @@
 #include <gatb/system/impl/System.hpp>
 
 #include <gatb/bank/impl/Bank.hpp>
-#include <gatb/bank/impl/BankBinary.hpp>
-#include <gatb/bank/impl/BankHelpers.hpp>
 
 #include <gatb/kmer/impl/Model.hpp>
-#include <gatb/kmer/impl/BankKmerIterator.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
-#include <gatb/tools/designpattern/impl/Command.hpp>
-
-#include <gatb/tools/misc/impl/Property.hpp>
-#include <gatb/tools/misc/impl/Progress.hpp>
-
-#include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/tools/math/LargeInt.hpp>
-#include <gatb/tools/math/Integer.hpp>
 #include <iostream>
 #include <string.h>
 
@@ -48,316 +38,115 @@ using namespace gatb::core::kmer;
 using namespace gatb::core::kmer::impl;
 using namespace gatb::core::tools::dp;
 using namespace gatb::core::tools::dp::impl;
-using namespace gatb::core::tools::misc;
-using namespace gatb::core::tools::misc::impl;
 using namespace gatb::core::tools::math;
-using namespace gatb::core::tools::misc::impl;
 
 /********************************************************************************/
 
-struct Hash  {   kmer_type operator () (kmer_type& lkmer)
+/** Benchmark of the kmers iteration for a given span, ie. of the LargeInt operations
+ * (shifts, additions, masks and revcomp) used by the kmer models. The kmer size is the
+ * largest one of the span, so all the words of the LargeInt are used. */
+template<size_t span>  struct FunctorBench
 {
-    kmer_type kmer_hash;
-
-    kmer_hash = lkmer ^ (lkmer >> 14);
-    kmer_hash = (~kmer_hash) + (kmer_hash << 18);
-    kmer_hash = kmer_hash ^ (kmer_hash >> 31);
-    kmer_hash = kmer_hash * 21;
-    kmer_hash = kmer_hash ^ (kmer_hash >> 11);
-    kmer_hash = kmer_hash + (kmer_hash << 6);
-    kmer_hash = kmer_hash ^ (kmer_hash >> 22);
+    typedef typename Kmer<span>::Type            Type;
+    typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
+    typedef typename ModelCanonical::Kmer        KmerType;
 
-    return kmer_hash;
-}};
-
-Hash theHash;
-
-/********************************************************************************/
-
-struct FunctorIter1
-{
-    void operator() (Sequence& sequence)
+    struct Checksum
     {
-        nbSeq++;
-        dataSeq += sequence.getData().size();
-
-        model->build (sequence.getData(), kmers);
-
-        size_t size = kmers.size();
-
-        for (size_t i=0; i<size; i++)
+        Checksum (u_int64_t& nbKmers, Type& checksum, vector<Type>* kmers) : nbKmers(nbKmers), checksum(checksum), kmers(kmers) {}
+        void operator() (const KmerType& kmer, size_t idx)
         {
-            kmer_type h = theHash(kmers[i]);
-
-            if ((h % nbPass) != pass)  { continue; }
-
-            nbKmers ++;
-            checksumKmers = checksumKmers + h;
+            nbKmers++;  checksum = checksum + kmer.value();
+            if (kmers != 0 && kmers->size() < 1000000)  {  kmers->push_back (kmer.forward());  }
         }
-    }
-
-    FunctorIter1 () : nbSeq(0), dataSeq(0), nbKmers(0), checksumKmers(0), pass(0), nbPass(0), model(0) {}
-
-    vector<kmer_type> kmers;
-
-    u_int64_t nbSeq;
-    u_int64_t dataSeq;
-    u_int64_t nbKmers;
-    kmer_type checksumKmers;
-
-    size_t pass;
-    size_t nbPass;
-    KmerModel* model;
-};
-
-template <typename Functor> void iter1 (
-    IDispatcher& dispatcher,
-    IBank& bank,
-    KmerModel& model,
-    Functor& hash,
-    IteratorListener* progress=0
-)
-{
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    // We need an iterator on the FASTA bank.
-    Iterator<Sequence>* itBank = bank.iterator();
-    LOCAL (itBank);
+        u_int64_t&    nbKmers;
+        Type&         checksum;
+        vector<Type>* kmers;
+    };
 
-    // We declare two kmer iterators for the two banks and a paired one that links them.
-    KmerModel::Iterator itKmer (model);
-
-    // We create an iterator over the paired iterator on sequences
-    SubjectIterator<Sequence> itSeq (itBank, 5*1000);
-
-    if (progress)  {  itSeq.addObserver (progress);  }
-
-    u_int64_t total_nbKmers       = 0;
-    kmer_type total_checksumKmers = 0;
-
-    size_t nbPasses = 10;
-
-    // We get some information about the kmers.
-    u_int64_t nbSeq[nbPasses];
-    u_int64_t dataSeq[nbPasses];
-    u_int64_t nbKmers[nbPasses];
-    kmer_type checksumKmers[nbPasses];
-
-    for (size_t p=0; p<nbPasses; p++)
+    void operator() (IBank& bank, size_t nbPasses)
     {
-        // We get current time stamp
-        ITime::Value t0 = System::time().getTimeStamp();
+        size_t kmerSize = span - 1;
 
-        vector<FunctorIter1> functors (dispatcher.getExecutionUnitsNumber());
+        ModelCanonical model (kmerSize);
 
-        for (size_t i=0; i<functors.size(); i++)
-        {
-            functors[i].pass   = p;
-            functors[i].nbPass = nbPasses;
-            functors[i].model  = &model;
-        }
+        /** We iterate the kmers of the sequences of the bank. */
+        u_int64_t nbKmers  = 0;
+        Type      checksum;  checksum.setVal(0);
 
-        nbSeq[p]         = 0;
-        dataSeq[p]       = 0;
-        nbKmers[p]       = 0;
-        checksumKmers[p] = 0;
+        vector<Type> kmers;
 
-#if 0
-        dispatcher.iterate (itSeq, functors);
-#endif
+        ITime::Value t0 = System::time().getTimeStamp();
 
-        for (size_t i=0; i<functors.size(); i++)
+        for (size_t p=0; p<nbPasses; p++)
         {
-            nbSeq[p]         += functors[i].nbSeq;
-            dataSeq[p]       += functors[i].dataSeq;
-            nbKmers[p]       += functors[i].nbKmers;
-            checksumKmers[p] = checksumKmers[p] + functors[i].checksumKmers;
+            Iterator<Sequence>* itSeq = bank.iterator();  LOCAL (itSeq);
 
-            total_nbKmers       += functors[i].nbKmers;
-            total_checksumKmers = total_checksumKmers + functors[i].checksumKmers;
+            for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+            {
+                model.iterate (itSeq->item().getData(), Checksum (nbKmers, checksum, p==0 ? &kmers : 0));
+            }
         }
 
-        // We get current time stamp
         ITime::Value t1 = System::time().getTimeStamp();
 
-        // We dump some information about the iterated kmers;
-        cout << "FOUND " << nbKmers[p] << " kmers  for " << nbSeq[p] << " sequences  (" << dataSeq[p] << " bytes)  "
-            << "in " << (t1-t0) << " msec (rate " << (double)nbKmers[p] / (double) (t1>t0 ? t1-t0 : 1) << " kmers/msec),  "
-            << "checksum is " << checksumKmers[p]
-            << endl;
-    }
-    cout << endl;
-    cout << "TOTAL KMERS " << total_nbKmers << "  WITH CHECKSUM " << hex << total_checksumKmers << "  WITH " << Integer::getName()  <<  endl;
-
-    for (size_t p=0; p<nbPasses; p++)
-    {
-        cout << "   [" << p << "]  " << 100.0 * (double)nbKmers[p] / (double) total_nbKmers << endl;
-    }
-}
-
-/********************************************************************************/
-
-template <typename Functor> void iter2 (IBank& bank, KmerModel& model, Functor& hash, IteratorListener* progress=0)
-{
-#if 1
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    BankKmerIterator itKmerBank (bank, model);
-
-    // We get some information about the kmers.
-    u_int64_t nbKmers       = 0;
-    kmer_type checksumKmers = 0;
+        /** We compute the revcomp of the kmers, and compare them to their revcomp. */
+        u_int64_t nbForward = 0;
+        Type      checksumRevcomp;  checksumRevcomp.setVal(0);
 
-    // We get current time stamp
-    ITime::Value t0 = System::time().getTimeStamp();
-
-    if (progress)  {  itKmerBank.addObserver (progress);  }
-
-    for (itKmerBank.first(); !itKmerBank.isDone();  itKmerBank.next())
-    {
-        nbKmers      += 1;
-        checksumKmers = checksumKmers + hash (*itKmerBank);
-    }
-
-    // We get current time stamp
-    ITime::Value t1 = System::time().getTimeStamp();
-
-    // We dump some information about the iterated kmers;
-    cout << "FOUND " << nbKmers << " kmers "
-         << "in " << (t1-t0) << " msec (rate " << (double)nbKmers / (double) (t1-t0) << " kmers/msec),  "
-         << "checksum is " << checksumKmers
-         << endl;
-#endif
-}
-
-/********************************************************************************/
-
-struct FunctorIter3
-{
-    void operator() (std::vector<kmer_type>& kmers)
-    {
-        Hash hash;
-
-        size_t size = kmers.size();
-
-        for (size_t i=0; i<size; i++)
+        for (size_t p=0; p<nbPasses; p++)
         {
-            nbKmers ++;
-            checksumKmers = checksumKmers + hash (kmers[i]);
+            for (size_t i=0; i<kmers.size(); i++)
+            {
+                Type rc = revcomp (kmers[i], kmerSize);
+                if (kmers[i] < rc)  {  nbForward++;  }
+                checksumRevcomp = checksumRevcomp + rc;
+            }
         }
-    }
-
-    u_int64_t nbKmers;
-    kmer_type checksumKmers;
-};
-
-template <typename Functor> void iter3 (IBank& bank, KmerModel& model, Functor& hash, IteratorListener* progress=0)
-{
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    BankVectorKmerIterator<kmer_type> itKmerBank (bank, model);
-
-    // We get some information about the kmers.
-    u_int64_t nbKmers       = 0;
-    kmer_type checksumKmers = 0;
-
-    // We get current time stamp
-    ITime::Value t0 = System::time().getTimeStamp();
 
-    if (progress)  {  itKmerBank.addObserver (progress);  }
+        ITime::Value t2 = System::time().getTimeStamp();
 
-    ParallelCommandDispatcher dispatcher (8);
-
-    vector<FunctorIter3> functors (dispatcher.getExecutionUnitsNumber());
-
-#if 0
-    dispatcher.iterate (itKmerBank, functors, 1);
-#endif
-
-    for (size_t i=0; i<functors.size(); i++)
-    {
-        nbKmers       += functors[i].nbKmers;
-        checksumKmers = checksumKmers + functors[i].checksumKmers;
+        cout << "SPAN " << span << "  " << Type::getName() << "  k=" << kmerSize << endl;
+        cout << "   iterate : " << nbKmers << " kmers in " << (t1-t0) << " msec (rate "
+             << (double)nbKmers / (double) (t1>t0 ? t1-t0 : 1) << " kmers/msec),  checksum is " << checksum << endl;
+        cout << "   revcomp : " << nbPasses*kmers.size() << " kmers in " << (t2-t1) << " msec (rate "
+             << (double)(nbPasses*kmers.size()) / (double) (t2>t1 ? t2-t1 : 1) << " kmers/msec),  checksum is "
+             << checksumRevcomp << " (" << nbForward << " forward)" << endl;
     }
-
-    // We get current time stamp
-    ITime::Value t1 = System::time().getTimeStamp();
-
-    // We dump some information about the iterated kmers;
-    cout << "FOUND " << nbKmers << " kmers "
-         << "in " << (t1-t0) << " msec (rate " << (double)nbKmers / (double) (t1-t0) << " kmers/msec),  "
-         << "checksum is " << checksumKmers
-         << endl;
-}
+};
 
 /********************************************************************************/
 
 int main (int argc, char* argv[])
 {
-    if (argc < 3)
+    if (argc < 2)
     {
-        cerr << "you must provide at least 2 arguments. Arguments are:" << endl;
-        cerr << "   1) kmer size"  << endl;
-        cerr << "   2) FASTA  bank" << endl;
-        cerr << "   3) binary bank" << endl;
+        cerr << "you must provide at least 1 argument. Arguments are:" << endl;
+        cerr << "   1) FASTA  bank" << endl;
+        cerr << "   2) number of passes (default 10)" << endl;
         return EXIT_FAILURE;
     }
 
-    // We define the max size of a data line in the FASTA output file
-    size_t kmerSize = atoi(argv[1]);
-
     // We get the URI of the FASTA bank
-    string filename (argv[2]);
-    string filenameBin = argc <=3 ? (filename + ".bin") : argv[3];
+    string filename (argv[1]);
+    size_t nbPasses = argc >= 3 ? atoi(argv[2]) : 10;
 
-#if 1
     // We define a try/catch block in case some method fails (bad filename for instance)
     try
     {
-        ParallelCommandDispatcher dispatcher (8);
-
-        // We declare a kmer model with a given span size.
-        KmerModel model (kmerSize);
-
-        // We declare the FASTA bank
-        BankFasta bank (filename);
+        IBank* bank = Bank::open (filename);  LOCAL (bank);
 
-        // We declare a binary bank
-        BankBinary bankBin (filenameBin);
-
-        if (System::file().doesExist(filenameBin) == false)
-        {
-            // We declare some job listener.
-            Progress progress (bank.estimateNbSequences(), "FASTA to binary conversion");
-
-            // We convert the FASTA bank in binary format
-            IProperties* props = BankHelper::singleton().convert (bank, bankBin, &progress);
-            LOCAL (props);
-        }
-
-        //HashNull hash;
-        Hash hash;
-
-        // TEST 1
-        iter1 (dispatcher, bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 1"));
-
-        // TEST 2
-        //iter2 (bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 2"));
-
-        // TEST 3
-        //iter3 (bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 3"));
-
-        // We remove the binary bank
-        //System::file().remove (filename + ".bin");
+        /** We bench the spans of the precisions 1 to 4 of LargeInt. */
+        FunctorBench<32>  () (*bank, nbPasses);
+        FunctorBench<64>  () (*bank, nbPasses);
+        FunctorBench<96>  () (*bank, nbPasses);
+        FunctorBench<128> () (*bank, nbPasses);
     }
 
     catch (gatb::core::system::Exception& e)
     {
         cerr << "EXCEPTION: " << e.getMessage() << endl;
     }
-#endif
+
     return EXIT_SUCCESS;
 }
@@ -24,12 +24,15 @@
 
 #include <gatb/bank/impl/Bank.hpp>
 #include <gatb/bank/impl/BankHelpers.hpp>
+#include <gatb/bank/impl/GzipReader.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
 #include <list>
+#include <map>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 
@@ -82,7 +85,14 @@ class TestBank : public Test
         CPPUNIT_TEST_GATB (bank_album2);
         CPPUNIT_TEST_GATB (bank_album3);
         CPPUNIT_TEST_GATB (bank_iteration);
-        //        CPPUNIT_TEST_GATB (bank_datalinesize); // disabled since we're printing fasta in one line now (see "#if 1" in BankFasta)
+        CPPUNIT_TEST_GATB (bank_ranges);
+        CPPUNIT_TEST_GATB (bank_mapped);
+        CPPUNIT_TEST_GATB (bank_mappedRanges);
+        CPPUNIT_TEST_GATB (bank_gzipThreads);
+        CPPUNIT_TEST_GATB (bank_gzipWriter);
+        CPPUNIT_TEST_GATB (bank_binaryIndexed);
+        CPPUNIT_TEST_GATB (bank_iterators);
+        //        CPPUNIT_TEST_GATB (bank_datalinesize); // disabled since we're printing fasta in one line now (see BankFasta::insert)
         CPPUNIT_TEST_GATB (bank_registery_types);
         CPPUNIT_TEST_GATB (bank_checkPower2);
 
@@ -987,6 +997,681 @@ public:
         CPPUNIT_ASSERT (count == 100);
     }
 
+    /********************************************************************************/
+    void bank_ranges_aux (const string& filename, size_t nbRanges)
+    {
+        BankFasta bank (filename);
+
+        /** We get the reference sequences through a single iterator. */
+        vector<string> ref;
+        Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  {  ref.push_back (it->item().getComment() + it->item().toString() + it->item().getQuality());  }
+
+        /** We check that the concatenation of the ranges gives the same sequences. */
+        vector<Iterator<Sequence>*> itRanges = bank.iterators (nbRanges);
+        CPPUNIT_ASSERT (itRanges.size() == nbRanges);
+
+        size_t idx = 0;
+        for (size_t r=0; r<itRanges.size(); r++)
+        {
+            Iterator<Sequence>* itRange = itRanges[r];  LOCAL (itRange);
+            for (itRange->first(); !itRange->isDone(); itRange->next(), idx++)
+            {
+                CPPUNIT_ASSERT (idx < ref.size());
+                CPPUNIT_ASSERT (ref[idx] == itRange->item().getComment() + itRange->item().toString() + itRange->item().getQuality());
+            }
+        }
+        CPPUNIT_ASSERT (idx == ref.size());
+    }
+
+    /** */
+    void bank_ranges ()
+    {
+        string filenames[] = {
+            System::file().getTemporaryDirectory() + "/ranges.fa",
+            System::file().getTemporaryDirectory() + "/ranges.fq"
+        };
+
+        srand (0);
+        const char* nt = "ACGT";
+
+        for (size_t f=0; f<ARRAY_SIZE(filenames); f++)
+        {
+            bool fastq = f==1;
+
+            /** We create a bank big enough to be split; for FASTQ, some qualities begin with '@'. */
+            FILE* file = fopen (filenames[f].c_str(), "w");
+            CPPUNIT_ASSERT (file != 0);
+            for (size_t i=0; i<40*1000; i++)
+            {
+                string data, qual;
+                size_t len = 50 + rand() % 100;
+                for (size_t j=0; j<len; j++)  {  data += nt[rand()%4];  qual += (j==0 && i%2==0) ? '@' : 'I';  }
+
+                if (fastq)  {  fprintf (file, "@seq%ld\n%s\n+\n%s\n", i, data.c_str(), qual.c_str());  }
+                else        {  fprintf (file, ">seq%ld\n%s\n%s\n", i, data.substr(0,len/2).c_str(), data.substr(len/2).c_str());  }
+            }
+            fclose (file);
+
+            size_t nbRangesTable[] = { 1, 2, 3, 4 };
+            for (size_t i=0; i<ARRAY_SIZE(nbRangesTable); i++)  {  bank_ranges_aux (filenames[f], nbRangesTable[i]);  }
+
+            System::file().remove (filenames[f]);
+        }
+
+        /** A gzipped bank can't be split. */
+        BankFasta bankgz (DBPATH("reads1.fa.gz"));
+        vector<Iterator<Sequence>*> itRanges = bankgz.iterators (4);
+        CPPUNIT_ASSERT (itRanges.size() == 1);
+        delete itRanges[0];
+    }
+
+    /********************************************************************************/
+    /** Write the content into a plain file, and into a gzipped one if a name is given. */
+    void writeFile (const string& filename, const string& content, const string& filenamegz="")
+    {
+        FILE* file = fopen (filename.c_str(), "w");
+        CPPUNIT_ASSERT (file != 0);
+        fwrite (content.data(), 1, content.size(), file);
+        fclose (file);
+
+        if (filenamegz.empty())  { return; }
+
+        gzFile filegz = gzopen (filenamegz.c_str(), "w");
+        CPPUNIT_ASSERT (filegz != 0);
+        gzwrite (filegz, content.data(), content.size());
+        gzclose (filegz);
+    }
+
+    /** Read the whole content of a file. */
+    string readFile (const string& filename)
+    {
+        string content;
+        FILE* file = fopen (filename.c_str(), "rb");
+        CPPUNIT_ASSERT (file != 0);
+        char buffer[64*1024];
+        for (size_t nb=0; (nb = fread (buffer, 1, sizeof(buffer), file)) > 0; )  {  content.append (buffer, nb);  }
+        fclose (file);
+        return content;
+    }
+
+    /** Build a FASTA and a FASTQ content holding the same random sequences 'seq0', 'seq1'... of 50 to 449 nt. */
+    void randomBank (size_t nbSequences, string& contentfa, string& contentfq)
+    {
+        const char* nt = "ACGT";
+
+        for (size_t i=0; i<nbSequences; i++)
+        {
+            string data, quality;
+            size_t len = 50 + rand() % 400;
+            for (size_t j=0; j<len; j++)  {  data += nt[rand()%4];  quality += (char)('!' + rand()%40);  }
+
+            char header[64];
+            snprintf (header, sizeof(header), "seq%ld", i);
+
+            contentfa += ">" + string(header) + "\n" + data + "\n";
+            contentfq += "@" + string(header) + "\n" + data + "\n+\n" + quality + "\n";
+        }
+    }
+
+    /********************************************************************************/
+    void bank_mapped ()
+    {
+        string filename   = System::file().getTemporaryDirectory() + "/mapped.fa";
+        string filenamegz = filename + ".gz";
+
+        srand (0);
+        const char* nt = "ACGTN";
+
+        /** We create a plain bank (memory mapped when read) and the same bank gzipped (read
+         * through zlib), with sequences on one or several lines, CRLF ends of lines, empty
+         * lines, a FASTQ part and no end of line at the end of the file. */
+        string content;
+        for (size_t i=0; i<3000; i++)
+        {
+            string data, qual;
+            size_t len = 1 + rand() % 300;
+            for (size_t j=0; j<len; j++)  {  data += nt[rand()%5];  qual += (j==0 && i%2==0) ? '@' : 'I';  }
+
+            const char* eol   = (i%3==0) ? "\r\n" : "\n";
+            size_t      width = (i%4==0) ? 60 : len;
+
+            char header[64];
+            snprintf (header, sizeof(header), "seq%ld comment", i);
+
+            if (i%5==0)
+            {
+                content += string("@") + header + eol + data + eol + "+" + eol + qual + eol;
+            }
+            else
+            {
+                content += string(">") + header + eol;
+                for (size_t j=0; j<len; j+=width)  {  content += data.substr (j, width) + eol;  }
+                if (i%7==0)  { content += eol; }
+            }
+        }
+        content += ">last\nACGT";
+
+        writeFile (filename, content, filenamegz);
+
+        {
+            BankFasta bank (filename);
+            BankFasta bankgz (filenamegz);
+
+            Iterator<Sequence>* it   = bank.iterator();    LOCAL (it);
+            Iterator<Sequence>* itgz = bankgz.iterator();  LOCAL (itgz);
+
+            size_t nb = 0;
+            for (it->first(), itgz->first(); !it->isDone() && !itgz->isDone(); it->next(), itgz->next(), nb++)
+            {
+                CPPUNIT_ASSERT (it->item().getComment() == itgz->item().getComment());
+                CPPUNIT_ASSERT (it->item().toString()   == itgz->item().toString());
+                CPPUNIT_ASSERT (it->item().getQuality() == itgz->item().getQuality());
+            }
+            CPPUNIT_ASSERT (it->isDone() && itgz->isDone());
+            CPPUNIT_ASSERT (nb == 3001);
+        }
+
+        /** The changes done by a client in the data of a sequence referring to the mapped bytes
+         * must not show up in the next iterations. */
+        {
+            BankFasta bank (filename);
+            Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+
+            it->first();
+            string check = it->item().toString();
+            CPPUNIT_ASSERT (check.size() > 0);
+
+            for (it->first(); !it->isDone(); it->next())  {  memset (it->item().getDataBuffer(), 'X', it->item().getDataSize());  }
+
+            it->first();
+            CPPUNIT_ASSERT (it->item().toString() == check);
+        }
+
+        System::file().remove (filename);
+        System::file().remove (filenamegz);
+    }
+
+    /********************************************************************************/
+    void bank_mappedRanges ()
+    {
+        string filename = System::file().getTemporaryDirectory() + "/mappedRanges.fa";
+
+        srand (0);
+        const char* nt = "ACGT";
+
+        /** Sequences on one or several lines, so that both the in place and the copied ones
+         * may cross the end of the mapped window of a byte range. */
+        string content;
+        for (size_t i=0; i<2000; i++)
+        {
+            string data;
+            size_t len = 1 + rand() % 1000;
+            for (size_t j=0; j<len; j++)  {  data += nt[rand()%4];  }
+
+            size_t width = (i%2==0) ? 60 : len;
+
+            char header[64];
+            snprintf (header, sizeof(header), ">seq%ld\n", i);
+            content += header;
+            for (size_t j=0; j<len; j+=width)  {  content += data.substr (j, width) + "\n";  }
+        }
+
+        writeFile (filename, content);
+
+        BankFasta bank (filename);
+
+        vector<string> ref;
+        Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  {  ref.push_back (it->item().getComment() + it->item().toString());  }
+        CPPUNIT_ASSERT (ref.size() == 2000);
+
+        /** A byte range ending in the middle of a record still gives the whole record, whose end is
+         * beyond the mapped window; a range starting in the middle of a record skips it. */
+        u_int64_t cuts[] = { 0, 4095, 4096, 4097, 10000, content.size()/3, content.size()/2 + 1, content.size() - 10, content.size() };
+
+        size_t idx = 0;
+        for (size_t c=0; c+1<ARRAY_SIZE(cuts); c++)
+        {
+            BankFasta::Iterator itRange (bank, cuts[c], cuts[c+1]);
+
+            /** Iterated twice, since the mapped window is mapped again at each rewind. */
+            for (size_t n=0; n<2; n++)
+            {
+                size_t nb = 0;
+                for (itRange.first(); !itRange.isDone(); itRange.next(), nb++)
+                {
+                    CPPUNIT_ASSERT (idx+nb < ref.size());
+                    CPPUNIT_ASSERT (ref[idx+nb] == itRange.item().getComment() + itRange.item().toString());
+                }
+                if (n==1)  { idx += nb; }
+            }
+        }
+        CPPUNIT_ASSERT (idx == ref.size());
+
+        System::file().remove (filename);
+    }
+
+    /********************************************************************************/
+    /** Write the data as a BGZF file, ie. independent gzip members of at most 64 KB with a 'BC' extra subfield. */
+    void writeBgzf (const string& filename, const string& content)
+    {
+        FILE* file = fopen (filename.c_str(), "wb");
+        CPPUNIT_ASSERT (file != 0);
+
+        /** The last block is the empty BGZF end of file block. */
+        for (size_t offset=0; offset <= content.size(); offset += 65280)
+        {
+            size_t len = std::min ((size_t)65280, content.size() - offset);
+
+            unsigned char cdata[70000];
+            z_stream zs;
+            memset (&zs, 0, sizeof(zs));
+            CPPUNIT_ASSERT (deflateInit2 (&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+            zs.next_in   = (Bytef*) content.data() + offset;
+            zs.avail_in  = len;
+            zs.next_out  = cdata;
+            zs.avail_out = sizeof(cdata);
+            CPPUNIT_ASSERT (deflate (&zs, Z_FINISH) == Z_STREAM_END);
+            size_t clen = zs.total_out;
+            deflateEnd (&zs);
+
+            u_int32_t crc   = crc32 (0, (const Bytef*) content.data() + offset, len);
+            u_int32_t bsize = 18 + clen + 8 - 1;
+
+            unsigned char header[18] = { 0x1f, 0x8b, 8, 4, 0,0,0,0, 0, 0xff, 6,0, 66,67, 2,0, (unsigned char)(bsize & 0xff), (unsigned char)(bsize >> 8) };
+            unsigned char trailer[8] = {
+                (unsigned char)crc, (unsigned char)(crc>>8), (unsigned char)(crc>>16), (unsigned char)(crc>>24),
+                (unsigned char)len, (unsigned char)(len>>8), (unsigned char)(len>>16), (unsigned char)(len>>24)
+            };
+
+            fwrite (header,  1, sizeof(header),  file);
+            fwrite (cdata,   1, clen,            file);
+            fwrite (trailer, 1, sizeof(trailer), file);
+
+            if (len == 0)  { break; }
+        }
+
+        fclose (file);
+    }
+
+    /********************************************************************************/
+    void bank_gzipThreads ()
+    {
+        string filename     = System::file().getTemporaryDirectory() + "/gzthreads.fa";
+        string filenamegz   = filename + ".gz";
+        string filenamebgzf = filename + ".bgz";
+
+        srand (0);
+
+        /** The bank is large enough for several BGZF batches and several gzip chunks. */
+        string content, contentfq;
+        randomBank (40000, content, contentfq);
+
+        writeFile (filename, content, filenamegz);
+        writeBgzf (filenamebgzf, content);
+
+        CPPUNIT_ASSERT (GzipReader::isBGZF (filenamegz)   == false);
+        CPPUNIT_ASSERT (GzipReader::isBGZF (filenamebgzf) == true);
+
+        size_t nbThreads[] = { 0, 1, 4 };
+        string filenames[] = { filenamegz, filenamebgzf };
+
+        for (size_t t=0; t<ARRAY_SIZE(nbThreads); t++)
+        {
+            for (size_t f=0; f<ARRAY_SIZE(filenames); f++)
+            {
+                BankFasta bank (filename);
+                BankFasta bankgz (filenames[f]);
+                bankgz.setNbDecompressThreads (nbThreads[t]);
+
+                Iterator<Sequence>* it   = bank.iterator();    LOCAL (it);
+                Iterator<Sequence>* itgz = bankgz.iterator();  LOCAL (itgz);
+
+                /** We iterate twice in order to check the rewind of the compressed file. */
+                for (size_t loop=0; loop<2; loop++)
+                {
+                    size_t nb = 0;
+                    for (it->first(), itgz->first(); !it->isDone() && !itgz->isDone(); it->next(), itgz->next(), nb++)
+                    {
+                        CPPUNIT_ASSERT (it->item().getComment() == itgz->item().getComment());
+                        CPPUNIT_ASSERT (it->item().toString()   == itgz->item().toString());
+                    }
+                    CPPUNIT_ASSERT (it->isDone() && itgz->isDone());
+                    CPPUNIT_ASSERT (nb == 40000);
+                }
+            }
+        }
+
+        /** The number of threads is set per bank, for each file of an album; a negative number is rejected. */
+        BankFasta bank1 (filenamegz);
+        BankFasta bank2 (filenamebgzf);
+        CPPUNIT_ASSERT (bank2.getNbDecompressThreads() == 0);
+
+        IBank* album = Bank::open (filenamegz + "," + filenamebgzf);
+        LOCAL (album);
+        Bank::setNbDecompressThreads (album, 4);
+        Bank::setNbDecompressThreads (&bank2, 4);
+
+        BankComposite* composite = dynamic_cast<BankComposite*> (album);
+        CPPUNIT_ASSERT (composite != 0  &&  composite->getBanks().size() == 2);
+        for (size_t i=0; i<composite->getBanks().size(); i++)
+        {
+            CPPUNIT_ASSERT (dynamic_cast<BankFasta*>(composite->getBanks()[i])->getNbDecompressThreads() == 4);
+        }
+        CPPUNIT_ASSERT (bank1.getNbDecompressThreads() == 0);
+        CPPUNIT_ASSERT (bank2.getNbDecompressThreads() == 4);
+
+        CPPUNIT_ASSERT_THROW (Bank::setNbDecompressThreads (&bank2, -1), gatb::core::system::Exception);
+        CPPUNIT_ASSERT (bank2.getNbDecompressThreads() == 4);
+
+        System::file().remove (filename);
+        System::file().remove (filenamegz);
+        System::file().remove (filenamebgzf);
+    }
+
+    /********************************************************************************/
+    /** Functor inserting the iterated sequences into a bank. */
+    struct InsertFunctor
+    {
+        IBank& bank;
+        InsertFunctor (IBank& bank) : bank(bank) {}
+        void operator() (Sequence& seq)  {  bank.insert (seq);  }
+    };
+
+    /********************************************************************************/
+    void bank_gzipWriter_aux (const string& filename, bool fastq)
+    {
+        string filenamegz = filename + ".out.gz";
+
+        BankFasta bank (filename);
+
+        size_t nbThreads[] = { 0, 1, 4 };
+
+        for (size_t bgzf=0; bgzf<2; bgzf++)
+        {
+            string reference;
+
+            for (size_t t=0; t<ARRAY_SIZE(nbThreads); t++)
+            {
+                {
+                    BankFasta bankgz (filenamegz, fastq, true);
+                    bankgz.setNbCompressThreads (nbThreads[t]);
+                    bankgz.setOutputBGZF (bgzf==1);
+                    Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+                    for (it->first(); !it->isDone(); it->next())  {  bankgz.insert (it->item());  }
+                    bankgz.flush ();
+                }
+
+                CPPUNIT_ASSERT (GzipReader::isBGZF (filenamegz) == (bgzf==1));
+
+                /** The compressed file doesn't depend on the number of threads. */
+                string content = readFile (filenamegz);
+                if (t==0)  { reference = content; }
+                CPPUNIT_ASSERT (content == reference);
+
+                BankFasta bankgz (filenamegz);
+                Iterator<Sequence>* it   = bank.iterator();    LOCAL (it);
+                Iterator<Sequence>* itgz = bankgz.iterator();  LOCAL (itgz);
+
+                size_t nb = 0;
+                for (it->first(), itgz->first(); !it->isDone() && !itgz->isDone(); it->next(), itgz->next(), nb++)
+                {
+                    CPPUNIT_ASSERT (it->item().getComment() == itgz->item().getComment());
+                    CPPUNIT_ASSERT (it->item().toString()   == itgz->item().toString());
+                    CPPUNIT_ASSERT (it->item().getQuality() == itgz->item().getQuality());
+                }
+                CPPUNIT_ASSERT (it->isDone() && itgz->isDone());
+                CPPUNIT_ASSERT (nb == 40000);
+            }
+        }
+
+        /** Several threads insert sequences into the same bank; the records must stay whole. */
+        {
+            BankFasta bankgz (filenamegz, fastq, true);
+            bankgz.setNbCompressThreads (2);
+            Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+            Dispatcher(4).iterate (it, InsertFunctor (bankgz), 100);
+        }
+
+        map<string,string> sequences;
+        Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  {  sequences[it->item().getComment()] = it->item().toString();  }
+
+        BankFasta bankgz (filenamegz);
+        Iterator<Sequence>* itgz = bankgz.iterator();  LOCAL (itgz);
+
+        size_t nb = 0;
+        for (itgz->first(); !itgz->isDone(); itgz->next(), nb++)
+        {
+            CPPUNIT_ASSERT (sequences[itgz->item().getComment()] == itgz->item().toString());
+        }
+        CPPUNIT_ASSERT (nb == 40000);
+
+        System::file().remove (filenamegz);
+    }
+
+    /********************************************************************************/
+    void bank_gzipWriter ()
+    {
+        string filenamefa = System::file().getTemporaryDirectory() + "/gzwriter.fa";
+        string filenamefq = System::file().getTemporaryDirectory() + "/gzwriter.fq";
+
+        srand (0);
+
+        /** The banks are large enough for several chunks of the writer. */
+        string contentfa, contentfq;
+        randomBank (40000, contentfa, contentfq);
+
+        writeFile (filenamefa, contentfa);
+        writeFile (filenamefq, contentfq);
+
+        bank_gzipWriter_aux (filenamefa, false);
+        bank_gzipWriter_aux (filenamefq, true);
+
+        System::file().remove (filenamefa);
+        System::file().remove (filenamefq);
+    }
+
+    /********************************************************************************/
+    void bank_binaryIndexed_aux (const string& filename)
+    {
+        string filenameBin = System::file().getTemporaryDirectory() + "/" + System::file().getBaseName (filename) + ".bin2";
+
+        /** We convert the bank with small blocks, so we have many of them. */
+        IBank* bank = Bank::open (filename);  LOCAL (bank);
+        {
+            BankBinaryIndexed bankBin (filenameBin, BankBinaryIndexed::WITH_COMMENTS | BankBinaryIndexed::WITH_QUALITIES, 500);
+            Iterator<Sequence>* it = bank->iterator();  LOCAL (it);
+            for (it->first(); !it->isDone(); it->next())  {  bankBin.insert (it->item());  }
+            bankBin.flush ();
+        }
+
+        /** The binary bank is recognized by Bank::open. */
+        IBank* bankBin = Bank::open (filenameBin);  LOCAL (bankBin);
+        CPPUNIT_ASSERT (dynamic_cast<BankBinaryIndexed*> (bankBin) != 0);
+        BankBinaryIndexed& ref = *dynamic_cast<BankBinaryIndexed*> (bankBin);
+        CPPUNIT_ASSERT (ref.getNbBlocks() > 1);
+
+        /** We check the sequences, the N excepted (other letters than ACGT are read as N). */
+        vector<string> comments, data, qualities;
+        u_int64_t totalSize = 0;
+
+        Iterator<Sequence>* it = bank->iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())
+        {
+            string s = it->item().toString();
+            for (size_t i=0; i<s.size(); i++)  {  s[i] = toupper (s[i]);  if (strchr ("ACGT", s[i]) == 0)  { s[i] = 'N'; }  }
+
+            comments.push_back  (it->item().getComment());
+            data.push_back      (s);
+            qualities.push_back (it->item().getQuality());
+            totalSize += s.size();
+        }
+
+        u_int64_t number, size, maxSize;
+        bankBin->estimate (number, size, maxSize);
+        CPPUNIT_ASSERT (number == data.size());
+        CPPUNIT_ASSERT (size   == totalSize);
+        CPPUNIT_ASSERT (bankBin->getNbItems() == (int64_t)data.size());
+
+        /** The block ranges cover the bank in order. */
+        vector<Iterator<Sequence>*> itRanges = ref.iterators (4);
+        CPPUNIT_ASSERT (itRanges.size() == std::min ((size_t)4, ref.getNbBlocks()));
+
+        size_t nb = 0;
+        for (size_t r=0; r<itRanges.size(); r++)
+        {
+            Iterator<Sequence>* itRange = itRanges[r];  LOCAL (itRange);
+            for (itRange->first(); !itRange->isDone(); itRange->next(), nb++)
+            {
+                Sequence& seq = itRange->item();
+                CPPUNIT_ASSERT (seq.getIndex()   == nb);
+                CPPUNIT_ASSERT (seq.getComment() == comments[nb]);
+                CPPUNIT_ASSERT (seq.toString()   == data[nb]);
+                CPPUNIT_ASSERT (seq.getQuality() == qualities[nb]);
+            }
+        }
+        CPPUNIT_ASSERT (nb == data.size());
+
+        /** We reach sequences by their index. */
+        BankBinaryIndexed::Iterator itJump (ref);
+        srand (0);
+        for (size_t i=0; i<100; i++)
+        {
+            size_t idx = rand() % data.size();
+            CPPUNIT_ASSERT (itJump.jump (idx) == true);
+            CPPUNIT_ASSERT (itJump.item().getComment() == comments[idx]);
+            CPPUNIT_ASSERT (itJump.item().toString()   == data[idx]);
+        }
+        CPPUNIT_ASSERT (itJump.jump (data.size()) == false);
+
+        /** A jump beyond the block range of an iterator doesn't change this range. */
+        BankBinaryIndexed::Iterator itFirst (ref, 0, 1);
+        size_t nbFirst = 0;
+        for (itFirst.first(); !itFirst.isDone(); itFirst.next())  { nbFirst++; }
+        CPPUNIT_ASSERT (itFirst.jump (data.size()-1) == true);
+        CPPUNIT_ASSERT (itFirst.item().toString() == data.back());
+        size_t nbAgain = 0;
+        for (itFirst.first(); !itFirst.isDone(); itFirst.next())  { nbAgain++; }
+        CPPUNIT_ASSERT (nbAgain == nbFirst);
+
+        bankBin->remove ();
+    }
+
+    /** \brief Check the conversion of banks into indexed binary banks. */
+    void bank_binaryIndexed ()
+    {
+        bank_binaryIndexed_aux (DBPATH("reads1.fa"));
+        bank_binaryIndexed_aux (DBPATH("leon1.fastq"));
+        bank_binaryIndexed_aux (DBPATH("NIST7035_TAAGGCGA_L001_R1_001_5OK.fastq.gz"));
+
+        /** A bank without sequences is still written. */
+        string filenameBin = System::file().getTemporaryDirectory() + "/empty.bin2";
+        System::file().remove (filenameBin);
+        {
+            BankBinaryIndexed bankBin (filenameBin);
+            bankBin.flush ();
+        }
+        IBank* bankBin = Bank::open (filenameBin);  LOCAL (bankBin);
+        CPPUNIT_ASSERT (dynamic_cast<BankBinaryIndexed*> (bankBin) != 0);
+        CPPUNIT_ASSERT (bankBin->getNbItems() == 0);
+        Iterator<Sequence>* it = bankBin->iterator();  LOCAL (it);
+        it->first();
+        CPPUNIT_ASSERT (it->isDone());
+        bankBin->remove ();
+    }
+
+    /********************************************************************************/
+    struct CountFunctor
+    {
+        u_int64_t* nbSeq;  u_int64_t* nbNucl;
+        CountFunctor (u_int64_t* nbSeq, u_int64_t* nbNucl) : nbSeq(nbSeq), nbNucl(nbNucl) {}
+        void operator() (Sequence& seq)
+        {
+            __sync_fetch_and_add (nbSeq,  1);
+            __sync_fetch_and_add (nbNucl, seq.getDataSize());
+        }
+    };
+
+    void bank_iterators_aux (IBank& bank, size_t nbIterators)
+    {
+        /** We get the reference sequences through a single iterator. */
+        vector<string> ref;
+        u_int64_t refNucl = 0;
+        Iterator<Sequence>* it = bank.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())
+        {
+            size_t len = it->item().getDataEncoding()==Data::BINARY ? (it->item().getDataSize()+3)/4 : it->item().getDataSize();
+            ref.push_back (string (it->item().getDataBuffer(), len));
+            refNucl += it->item().getDataSize();
+        }
+
+        /** We check that the concatenation of the iterators gives the same sequences. */
+        vector<Iterator<Sequence>*> its = bank.iterators (nbIterators);
+        CPPUNIT_ASSERT (its.size() >= 1 && its.size() <= nbIterators);
+
+        size_t idx = 0;
+        for (size_t r=0; r<its.size(); r++)
+        {
+            Iterator<Sequence>* itPart = its[r];  LOCAL (itPart);
+            for (itPart->first(); !itPart->isDone(); itPart->next(), idx++)
+            {
+                size_t len = itPart->item().getDataEncoding()==Data::BINARY ? (itPart->item().getDataSize()+3)/4 : itPart->item().getDataSize();
+                CPPUNIT_ASSERT (idx < ref.size());
+                CPPUNIT_ASSERT (ref[idx] == string (itPart->item().getDataBuffer(), len));
+            }
+        }
+        CPPUNIT_ASSERT (idx == ref.size());
+
+        /** We iterate the iterators in parallel, one thread each. */
+        u_int64_t nbSeq = 0, nbNucl = 0;
+        Dispatcher(nbIterators).iterate (bank.iterators (nbIterators), CountFunctor (&nbSeq, &nbNucl));
+        CPPUNIT_ASSERT (nbSeq  == ref.size());
+        CPPUNIT_ASSERT (nbNucl == refNucl);
+    }
+
+    /** \brief Check the split of several kinds of banks into iterators used concurrently. */
+    void bank_iterators ()
+    {
+        size_t nbIteratorsTable[] = { 1, 2, 3, 8 };
+
+        /** Strings bank. */
+        vector<string> table;
+        for (size_t i=0; i<100; i++)  {  table.push_back (string (1 + i%17, "ACGT"[i%4]));  }
+        BankStrings bankStrings (table);
+
+        /** Album made of several banks. */
+        string albumUri = System::file().getTemporaryDirectory() + "/test_album_iterators.txt";
+        System::file().remove (albumUri);
+        BankAlbum album (albumUri);
+        album.addBank (System::file().getRealPath(DBPATH("reads1.fa")));
+        album.addBank (System::file().getRealPath(DBPATH("reads2.fa")));
+        album.addBank (System::file().getRealPath(DBPATH("reads1.fa.gz")));
+
+        /** Binary bank with several blocks. */
+        string filenameBin = System::file().getTemporaryDirectory() + "/test_iterators.bin";
+        BankBinary::setBufferSize (10000);
+        BankBinary bankBin (filenameBin);
+        BankBinary::setBufferSize (100000);
+        {
+            BankFasta bankFasta (DBPATH("reads2.fa"));
+            Iterator<Sequence>* itFasta = bankFasta.iterator();  LOCAL (itFasta);
+            for (itFasta->first(); !itFasta->isDone(); itFasta->next())  {  bankBin.insert (itFasta->item());  }
+            bankBin.flush();
+        }
+
+        for (size_t i=0; i<ARRAY_SIZE(nbIteratorsTable); i++)
+        {
+            bank_iterators_aux (bankStrings, nbIteratorsTable[i]);
+            bank_iterators_aux (album,       nbIteratorsTable[i]);
+            bank_iterators_aux (bankBin,     nbIteratorsTable[i]);
+        }
+
+        bankBin.remove();
+        System::file().remove (albumUri);
+    }
+
     /********************************************************************************/
     void bank_datalinesize_aux (const char* sequence, size_t dataLineSize)
     {
@@ -43,8 +43,10 @@
 #include <gatb/bank/impl/BankRandom.hpp>
 
 #include <gatb/tools/storage/impl/Storage.hpp>
+#include <gatb/tools/storage/impl/StorageTools.hpp>
 
 #include <iostream>
+#include <climits>
 #include <memory>
 
 using namespace std;
@@ -103,10 +105,15 @@ class TestDebruijn : public Test
         CPPUNIT_TEST_GATB (debruijn_test13);
 //        CPPUNIT_TEST_GATB (debruijn_mutation); // has been removed due to it crashing clang, and since mutate() isn't really used in apps, i didn't bother.
         CPPUNIT_TEST_GATB (debruijn_build);
+        CPPUNIT_TEST_GATB (debruijn_bloomBlocked);
+        CPPUNIT_TEST_GATB (debruijn_mmap);
+        CPPUNIT_TEST_GATB (debruijn_cuckoo);
+        CPPUNIT_TEST_GATB (debruijn_bloomCounting);
         CPPUNIT_TEST_GATB (debruijn_checkbranching);
         CPPUNIT_TEST_GATB (debruijn_mphf);
         CPPUNIT_TEST_GATB (debruijn_mphf_nodeindex);
         CPPUNIT_TEST_GATB (debruijn_traversal1);
+        CPPUNIT_TEST_GATB (debruijn_traversal_fast);
         
         CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -955,6 +962,215 @@ public:
         debruijn_build_aux (sequences, ARRAY_SIZE(sequences));
     }
 
+    /********************************************************************************/
+    void debruijn_bloomBlocked ()
+    {
+        /** The Bloom filter kind must not change the graph (false positives are removed by the cFP);
+         * the graphs are loaded from their files, so the 'blocked' Bloom filter is saved and loaded too. */
+        const char* kinds[] = { "neighbor", "blocked" };
+
+        debruijn_build_entry r[2];
+
+        for (size_t i=0; i<ARRAY_SIZE(kinds); i++)
+        {
+            Graph::create ("-in %s -kmer-size 31 -out g_%s -bloom %s -abundance-min 1 -verbose 0 -max-memory %d",
+                (DBPATH("reads1.fa")).c_str(), kinds[i], kinds[i], MAX_MEMORY
+            );
+
+            r[i] = debruijn_build_aux_aux ((string("g_") + kinds[i]).c_str(), true, true);
+
+            Graph::load (string("g_") + kinds[i]).remove();
+        }
+
+        CPPUNIT_ASSERT (r[0].nbNodes                > 0);
+        CPPUNIT_ASSERT (r[0].nbNodes                == r[1].nbNodes);
+        CPPUNIT_ASSERT (r[0].checksumNodes          == r[1].checksumNodes);
+        CPPUNIT_ASSERT (r[0].nbBranchingNodes       == r[1].nbBranchingNodes);
+        CPPUNIT_ASSERT (r[0].checksumBranchingNodes == r[1].checksumBranchingNodes);
+    }
+
+    /********************************************************************************/
+    void debruijn_mmap ()
+    {
+        /** A graph whose Bloom, cFP and MPHF are used in place from the mapped file must be the same
+         * as the graph read from the HDF5 file. */
+        const char* options[] = { "", "-mmap" };
+        const char* names[]   = { "g_h5", "g_mmap" };
+
+        for (size_t i=0; i<ARRAY_SIZE(names); i++)
+        {
+            Graph::create ("-in %s -kmer-size 31 -out %s %s -abundance-min 1 -verbose 0 -max-memory %d",
+                (DBPATH("reads1.fa")).c_str(), names[i], options[i], MAX_MEMORY
+            );
+        }
+
+        CPPUNIT_ASSERT (System::file().doesExist ("g_h5.mmap")   == false);
+        CPPUNIT_ASSERT (System::file().doesExist ("g_mmap.mmap") == true);
+
+        Graph graph1 = Graph::load (names[0]);
+        Graph graph2 = Graph::load (names[1]);
+
+        size_t nbNodes = 0;
+        GraphIterator<Node> it = graph1.iterator();
+        for (it.first(); !it.isDone(); it.next(), nbNodes++)
+        {
+            Node& node = it.item();
+
+            CPPUNIT_ASSERT (graph2.contains (node));
+            CPPUNIT_ASSERT (graph1.queryAbundance (node) == graph2.queryAbundance (node));
+            CPPUNIT_ASSERT (graph1.outdegree (node)      == graph2.outdegree (node));
+            CPPUNIT_ASSERT (graph1.indegree  (node)      == graph2.indegree  (node));
+        }
+        CPPUNIT_ASSERT (nbNodes > 0);
+
+        /** Node states are not shared with the mapped file. */
+        it.first();
+        graph2.deleteNode (it.item());
+        CPPUNIT_ASSERT (graph2.isNodeDeleted (it.item()) == true);
+        CPPUNIT_ASSERT (graph1.isNodeDeleted (it.item()) == false);
+
+        /** Without MPHF, nodes are removed from the cuckoo filter: it is copied from the (read only) mapping. */
+        Graph::create ("-in %s -kmer-size 31 -out g_mmap_cuckoo -mmap -debloom cuckoo -no-mphf -abundance-min 1 -verbose 0 -max-memory %d",
+            (DBPATH("reads1.fa")).c_str(), MAX_MEMORY
+        );
+        Graph graph3 = Graph::load ("g_mmap_cuckoo");
+        Graph graph4 = Graph::load ("g_mmap_cuckoo");
+
+        graph3.deleteNode (it.item());
+        CPPUNIT_ASSERT (graph3.contains (it.item()) == false);
+        CPPUNIT_ASSERT (graph4.contains (it.item()) == true);
+
+        /** The mapped file is removed with the graph. */
+        graph1.remove();
+        graph2.remove();
+        graph3.remove();
+        CPPUNIT_ASSERT (System::file().doesExist ("g_mmap.mmap") == false);
+    }
+
+    /********************************************************************************/
+    void debruijn_cuckoo ()
+    {
+        /** The nodes of a graph are put in a cuckoo filter instead of a Bloom filter and a cFP set;
+         * the graph has all the nodes of the exact graph, with a few false positive neighbors. */
+        const char* options[] = { "", "-debloom cuckoo -cuckoo-bits 16" };
+        const char* names[]   = { "g_cfp", "g_cuckoo" };
+
+        for (size_t i=0; i<ARRAY_SIZE(names); i++)
+        {
+            Graph::create ("-in %s -kmer-size 31 -out %s %s -abundance-min 1 -verbose 0 -max-memory %d",
+                (DBPATH("reads1.fa")).c_str(), names[i], options[i], MAX_MEMORY
+            );
+        }
+
+        Graph graph1 = Graph::load (names[0]);
+        Graph graph2 = Graph::load (names[1]);
+
+        size_t nbNodes = 0;
+        size_t nbDiffs = 0;
+        GraphIterator<Node> it = graph1.iterator();
+        for (it.first(); !it.isDone(); it.next(), nbNodes++)
+        {
+            Node& node = it.item();
+
+            CPPUNIT_ASSERT (graph2.contains (node));
+            CPPUNIT_ASSERT (graph1.queryAbundance (node) == graph2.queryAbundance (node));
+
+            nbDiffs += graph1.outdegree (node) != graph2.outdegree (node);
+        }
+        CPPUNIT_ASSERT (nbNodes > 0);
+        CPPUNIT_ASSERT (nbDiffs <= nbNodes/100);
+
+        it.first();
+        graph2.deleteNode (it.item());
+        CPPUNIT_ASSERT (graph2.isNodeDeleted (it.item()) == true);
+        CPPUNIT_ASSERT (graph2.contains (it.item())      == false);
+
+        /** Deleting a false positive neighbor must not remove the solid node sharing its fingerprint;
+         * small fingerprints give false positives enough. The node checks reject the kmers whose MPHF
+         * index belongs to another kmer, so no solid node is ever marked as deleted. */
+        Graph graph3 = Graph::create ("-in %s -kmer-size 31 -out g_cuckoo8 -debloom cuckoo -cuckoo-bits 8 -abundance-min 1 -verbose 0 -max-memory %d",
+            (DBPATH("reads1.fa")).c_str(), MAX_MEMORY
+        );
+
+        /** The same filter without MPHF tells the false positives among the candidates. */
+        Graph graph4 = Graph::create ("-in %s -kmer-size 31 -out g_cuckoo8_nomphf -debloom cuckoo -cuckoo-bits 8 -no-mphf -abundance-min 1 -verbose 0 -max-memory %d",
+            (DBPATH("reads1.fa")).c_str(), MAX_MEMORY
+        );
+
+        const char nucleotides[] = { 'A', 'C', 'T', 'G' };
+        size_t nbFalsePositives = 0;
+        for (it.first(); !it.isDone(); it.next())
+        {
+            /** We build all the possible successors, not only the ones reported by the graph. */
+            std::string kmer = graph3.toString (it.item());
+            for (size_t n=0; n<ARRAY_SIZE(nucleotides); n++)
+            {
+                std::string next = kmer.substr(1) + nucleotides[n];
+                Node neighbor = graph3.buildNode (next.c_str());
+                if (graph1.contains (neighbor))  { continue; }
+
+                CPPUNIT_ASSERT (graph3.contains (neighbor) == false);
+                graph3.deleteNode (neighbor);
+                nbFalsePositives += graph4.contains (neighbor);
+            }
+        }
+        CPPUNIT_ASSERT (nbFalsePositives > 0);
+
+        for (it.first(); !it.isDone(); it.next())
+        {
+            CPPUNIT_ASSERT (graph3.contains      (it.item()) == true);
+            CPPUNIT_ASSERT (graph3.isNodeDeleted (it.item()) == false);
+            CPPUNIT_ASSERT (graph3.outdegree (it.item()) == graph1.outdegree (it.item()));
+        }
+
+        graph1.remove();
+        graph2.remove();
+        graph3.remove();
+        graph4.remove();
+    }
+
+    /********************************************************************************/
+    void debruijn_bloomCounting ()
+    {
+        typedef Kmer<KMER_SPAN(0)>::Type  Type;
+        typedef Kmer<KMER_SPAN(0)>::Count Count;
+
+        /** The Bloom filter of the solid kmers is filled during the kmers counting (it is sized from the
+         * estimated number of solid kmers); it must be the same as a Bloom filter of the same size filled
+         * afterwards from the solid kmers. */
+        Graph graph = Graph::create ("-in %s -kmer-size 31 -out g_bloomcount -abundance-min 1 -verbose 0 -max-memory %d -estimate-kmers 1",
+            (DBPATH("reads1.fa")).c_str(), MAX_MEMORY
+        );
+
+        CPPUNIT_ASSERT (graph.getInfo().getInt ("bloom_in_counting") == 1);
+        CPPUNIT_ASSERT (graph.getInfo().getInt ("from_counting")     == 1);
+
+        Group& bloomGroup = graph.getStorage().getGroup("bloom");
+
+        IBloom<Type>* bloom1 = StorageTools::singleton().loadBloom<Type> (bloomGroup, "bloom");
+        LOCAL (bloom1);
+
+        BloomKind kind;  parse (bloomGroup.getProperty("kind"), kind);
+
+        BloomBuilder<KMER_SPAN(0)> builder (bloom1->getBitSize(), bloom1->getNbHash(), 31, kind);
+        IBloom<Type>* bloom2 = builder.build (graph.getStorage().getGroup("dsk").getPartition<Count>("solid").iterator());
+        LOCAL (bloom2);
+
+        CPPUNIT_ASSERT (bloom1->getSize() == bloom2->getSize());
+        CPPUNIT_ASSERT (memcmp (bloom1->getArray(), bloom2->getArray(), bloom1->getSize()) == 0);
+
+        /** Without memory enough for both the counting and the Bloom filter, the Bloom filter is built afterwards. */
+        Graph graph2 = Graph::create ("-in %s -kmer-size 31 -out g_bloomcount2 -abundance-min 1 -verbose 0 -max-memory 1 -estimate-kmers 1",
+            (DBPATH("reads1.fa")).c_str()
+        );
+
+        CPPUNIT_ASSERT (graph2.getInfo().getInt ("bloom_in_counting") == 0);
+        CPPUNIT_ASSERT (graph2.getInfo().getInt ("from_counting")     == 0);
+
+        graph.remove();
+        graph2.remove();
+    }
+
     /********************************************************************************/
     void debruijn_checksum_aux2 (
         const string& readfile,
@@ -1169,6 +1385,63 @@ public:
     	debruijn_traversal1_aux (true);
     }
 
+    /********************************************************************************/
+    struct TraversalFastParams
+    {
+        TraversalFastParams (const char* seq, TraversalKind kind, string& result) : seq(seq), kind(kind), result(result) {}
+        const char*   seq;
+        TraversalKind kind;
+        string&       result;
+    };
+
+    template<size_t span>  struct debruijn_traversal_fast_functor
+    {
+        void operator() (GraphFast<span>& graph, TraversalFastParams params) const
+        {
+            BranchingTerminatorFast<span> terminator (graph);
+
+            NodeFast<span> node = graph.buildNode (params.seq);
+
+            TraversalFast<span>* traversal = TraversalFast<span>::create (params.kind, graph, terminator);
+            LOCAL (traversal);
+
+            Path_t<NodeFast<span> > path;
+            traversal->traverse (node, DIR_OUTCOMING, path);
+
+            stringstream ss;  ss << graph.toString (node) << path;
+            params.result = ss.str();
+        }
+    };
+
+    void debruijn_traversal_fast ()
+    {
+        const char* seqs[] =
+        {
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA",
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCGATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA"
+            //      SNP HERE at pos 31      x
+        };
+
+        Graph graph = Graph::create (new BankStrings (seqs, ARRAY_SIZE(seqs)),
+            "-abundance-min 1  -verbose 0  -kmer-size 15  -max-memory %d", MAX_MEMORY
+        );
+
+        /** The traversals of the span-typed graph give the same paths as the ones of debruijn_traversal1. */
+        string result;
+
+        graph.applyFast<debruijn_traversal_fast_functor> (TraversalFastParams (seqs[0], TRAVERSAL_UNITIG, result));
+        CPPUNIT_ASSERT (result == "CGCTACAGCAGCTAGTTCATCATTGTTTATC");
+
+        graph.applyFast<debruijn_traversal_fast_functor> (TraversalFastParams (seqs[0], TRAVERSAL_CONTIG, result));
+        CPPUNIT_ASSERT (result == seqs[0]);
+
+        /** The data of the graph can't be used with another span. */
+        bool hasThrown = false;
+        try  {  GraphFast<KMER_SPAN(1)> graphFast (graph);  }
+        catch (gatb::core::system::Exception& e)  {  hasThrown = true;  }
+        CPPUNIT_ASSERT (hasThrown == true);
+    }
+
 
 
 
@@ -1199,6 +1472,24 @@ public:
         graph2.precomputeAdjacency(1, false);
         
         debruijn_deletenode_fct (graph2);
+
+        /* rerun this test with nodes in a cuckoo filter, removed from the filter itself (no MPHF) */
+
+        Graph graph3 = Graph::create (new BankStrings ("AGGCGCC", "ACTGACTGACTGACTG",0),  "-kmer-size 5  -abundance-min 1  -verbose 0  -max-memory %d -debloom cuckoo -no-mphf", MAX_MEMORY);
+
+        debruijn_deletenode_fct (graph3);
+
+        Node n3 = graph3.buildNode ((char*)"GCGCC");
+        CPPUNIT_ASSERT (graph3.contains (n3) == false);
+        CPPUNIT_ASSERT (graph3.isNodeDeleted (n3) == true);
+
+        /* a Bloom filter can't remove nodes: without MPHF, all nodes are still said deleted */
+
+        Graph graph4 = Graph::create (new BankStrings ("AGGCGCC", "ACTGACTGACTGACTG",0),  "-kmer-size 5  -abundance-min 1  -verbose 0  -max-memory %d -no-mphf", MAX_MEMORY);
+
+        Node n4 = graph4.buildNode ((char*)"GGCGC");
+        CPPUNIT_ASSERT (graph4.contains (n4) == true);
+        CPPUNIT_ASSERT (graph4.isNodeDeleted (n4) == true);
     }
 
     void debruijn_deletenode2_fct (const Graph& graph) 
@@ -26,14 +26,19 @@
 #include <gatb/bank/impl/Bank.hpp>
 
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
+#include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
+#include <gatb/kmer/impl/CountProcessor.hpp>
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/BankKmers.hpp>
+#include <gatb/kmer/impl/RadixSort.hpp>
+#include <gatb/kmer/impl/HashCounter.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/Histogram.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
@@ -101,7 +106,16 @@ class TestDSK : public Test
         CPPUNIT_TEST_GATB (DSK_perBank1);
         CPPUNIT_TEST_GATB (DSK_perBank2);
         CPPUNIT_TEST_GATB (DSK_perBankKmer);
+        CPPUNIT_TEST_GATB (DSK_perBankConcurrent);
         CPPUNIT_TEST_GATB (DSK_multibank);
+        CPPUNIT_TEST_GATB (DSK_radixSort);
+        CPPUNIT_TEST_GATB (DSK_pipeline);
+        CPPUNIT_TEST_GATB (DSK_partiInfo);
+        CPPUNIT_TEST_GATB (DSK_oversized);
+        CPPUNIT_TEST_GATB (DSK_estimations);
+        CPPUNIT_TEST_GATB (DSK_hashSpillInMemory);
+        CPPUNIT_TEST_GATB (DSK_processBatch);
+        CPPUNIT_TEST_GATB (DSK_hashCounter);
 		 
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -440,10 +454,9 @@ public:
 
     /********************************************************************************/
     template<size_t span>
-    void DSK_perBank_aux (IBank* bank, size_t kmerSize, size_t nksMin, size_t nksMax, KmerSolidityKind solidityKind, size_t checkNb)
+    void DSK_perBank_aux (IBank* bank, size_t kmerSize, size_t nksMin, size_t nksMax, KmerSolidityKind solidityKind, size_t checkNb, size_t nbCores=1)
     {
         size_t maxDiskSpace = 0;
-        size_t nbCores      = 1;
 
         /** We configure parameters for a SortingCountAlgorithm object. */
         IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
@@ -609,7 +622,7 @@ public:
     }
 
     /********************************************************************************/
-    void DSK_perBankKmer_aux (size_t kmerSize, size_t nbBanksMax)
+    void DSK_perBankKmer_aux (size_t kmerSize, size_t nbBanksMax, size_t nbCores=1)
     {
         /** We create a bank holding all 4^k kmers =>  we will have 4^k/2 canonical kmers with abundance==2  */
         IBank* kmersBank = new BankKmers(kmerSize);  LOCAL (kmersBank);
@@ -657,9 +670,9 @@ public:
                 /** For mode "sum" : N times composite banks have 2N coverage for each kmer. */
                 size_t checkSum = abundMin > 2*(i+1) ? 0 : nbKmersCanonical;
 
-                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_MIN, checkMin);
-                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_MAX, checkMax);
-                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_SUM, checkSum);
+                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_MIN, checkMin, nbCores);
+                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_MAX, checkMax, nbCores);
+                DSK_perBank_aux<KSIZE_1> (current, kmerSize, abundMin, abundMax, KMER_SOLIDITY_SUM, checkSum, nbCores);
             }
         }
 
@@ -674,6 +687,15 @@ public:
         DSK_perBankKmer_aux (11, 3);
     }
 
+    /********************************************************************************/
+    void DSK_perBankConcurrent ()
+    {
+        /** With several cores, the banks of the albums are read at the same time; the kmers of
+         * each bank must still be counted for this bank. */
+        DSK_perBankKmer_aux (9, 4, 2);
+        DSK_perBankKmer_aux (9, 4, 4);
+    }
+
     /********************************************************************************/
     struct DSK_multibank_aux  {  template<typename U> void operator() (U)
     {
@@ -703,6 +725,489 @@ public:
 
         boost::mpl::for_each<gatb::core::tools::math::IntegerList>(DSK_multibank_aux());
     }
+    /********************************************************************************/
+    struct DSK_radixSort_aux  {  template<typename U> void operator() (U)
+    {
+        typedef typename Kmer<U::value>::Type Type;
+
+        srand (1234);
+
+        /** We check several sizes, in order to go through both the radix and insertion sorts. */
+        size_t sizes[] = { 0, 1, 2, 31, 33, 1000, 100000 };
+
+        for (size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++)
+        {
+            size_t nb = sizes[s];
+
+            vector<Type>             kmers (nb);
+            vector<BankIdType> ids   (nb);
+            vector<pair<string,BankIdType> > check (nb);
+
+            for (size_t i=0; i<nb; i++)
+            {
+                /** We build kmers sharing a common upper byte, like in a DSK radix bucket,
+                 * with some duplicates. */
+                Type k;  k.setVal (0xAB);
+                for (size_t w=0; w<Type::getSize()/32; w++)  {  Type r;  r.setVal (rand() % (nb/4 + 1));  k = (k << 32) | r;  }
+
+                kmers[i] = k;
+                ids  [i] = rand() % 4;
+                check[i] = make_pair (k.toString(Type::getSize()/2), ids[i]);
+            }
+
+            RadixSort<Type,BankIdType>::sort (kmers.data(), ids.data(), nb);
+
+            for (size_t i=1; i<nb; i++)  {  CPPUNIT_ASSERT (! (kmers[i] < kmers[i-1]));  }
+
+            /** The bank ids must have moved along with their kmers. */
+            vector<pair<string,BankIdType> > result (nb);
+            for (size_t i=0; i<nb; i++)  {  result[i] = make_pair (kmers[i].toString(Type::getSize()/2), ids[i]);  }
+
+            std::sort (check.begin(),  check.end());
+            std::sort (result.begin(), result.end());
+            CPPUNIT_ASSERT (check == result);
+        }
+    }};
+
+    void DSK_radixSort ()
+    {
+        boost::mpl::for_each<gatb::core::tools::math::IntegerList>(DSK_radixSort_aux());
+    }
+
+    /********************************************************************************/
+    /** Check that overlapping the fill of pass N+1 with the counting of pass N gives
+     * the same solid kmers than the sequential scheduling of the passes. */
+    void DSK_pipeline ()
+    {
+        typedef Kmer<>::Type                    Type;
+        typedef SortingCountAlgorithm<>::Count  Count;
+
+        IBank* bank = Bank::open (DBPATH("reads1.fa"));
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+        LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+
+        ConfigurationAlgorithm<KMER_DEFAULT_SPAN> configAlgo (bank, params);
+        configAlgo.execute();
+
+        map<Type,CountNumber> counts[2];
+
+        for (size_t pipeline=0; pipeline<2; pipeline++)
+        {
+            /** We force several passes on disk, with or without overlap. */
+            Configuration config = configAlgo.getConfiguration();
+            config._nb_passes        = 3;
+            config._pipeline_passes  = (pipeline == 1);
+            config._superk_in_memory = false;
+
+            SortingCountAlgorithm<> dsk (bank, config, 0, vector<SortingCountAlgorithm<>::CountProcessor*>(), params);
+            dsk.execute();
+
+            Iterator<Count>* itCounts = dsk.getSolidCounts()->iterator();
+            LOCAL (itCounts);
+            for (itCounts->first(); !itCounts->isDone(); itCounts->next())  {  counts[pipeline][itCounts->item().value] = itCounts->item().abundance;  }
+        }
+
+        CPPUNIT_ASSERT (counts[0].size() > 0);
+        CPPUNIT_ASSERT (counts[0] == counts[1]);
+    }
+    /********************************************************************************/
+    /** Count a bank having a few oversized partitions with a tiny memory budget: these partitions
+     * are counted alone with all the cores, and the counts must be the same as with one core. */
+    void DSK_oversized ()
+    {
+        typedef Kmer<>::Type                    Type;
+        typedef SortingCountAlgorithm<>::Count  Count;
+
+        const char* nt = "ACGT";
+        srand (1);
+
+        /** Random reads, and many copies of one more read: the few partitions holding the kmers
+         * of the copied read are much bigger than the others. */
+        vector<string> seqs (2000);
+        for (size_t i=0; i<seqs.size(); i++)  {  for (size_t j=0; j<100; j++)  { seqs[i] += nt[rand()%4]; }  }
+        seqs.resize (seqs.size() + 3000, seqs[0]);
+
+        IBank* bank = new BankStrings (seqs);
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+        LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+        params->add    (0, STR_NB_CORES,        "%d", 4);
+
+        ConfigurationAlgorithm<KMER_DEFAULT_SPAN> configAlgo (bank, params);
+        configAlgo.execute();
+
+        map<Type,CountNumber> counts[2];
+        u_int64_t             nbOversized[2];
+
+        for (size_t tiny=0; tiny<2; tiny++)
+        {
+            Configuration config = configAlgo.getConfiguration();
+            config._nb_passes        = 1;
+            config._nb_partitions    = 64;   // enough partitions for the median one to be small
+            config._pipeline_passes  = false;
+            config._superk_in_memory = false;
+
+            if (tiny == 0)
+            {
+                /** Reference: one core, one partition at a time. */
+                config._nbCores                   = 1;
+                config._nb_partitions_in_parallel = 1;
+                config._nbCores_per_partition     = 1;
+            }
+            else
+            {
+                /** Several partitions in parallel, with a budget smaller than the big partitions. */
+                config._nbCores                   = 4;
+                config._nb_partitions_in_parallel = 4;
+                config._nbCores_per_partition     = 1;
+                config._max_memory                = 1;
+            }
+
+            SortingCountAlgorithm<> dsk (bank, config, 0, vector<SortingCountAlgorithm<>::CountProcessor*>(), params);
+            dsk.execute();
+
+            nbOversized[tiny] = dsk.getInfo()->getInt ("nb oversized partitions");
+
+            Iterator<Count>* itCounts = dsk.getSolidCounts()->iterator();
+            LOCAL (itCounts);
+            for (itCounts->first(); !itCounts->isDone(); itCounts->next())  {  counts[tiny][itCounts->item().value] = itCounts->item().abundance;  }
+        }
+
+        CPPUNIT_ASSERT (nbOversized[0] == 0);
+        CPPUNIT_ASSERT (nbOversized[1] >  0);
+        CPPUNIT_ASSERT (counts[0].size() > 0);
+        CPPUNIT_ASSERT (counts[0] == counts[1]);
+    }
+
+    /********************************************************************************/
+    /** Check the estimations of the distinct and solid kmers numbers done by the configuration. */
+    void DSK_estimations ()
+    {
+        const char* nt = "ACGT";
+        srand (2);
+
+        /** Random reads, the first half of them being repeated 3 times: the distinct kmers are
+         * the 80 kmers of each of the 2000 reads, the solid ones those of the 1000 repeated reads. */
+        vector<string> seqs (2000);
+        for (size_t i=0; i<seqs.size(); i++)  {  for (size_t j=0; j<100; j++)  { seqs[i] += nt[rand()%4]; }  }
+        for (size_t i=0; i<1000; i++)  {  seqs.push_back (seqs[i]);  seqs.push_back (seqs[i]);  }
+
+        IBank* bank = new BankStrings (seqs);
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+        LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 2);
+
+        /** The estimations are not computed by default. */
+        ConfigurationAlgorithm<KMER_DEFAULT_SPAN> configAlgo0 (bank, params);
+        configAlgo0.execute();
+        CPPUNIT_ASSERT (configAlgo0.getConfiguration()._estimatedDistinctKmerNb == 0);
+        CPPUNIT_ASSERT (configAlgo0.getConfiguration()._estimatedSolidKmerNb    == 0);
+
+        params->setInt (STR_ESTIMATE_KMERS, 1);
+
+        ConfigurationAlgorithm<KMER_DEFAULT_SPAN> configAlgo (bank, params);
+        configAlgo.execute();
+
+        Configuration config = configAlgo.getConfiguration();
+
+        /** The HyperLogLog error is about 1% and the solid ratio is computed from about 150 kmers. */
+        CPPUNIT_ASSERT (config._estimatedDistinctKmerNb > 160000*0.9  &&  config._estimatedDistinctKmerNb < 160000*1.1);
+        CPPUNIT_ASSERT (config._estimatedSolidKmerNb    >  80000*0.7  &&  config._estimatedSolidKmerNb    <  80000*1.3);
+
+        /** The partitions counted with hash tables sized from the estimation give the same counts
+         * as the sorted vectors. */
+        params->setStr (STR_URI_OUTPUT, "foo");
+
+        map<Kmer<>::Type,CountNumber> counts[2];
+
+        for (size_t hash=0; hash<2; hash++)
+        {
+            config._hash_counting = (hash == 1);
+
+            SortingCountAlgorithm<> dsk (bank, config, 0, vector<SortingCountAlgorithm<>::CountProcessor*>(), params);
+            dsk.execute();
+
+            Iterator<SortingCountAlgorithm<>::Count>* itCounts = dsk.getSolidCounts()->iterator();
+            LOCAL (itCounts);
+            for (itCounts->first(); !itCounts->isDone(); itCounts->next())  {  counts[hash][itCounts->item().value] = itCounts->item().abundance;  }
+        }
+
+        CPPUNIT_ASSERT (counts[0].size() > 80000*0.99);
+        CPPUNIT_ASSERT (counts[0] == counts[1]);
+    }
+
+    /********************************************************************************/
+    /** Count with hash tables too small for the partitions, the superkmers being kept in memory:
+     * the runs dumped by the full tables go into the (created) directory of the partitions. */
+    void DSK_hashSpillInMemory ()
+    {
+        const char* nt = "ACGT";
+        srand (3);
+
+        /** Random reads: about 160000 distinct kmers, ie. 80000 per partition. */
+        vector<string> seqs (2000);
+        for (size_t i=0; i<seqs.size(); i++)  {  for (size_t j=0; j<100; j++)  { seqs[i] += nt[rand()%4]; }  }
+
+        IBank* bank = new BankStrings (seqs);
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+        LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+
+        ConfigurationAlgorithm<KMER_DEFAULT_SPAN> configAlgo (bank, params);
+        configAlgo.execute();
+
+        map<Kmer<>::Type,CountNumber> counts[2];
+
+        for (size_t hash=0; hash<2; hash++)
+        {
+            Configuration config = configAlgo.getConfiguration();
+            config._nb_passes        = 1;
+            config._nb_partitions    = 2;
+            config._pipeline_passes  = false;
+            config._superk_in_memory = true;
+            config._hash_counting    = (hash == 1);
+
+            /** A tiny estimation gives hash tables of 1 MB, ie. about 45000 kmers: each partition
+             * is dumped at least once on disk. */
+            config._estimatedDistinctKmerNb = 1;
+
+            SortingCountAlgorithm<> dsk (bank, config, 0, vector<SortingCountAlgorithm<>::CountProcessor*>(), params);
+            dsk.execute();
+
+            Iterator<SortingCountAlgorithm<>::Count>* itCounts = dsk.getSolidCounts()->iterator();
+            LOCAL (itCounts);
+            for (itCounts->first(); !itCounts->isDone(); itCounts->next())  {  counts[hash][itCounts->item().value] = itCounts->item().abundance;  }
+        }
+
+        CPPUNIT_ASSERT (counts[0].size() > 160000*0.99);
+        CPPUNIT_ASSERT (counts[0] == counts[1]);
+    }
+
+    /********************************************************************************/
+    /** Check the PartiInfo statistics used for scheduling the partitions counting. */
+    void DSK_partiInfo ()
+    {
+        size_t nbParts = 6;
+        PartiInfo<5> pInfo (nbParts, 4);
+
+        /** We create a skewed distribution: partition 3 is much bigger than the others. */
+        u_int64_t sizes[] = { 10, 20, 10, 1000, 0, 30 };
+        for (size_t p=0; p<nbParts; p++)
+        {
+            for (size_t n=0; n<sizes[p]; n++)  {  pInfo.incKmer_and_rad (p, n%256, n%5);  }
+        }
+
+        vector<size_t> order = pInfo.getPartitionsBySize();
+        size_t check[] = { 3, 5, 1, 0, 2, 4 };
+        CPPUNIT_ASSERT (order.size() == nbParts);
+        for (size_t i=0; i<nbParts; i++)  {  CPPUNIT_ASSERT (order[i] == check[i]);  }
+
+        CPPUNIT_ASSERT (pInfo.getNbSuperKmerMedian() == 20);
+
+        /** The radix ranges of the big partition must cover all its items, without overlapping. */
+        for (size_t nbRanges=1; nbRanges<=8; nbRanges++)
+        {
+            vector<pair<int,int> > ranges;
+            pInfo.getRadixRanges (3, nbRanges, ranges);
+
+            CPPUNIT_ASSERT (ranges.size() > 0 && ranges.size() <= nbRanges);
+
+            u_int64_t total = 0;
+            for (size_t r=0; r<ranges.size(); r++)
+            {
+                CPPUNIT_ASSERT (ranges[r].first <= ranges[r].second);
+                if (r>0)  { CPPUNIT_ASSERT (ranges[r].first == ranges[r-1].second + 1); }
+
+                for (int b=ranges[r].first; b<=ranges[r].second; b++)  {  total += pInfo.getNbKmer (3, b%256, b/256);  }
+            }
+            CPPUNIT_ASSERT (total == sizes[3]);
+        }
+
+        /** An empty partition has no range. */
+        vector<pair<int,int> > ranges;
+        pInfo.getRadixRanges (4, 4, ranges);
+        CPPUNIT_ASSERT (ranges.empty());
+    }
+
+    /********************************************************************************/
+    /** Count processor that only implements 'process'; it gets batches through the default adapter. */
+    struct CountProcessorCollect : public CountProcessorAbstract<KMER_DEFAULT_SPAN>
+    {
+        typedef Kmer<KMER_DEFAULT_SPAN>::Type Type;
+
+        CountProcessorAbstract<KMER_DEFAULT_SPAN>* clone ()  { return new CountProcessorCollect(); }
+
+        bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum)
+        {
+            kmers.push_back (kmer);
+            sums.push_back  (sum);
+            return true;
+        }
+
+        vector<Type>        kmers;
+        vector<CountNumber> sums;
+    };
+
+    /** Check that processBatch gives the same results as process, including through a chain. */
+    void DSK_processBatch ()
+    {
+        typedef Kmer<KMER_DEFAULT_SPAN>::Type Type;
+
+        size_t nb = 100;
+        vector<Type>        kmers  (nb);
+        vector<CountNumber> counts (nb);
+        for (size_t i=0; i<nb; i++)  {  kmers[i].setVal (i);  counts[i] = i%7;  }
+
+        vector<CountRange> thresholds;
+        thresholds.push_back (CountRange (3, 1000));
+        vector<bool> solidVec (1, true);
+
+        /** The native batch version of the solidity processor must select the same kmers as 'process'. */
+        CountProcessorSoliditySum<KMER_DEFAULT_SPAN> solidity (thresholds, solidVec);
+        vector<u_int32_t> selected (nb);
+        size_t nbSelected = solidity.processBatch (0, &kmers[0], &counts[0], nb, 1, 0, &selected[0]);
+
+        size_t nbSolid = 0;
+        for (size_t i=0; i<nb; i++)
+        {
+            if (solidity.process (0, kmers[i], CountVector (1, counts[i]), counts[i]))
+            {
+                CPPUNIT_ASSERT (nbSolid < nbSelected && selected[nbSolid] == i);
+                nbSolid ++;
+            }
+        }
+        CPPUNIT_ASSERT (nbSelected == nbSolid);
+
+        /** The chain only gives the solid kmers to its last item, with their sums. */
+        CountProcessorHistogram<KMER_DEFAULT_SPAN>* histogram = new CountProcessorHistogram<KMER_DEFAULT_SPAN> ();
+        CountProcessorCollect*                      collect   = new CountProcessorCollect ();
+
+        CountProcessorChain<KMER_DEFAULT_SPAN>* chain = new CountProcessorChain<KMER_DEFAULT_SPAN> (
+            histogram,
+            new CountProcessorSoliditySum<KMER_DEFAULT_SPAN> (thresholds, solidVec),
+            collect,
+            NULL
+        );
+        LOCAL (chain);
+
+        /** We send the kmers in two batches. */
+        size_t half = nb/2;
+        size_t nbChain = chain->processBatch (0, &kmers[0],    &counts[0],    half,    1, 0, &selected[0]);
+        nbChain       += chain->processBatch (0, &kmers[half], &counts[half], nb-half, 1, 0, &selected[nbChain]);
+
+        CPPUNIT_ASSERT (nbChain == nbSolid);
+        CPPUNIT_ASSERT (collect->kmers.size() == nbSolid);
+
+        for (size_t j=0, i=0; i<nb; i++)
+        {
+            if (counts[i] < 3)  { continue; }
+            CPPUNIT_ASSERT (collect->kmers[j] == kmers[i]);
+            CPPUNIT_ASSERT (collect->sums [j] == counts[i]);
+            /** The selected indexes are relative to the batch. */
+            CPPUNIT_ASSERT (selected[j] == (i >= half ? i-half : i));
+            j++;
+        }
+
+        /** The histogram (first item of the chain) has seen all the kmers. */
+        for (size_t a=0; a<7; a++)  {  CPPUNIT_ASSERT (histogram->getHistogram()->get(a) == (nb+6-a)/7);  }
+
+        /** Without sums, the default adapter gives to 'process' the sum of the counts of each kmer. */
+        CountProcessorCollect collect2;
+        vector<CountNumber> counts2 (2*nb);
+        for (size_t i=0; i<nb; i++)  {  counts2[2*i] = i%7;  counts2[2*i+1] = i%3;  }
+
+        CPPUNIT_ASSERT (collect2.processBatch (0, &kmers[0], &counts2[0], nb, 2) == nb);
+        CPPUNIT_ASSERT (collect2.sums.size() == nb);
+        for (size_t i=0; i<nb; i++)  {  CPPUNIT_ASSERT (collect2.sums[i] == i%7 + i%3);  }
+    }
+
+    /********************************************************************************/
+    /** Command incrementing the keys i%nbKeys for i in [0..nb[ in a HashCounter. */
+    struct HashCounterCommand : public ICommand, public SmartPointer
+    {
+        typedef Kmer<KMER_DEFAULT_SPAN>::Type Type;
+
+        HashCounterCommand (HashCounter<Type>& table, size_t nb, size_t nbKeys) : table(table), nb(nb), nbKeys(nbKeys), nbFailed(0) {}
+
+        void execute ()
+        {
+            Type key;
+            for (size_t i=0; i<nb; i++)  {  key.setVal ((i*7919) % nbKeys);  if (!table.increment (key))  { nbFailed++; }  }
+        }
+
+        HashCounter<Type>& table;
+        size_t nb;
+        size_t nbKeys;
+        size_t nbFailed;
+    };
+
+    /** Check the concurrent hash table used for counting kmers in PartitionsByHashCommand. */
+    void DSK_hashCounter ()
+    {
+        typedef Kmer<KMER_DEFAULT_SPAN>::Type   Type;
+        typedef HashCounter<Type>::Count        Count;
+
+        size_t nbThreads = 4;
+        size_t nbKeys    = 5000;
+        size_t nbPerKey  = 3;
+
+        HashCounter<Type> table (1<<20);
+        CPPUNIT_ASSERT (table.getMaxNbItems() > nbKeys);
+
+        /** Several threads increment the same keys at the same time. */
+        vector<ICommand*> cmds;
+        for (size_t t=0; t<nbThreads; t++)  {  cmds.push_back (new HashCounterCommand (table, nbKeys*nbPerKey, nbKeys));  }
+        Dispatcher(nbThreads).dispatchCommands (cmds, 0);
+
+        CPPUNIT_ASSERT (table.getNbItems() == nbKeys);
+
+        /** The sorted content holds each key once, with the total number of occurrences. */
+        u_int64_t nbItems = table.sort();
+        CPPUNIT_ASSERT (nbItems == nbKeys);
+        for (size_t i=0; i<nbItems; i++)
+        {
+            CPPUNIT_ASSERT (table.getKeys()[i].getVal() == i);
+            CPPUNIT_ASSERT (table.getCounts()[i] == (CountNumber) (nbThreads*nbPerKey));
+        }
+
+        Iterator<Count>* it = table.iterator (10, 20);
+        LOCAL (it);
+        size_t nbIterated = 0;
+        for (it->first(); !it->isDone(); it->next(), nbIterated++)  {  CPPUNIT_ASSERT (it->item().value.getVal() == 10+nbIterated);  }
+        CPPUNIT_ASSERT (nbIterated == 10);
+
+        /** When the table is full, new keys are rejected but known keys are still counted. */
+        table.clear();
+        CPPUNIT_ASSERT (table.getNbItems() == 0);
+
+        HashCounterCommand fill (table, 2*table.getMaxNbItems(), 2*table.getMaxNbItems());
+        fill.execute();
+        CPPUNIT_ASSERT (table.isFull());
+        CPPUNIT_ASSERT (fill.nbFailed == table.getMaxNbItems());
+
+        Type known;  known.setVal(0);
+        CPPUNIT_ASSERT (table.increment (known) == true);
+    }
 };
 
 /********************************************************************************/
@@ -27,6 +27,8 @@
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/math/NucleotideCodec.hpp>
+#include <gatb/tools/math/NtHash.hpp>
 
 #include <gatb/bank/impl/Bank.hpp>
 #include <gatb/bank/impl/BankRandom.hpp>
@@ -78,6 +80,9 @@ class TestKmer : public Test
         CPPUNIT_TEST_GATB (kmer_minimizer2); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer3); // with ModelCanonical
         CPPUNIT_TEST_GATB (kmer_badchar);
+        CPPUNIT_TEST_GATB (kmer_minimizerBulk);
+        CPPUNIT_TEST_GATB (kmer_codec);
+        CPPUNIT_TEST_GATB (kmer_rollingHash);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -568,6 +573,294 @@ public:
         model.iterate (data, fct);
     }
 
+    /** */
+    template<typename KmerType>
+    struct kmer_minimizerBulk_functor
+    {
+        vector<KmerType>& kmers;
+        kmer_minimizerBulk_functor (vector<KmerType>& kmers) : kmers(kmers) {}
+        void operator() (const KmerType& kmer, size_t idx)  {  kmers.push_back (kmer);  }
+    };
+
+    template<typename ModelMinimizer>
+    void kmer_minimizerBulk_aux (const char* seq, size_t kmerSize, size_t mmerSize, uint32_t* freq_order)
+    {
+        typedef typename ModelMinimizer::Kmer KmerType;
+
+        ModelMinimizer model (kmerSize, mmerSize, typename Kmer<>::ComparatorMinimizerFrequencyOrLex(), freq_order);
+        typename ModelMinimizer::MinimizersBuffer buffer;
+
+        Data data (Data::ASCII);
+        data.set ((char*)seq, strlen(seq));
+
+        /** The bulk iteration must give the same minimizers than the kmer by kmer one. */
+        vector<KmerType> check, result;
+        model.iterate     (data, kmer_minimizerBulk_functor<KmerType>(check));
+        model.iterateBulk (data, kmer_minimizerBulk_functor<KmerType>(result), buffer);
+
+        CPPUNIT_ASSERT (check.size() == result.size());
+
+        for (size_t i=0; i<check.size(); i++)
+        {
+            CPPUNIT_ASSERT (check[i].value()              == result[i].value());
+            CPPUNIT_ASSERT (check[i].isValid()            == result[i].isValid());
+            CPPUNIT_ASSERT (check[i].minimizer().value()  == result[i].minimizer().value());
+            CPPUNIT_ASSERT (check[i].position()           == result[i].position());
+        }
+    }
+
+    void kmer_minimizerBulk (void)
+    {
+        typedef Kmer<>::ModelDirect                     ModelDirect;
+        typedef Kmer<>::ModelCanonical                  ModelCanonical;
+
+        const char* seq = "ATGTCTGAAGTGACCTAACATTGCAGTGTGTTAAAAAAAAAACCCNGATTAGCATTTTTTTTTTTGACGATCGAAAAGGCCTAGCAGTCAGAGAGCATTACAGACTTACGANNNNACGAGCTAGCTACGACT";
+
+        size_t mmerSize = 7;
+        uint32_t* freq_order = new uint32_t [1 << (2*mmerSize)];
+        for (size_t i=0; i<(1 << (2*mmerSize)); i++)  {  freq_order[i] = (i*2654435761U) % 1000;  }
+
+        size_t kmerSizes[] = { 7, 8, 15, 21, 31 };
+        for (size_t k=0; k<ARRAY_SIZE(kmerSizes); k++)
+        {
+            kmer_minimizerBulk_aux < Kmer<>::ModelMinimizer<ModelDirect>    > (seq, kmerSizes[k], mmerSize, 0);
+            kmer_minimizerBulk_aux < Kmer<>::ModelMinimizer<ModelCanonical> > (seq, kmerSizes[k], mmerSize, 0);
+            kmer_minimizerBulk_aux < Kmer<>::ModelMinimizer<ModelCanonical> > (seq, kmerSizes[k], mmerSize, freq_order);
+        }
+
+        delete[] freq_order;
+
+        /** Big mmers have no LUT: their codes are computed on the fly. */
+        size_t bigSizes[][2] = { {21,21}, {21,25}, {21,31}, {31,31} };
+        for (size_t k=0; k<ARRAY_SIZE(bigSizes); k++)
+        {
+            kmer_minimizerBulk_aux < Kmer<>::ModelMinimizer<ModelDirect>    > (seq, bigSizes[k][1], bigSizes[k][0], 0);
+            kmer_minimizerBulk_aux < Kmer<>::ModelMinimizer<ModelCanonical> > (seq, bigSizes[k][1], bigSizes[k][0], 0);
+        }
+    }
+
+    /********************************************************************************/
+    template<typename Model>
+    void kmer_codec_model (const string& seq, size_t kmerSize)
+    {
+        typedef typename Model::Kmer KmerType;
+
+        Model model (kmerSize);
+
+        Data data (Data::ASCII);
+        data.set ((char*)seq.data(), seq.size());
+
+        /** The kmers of the (codec) iteration must be the ones computed from scratch. */
+        vector<KmerType> result;
+        model.iterate (data, kmer_minimizerBulk_functor<KmerType>(result));
+
+        CPPUNIT_ASSERT (result.size() == (seq.size() >= kmerSize ? seq.size() - kmerSize + 1 : 0));
+
+        for (size_t i=0; i<result.size(); i++)
+        {
+            KmerType check = model.codeSeed (seq.data(), Data::ASCII, i);
+            CPPUNIT_ASSERT (check.value()   == result[i].value());
+            CPPUNIT_ASSERT (check.isValid() == result[i].isValid());
+        }
+    }
+
+    void kmer_codec_aux (const string& seq)
+    {
+        size_t length = seq.size();
+
+        vector<u_int8_t>  packed  (getPackedSize(length) + 1, 0);
+        vector<u_int8_t>  revcomp (getPackedSize(length) + 1, 0);
+        vector<u_int64_t> badMask (length/64 + 1, 0);
+
+        /** Packing: A=0, C=1, T=2, G=3 with the first nucleotide in the high bits of a byte. */
+        size_t nbBad = packNucleotides (seq.data(), length, &packed[0], &badMask[0]);
+
+        size_t nbBadCheck = 0;
+        for (size_t i=0; i<length; i++)
+        {
+            bool bad = strchr ("ACGTacgt", seq[i]) == 0;
+            nbBadCheck += bad;
+            CPPUNIT_ASSERT (((packed[i/4] >> (6-2*(i%4))) & 3) == ((seq[i]>>1) & 3));
+            CPPUNIT_ASSERT (((badMask[i/64] >> (i%64)) & 1) == bad);
+        }
+        CPPUNIT_ASSERT (nbBad == nbBadCheck);
+
+        /** Unpacking from any position. */
+        for (size_t start=0; start<length && start<8; start++)
+        {
+            string ascii (length-start, ' ');
+            unpackNucleotides (&packed[0], start, length-start, &ascii[0]);
+            for (size_t i=start; i<length; i++)  {  CPPUNIT_ASSERT (ascii[i-start] == "ACTG"[(seq[i]>>1) & 3]);  }
+        }
+
+        /** Reverse complement of the packed sequence. */
+        reverseComplementPacked (&packed[0], length, &revcomp[0]);
+        for (size_t i=0; i<length; i++)
+        {
+            CPPUNIT_ASSERT (((revcomp[i/4] >> (6-2*(i%4))) & 3) == (((seq[length-1-i]>>1) & 3) ^ 2));
+        }
+
+        /** Forward and reverse complement kmers. */
+        size_t kmerSizes[] = { 1, 5, 11, 21, 29, 30, 31, 32 };
+        for (size_t k=0; k<ARRAY_SIZE(kmerSizes) && kmerSizes[k]<=length; k++)
+        {
+            size_t kmerSize = kmerSizes[k];
+            size_t nbKmers  = length - kmerSize + 1;
+
+            vector<u_int64_t> forward (nbKmers), reverse (nbKmers);
+            buildKmers (&packed[0], &revcomp[0], length, kmerSize, &forward[0], &reverse[0]);
+
+            for (size_t i=0; i<nbKmers; i++)
+            {
+                u_int64_t fw=0, rc=0;
+                for (size_t j=0; j<kmerSize; j++)
+                {
+                    fw = (fw << 2) + ((seq[i+j]>>1) & 3);
+                    rc = (rc << 2) + (((seq[i+kmerSize-1-j]>>1) & 3) ^ 2);
+                }
+                CPPUNIT_ASSERT (forward[i] == fw);
+                CPPUNIT_ASSERT (reverse[i] == rc);
+            }
+        }
+    }
+
+    void kmer_codec (void)
+    {
+        const char* initialKernel = getCodecKernelName();
+
+        const char* kernels[] = { "scalar", "sse4", "avx2" };
+
+        for (size_t n=0; n<ARRAY_SIZE(kernels); n++)
+        {
+            /** The kernel may not be supported by the CPU. */
+            if (setCodecKernel (kernels[n]) == false)  { continue; }
+
+            srand (n);
+
+            /** The lengths cover the tails of the SIMD kernels. */
+            for (size_t length=0; length<200; length++)
+            {
+                string seq (length, 'A');
+                for (size_t i=0; i<length; i++)  {  seq[i] = "ACGTacgtN" [rand() % (length%2 ? 4 : 9)];  }
+
+                kmer_codec_aux (seq);
+            }
+
+            /** The kmers of the models go beyond the blocks of the codec iteration. */
+            string seq (3000, 'A');
+            for (size_t i=0; i<seq.size(); i++)  {  seq[i] = "ACGTN" [rand() % (i<2000 ? 4 : 5)];  }
+
+            size_t kmerSizes[] = { 5, 21, 31 };
+            for (size_t k=0; k<ARRAY_SIZE(kmerSizes); k++)
+            {
+                kmer_codec_model <Kmer<>::ModelDirect>    (seq, kmerSizes[k]);
+                kmer_codec_model <Kmer<>::ModelCanonical> (seq, kmerSizes[k]);
+                kmer_codec_model <Kmer<>::ModelCanonical> (seq.substr (0, 20), kmerSizes[k]);
+            }
+        }
+
+        setCodecKernel (initialKernel);
+    }
+
+    /********************************************************************************/
+    template<size_t span>
+    void kmer_rollingHash_aux (const string& seq, size_t kmerSize)
+    {
+        typedef typename Kmer<span>::ModelRollingHash  ModelRollingHash;
+        typedef typename Kmer<span>::ModelCanonical    ModelCanonical;
+
+        ModelRollingHash model     (kmerSize);
+        ModelCanonical   modelCano (kmerSize);
+
+        Data data (Data::ASCII);
+        data.set ((char*)seq.data(), seq.size());
+
+        vector<typename ModelRollingHash::Kmer> kmers;
+        vector<typename ModelCanonical::Kmer>   check;
+        model.iterate     (data, kmer_minimizerBulk_functor<typename ModelRollingHash::Kmer>(kmers));
+        modelCano.iterate (data, kmer_minimizerBulk_functor<typename ModelCanonical::Kmer>  (check));
+
+        CPPUNIT_ASSERT (kmers.size() == check.size());
+
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            /** The kmers are the canonical ones, and the rolling hash is the one computed from scratch,
+             * from both strands. */
+            CPPUNIT_ASSERT (kmers[i].value()   == check[i].value());
+            CPPUNIT_ASSERT (kmers[i].isValid() == check[i].isValid());
+            CPPUNIT_ASSERT (kmers[i].hash()    == model.getHash (kmers[i].forward()));
+            CPPUNIT_ASSERT (kmers[i].hash()    == model.getHash (kmers[i].revcomp()));
+
+            if (kmerSize <= 32)  {  CPPUNIT_ASSERT (kmers[i].hash() == ntHashCanonical (kmers[i].forward().getVal(), kmerSize));  }
+        }
+    }
+
+    void kmer_rollingHash (void)
+    {
+        string seq (500, 'A');
+        srand (0);
+        for (size_t i=0; i<seq.size(); i++)  {  seq[i] = "ACGTN" [rand() % 5];  }
+
+        size_t kmerSizes[] = { 5, 21, 31 };
+        for (size_t k=0; k<ARRAY_SIZE(kmerSizes); k++)  {  kmer_rollingHash_aux<KMER_SPAN(0)> (seq, kmerSizes[k]);  }
+
+#if KSIZE_32
+#else
+        static const size_t KSIZE_2 = KMER_SPAN(1);
+        kmer_rollingHash_aux<KSIZE_2> (seq, 33);
+        kmer_rollingHash_aux<KSIZE_2> (seq, KSIZE_2-1);
+
+        static const size_t KSIZE_4 = KMER_SPAN(3);
+        kmer_rollingHash_aux<KSIZE_4> (seq, KSIZE_4-1);
+#endif
+
+        /** Minimizers in the hash order, whose hashes are rolled by ModelMinimizer. */
+        size_t minimizerSizes[][2] = { {21,9}, {5,3}, {9,9}, {31,4}, {31,31} };
+        for (size_t i=0; i<ARRAY_SIZE(minimizerSizes); i++)  {  kmer_minimizerHash_aux<KMER_SPAN(0)> (seq, minimizerSizes[i][0], minimizerSizes[i][1]);  }
+
+#if KSIZE_32
+#else
+        kmer_minimizerHash_aux<KSIZE_2> (seq, 45, 13);
+#endif
+    }
+
+    /********************************************************************************/
+    template<size_t span>
+    void kmer_minimizerHash_aux (const string& seq, size_t kmerSize, size_t mmerSize)
+    {
+        /** Minimizers in the hash order: the minimizer of a kmer is its mmer with the smallest hash,
+         * the forbidden mmers being replaced by the default minimizer (as given by a model with m=k). */
+        typedef typename Kmer<span>::ComparatorMinimizerHash                                       Comparator;
+        typedef typename Kmer<span>::template ModelMinimizer<typename Kmer<span>::ModelCanonical, Comparator> ModelMinimizer;
+        typedef typename Kmer<span>::Type                                                          Type;
+
+        ModelMinimizer model     (kmerSize, mmerSize);
+        ModelMinimizer modelMmer (mmerSize, mmerSize);
+
+        Comparator cmp;
+        Type defaultMinimizer;
+        cmp.init (modelMmer.getMmersModel(), defaultMinimizer);
+
+        Data data (Data::ASCII);
+        data.set ((char*)seq.data(), seq.size());
+
+        vector<typename ModelMinimizer::Kmer> kmers;
+        model.iterate (data, kmer_minimizerBulk_functor<typename ModelMinimizer::Kmer>(kmers));
+
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            /** The mmers are compared by hashes computed from scratch. */
+            Type best = defaultMinimizer;
+            for (size_t j=0; j+mmerSize<=kmerSize; j++)
+            {
+                Type mmer = modelMmer.codeSeed (seq.data() + i + j, Data::ASCII).minimizer().value();
+                if (cmp (mmer, best))  { best = mmer; }
+            }
+            CPPUNIT_ASSERT (kmers[i].minimizer().value() == best);
+            CPPUNIT_ASSERT (model.getMinimizerValue (kmers[i].value()) == best.getVal());
+        }
+    }
+
     void kmer_tostring (void)
     {
 #if KSIZE_32
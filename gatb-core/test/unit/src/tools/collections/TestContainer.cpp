@@ -20,8 +20,13 @@
 
 #define USE_LARGEINT_CONSTRUCTOR 1 // one of the only cases where LargeInt should be using its constructor; but got lazy to want to change the unit tests here.
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
+#include <gatb/tools/collections/impl/CuckooFilter.hpp>
+#include <gatb/debruijn/impl/ContainerNode.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/math/NativeInt64.hpp>
 #include <gatb/tools/math/NativeInt128.hpp>
@@ -36,6 +41,9 @@ using namespace std;
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 using namespace gatb::core::tools::math;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::dp::impl;
+using namespace gatb::core::debruijn::impl;
 
 /********************************************************************************/
 namespace gatb  {  namespace tests  {
@@ -51,6 +59,11 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (bloom_checkContainsHash);
+        CPPUNIT_TEST_GATB (bloom_checkContainsBatch);
+        CPPUNIT_TEST_GATB (cuckoo_checkRemove);
+        CPPUNIT_TEST_GATB (cuckoo_checkConcurrentInsert);
+        CPPUNIT_TEST_GATB (hyperloglog_checkEstimate);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -132,6 +145,227 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    void bloom_checkContainsHash_aux (IBloom<LargeInt<2> >* bloom)
+    {
+        LOCAL (bloom);
+
+        size_t nbItems = 10000;
+
+        /** We insert hashes of items (as given by a rolling hash for instance). */
+        for (size_t i=0; i<nbItems; i++)  {  bloom->insertHash (i * 0x9E3779B97F4A7C15ULL);  }
+
+        /** No false negative. */
+        for (size_t i=0; i<nbItems; i++)  {  CPPUNIT_ASSERT (bloom->containsHash (i * 0x9E3779B97F4A7C15ULL) == true);  }
+
+        /** Few false positives: 8 bits per item with 4 hash functions give about 2.5%. */
+        size_t nbFalsePositives = 0;
+        for (size_t i=nbItems; i<2*nbItems; i++)  {  nbFalsePositives += bloom->containsHash (i * 0x9E3779B97F4A7C15ULL);  }
+        CPPUNIT_ASSERT (nbFalsePositives < nbItems / 20);
+    }
+
+    /** */
+    void bloom_checkContainsHash ()
+    {
+        bloom_checkContainsHash_aux (new Bloom             <LargeInt<2> > (8*10000));
+        bloom_checkContainsHash_aux (new Bloom             <LargeInt<2> > (1<<16));
+        bloom_checkContainsHash_aux (new BloomSynchronized <LargeInt<2> > (8*10000));
+        bloom_checkContainsHash_aux (new BloomCacheCoherent<LargeInt<2> > (8*10000));
+        bloom_checkContainsHash_aux (new BloomBlocked      <LargeInt<2> > (8*10000, 0, 4));
+    }
+
+    /********************************************************************************/
+    LargeInt<2> bloom_checkContainsBatch_item (size_t i)  {  return LargeInt<2> ((i * 0x9E3779B97F4A7C15ULL) & ((1ULL << 62) - 1));  }
+
+    void bloom_checkContainsBatch_aux (Container<LargeInt<2> >* container, Bag<LargeInt<2> >* bag, bool noFalseNegative)
+    {
+        LOCAL (container);
+
+        size_t nbItems = 10000;
+
+        vector<LargeInt<2> > items;
+        for (size_t i=0; i<2*nbItems; i++)  {  items.push_back (bloom_checkContainsBatch_item (i));  }
+
+        /** We insert the first half of the items. */
+        for (size_t i=0; i<nbItems; i++)  {  bag->insert (items[i]);  }
+
+        /** The batched answers must be the ones of contains, for batches of various sizes. */
+        vector<u_int8_t> out (items.size());
+        for (size_t i=0, n=1; i<items.size(); i+=n, n=(n%13)+1)
+        {
+            container->containsBatch (&items[i], std::min (n, items.size()-i), &out[i]);
+        }
+
+        for (size_t i=0; i<items.size(); i++)
+        {
+            CPPUNIT_ASSERT ((out[i] != 0) == container->contains (items[i]));
+            if (noFalseNegative && i<nbItems)  {  CPPUNIT_ASSERT (out[i] == 1);  }
+        }
+    }
+
+    /** */
+    void bloom_checkContainsBatch ()
+    {
+        IBloom<LargeInt<2> >* blooms[] =
+        {
+            new Bloom                 <LargeInt<2> > (8*10000),
+            new Bloom                 <LargeInt<2> > (1<<16),
+            new BloomCacheCoherent    <LargeInt<2> > (8*10000),
+            new BloomNeighborCoherent <LargeInt<2> > (8*10000, 31),
+            new BloomBlocked          <LargeInt<2> > (8*10000, 31, 4),
+            new BloomCacheCoherent    <LargeInt<2> > (8*10000, 24),
+            new BloomNeighborCoherent <LargeInt<2> > (8*10000, 31, 24)
+        };
+
+        /** The cache coherent filters have at most 20 hash functions. */
+        CPPUNIT_ASSERT (blooms[5]->getNbHash() == 20);
+        CPPUNIT_ASSERT (blooms[6]->getNbHash() == 20);
+
+        for (size_t i=0; i<ARRAY_SIZE(blooms); i++)  {  bloom_checkContainsBatch_aux (blooms[i], blooms[i], true);  }
+
+        /** Node containers; their cFP structures are mimicked by Bloom filters holding some of the items. */
+        IBloom<LargeInt<2> >* bloom = new Bloom<LargeInt<2> > (8*10000);
+        LOCAL (bloom);
+
+        vector<IBloom<LargeInt<2> >*> cfp;
+        for (size_t j=0; j<4; j++)
+        {
+            cfp.push_back (new Bloom<LargeInt<2> > (8*10000));
+            cfp[j]->use();
+            for (size_t i=0; i<2*10000; i+=j+2)  {  cfp[j]->insert (bloom_checkContainsBatch_item (i));  }
+        }
+
+        bloom_checkContainsBatch_aux (new ContainerNodeNoCFP    <LargeInt<2> > (bloom),                                 bloom, true);
+        bloom_checkContainsBatch_aux (new ContainerNode         <LargeInt<2> > (bloom, cfp[0]),                         bloom, false);
+        bloom_checkContainsBatch_aux (new ContainerNodeCascading<LargeInt<2> > (bloom, cfp[0], cfp[1], cfp[2], cfp[3]), bloom, false);
+
+        for (size_t j=0; j<4; j++)  {  cfp[j]->forget();  }
+    }
+
+    /********************************************************************************/
+    void cuckoo_checkRemove ()
+    {
+        size_t nbItems = 10000;
+
+        vector<LargeInt<2> > items;
+        for (size_t i=0; i<2*nbItems; i++)  {  items.push_back (bloom_checkContainsBatch_item (i));  }
+
+        size_t fingerprintBits[] = { 4, 8, 12, 16 };
+
+        for (size_t f=0; f<ARRAY_SIZE(fingerprintBits); f++)
+        {
+            CuckooFilter<LargeInt<2> > filter (nbItems, fingerprintBits[f]);
+
+            /** We insert the first half of the items. */
+            for (size_t i=0; i<nbItems; i++)  {  filter.insert (items[i]);  }
+            CPPUNIT_ASSERT (filter.getNbItems() == nbItems);
+
+            /** No false negative, and about 2*(64/f)/2^f false positives. */
+            size_t nbFalsePositives = 0;
+            for (size_t i=0; i<2*nbItems; i++)
+            {
+                if (i < nbItems)  {  CPPUNIT_ASSERT (filter.contains (items[i]));  }
+                else              {  nbFalsePositives += filter.contains (items[i]);  }
+            }
+            double fpr = 2.0 * (64/fingerprintBits[f]) / (1 << fingerprintBits[f]);
+            CPPUNIT_ASSERT (nbFalsePositives <= 2*fpr*nbItems + 10);
+
+            /** We remove one item out of two; the other ones must stay in the filter. */
+            size_t nbRemainders = 0;
+            for (size_t i=0; i<nbItems; i+=2)  {  CPPUNIT_ASSERT (filter.remove (items[i]));  }
+            for (size_t i=0; i<nbItems; i++)
+            {
+                if (i%2==1)  {  CPPUNIT_ASSERT (filter.contains (items[i]));  }
+                else         {  nbRemainders += filter.contains (items[i]);   }
+            }
+            CPPUNIT_ASSERT (filter.getNbItems() == nbItems/2);
+            CPPUNIT_ASSERT (nbRemainders <= 2*fpr*nbItems + 10);
+        }
+
+        /** The batched queries, directly and through the node container. */
+        CuckooFilter<LargeInt<2> >* filter1 = new CuckooFilter<LargeInt<2> > (nbItems);
+        bloom_checkContainsBatch_aux (filter1, filter1, true);
+
+        CuckooFilter<LargeInt<2> >* filter2 = new CuckooFilter<LargeInt<2> > (nbItems);
+        LOCAL (filter2);
+        bloom_checkContainsBatch_aux (new ContainerNodeCuckoo<LargeInt<2> > (filter2), filter2, true);
+    }
+
+    /********************************************************************************/
+    void cuckoo_checkConcurrentInsert ()
+    {
+        size_t nbItems = 100000;
+
+        vector<LargeInt<2> > items;
+        for (size_t i=0; i<nbItems; i++)  {  items.push_back (bloom_checkContainsBatch_item (i));  }
+
+        /** Small fingerprints fill the buckets, so some insertions have to move fingerprints. */
+        size_t fingerprintBits[] = { 8, 12 };
+
+        for (size_t f=0; f<ARRAY_SIZE(fingerprintBits); f++)
+        {
+            CuckooFilter<LargeInt<2> > filter (nbItems, fingerprintBits[f]);
+
+            /** The items are inserted by several threads. */
+            Range<size_t>::Iterator* it = new Range<size_t>::Iterator (0, nbItems-1);
+            Dispatcher(8).iterate (it, [&] (size_t i)  {  filter.insert (items[i]);  }, 100);
+
+            /** No item is lost. */
+            CPPUNIT_ASSERT (filter.getNbItems() == nbItems);
+            for (size_t i=0; i<nbItems; i++)  {  CPPUNIT_ASSERT (filter.contains (items[i]));  }
+        }
+    }
+
+    /********************************************************************************/
+    template<typename Item> void hyperloglog_checkEstimate_aux (u_int64_t nbItems, size_t precision)
+    {
+        HyperLogLog<Item> hll (precision);
+        HyperLogLog<Item> hll1 (precision);
+        HyperLogLog<Item> hll2 (precision);
+
+        /** Each item is inserted 3 times; half of them are also put in each partial sketch. */
+        for (size_t n=0; n<3; n++)
+        {
+            for (u_int64_t i=0; i<nbItems; i++)
+            {
+                Item item (i*2654435761ULL + 17);
+                hll.insert (item);
+                if (i%2==0)  { hll1.insert (item); }  else  { hll2.insert (item); }
+            }
+        }
+
+        /** We accept 5 times the standard error (1.04/sqrt(2^precision)). */
+        double maxError = 5 * 1.04 / sqrt ((double) ((u_int64_t)1 << precision));
+
+        u_int64_t estimation = hll.estimate();
+        CPPUNIT_ASSERT (fabs ((double)estimation - (double)nbItems) <= maxError * nbItems + 1);
+
+        /** The merge of the partial sketches must be the same as the whole sketch. */
+        hll1.merge (hll2);
+        CPPUNIT_ASSERT (hll1.estimate() == estimation);
+
+        hll.clear ();
+        CPPUNIT_ASSERT (hll.estimate() == 0);
+    }
+
+    /** */
+    void hyperloglog_checkEstimate ()
+    {
+        u_int64_t nbItems[] = { 10, 1000, 50000, 1000000 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbItems); i++)
+        {
+            hyperloglog_checkEstimate_aux<NativeInt64>  (nbItems[i], 14);
+            hyperloglog_checkEstimate_aux<LargeInt<1> > (nbItems[i], 12);
+            hyperloglog_checkEstimate_aux<LargeInt<2> > (nbItems[i], 16);
+        }
+
+        /** Sketches of different precisions can't be merged. */
+        HyperLogLog<NativeInt64> hll1 (10);
+        HyperLogLog<NativeInt64> hll2 (12);
+        CPPUNIT_ASSERT_THROW (hll1.merge (hll2), core::system::Exception);
+    }
 };
 
 /********************************************************************************/
@@ -55,6 +55,7 @@ class TestIterators : public Test
         CPPUNIT_TEST_GATB (iterators_checkVariant1);
         CPPUNIT_TEST_GATB (iterators_checkVariant2);
         CPPUNIT_TEST_GATB (iterators_adaptator);
+        CPPUNIT_TEST_GATB (iterators_checkMergeIterator);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -360,6 +361,63 @@ public:
             CPPUNIT_ASSERT (itAdapt.item() == table[i].x);
         }
     }
+
+    /********************************************************************************/
+    void iterators_checkMergeIterator ()
+    {
+        int values1[] = {1,4,4,9,12};
+        int values2[] = {2,3,4,20};
+        int values3[] = {0,30};
+
+        list<int> l1 (values1, values1 + ARRAY_SIZE(values1));
+        list<int> l2 (values2, values2 + ARRAY_SIZE(values2));
+        list<int> l3 (values3, values3 + ARRAY_SIZE(values3));
+        list<int> l4;
+
+        vector<Iterator<int>*> iterators;
+        iterators.push_back (new ListIterator<int> (l1));
+        iterators.push_back (new ListIterator<int> (l4));
+        iterators.push_back (new ListIterator<int> (l2));
+        iterators.push_back (new ListIterator<int> (l3));
+
+        MergeIterator<int>* it = new MergeIterator<int> (iterators);
+        LOCAL (it);
+
+        int check[] = {0,1,2,3,4,4,4,9,12,20,30};
+        size_t nbItems = 0;
+        for (it->first(); !it->isDone(); it->next())
+        {
+            CPPUNIT_ASSERT (nbItems < ARRAY_SIZE(check) && it->item() == check[nbItems]);
+            nbItems++;
+        }
+        CPPUNIT_ASSERT (nbItems == ARRAY_SIZE(check));
+
+        /** We check the merge for different numbers of random sorted lists. */
+        srand (0);
+        for (size_t k=1; k<=9; k++)
+        {
+            vector< list<int> > lists (k);
+            vector<int>         all;
+            for (size_t i=0; i<k; i++)
+            {
+                size_t len = rand() % 50;
+                for (size_t j=0; j<len; j++)  { lists[i].push_back (rand() % 100); }
+                lists[i].sort();
+                all.insert (all.end(), lists[i].begin(), lists[i].end());
+            }
+            std::sort (all.begin(), all.end());
+
+            vector<Iterator<int>*> its;
+            for (size_t i=0; i<k; i++)  {  its.push_back (new ListIterator<int> (lists[i]));  }
+
+            MergeIterator<int>* itMerge = new MergeIterator<int> (its);
+            LOCAL (itMerge);
+
+            vector<int> merged;
+            for (itMerge->first(); !itMerge->isDone(); itMerge->next())  {  merged.push_back (itMerge->item());  }
+            CPPUNIT_ASSERT (merged == all);
+        }
+    }
 };
 
 /********************************************************************************/
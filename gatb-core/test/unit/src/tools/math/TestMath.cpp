@@ -38,6 +38,7 @@ class TestMath : public Test
         CPPUNIT_TEST_GATB (math_checkBasic);
         CPPUNIT_TEST_GATB (math_checkFibo);
         CPPUNIT_TEST_GATB (math_test1);
+        CPPUNIT_TEST_GATB (math_checkWords);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -172,6 +173,70 @@ public:
         math_test1_template <LargeInt<4> >();
         math_test1_template <LargeInt<5> >();
     }
+
+    /********************************************************************************/
+    struct Nt2Code  {  int operator() (char c)  { return (c>>1) & 3; }  };
+
+    /** Random nucleotides sequence. */
+    static string math_randomSequence (size_t size)
+    {
+        string result (size, 'A');
+        for (size_t i=0; i<size; i++)  {  result[i] = "ACTG"[rand() % 4];  }
+        return result;
+    }
+
+    /** Check the specialized methods of LargeInt<precision> (see LargeIntWords.pri) against
+     * the generic ones of LargeInt<5>, which has no specialization. */
+    template <int precision> void math_checkWords_template ()
+    {
+        typedef LargeInt<precision> T;
+        typedef LargeInt<5>         R;
+
+        const size_t nbNt = 32*precision;
+
+        for (size_t n=0; n<1000; n++)
+        {
+            string sa = math_randomSequence (nbNt);
+            string sb = (n%10==0) ? sa : math_randomSequence (nbNt);
+
+            T a = T::polynom (sa.data(), nbNt, Nt2Code());
+            T b = T::polynom (sb.data(), nbNt, Nt2Code());
+            R ra = R::polynom (sa.data(), nbNt, Nt2Code());
+            R rb = R::polynom (sb.data(), nbNt, Nt2Code());
+
+            CPPUNIT_ASSERT (a.toString(nbNt)  == sa);
+            CPPUNIT_ASSERT (ra.toString(nbNt) == sa);
+
+            CPPUNIT_ASSERT ((a + b).toString(nbNt) == (ra + rb).toString(nbNt));
+            CPPUNIT_ASSERT ((a - b).toString(nbNt) == (ra - rb).toString(nbNt));
+            CPPUNIT_ASSERT ((a + (u_int64_t)n).toString(nbNt) == (ra + (u_int64_t)n).toString(nbNt));
+
+            CPPUNIT_ASSERT ((a == b) == (ra == rb));
+            CPPUNIT_ASSERT ((a != b) == (ra != rb));
+            CPPUNIT_ASSERT ((a <  b) == (ra <  rb));
+            CPPUNIT_ASSERT ((b <  a) == (rb <  ra));
+            CPPUNIT_ASSERT ((a <= b) == (ra <= rb));
+
+            int shift = rand() % (64*precision);
+            CPPUNIT_ASSERT ((a << shift).toString(nbNt) == (ra << shift).toString(nbNt));
+            CPPUNIT_ASSERT ((a >> shift).toString(nbNt) == (ra >> shift).toString(nbNt));
+            CPPUNIT_ASSERT ((a << 2).toString(nbNt) == (ra << 2).toString(nbNt));
+            CPPUNIT_ASSERT ((a >> 2).toString(nbNt) == (ra >> 2).toString(nbNt));
+
+            size_t kmerSize = 1 + rand() % nbNt;
+            T kmer = a >> (2*(nbNt - kmerSize));
+            CPPUNIT_ASSERT (revcomp (kmer, kmerSize).toString(nbNt) == revcomp (ra >> (2*(nbNt - kmerSize)), kmerSize).toString(nbNt));
+            CPPUNIT_ASSERT (revcomp (revcomp (kmer, kmerSize), kmerSize) == kmer);
+        }
+    }
+
+    void math_checkWords ()
+    {
+        srand (0);
+        math_checkWords_template<2> ();
+        math_checkWords_template<3> ();
+        math_checkWords_template<4> ();
+    }
 };
 
 /********************************************************************************/
@@ -62,6 +62,7 @@ class TestMisc : public Test
         // DEACTIVATED BECAUSE OF MACOS (TO BE INVESTIGATED...)  CPPUNIT_TEST_GATB (vector_check1);
         CPPUNIT_TEST_GATB (vector_check2);
         CPPUNIT_TEST_GATB (vector_check3);
+        CPPUNIT_TEST_GATB (vector_check4);
         CPPUNIT_TEST_GATB (parser_check1);
         CPPUNIT_TEST_GATB (parser_check2);
 
@@ -234,6 +235,35 @@ public:
         CPPUNIT_ASSERT (ref3[2] == 21);
     }
 
+    /********************************************************************************/
+    /** \brief Check that resizing a vector referring to some data copies this data. */
+    void vector_check4 ()
+    {
+        char table[] = { 1, 2, 3, 5, 8, 13, 21, 34, 55, 89};
+
+        /** A vector referring to a buffer not allocated with MALLOC. */
+        Vector<char> v1;
+        v1.setRef (table, ARRAY_SIZE(table));
+        CPPUNIT_ASSERT (v1.getBuffer() == table);
+
+        v1.resize (4);
+        CPPUNIT_ASSERT (v1.getBuffer() != table);
+        CPPUNIT_ASSERT (v1.size() == 4);
+        for (size_t i=0; i<v1.size(); i++)  {  CPPUNIT_ASSERT (v1[i] == table[i]);  }
+
+        v1.resize (2*ARRAY_SIZE(table));
+        for (size_t i=0; i<4; i++)  {  CPPUNIT_ASSERT (v1[i] == table[i]);  }
+
+        /** A vector referring to another vector. */
+        Vector<char>* ref = new Vector<char> (ARRAY_SIZE(table));
+        for (size_t i=0; i<ARRAY_SIZE(table); i++)  { (*ref)[i] = table[i]; }
+
+        Vector<char> v2;  v2.setRef (ref, 3, 5);  // should hold 5, 8, 13, 21, 34
+        v2.resize (8);
+        CPPUNIT_ASSERT (v2.size() == 8);
+        for (size_t i=0; i<5; i++)  {  CPPUNIT_ASSERT (v2[i] == table[i+3]);  }
+    }
+
     /********************************************************************************/
     void parser_check1_aux (IOptionsParser* parser, const string& str, bool ok, size_t nbProps, const string& check)
     {
@@ -74,6 +74,9 @@ class TestStorage : public Test
 
         CPPUNIT_TEST_GATB (storage_HDF5_check_collection);
         CPPUNIT_TEST_GATB (storage_HDF5_check_partition);
+
+        CPPUNIT_TEST_GATB (storage_superkmer_lockfree);
+        CPPUNIT_TEST_GATB (storage_superkmer_memory);
         
         CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -447,7 +450,85 @@ public:
         free(buffer2);
     }
 
+    /********************************************************************************/
+
+    struct SuperKmerWriter
+    {
+        SuperKmerBinFiles& _files;
+        SuperKmerWriter (SuperKmerBinFiles& files) : _files(files) {}
+
+        void operator() (const size_t& item)
+        {
+            /** A block holds its item id followed by a variable number of copies of its low byte. */
+            unsigned int size  = 4 + item%50;
+            u_int8_t*    block = (u_int8_t*) MALLOC (size);
+
+            u_int32_t id = item;  memcpy (block, &id, sizeof(id));
+            for (size_t i=4; i<size; i++)  { block[i] = item & 0xFF; }
+
+            /** In memory, the block itself is kept by the files. */
+            _files.writeBlock (block, size, item % _files.nbFiles(), 1);
+            if (_files.isInMemory() == false)  { FREE (block); }
+        }
+    };
+
+    void storage_superkmer_aux (bool lockFree, bool inMemory)
+    {
+        size_t nbFiles = 7;
+        size_t nbItems = 100*1000;
+
+        string path = System::file().getTemporaryDirectory() + "/superk_check";
+        SuperKmerBinFiles files (path, "superk", nbFiles, lockFree, inMemory);
+
+        /** The directory is created even in memory, for the files put next to the partitions. */
+        CPPUNIT_ASSERT (System::file().doesExist (path) == true);
+
+        /** Several threads write blocks into the same files without lock. */
+        Range<size_t>::Iterator it (0, nbItems-1);
+        Dispatcher(8).iterate (it, SuperKmerWriter(files));
+
+        files.flushFiles();
+        files.closeFiles();
+
+        /** We read back the files and check that each block is complete and found once. */
+        vector<bool> found (nbItems, false);
+        size_t nbFound = 0;
+
+        unsigned char* block     = 0;
+        unsigned int   blockSize = 0;
+        unsigned int   nbBytes   = 0;
+
+        for (size_t f=0; f<nbFiles; f++)
+        {
+            files.openFile ("rb", f);
+
+            while (files.readBlock (&block, &blockSize, &nbBytes, f))
+            {
+                u_int32_t id;  memcpy (&id, block, sizeof(id));
+
+                CPPUNIT_ASSERT (id < nbItems);
+                CPPUNIT_ASSERT (id % nbFiles == f);
+                CPPUNIT_ASSERT (nbBytes == 4 + id%50);
+                for (size_t i=4; i<nbBytes; i++)  {  CPPUNIT_ASSERT (block[i] == (id & 0xFF));  }
+
+                CPPUNIT_ASSERT (found[id] == false);
+                found[id] = true;
+                nbFound++;
+            }
+
+            CPPUNIT_ASSERT (files.getNbItems(f) == (int) ((nbItems + nbFiles - 1 - f) / nbFiles));
+
+            files.closeFile (f);
+        }
+
+        CPPUNIT_ASSERT (nbFound == nbItems);
+
+        FREE (block);
+    }
+
+    void storage_superkmer_lockfree ()  {  storage_superkmer_aux (true,  false);  }
 
+    void storage_superkmer_memory ()    {  storage_superkmer_aux (false, true);   }
 };
 
 /********************************************************************************/